@@ -0,0 +1,149 @@
+#include <pcl/common/point_tests.h> // for isFinite
+#include <pcl/io/pcd_io.h>              // for PCDReader
+#include <pcl/search/kdtree.h>          // for KdTree
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm> // for count_if
+
+template <typename Tree>
+static void
+BM_KdTreeBuild(benchmark::State& state, const std::string& file)
+{
+  // Perform setup here
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::PCDReader reader;
+  reader.read(file, *cloud);
+  pcl::search::KdTree<pcl::PointXYZ, Tree> tree;
+  for (auto _ : state) {
+    // This code gets timed
+    tree.setInputCloud(cloud);
+  }
+}
+
+template <typename Tree>
+static void
+BM_KdTreeNearestKSearch(benchmark::State& state, const std::string& file)
+{
+  // Perform setup here
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::PCDReader reader;
+  reader.read(file, *cloud);
+  pcl::search::KdTree<pcl::PointXYZ, Tree> tree;
+  tree.setInputCloud(cloud);
+  const auto k = static_cast<int>(state.range(0));
+  const auto nr_queries = std::count_if(
+      cloud->begin(), cloud->end(), [](const pcl::PointXYZ& point) {
+        return pcl::isFinite(point);
+      });
+  pcl::Indices k_indices;
+  std::vector<float> k_sqr_distances;
+  for (auto _ : state) {
+    // This code gets timed
+    for (const auto& point : *cloud) {
+      if (!pcl::isFinite(point))
+        continue;
+      tree.nearestKSearch(point, k, k_indices, k_sqr_distances);
+      benchmark::DoNotOptimize(k_indices.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * nr_queries);
+}
+
+template <typename Tree>
+static void
+BM_KdTreeRadiusSearch(benchmark::State& state, const std::string& file)
+{
+  // Perform setup here
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::PCDReader reader;
+  reader.read(file, *cloud);
+  pcl::search::KdTree<pcl::PointXYZ, Tree> tree;
+  tree.setInputCloud(cloud);
+  const double radius = state.range(0) / 1000.0; // in millimeters
+  const auto nr_queries = std::count_if(
+      cloud->begin(), cloud->end(), [](const pcl::PointXYZ& point) {
+        return pcl::isFinite(point);
+      });
+  pcl::Indices k_indices;
+  std::vector<float> k_sqr_distances;
+  for (auto _ : state) {
+    // This code gets timed
+    for (const auto& point : *cloud) {
+      if (!pcl::isFinite(point))
+        continue;
+      tree.radiusSearch(point, radius, k_indices, k_sqr_distances);
+      benchmark::DoNotOptimize(k_indices.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * nr_queries);
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc < 3) {
+    std::cerr
+        << "No test files given. Please download `table_scene_mug_stereo_textured.pcd` "
+           "and `milk_cartoon_all_small_clorox.pcd`, and pass their paths to the test."
+        << std::endl;
+    return (-1);
+  }
+
+  using FLANN = pcl::KdTreeFLANN<pcl::PointXYZ>;
+  using Native = pcl::KdTree3D<pcl::PointXYZ>;
+
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeBuild_FLANN_mug", &BM_KdTreeBuild<FLANN>, argv[1])
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeBuild_3D_mug", &BM_KdTreeBuild<Native>, argv[1])
+      ->Unit(benchmark::kMillisecond);
+
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeNearestKSearch_FLANN_mug", &BM_KdTreeNearestKSearch<FLANN>, argv[1])
+      ->Arg(10)
+      ->Arg(50)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeNearestKSearch_3D_mug", &BM_KdTreeNearestKSearch<Native>, argv[1])
+      ->Arg(10)
+      ->Arg(50)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeNearestKSearch_FLANN_milk", &BM_KdTreeNearestKSearch<FLANN>, argv[2])
+      ->Arg(10)
+      ->Arg(50)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeNearestKSearch_3D_milk", &BM_KdTreeNearestKSearch<Native>, argv[2])
+      ->Arg(10)
+      ->Arg(50)
+      ->Unit(benchmark::kMillisecond);
+
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeRadiusSearch_FLANN_mug", &BM_KdTreeRadiusSearch<FLANN>, argv[1])
+      ->Arg(5)
+      ->Arg(10)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeRadiusSearch_3D_mug", &BM_KdTreeRadiusSearch<Native>, argv[1])
+      ->Arg(5)
+      ->Arg(10)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeRadiusSearch_FLANN_milk", &BM_KdTreeRadiusSearch<FLANN>, argv[2])
+      ->Arg(5)
+      ->Arg(10)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(
+      "BM_KdTreeRadiusSearch_3D_milk", &BM_KdTreeRadiusSearch<Native>, argv[2])
+      ->Arg(5)
+      ->Arg(10)
+      ->Unit(benchmark::kMillisecond);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+}
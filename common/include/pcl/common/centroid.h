@@ -494,6 +494,26 @@ namespace pcl
     return (computeMeanAndCovarianceMatrix<PointT, double> (cloud, indices, covariance_matrix, centroid));
   }
 
+  /** \brief Compute the normalized 3x3 covariance matrices and the centroids of a batch of point neighborhoods,
+    * with the same results as computeMeanAndCovarianceMatrix called on each neighborhood.
+    * The coordinates of each neighborhood are gathered into structure-of-arrays buffers and the 9 moments
+    * are accumulated several points at a time with SIMD instructions (AVX, SSE or NEON, depending on the compile flags).
+    * The eigen33 overloads for batches of matrices take the resulting covariance matrices as they are.
+    * \param[in] cloud the input point cloud
+    * \param[in] neighborhoods the indices of the points of each neighborhood
+    * \param[out] covariance_matrices the resultant 3x3 covariance matrix of each neighborhood
+    * \param[out] centroids the centroid of each neighborhood
+    * \param[out] point_counts number of valid points used for each neighborhood. Covariance matrices and centroids
+    * of neighborhoods without valid points are left uninitialized.
+    * \ingroup common
+    */
+  template <typename PointT> inline void
+  computeMeanAndCovarianceMatrices (const pcl::PointCloud<PointT> &cloud,
+                                    const std::vector<pcl::Indices> &neighborhoods,
+                                    std::vector<Eigen::Matrix3f> &covariance_matrices,
+                                    std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > &centroids,
+                                    std::vector<unsigned int> &point_counts);
+
   /** \brief Compute the normalized 3x3 covariance matrix for a already demeaned point cloud.
     * Normalized means that every entry has been divided by the number of entries in the input point cloud.
     * For small number of points, or if you want explicitly the sample-variance, scale the covariance matrix
@@ -57,6 +57,7 @@
 #include <Eigen/StdVector>
 #include <Eigen/Geometry>
 #include <Eigen/LU>
+#include <vector>
 
 namespace pcl
 {
@@ -129,6 +130,28 @@ namespace pcl
   template <typename Matrix, typename Vector> void
   eigen33 (const Matrix &mat, Matrix &evecs, Vector &evals);
 
+  /** \brief determines the smallest eigenvalue and its eigenvector for a batch of symmetric positive semi definite
+    * matrices. Several matrices are solved at once, one per SIMD lane (AVX, SSE or NEON, depending on the compile
+    * flags), with the same closed form solution as the single matrix version.
+    * \param[in] mats symmetric positive semi definite input matrices
+    * \param[out] eigenvalues smallest eigenvalue of each input matrix
+    * \param[out] eigenvectors the corresponding eigenvector of each input matrix
+    * \ingroup common
+    */
+  inline void
+  eigen33 (const std::vector<Eigen::Matrix3f> &mats, std::vector<float> &eigenvalues, std::vector<Eigen::Vector3f> &eigenvectors);
+
+  /** \brief determines the eigenvalues and eigenvectors for a batch of symmetric positive semi definite matrices,
+    * solving several matrices at once, one per SIMD lane. Matrices with repeated eigenvalues fall back to the
+    * single matrix version.
+    * \param[in] mats symmetric positive semi definite input matrices
+    * \param[out] evecs corresponding eigenvectors of each input matrix in correct order according to eigenvalues
+    * \param[out] evals resulting eigenvalues of each input matrix in ascending order
+    * \ingroup common
+    */
+  inline void
+  eigen33 (const std::vector<Eigen::Matrix3f> &mats, std::vector<Eigen::Matrix3f> &evecs, std::vector<Eigen::Vector3f> &evals);
+
   /** \brief Calculate the inverse of a 2x2 matrix
     * \param[in] matrix matrix to be inverted
     * \param[out] inverse the resultant inverted matrix
@@ -43,12 +43,15 @@
 #include <pcl/common/centroid.h>
 #include <pcl/conversions.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/common/impl/simd_float.hpp> // for detail::SimdFloat
 #include <Eigen/Eigenvalues> // for EigenSolver
 
 #include <boost/fusion/algorithm/transformation/filter_if.hpp> // for boost::fusion::filter_if
 #include <boost/fusion/algorithm/iteration/for_each.hpp> // for boost::fusion::for_each
 #include <boost/mpl/size.hpp> // for boost::mpl::size
 
+#include <algorithm> // for std::fill
+
 
 namespace pcl
 {
@@ -659,6 +662,104 @@ computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
   return (computeMeanAndCovarianceMatrix (cloud, indices.indices, covariance_matrix, centroid));
 }
 
+
+template <typename PointT> inline void
+computeMeanAndCovarianceMatrices (const pcl::PointCloud<PointT> &cloud,
+                                  const std::vector<pcl::Indices> &neighborhoods,
+                                  std::vector<Eigen::Matrix3f> &covariance_matrices,
+                                  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > &centroids,
+                                  std::vector<unsigned int> &point_counts)
+{
+  using detail::SimdFloat;
+  constexpr std::size_t width = SimdFloat::size;
+  covariance_matrices.resize (neighborhoods.size ());
+  centroids.resize (neighborhoods.size ());
+  point_counts.resize (neighborhoods.size ());
+
+  // Structure-of-arrays buffers for the shifted coordinates, large enough for the biggest neighborhood
+  // rounded up to a whole number of registers
+  std::size_t max_size = 0;
+  for (const auto &neighborhood : neighborhoods)
+    max_size = std::max (max_size, neighborhood.size ());
+  const std::size_t buffer_size = (max_size + width - 1) / width * width;
+  std::vector<float> xs (buffer_size), ys (buffer_size), zs (buffer_size);
+  alignas (32) float lanes[9][SimdFloat::size];
+
+  for (std::size_t n = 0; n < neighborhoods.size (); ++n)
+  {
+    const Indices &indices = neighborhoods[n];
+    // Shifted data/with estimate of mean, see computeMeanAndCovarianceMatrix
+    Eigen::Vector3f K (0.0f, 0.0f, 0.0f);
+    for (const auto &index : indices)
+      if (isFinite (cloud[index]))
+      {
+        K = Eigen::Vector3f (cloud[index].x, cloud[index].y, cloud[index].z);
+        break;
+      }
+
+    std::size_t point_count = 0;
+    for (const auto &index : indices)
+    {
+      const PointT &point = cloud[index];
+      if (!cloud.is_dense && !isFinite (point))
+        continue;
+      xs[point_count] = point.x - K.x ();
+      ys[point_count] = point.y - K.y ();
+      zs[point_count] = point.z - K.z ();
+      ++point_count;
+    }
+    point_counts[n] = static_cast<unsigned int> (point_count);
+    if (point_count == 0)
+      continue;
+
+    // Zero padding does not contribute to any of the moments
+    const std::size_t end = (point_count + width - 1) / width * width;
+    std::fill (xs.begin () + point_count, xs.begin () + end, 0.0f);
+    std::fill (ys.begin () + point_count, ys.begin () + end, 0.0f);
+    std::fill (zs.begin () + point_count, zs.begin () + end, 0.0f);
+
+    SimdFloat sums[9];
+    for (auto &sum : sums)
+      sum = detail::simdSet (0.0f);
+    for (std::size_t i = 0; i < end; i += width)
+    {
+      const SimdFloat x = detail::simdLoad (&xs[i]), y = detail::simdLoad (&ys[i]), z = detail::simdLoad (&zs[i]);
+      sums[0] += x * x;
+      sums[1] += x * y;
+      sums[2] += x * z;
+      sums[3] += y * y;
+      sums[4] += y * z;
+      sums[5] += z * z;
+      sums[6] += x;
+      sums[7] += y;
+      sums[8] += z;
+    }
+
+    Eigen::Matrix<float, 1, 9, Eigen::RowMajor> accu = Eigen::Matrix<float, 1, 9, Eigen::RowMajor>::Zero ();
+    for (int k = 0; k < 9; ++k)
+    {
+      detail::simdStore (lanes[k], sums[k]);
+      for (std::size_t lane = 0; lane < width; ++lane)
+        accu[k] += lanes[k][lane];
+    }
+
+    accu /= static_cast<float> (point_count);
+    Eigen::Vector4f &centroid = centroids[n];
+    centroid[0] = accu[6] + K.x (); centroid[1] = accu[7] + K.y (); centroid[2] = accu[8] + K.z ();
+    centroid[3] = 1;
+    Eigen::Matrix3f &covariance_matrix = covariance_matrices[n];
+    covariance_matrix.coeffRef (0) = accu [0] - accu [6] * accu [6];
+    covariance_matrix.coeffRef (1) = accu [1] - accu [6] * accu [7];
+    covariance_matrix.coeffRef (2) = accu [2] - accu [6] * accu [8];
+    covariance_matrix.coeffRef (4) = accu [3] - accu [7] * accu [7];
+    covariance_matrix.coeffRef (5) = accu [4] - accu [7] * accu [8];
+    covariance_matrix.coeffRef (8) = accu [5] - accu [8] * accu [8];
+    covariance_matrix.coeffRef (3) = covariance_matrix.coeff (1);
+    covariance_matrix.coeffRef (6) = covariance_matrix.coeff (2);
+    covariance_matrix.coeffRef (7) = covariance_matrix.coeff (5);
+  }
+}
+
 template <typename PointT, typename Scalar> inline unsigned int
 computeCentroidAndOBB (const pcl::PointCloud<PointT> &cloud,
   Eigen::Matrix<Scalar, 3, 1> &centroid,
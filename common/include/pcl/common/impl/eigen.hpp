@@ -39,11 +39,14 @@
 #pragma once
 
 #include <pcl/common/eigen.h>
+#include <pcl/common/impl/simd_float.hpp>
 #include <pcl/console/print.h>
 
 #include <array>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 
 namespace pcl
@@ -400,6 +403,214 @@ eigen33 (const Matrix& mat, Matrix& evecs, Vector& evals)
 }
 
 
+namespace detail
+{
+
+/** \brief Load the 6 distinct coefficients of the symmetric matrices mats[first] .. mats[first + SimdFloat::size - 1]
+  * into one register each, scaled so that every entry is in [-1,1] like in eigen33. Lanes past the end of mats
+  * hold zero matrices.
+  */
+inline void
+loadScaledSymmetric3x3 (const std::vector<Eigen::Matrix3f> &mats, std::size_t first, SimdFloat coeffs[6], SimdFloat &scale)
+{
+  alignas (32) float buffer[6][SimdFloat::size] = {};
+  const std::size_t width = SimdFloat::size;
+  const std::size_t count = std::min (width, mats.size () - first);
+  for (std::size_t lane = 0; lane < count; ++lane)
+  {
+    const Eigen::Matrix3f &mat = mats[first + lane];
+    buffer[0][lane] = mat.coeff (0, 0);
+    buffer[1][lane] = mat.coeff (0, 1);
+    buffer[2][lane] = mat.coeff (0, 2);
+    buffer[3][lane] = mat.coeff (1, 1);
+    buffer[4][lane] = mat.coeff (1, 2);
+    buffer[5][lane] = mat.coeff (2, 2);
+  }
+  for (int i = 0; i < 6; ++i)
+    coeffs[i] = simdLoad (buffer[i]);
+
+  scale = simdAbs (coeffs[0]);
+  for (int i = 1; i < 6; ++i)
+    scale = simdMax (scale, simdAbs (coeffs[i]));
+  scale = simdSelect (scale <= simdSet (std::numeric_limits<float>::min ()), simdSet (1.0f), scale);
+  for (int i = 0; i < 6; ++i)
+    coeffs[i] = coeffs[i] / scale;
+}
+
+/** \brief Lane-wise computeRoots of the symmetric matrices (m00, m01, m02, m11, m12, m22) in m.
+  * The roots are returned in ascending order.
+  */
+inline void
+simdComputeRoots (const SimdFloat m[6], SimdFloat &root0, SimdFloat &root1, SimdFloat &root2)
+{
+  const SimdFloat zero = simdSet (0.0f), one = simdSet (1.0f), two = simdSet (2.0f);
+  const SimdFloat c0 = m[0] * m[3] * m[5] + two * m[1] * m[2] * m[4]
+                     - m[0] * m[4] * m[4] - m[3] * m[2] * m[2] - m[5] * m[1] * m[1];
+  const SimdFloat c1 = m[0] * m[3] - m[1] * m[1] + m[0] * m[5] - m[2] * m[2] + m[3] * m[5] - m[4] * m[4];
+  const SimdFloat c2 = m[0] + m[3] + m[5];
+
+  const SimdFloat c2_over_3 = c2 * simdSet (1.0f / 3.0f);
+  const SimdFloat a_over_3 = simdMin ((c1 - c2 * c2_over_3) * simdSet (1.0f / 3.0f), zero);
+  const SimdFloat half_b = simdSet (0.5f) * (c0 + c2_over_3 * (two * c2_over_3 * c2_over_3 - c1));
+  const SimdFloat rho = simdSqrt (zero - a_over_3);
+
+  // The atan2 (sqrt (-q), half_b) of computeRoots equals acos (half_b / rho^3), since -q = rho^6 - half_b^2
+  const SimdFloat rho3 = rho * rho * rho;
+  const SimdFloat cos_3theta = simdSelect (zero < rho3,
+                                           simdMax (simdMin (half_b / rho3, one), simdSet (-1.0f)),
+                                           simdSelect (half_b < zero, simdSet (-1.0f), one));
+  SimdFloat cos_theta, sin_theta;
+  simdCosSin (simdAcos (cos_3theta) * simdSet (1.0f / 3.0f), cos_theta, sin_theta);
+
+  // theta is in [0, pi/3], which already sorts the roots
+  const SimdFloat sqrt3_sin_theta = simdSet (1.73205080757f) * sin_theta;
+  root0 = c2_over_3 - rho * (cos_theta + sqrt3_sin_theta);
+  root1 = c2_over_3 - rho * (cos_theta - sqrt3_sin_theta);
+  root2 = c2_over_3 + two * rho * cos_theta;
+
+  // One root is 0: solve the remaining quadratic like computeRoots2
+  const SimdMask quadratic = (simdAbs (c0) < simdSet (Eigen::NumTraits<float>::epsilon ())) | (root0 <= zero);
+  const SimdFloat sd = simdSqrt (simdMax (c2 * c2 - simdSet (4.0f) * c1, zero));
+  root0 = simdSelect (quadratic, zero, root0);
+  root1 = simdSelect (quadratic, simdSet (0.5f) * (c2 - sd), root1);
+  root2 = simdSelect (quadratic, simdSet (0.5f) * (c2 + sd), root2);
+}
+
+/** \brief Lane-wise getLargest3x3Eigenvector of m - eigenvalue * I, m given as in simdComputeRoots. */
+inline SimdVector3
+simdLargest3x3Eigenvector (const SimdFloat m[6], const SimdFloat &eigenvalue, SimdFloat &length)
+{
+  const SimdVector3 row0 {m[0] - eigenvalue, m[1], m[2]};
+  const SimdVector3 row1 {m[1], m[3] - eigenvalue, m[4]};
+  const SimdVector3 row2 {m[2], m[4], m[5] - eigenvalue};
+  const SimdVector3 cross01 = simdCross (row0, row1);
+  const SimdVector3 cross02 = simdCross (row0, row2);
+  const SimdVector3 cross12 = simdCross (row1, row2);
+
+  // Like maxCoeff, prefer the first of several equally long cross products
+  SimdVector3 largest = cross12;
+  SimdFloat largest_sqr_len = simdSquaredNorm (cross12);
+  const SimdFloat sqr_len02 = simdSquaredNorm (cross02);
+  SimdMask longer = sqr_len02 >= largest_sqr_len;
+  largest = simdSelect (longer, cross02, largest);
+  largest_sqr_len = simdSelect (longer, sqr_len02, largest_sqr_len);
+  const SimdFloat sqr_len01 = simdSquaredNorm (cross01);
+  longer = sqr_len01 >= largest_sqr_len;
+  largest = simdSelect (longer, cross01, largest);
+  largest_sqr_len = simdSelect (longer, sqr_len01, largest_sqr_len);
+
+  length = simdSqrt (largest_sqr_len);
+  const SimdFloat inv_length = simdSet (1.0f) / length;
+  return {largest.x * inv_length, largest.y * inv_length, largest.z * inv_length};
+}
+
+}  // namespace detail
+
+
+inline void
+eigen33 (const std::vector<Eigen::Matrix3f> &mats, std::vector<float> &eigenvalues, std::vector<Eigen::Vector3f> &eigenvectors)
+{
+  using detail::SimdFloat;
+  eigenvalues.resize (mats.size ());
+  eigenvectors.resize (mats.size ());
+
+  alignas (32) float result[4][SimdFloat::size];
+  for (std::size_t first = 0; first < mats.size (); first += SimdFloat::size)
+  {
+    SimdFloat m[6], scale;
+    detail::loadScaledSymmetric3x3 (mats, first, m, scale);
+
+    SimdFloat root0, root1, root2, length;
+    detail::simdComputeRoots (m, root0, root1, root2);
+    const detail::SimdVector3 vector = detail::simdLargest3x3Eigenvector (m, root0, length);
+
+    detail::simdStore (result[0], root0 * scale);
+    detail::simdStore (result[1], vector.x);
+    detail::simdStore (result[2], vector.y);
+    detail::simdStore (result[3], vector.z);
+    const std::size_t width = SimdFloat::size;
+    const std::size_t count = std::min (width, mats.size () - first);
+    for (std::size_t lane = 0; lane < count; ++lane)
+    {
+      eigenvalues[first + lane] = result[0][lane];
+      eigenvectors[first + lane] = Eigen::Vector3f (result[1][lane], result[2][lane], result[3][lane]);
+    }
+  }
+}
+
+
+inline void
+eigen33 (const std::vector<Eigen::Matrix3f> &mats, std::vector<Eigen::Matrix3f> &evecs, std::vector<Eigen::Vector3f> &evals)
+{
+  using detail::SimdFloat;
+  using detail::SimdMask;
+  using detail::SimdVector3;
+  evecs.resize (mats.size ());
+  evals.resize (mats.size ());
+
+  const SimdFloat epsilon = detail::simdSet (Eigen::NumTraits<float>::epsilon ());
+  alignas (32) float result[12][SimdFloat::size];
+  for (std::size_t first = 0; first < mats.size (); first += SimdFloat::size)
+  {
+    SimdFloat m[6], scale;
+    detail::loadScaledSymmetric3x3 (mats, first, m, scale);
+
+    SimdFloat roots[3];
+    detail::simdComputeRoots (m, roots[0], roots[1], roots[2]);
+
+    // Repeated eigenvalues are left to the scalar eigen33, which picks an orthonormal basis for them
+    const int degenerate = detail::simdMaskBits (((roots[2] - roots[0]) <= epsilon) |
+                                                 ((roots[1] - roots[0]) <= epsilon) |
+                                                 ((roots[2] - roots[1]) <= epsilon));
+
+    SimdVector3 vecs[3];
+    SimdFloat lengths[3];
+    for (int i = 0; i < 3; ++i)
+      vecs[i] = detail::simdLargest3x3Eigenvector (m, roots[i], lengths[i]);
+
+    // Like eigen33, recompute the least and then the middle reliable vector (shortest and middle cross product)
+    // from the other two, where std::minmax_element picks the first minimum and the last maximum
+    const SimdMask is_min[3] = {(lengths[0] <= lengths[1]) & (lengths[0] <= lengths[2]),
+                                (lengths[1] < lengths[0]) & (lengths[1] <= lengths[2]),
+                                (lengths[2] < lengths[0]) & (lengths[2] < lengths[1])};
+    const SimdMask is_max[3] = {(lengths[0] > lengths[1]) & (lengths[0] > lengths[2]),
+                                (lengths[1] >= lengths[0]) & (lengths[1] > lengths[2]),
+                                (lengths[2] >= lengths[0]) & (lengths[2] >= lengths[1])};
+    SimdVector3 crossed[3];
+    for (int i = 0; i < 3; ++i)
+      crossed[i] = detail::simdNormalized (detail::simdCross (vecs[(i + 1) % 3], vecs[(i + 2) % 3]));
+    for (int i = 0; i < 3; ++i)
+      vecs[i] = detail::simdSelect (is_min[i], crossed[i], vecs[i]);
+    for (int i = 0; i < 3; ++i)
+      crossed[i] = detail::simdNormalized (detail::simdCross (vecs[(i + 1) % 3], vecs[(i + 2) % 3]));
+    for (int i = 0; i < 3; ++i)
+      vecs[i] = detail::simdSelect (!(is_min[i] | is_max[i]), crossed[i], vecs[i]);
+
+    for (int i = 0; i < 3; ++i)
+    {
+      detail::simdStore (result[3 * i], vecs[i].x);
+      detail::simdStore (result[3 * i + 1], vecs[i].y);
+      detail::simdStore (result[3 * i + 2], vecs[i].z);
+      detail::simdStore (result[9 + i], roots[i] * scale);
+    }
+    const std::size_t width = SimdFloat::size;
+    const std::size_t count = std::min (width, mats.size () - first);
+    for (std::size_t lane = 0; lane < count; ++lane)
+    {
+      if (degenerate & (1 << lane))
+      {
+        eigen33 (mats[first + lane], evecs[first + lane], evals[first + lane]);
+        continue;
+      }
+      Eigen::Matrix3f &vectors = evecs[first + lane];
+      for (int i = 0; i < 9; ++i)
+        vectors.coeffRef (i) = result[i][lane];
+      evals[first + lane] = Eigen::Vector3f (result[9][lane], result[10][lane], result[11][lane]);
+    }
+  }
+}
+
+
 template <typename Matrix> inline typename Matrix::Scalar
 invert2x2 (const Matrix& matrix, Matrix& inverse)
 {
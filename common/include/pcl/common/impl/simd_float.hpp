@@ -0,0 +1,254 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace pcl
+{
+namespace detail
+{
+/** \brief Thin wrapper around the widest float SIMD register available at compile time
+  * (AVX, SSE, AArch64 NEON, or a single float as fallback), used by the batched kernels of
+  * pcl/common to write one kernel body for every instruction set. A SimdMask holds the
+  * per-lane result of a comparison.
+  */
+#if defined(__AVX__)
+struct SimdFloat { __m256 v; static constexpr std::size_t size = 8; };
+struct SimdMask { __m256 v; };
+
+inline SimdFloat simdSet (float x) { return {_mm256_set1_ps (x)}; }
+inline SimdFloat simdLoad (const float *p) { return {_mm256_loadu_ps (p)}; }
+inline void simdStore (float *p, const SimdFloat &a) { _mm256_storeu_ps (p, a.v); }
+inline SimdFloat operator+ (const SimdFloat &a, const SimdFloat &b) { return {_mm256_add_ps (a.v, b.v)}; }
+inline SimdFloat operator- (const SimdFloat &a, const SimdFloat &b) { return {_mm256_sub_ps (a.v, b.v)}; }
+inline SimdFloat operator* (const SimdFloat &a, const SimdFloat &b) { return {_mm256_mul_ps (a.v, b.v)}; }
+inline SimdFloat operator/ (const SimdFloat &a, const SimdFloat &b) { return {_mm256_div_ps (a.v, b.v)}; }
+inline SimdFloat simdSqrt (const SimdFloat &a) { return {_mm256_sqrt_ps (a.v)}; }
+inline SimdFloat simdAbs (const SimdFloat &a) { return {_mm256_andnot_ps (_mm256_set1_ps (-0.0f), a.v)}; }
+inline SimdFloat simdMin (const SimdFloat &a, const SimdFloat &b) { return {_mm256_min_ps (a.v, b.v)}; }
+inline SimdFloat simdMax (const SimdFloat &a, const SimdFloat &b) { return {_mm256_max_ps (a.v, b.v)}; }
+inline SimdMask operator< (const SimdFloat &a, const SimdFloat &b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_LT_OQ)}; }
+inline SimdMask operator<= (const SimdFloat &a, const SimdFloat &b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_LE_OQ)}; }
+inline SimdMask operator> (const SimdFloat &a, const SimdFloat &b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_GT_OQ)}; }
+inline SimdMask operator>= (const SimdFloat &a, const SimdFloat &b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_GE_OQ)}; }
+inline SimdMask operator& (const SimdMask &a, const SimdMask &b) { return {_mm256_and_ps (a.v, b.v)}; }
+inline SimdMask operator| (const SimdMask &a, const SimdMask &b) { return {_mm256_or_ps (a.v, b.v)}; }
+inline SimdMask operator! (const SimdMask &a) { return {_mm256_xor_ps (a.v, _mm256_castsi256_ps (_mm256_set1_epi32 (-1)))}; }
+/** \brief Per lane: mask ? a : b */
+inline SimdFloat simdSelect (const SimdMask &mask, const SimdFloat &a, const SimdFloat &b) { return {_mm256_blendv_ps (b.v, a.v, mask.v)}; }
+/** \brief Bit i is set if lane i of the mask is set. */
+inline int simdMaskBits (const SimdMask &mask) { return _mm256_movemask_ps (mask.v); }
+
+#elif defined(__SSE2__)
+struct SimdFloat { __m128 v; static constexpr std::size_t size = 4; };
+struct SimdMask { __m128 v; };
+
+inline SimdFloat simdSet (float x) { return {_mm_set1_ps (x)}; }
+inline SimdFloat simdLoad (const float *p) { return {_mm_loadu_ps (p)}; }
+inline void simdStore (float *p, const SimdFloat &a) { _mm_storeu_ps (p, a.v); }
+inline SimdFloat operator+ (const SimdFloat &a, const SimdFloat &b) { return {_mm_add_ps (a.v, b.v)}; }
+inline SimdFloat operator- (const SimdFloat &a, const SimdFloat &b) { return {_mm_sub_ps (a.v, b.v)}; }
+inline SimdFloat operator* (const SimdFloat &a, const SimdFloat &b) { return {_mm_mul_ps (a.v, b.v)}; }
+inline SimdFloat operator/ (const SimdFloat &a, const SimdFloat &b) { return {_mm_div_ps (a.v, b.v)}; }
+inline SimdFloat simdSqrt (const SimdFloat &a) { return {_mm_sqrt_ps (a.v)}; }
+inline SimdFloat simdAbs (const SimdFloat &a) { return {_mm_andnot_ps (_mm_set1_ps (-0.0f), a.v)}; }
+inline SimdFloat simdMin (const SimdFloat &a, const SimdFloat &b) { return {_mm_min_ps (a.v, b.v)}; }
+inline SimdFloat simdMax (const SimdFloat &a, const SimdFloat &b) { return {_mm_max_ps (a.v, b.v)}; }
+inline SimdMask operator< (const SimdFloat &a, const SimdFloat &b) { return {_mm_cmplt_ps (a.v, b.v)}; }
+inline SimdMask operator<= (const SimdFloat &a, const SimdFloat &b) { return {_mm_cmple_ps (a.v, b.v)}; }
+inline SimdMask operator> (const SimdFloat &a, const SimdFloat &b) { return {_mm_cmpgt_ps (a.v, b.v)}; }
+inline SimdMask operator>= (const SimdFloat &a, const SimdFloat &b) { return {_mm_cmpge_ps (a.v, b.v)}; }
+inline SimdMask operator& (const SimdMask &a, const SimdMask &b) { return {_mm_and_ps (a.v, b.v)}; }
+inline SimdMask operator| (const SimdMask &a, const SimdMask &b) { return {_mm_or_ps (a.v, b.v)}; }
+inline SimdMask operator! (const SimdMask &a) { return {_mm_xor_ps (a.v, _mm_castsi128_ps (_mm_set1_epi32 (-1)))}; }
+/** \brief Per lane: mask ? a : b */
+inline SimdFloat simdSelect (const SimdMask &mask, const SimdFloat &a, const SimdFloat &b)
+{
+#ifdef __SSE4_1__
+  return {_mm_blendv_ps (b.v, a.v, mask.v)};
+#else
+  return {_mm_or_ps (_mm_and_ps (mask.v, a.v), _mm_andnot_ps (mask.v, b.v))};
+#endif
+}
+/** \brief Bit i is set if lane i of the mask is set. */
+inline int simdMaskBits (const SimdMask &mask) { return _mm_movemask_ps (mask.v); }
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+struct SimdFloat { float32x4_t v; static constexpr std::size_t size = 4; };
+struct SimdMask { uint32x4_t v; };
+
+inline SimdFloat simdSet (float x) { return {vdupq_n_f32 (x)}; }
+inline SimdFloat simdLoad (const float *p) { return {vld1q_f32 (p)}; }
+inline void simdStore (float *p, const SimdFloat &a) { vst1q_f32 (p, a.v); }
+inline SimdFloat operator+ (const SimdFloat &a, const SimdFloat &b) { return {vaddq_f32 (a.v, b.v)}; }
+inline SimdFloat operator- (const SimdFloat &a, const SimdFloat &b) { return {vsubq_f32 (a.v, b.v)}; }
+inline SimdFloat operator* (const SimdFloat &a, const SimdFloat &b) { return {vmulq_f32 (a.v, b.v)}; }
+inline SimdFloat operator/ (const SimdFloat &a, const SimdFloat &b) { return {vdivq_f32 (a.v, b.v)}; }
+inline SimdFloat simdSqrt (const SimdFloat &a) { return {vsqrtq_f32 (a.v)}; }
+inline SimdFloat simdAbs (const SimdFloat &a) { return {vabsq_f32 (a.v)}; }
+inline SimdFloat simdMin (const SimdFloat &a, const SimdFloat &b) { return {vminq_f32 (a.v, b.v)}; }
+inline SimdFloat simdMax (const SimdFloat &a, const SimdFloat &b) { return {vmaxq_f32 (a.v, b.v)}; }
+inline SimdMask operator< (const SimdFloat &a, const SimdFloat &b) { return {vcltq_f32 (a.v, b.v)}; }
+inline SimdMask operator<= (const SimdFloat &a, const SimdFloat &b) { return {vcleq_f32 (a.v, b.v)}; }
+inline SimdMask operator> (const SimdFloat &a, const SimdFloat &b) { return {vcgtq_f32 (a.v, b.v)}; }
+inline SimdMask operator>= (const SimdFloat &a, const SimdFloat &b) { return {vcgeq_f32 (a.v, b.v)}; }
+inline SimdMask operator& (const SimdMask &a, const SimdMask &b) { return {vandq_u32 (a.v, b.v)}; }
+inline SimdMask operator| (const SimdMask &a, const SimdMask &b) { return {vorrq_u32 (a.v, b.v)}; }
+inline SimdMask operator! (const SimdMask &a) { return {vmvnq_u32 (a.v)}; }
+/** \brief Per lane: mask ? a : b */
+inline SimdFloat simdSelect (const SimdMask &mask, const SimdFloat &a, const SimdFloat &b) { return {vbslq_f32 (mask.v, a.v, b.v)}; }
+/** \brief Bit i is set if lane i of the mask is set. */
+inline int simdMaskBits (const SimdMask &mask)
+{
+  const uint32x4_t bits = vshrq_n_u32 (mask.v, 31);
+  return static_cast<int> (vgetq_lane_u32 (bits, 0) | (vgetq_lane_u32 (bits, 1) << 1) |
+                           (vgetq_lane_u32 (bits, 2) << 2) | (vgetq_lane_u32 (bits, 3) << 3));
+}
+
+#else
+struct SimdFloat { float v; static constexpr std::size_t size = 1; };
+struct SimdMask { bool v; };
+
+inline SimdFloat simdSet (float x) { return {x}; }
+inline SimdFloat simdLoad (const float *p) { return {*p}; }
+inline void simdStore (float *p, const SimdFloat &a) { *p = a.v; }
+inline SimdFloat operator+ (const SimdFloat &a, const SimdFloat &b) { return {a.v + b.v}; }
+inline SimdFloat operator- (const SimdFloat &a, const SimdFloat &b) { return {a.v - b.v}; }
+inline SimdFloat operator* (const SimdFloat &a, const SimdFloat &b) { return {a.v * b.v}; }
+inline SimdFloat operator/ (const SimdFloat &a, const SimdFloat &b) { return {a.v / b.v}; }
+inline SimdFloat simdSqrt (const SimdFloat &a) { return {std::sqrt (a.v)}; }
+inline SimdFloat simdAbs (const SimdFloat &a) { return {std::abs (a.v)}; }
+inline SimdFloat simdMin (const SimdFloat &a, const SimdFloat &b) { return {b.v < a.v ? b.v : a.v}; }
+inline SimdFloat simdMax (const SimdFloat &a, const SimdFloat &b) { return {a.v < b.v ? b.v : a.v}; }
+inline SimdMask operator< (const SimdFloat &a, const SimdFloat &b) { return {a.v < b.v}; }
+inline SimdMask operator<= (const SimdFloat &a, const SimdFloat &b) { return {a.v <= b.v}; }
+inline SimdMask operator> (const SimdFloat &a, const SimdFloat &b) { return {a.v > b.v}; }
+inline SimdMask operator>= (const SimdFloat &a, const SimdFloat &b) { return {a.v >= b.v}; }
+inline SimdMask operator& (const SimdMask &a, const SimdMask &b) { return {a.v && b.v}; }
+inline SimdMask operator| (const SimdMask &a, const SimdMask &b) { return {a.v || b.v}; }
+inline SimdMask operator! (const SimdMask &a) { return {!a.v}; }
+/** \brief Per lane: mask ? a : b */
+inline SimdFloat simdSelect (const SimdMask &mask, const SimdFloat &a, const SimdFloat &b) { return {mask.v ? a.v : b.v}; }
+/** \brief Bit i is set if lane i of the mask is set. */
+inline int simdMaskBits (const SimdMask &mask) { return mask.v ? 1 : 0; }
+#endif
+
+inline SimdFloat& operator+= (SimdFloat &a, const SimdFloat &b) { return a = a + b; }
+inline SimdFloat& operator-= (SimdFloat &a, const SimdFloat &b) { return a = a - b; }
+inline SimdFloat& operator*= (SimdFloat &a, const SimdFloat &b) { return a = a * b; }
+
+/** \brief Three SIMD registers holding the x, y and z components of one 3D vector per lane. */
+struct SimdVector3 { SimdFloat x, y, z; };
+
+inline SimdVector3
+simdCross (const SimdVector3 &a, const SimdVector3 &b)
+{
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline SimdFloat
+simdSquaredNorm (const SimdVector3 &a)
+{
+  return a.x * a.x + a.y * a.y + a.z * a.z;
+}
+
+inline SimdVector3
+simdNormalized (const SimdVector3 &a)
+{
+  const SimdFloat inv_norm = simdSet (1.0f) / simdSqrt (simdSquaredNorm (a));
+  return {a.x * inv_norm, a.y * inv_norm, a.z * inv_norm};
+}
+
+inline SimdVector3
+simdSelect (const SimdMask &mask, const SimdVector3 &a, const SimdVector3 &b)
+{
+  return {simdSelect (mask, a.x, b.x), simdSelect (mask, a.y, b.y), simdSelect (mask, a.z, b.z)};
+}
+
+/** \brief Accurate arccosine (about 1 ulp away from std::acos) of every lane, x in [-1, 1].
+  * Uses the Cephes asin polynomial on [0, 0.5] and the half angle identity above it.
+  */
+inline SimdFloat
+simdAcos (const SimdFloat &x)
+{
+  const SimdFloat one = simdSet (1.0f), half = simdSet (0.5f);
+  const SimdFloat a = simdMin (simdAbs (x), one);
+  const SimdMask big = half < a;
+  const SimdFloat z = simdSelect (big, half * (one - a), a * a);
+  const SimdFloat s = simdSelect (big, simdSqrt (z), a);
+  SimdFloat p = simdSet (4.2163199048e-2f);
+  p = p * z + simdSet (2.4181311049e-2f);
+  p = p * z + simdSet (4.5470025998e-2f);
+  p = p * z + simdSet (7.4953002686e-2f);
+  p = p * z + simdSet (1.6666752422e-1f);
+  const SimdFloat r = s + s * z * p;
+  // acos (|x|): 2 asin (sqrt ((1 - |x|) / 2)) above 0.5, pi / 2 - asin (|x|) below
+  const SimdFloat acos_abs = simdSelect (big, r + r, simdSet (1.57079632679f) - r);
+  return simdSelect (x < simdSet (0.0f), simdSet (3.14159265359f) - acos_abs, acos_abs);
+}
+
+/** \brief Cosine and sine of every lane by their Taylor series, accurate to float precision for
+  * x in [0, pi / 3].
+  */
+inline void
+simdCosSin (const SimdFloat &x, SimdFloat &cos_x, SimdFloat &sin_x)
+{
+  const SimdFloat x2 = x * x;
+  SimdFloat c = simdSet (-1.0f / 3628800.0f);
+  c = c * x2 + simdSet (1.0f / 40320.0f);
+  c = c * x2 + simdSet (-1.0f / 720.0f);
+  c = c * x2 + simdSet (1.0f / 24.0f);
+  c = c * x2 + simdSet (-0.5f);
+  cos_x = c * x2 + simdSet (1.0f);
+  SimdFloat s = simdSet (-1.0f / 39916800.0f);
+  s = s * x2 + simdSet (1.0f / 362880.0f);
+  s = s * x2 + simdSet (-1.0f / 5040.0f);
+  s = s * x2 + simdSet (1.0f / 120.0f);
+  s = s * x2 + simdSet (-1.0f / 6.0f);
+  sin_x = x + x * x2 * s;
+}
+}  // namespace detail
+}  // namespace pcl
@@ -179,6 +179,20 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Copy the estimator for parallel computation, see Feature::makeThreadCopy.
+        * \note Every copy reseeds its random number generator from the current state and the
+        * first position it computes, so the copies draw different numbers. The random x axes of
+        * the reference frames therefore depend on the number of threads.
+        */
+      typename Feature<PointInT, PointOutT>::Ptr
+      makeThreadCopy (std::size_t first, std::size_t) const override
+      {
+        auto copy = new ShapeContext3DEstimation<PointInT, PointNT, PointOutT> (*this);
+        std::seed_seq seeds {static_cast<std::uint32_t> (copy->rng_ ()), static_cast<std::uint32_t> (first)};
+        copy->rng_.seed (seeds);
+        return (typename Feature<PointInT, PointOutT>::Ptr (copy));
+      }
+
       /** \brief Values of the radii interval */
       std::vector<float> radii_interval_;
 
@@ -173,6 +173,13 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Copy the estimator for parallel computation, see Feature::makeThreadCopy. */
+      typename Feature<PointInT, PointOutT>::Ptr
+      makeThreadCopy (std::size_t, std::size_t) const override
+      {
+        return (typename Feature<PointInT, PointOutT>::Ptr (new BoundaryEstimation<PointInT, PointNT, PointOutT> (*this)));
+      }
+
       /** \brief The decision boundary (angle threshold) that marks points as boundary or regular. (default \f$\pi / 2.0\f$) */
       float angle_threshold_;
   };
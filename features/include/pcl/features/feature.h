@@ -215,6 +215,17 @@ namespace pcl
       void
       compute (PointCloudOut &output);
 
+      /** \brief Set the number of threads used by \ref compute.
+        *
+        * The indices are split into chunks that are computed concurrently, each one by its own copy
+        * of the estimator (see \ref makeThreadCopy). Estimators that do not support this compute all
+        * the indices in a single call, which uses the same number of threads if the estimator is
+        * parallelized internally (e.g. NormalEstimationOMP), and a single thread otherwise.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
     protected:
       /** \brief The feature name. */
       std::string feature_name_;
@@ -289,6 +300,27 @@ namespace pcl
         return (search_method_surface_ (cloud, index, parameter, indices, distances));
       }
 
+      /** \brief Create a copy of this estimator, used by \ref compute to estimate the features of
+        * the points indices_[first, last) on another thread. The indices of the copy are restricted
+        * to that range by the caller.
+        *
+        * Estimators can opt in to parallel computation by overriding this method, if their
+        * computeFeature writes exactly one output point per index (output[i] for (*indices_)[i]),
+        * keeps its scratch data in member variables and only reads the shared inputs (clouds,
+        * search method). State computed per index in initCompute has to be restricted to the
+        * range by the override. The default returns a null pointer, i.e. no parallel computation.
+        * \param[in] first the first position in indices_ the copy will compute
+        * \param[in] last one past the last position in indices_ the copy will compute
+        */
+      virtual Ptr
+      makeThreadCopy (std::size_t /*first*/, std::size_t /*last*/) const
+      {
+        return (Ptr ());
+      }
+
+      /** \brief The number of threads used by \ref compute. */
+      unsigned int threads_{1};
+
     private:
       /** \brief Abstract feature estimation method.
         * \param[out] output the resultant features
@@ -296,6 +328,14 @@ namespace pcl
       virtual void
       computeFeature (PointCloudOut &output) = 0;
 
+      /** \brief Split indices_ into chunks and call computeFeature on a copy of the estimator for
+        * each of them, on threads_ threads. Falls back to computeFeature if the estimator does not
+        * support it (see \ref makeThreadCopy).
+        * \param[out] output the resultant features, already resized to indices_->size ()
+        */
+      void
+      computeFeatureParallel (PointCloudOut &output);
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -0,0 +1,239 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_exports.h>
+#include <pcl/types.h>
+#include <Eigen/Core>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Identifies the data a feature cache was filled from: the surface, the normals and the estimation
+    * parameters the cached values depend on. The clouds are tracked by weak pointers, so a cloud that was
+    * destroyed never matches, even if a new cloud is allocated at the same address.
+    * \note Changes made in place to the points or normals of a cloud are not detected. Clear the cache after
+    * modifying a cloud that is still bound to it.
+    * \ingroup features
+    */
+  class PCL_EXPORTS FeatureCacheSource
+  {
+    public:
+      /** \brief Check whether the given data is the one the cache was filled from.
+        * \param[in] surface the cloud the features are computed on
+        * \param[in] normals the normals of \a surface
+        * \param[in] parameters the estimation parameters the cached values depend on
+        */
+      bool
+      matches (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+               const std::vector<double> &parameters) const;
+
+      /** \brief Remember the given data as the one the cache is filled from. */
+      void
+      assign (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+              const std::vector<double> &parameters);
+
+    private:
+      weak_ptr<const void> surface_;
+      weak_ptr<const void> normals_;
+      std::vector<double> parameters_;
+  };
+
+  /** \brief PairFeatureCache is a bounded cache of the (f1, f2, f3, f4) pair features of \ref PFHEstimation,
+    * indexed by the ordered pair of point indices they were computed from.
+    *
+    * The cache is an open addressing hash table. Its slots are allocated by \ref bind, twice as many as the
+    * expected number of pairs and at most the capacity, so a small cloud does not pay for the maximum size of
+    * the table. \ref find and \ref insert are
+    * lock-free and can be called concurrently, so the same cache can be shared by all threads of a parallel
+    * estimation and reused by later compute calls on the same data (e.g. the scales of a
+    * \ref MultiscaleFeaturePersistence run, as pair features do not depend on the search radius). Entries are
+    * never evicted: once the table is full, new pairs are simply not stored anymore. \ref bind, \ref clear and
+    * \ref setCapacity must not be called while other threads are using the cache.
+    *
+    * \ingroup features
+    */
+  class PCL_EXPORTS PairFeatureCache
+  {
+    public:
+      using Ptr = shared_ptr<PairFeatureCache>;
+      using ConstPtr = shared_ptr<const PairFeatureCache>;
+
+      /** \brief Constructor. No memory is allocated until the first call to \ref bind.
+        * \param[in] capacity the maximum number of pairs stored (rounded up to a power of 2)
+        */
+      PairFeatureCache (std::size_t capacity = (std::size_t (1) << 22));
+
+      /** \brief Set the maximum number of pairs stored, rounded up to a power of 2. Clears the cache if the
+        * capacity changes.
+        */
+      void
+      setCapacity (std::size_t capacity);
+
+      /** \brief Get the maximum number of pairs stored. */
+      inline std::size_t
+      getCapacity () const { return (capacity_); }
+
+      /** \brief Get the number of slots allocated by the last call to \ref bind. */
+      inline std::size_t
+      getNumberOfSlots () const { return (slots_.size ()); }
+
+      /** \brief Clear the cache if it was filled from different data, and size the table for the expected
+        * number of pairs. If the data is the same, the table only grows and keeps the stored pairs.
+        * \param[in] surface the cloud the pair features are computed on
+        * \param[in] normals the normals of \a surface
+        * \param[in] nr_pairs the expected number of pairs (the table never holds more than the capacity)
+        * \return true if the cache was cleared
+        */
+      bool
+      bind (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+            std::size_t nr_pairs);
+
+      /** \brief Remove all pairs from the cache. */
+      void
+      clear ();
+
+      /** \brief Look up the pair features of the points p and q.
+        * \param[in] p the index of the first point (source)
+        * \param[in] q the index of the second point (target)
+        * \param[out] features the (f1, f2, f3, f4) features of the pair, if found
+        * \return true if the pair was found
+        */
+      bool
+      find (pcl::index_t p, pcl::index_t q, Eigen::Vector4f &features) const;
+
+      /** \brief Store the pair features of the points p and q.
+        * \param[in] p the index of the first point (source)
+        * \param[in] q the index of the second point (target)
+        * \param[in] features the (f1, f2, f3, f4) features of the pair
+        * \return true if the pair was stored, false if it was already in the cache or the cache is full
+        */
+      bool
+      insert (pcl::index_t p, pcl::index_t q, const Eigen::Vector4f &features);
+
+    private:
+      struct Slot
+      {
+        /** \brief Generation of the cache the slot was filled in, and its status (see SlotStatus). */
+        std::atomic<std::uint32_t> state;
+        std::uint64_t key;
+        float features[4];
+      };
+
+      /** \brief Allocate empty slots.
+        * \param[in] nr_slots the number of slots, a power of 2
+        */
+      void
+      allocate (std::size_t nr_slots);
+
+      /** \brief Store the features of a pair given by its key, see \ref insert. */
+      bool
+      insertKey (std::uint64_t key, const float *features);
+
+      std::vector<Slot> slots_;
+      std::size_t capacity_{0};
+      std::uint32_t generation_{1};
+      FeatureCacheSource source_;
+  };
+
+  /** \brief SPFHCache stores the SPFH (Simplified Point Feature Histogram) signatures of \ref FPFHEstimation,
+    * one row of values per point of the search surface.
+    *
+    * \ref find and \ref insert are lock-free and can be called concurrently, so the same cache can be shared by
+    * all threads of \ref FPFHEstimationOMP and reused by later compute calls with the same surface, normals and
+    * parameters, e.g. when the features of overlapping index sets are computed one after the other. The memory
+    * used is bounded by the size of the surface. \ref bind and \ref clear must not be called while other threads
+    * are using the cache.
+    *
+    * \ingroup features
+    */
+  class PCL_EXPORTS SPFHCache
+  {
+    public:
+      using Ptr = shared_ptr<SPFHCache>;
+      using ConstPtr = shared_ptr<const SPFHCache>;
+
+      /** \brief Prepare the cache for the given data, and clear it if it was filled from different data.
+        * \param[in] surface the cloud the signatures are computed on
+        * \param[in] normals the normals of \a surface
+        * \param[in] nr_points the number of points in \a surface
+        * \param[in] nr_values the number of values of a signature
+        * \param[in] parameters the estimation parameters the signatures depend on
+        * \return true if the cache was cleared
+        */
+      bool
+      bind (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+            std::size_t nr_points, std::size_t nr_values, const std::vector<double> &parameters);
+
+      /** \brief Remove all signatures from the cache. */
+      void
+      clear ();
+
+      /** \brief Get the number of values of a signature. */
+      inline std::size_t
+      getNumberOfValues () const { return (nr_values_); }
+
+      /** \brief Look up the signature of a point.
+        * \param[in] index the index of the point in the surface
+        * \return a pointer to the getNumberOfValues () values of the signature, or a null pointer if the
+        * signature is not in the cache
+        */
+      const float*
+      find (pcl::index_t index) const;
+
+      /** \brief Store the signature of a point.
+        * \param[in] index the index of the point in the surface
+        * \param[in] values the getNumberOfValues () values of the signature
+        * \return true if the signature was stored, false if it was already stored (or is being stored by
+        * another thread)
+        */
+      bool
+      insert (pcl::index_t index, const float *values);
+
+    private:
+      std::vector<std::atomic<std::uint32_t> > states_;
+      std::vector<float> values_;
+      std::size_t nr_values_{0};
+      std::uint32_t generation_{1};
+      FeatureCacheSource source_;
+  };
+}
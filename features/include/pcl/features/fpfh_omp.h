@@ -42,6 +42,7 @@
 
 #include <pcl/features/feature.h>
 #include <pcl/features/fpfh.h>
+#include <pcl/features/feature_cache.h>
 
 namespace pcl
 {
@@ -67,6 +68,12 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its FPFH feature property set to NaN.
     *
+    * \note The SPFH signatures of the neighbors are computed when they are first needed and shared by all
+    * threads through a \ref SPFHCache. A cache provided with \ref setCache is also kept between calls to
+    * compute, as long as the search surface, the normals and the parameters do not change. Without it, a
+    * temporary cache is used, which only holds the neighbors of the query points if these are few compared
+    * to the search surface.
+    *
     * \author Radu B. Rusu
     * \ingroup features
     */
@@ -81,8 +88,10 @@ namespace pcl
       using Feature<PointInT, PointOutT>::indices_;
       using Feature<PointInT, PointOutT>::k_;
       using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::search_radius_;
       using Feature<PointInT, PointOutT>::input_;
       using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::threads_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FPFHEstimation<PointInT, PointNT, PointOutT>::hist_f1_;
       using FPFHEstimation<PointInT, PointNT, PointOutT>::hist_f2_;
@@ -98,14 +107,19 @@ namespace pcl
       {
         feature_name_ = "FPFHEstimationOMP";
 
-        setNumberOfThreads(nr_threads);
+        this->setNumberOfThreads (nr_threads);
       }
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+      /** \brief Provide a pointer to a cache of SPFH signatures, to reuse them in later calls to compute, e.g.
+        * for overlapping sets of indices on the same search surface.
+        * \param[in] cache the cache of SPFH signatures (a null pointer disables reuse between calls)
         */
-      void
-      setNumberOfThreads (unsigned int nr_threads = 0);
+      inline void
+      setCache (const SPFHCache::Ptr &cache) { cache_ = cache; }
+
+      /** \brief Get a pointer to the cache of SPFH signatures set with \ref setCache. */
+      inline SPFHCache::Ptr
+      getCache () const { return (cache_); }
 
     private:
       /** \brief Estimate the Fast Point Feature Histograms (FPFH) descriptors at a set of points given by
@@ -120,8 +134,8 @@ namespace pcl
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_bins_f1_{11}, nr_bins_f2_{11}, nr_bins_f3_{11};
     private:
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
+      /** \brief The cache of SPFH signatures kept between calls to compute. */
+      SPFHCache::Ptr cache_;
   };
 }
 
@@ -44,6 +44,11 @@
 #include <pcl/search/kdtree.h> // for KdTree
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace pcl
 {
@@ -222,11 +227,88 @@ Feature<PointInT, PointOutT>::compute (PointCloudOut &output)
   output.is_dense = input_->is_dense;
 
   // Perform the actual feature computation
-  computeFeature (output);
+  if (threads_ > 1 && indices_->size () > 1)
+    computeFeatureParallel (output);
+  else
+    computeFeature (output);
 
   deinitCompute ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+Feature<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::%s::setNumberOfThreads] Setting number of threads to %u.\n", getClassName ().c_str (), threads_);
+#else
+  threads_ = 1;
+  if (nr_threads > 1)
+    PCL_WARN ("[pcl::%s::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n", getClassName ().c_str ());
+#endif // _OPENMP
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+Feature<PointInT, PointOutT>::computeFeatureParallel (PointCloudOut &output)
+{
+  // A few chunks per thread, so that threads with cheap points can take over more chunks
+  const std::size_t nr_indices = indices_->size ();
+  const std::size_t nr_chunks = std::min<std::size_t> (nr_indices, 4 * threads_);
+
+  // Each chunk is computed by its own copy of the estimator, which holds the scratch data
+  std::vector<Ptr> copies (nr_chunks);
+  for (std::size_t chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    const std::size_t first = nr_indices * chunk / nr_chunks;
+    const std::size_t last = nr_indices * (chunk + 1) / nr_chunks;
+    copies[chunk] = makeThreadCopy (first, last);
+    if (!copies[chunk])
+    {
+      PCL_DEBUG ("[pcl::%s::compute] Splitting the indices is not supported, computing them in a single call.\n", getClassName ().c_str ());
+      computeFeature (output);
+      return;
+    }
+    copies[chunk]->indices_.reset (new pcl::Indices (indices_->cbegin () + first, indices_->cbegin () + last));
+  }
+
+  std::vector<PointCloudOut> outputs (nr_chunks);
+#pragma omp parallel for \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t chunk = 0; chunk < static_cast<std::ptrdiff_t> (nr_chunks); ++chunk)
+  {
+    auto& chunk_output = outputs[chunk];
+    chunk_output.header = output.header;
+    chunk_output.resize (copies[chunk]->indices_->size ());
+    chunk_output.is_dense = output.is_dense;
+    copies[chunk]->computeFeature (chunk_output);
+    // Release the scratch data as soon as possible
+    copies[chunk].reset ();
+  }
+
+  bool is_dense = output.is_dense;
+  for (std::size_t chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    const std::size_t first = nr_indices * chunk / nr_chunks;
+    const std::size_t last = nr_indices * (chunk + 1) / nr_chunks;
+    if (outputs[chunk].size () != last - first)
+    {
+      PCL_ERROR ("[pcl::%s::compute] The estimation of points %zu to %zu returned %zu features!\n", getClassName ().c_str (), first, last, outputs[chunk].size ());
+      output.width = output.height = 0;
+      output.clear ();
+      return;
+    }
+    std::copy (outputs[chunk].begin (), outputs[chunk].end (), output.begin () + first);
+    is_dense = is_dense && outputs[chunk].is_dense;
+  }
+  output.is_dense = is_dense;
+}
+
 
 template <typename PointInT, typename PointNT, typename PointOutT> bool
 FeatureFromNormals<PointInT, PointNT, PointOutT>::initCompute ()
@@ -44,103 +44,78 @@
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
-#include <numeric>
+#include <algorithm> // for std::copy_n, std::lower_bound, std::sort, std::unique
 
 
-//////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
-{
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
-}
-
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  std::vector<int> spfh_indices_vec;
-  std::vector<int> spfh_hist_lookup (surface_->size ());
-
-  // Build a list of (unique) indices for which we will need to compute SPFH signatures
-  // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
-  if (surface_ != input_ ||
-      indices_->size () != surface_->size ())
-  { 
-    pcl::Indices nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-
-    std::set<int> spfh_indices_set;
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      int p_idx = (*indices_)[idx];
-      if (!isFinite ((*input_)[p_idx]) ||
-          this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-        continue;
-
-      spfh_indices_set.insert (nn_indices.begin (), nn_indices.end ());
-    }
-    spfh_indices_vec.resize (spfh_indices_set.size ());
-    std::copy (spfh_indices_set.cbegin (), spfh_indices_set.cend (), spfh_indices_vec.begin ());
-  }
-  else
+  const int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+
+  pcl::Indices nn_indices (k_), spfh_nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
+  std::vector<float> nn_dists (k_), spfh_nn_dists (k_);
+
+  // The SPFH signatures are computed when a query point first needs them, and are shared by all threads
+  // through the cache. Without a user provided cache, they are only kept for this call. If only a small part
+  // of the surface is queried, the rows of that temporary cache are then restricted to the neighbors of the
+  // query points, which are gathered first and sorted, so that a row is found by binary search.
+  SPFHCache::Ptr cache = cache_;
+  pcl::Indices spfh_indices;
+  if (!cache_)
   {
-    // Special case: When a feature must be computed at every point, there is no need for a neighborhood search
-    spfh_indices_vec.resize (indices_->size ());
-    std::iota(spfh_indices_vec.begin (), spfh_indices_vec.end (),
-              static_cast<decltype(spfh_indices_vec)::value_type>(0));
-  }
-
-  // Initialize the arrays that will store the SPFH signatures
-  const auto data_size = spfh_indices_vec.size ();
-  hist_f1_.setZero (data_size, nr_bins_f1_);
-  hist_f2_.setZero (data_size, nr_bins_f2_);
-  hist_f3_.setZero (data_size, nr_bins_f3_);
-
-  pcl::Indices nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-  std::vector<float> nn_dists (k_); 
-
-  // Compute SPFH signatures for every point that needs them
-
-#pragma omp parallel for \
-  default(none) \
-  shared(spfh_hist_lookup, spfh_indices_vec) \
+    cache.reset (new SPFHCache);
+    if (indices_->size () < surface_->size () / 4)
+    {
+#pragma omp parallel \
+  shared(spfh_indices) \
   firstprivate(nn_indices, nn_dists) \
   num_threads(threads_)
-  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (spfh_indices_vec.size ()); ++i)
-  {
-    // Get the next point index
-    int p_idx = spfh_indices_vec[i];
-
-    // Find the neighborhood around p_idx
-    if (!isFinite ((*surface_)[p_idx]) ||
-        this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-      continue;
-
-    // Estimate the SPFH signature around p_idx
-    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1_, hist_f2_, hist_f3_);
-
-    // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
-    spfh_hist_lookup[p_idx] = i;
+      {
+        pcl::Indices thread_spfh_indices;
+#pragma omp for
+        for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+        {
+          if (isFinite ((*input_)[(*indices_)[idx]]) &&
+              this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) != 0)
+            thread_spfh_indices.insert (thread_spfh_indices.end (), nn_indices.cbegin (), nn_indices.cend ());
+        }
+#pragma omp critical(fpfh_omp_spfh_indices)
+        spfh_indices.insert (spfh_indices.end (), thread_spfh_indices.cbegin (), thread_spfh_indices.cend ());
+      }
+      std::sort (spfh_indices.begin (), spfh_indices.end ());
+      spfh_indices.erase (std::unique (spfh_indices.begin (), spfh_indices.end ()), spfh_indices.end ());
+      // A temporary cache with one row per point would not be larger
+      if (spfh_indices.size () == surface_->size ())
+        spfh_indices.clear ();
+    }
   }
+  if (cache->bind (surface_, normals_, spfh_indices.empty () ? surface_->size () : spfh_indices.size (), nr_bins,
+                   {static_cast<double> (k_), search_radius_, static_cast<double> (nr_bins_f1_),
+                    static_cast<double> (nr_bins_f2_), static_cast<double> (nr_bins_f3_)}) && cache_)
+    PCL_DEBUG ("[pcl::%s::computeFeature] Cleared the cache of SPFH signatures.\n", getClassName ().c_str ());
 
-  // Initialize the array that will store the FPFH signature
-  int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
-
-  nn_indices.clear();
-  nn_dists.clear();
+  // The row of the cache that holds the SPFH signature of a surface point, -1 if there is none
+  const auto getCacheRow = [&spfh_indices] (pcl::index_t p_idx) -> pcl::index_t
+  {
+    if (spfh_indices.empty ())
+      return (p_idx);
+    const auto it = std::lower_bound (spfh_indices.cbegin (), spfh_indices.cend (), p_idx);
+    return ((it != spfh_indices.cend () && *it == p_idx) ? static_cast<pcl::index_t> (it - spfh_indices.cbegin ()) : -1);
+  };
+
+  // The SPFH signatures of the neighbors of a query point, one row per neighbor
+  Eigen::MatrixXf hist_f1, hist_f2, hist_f3;
+  // Placeholders for the SPFH signature of a single point
+  Eigen::MatrixXf spfh_f1 (1, nr_bins_f1_), spfh_f2 (1, nr_bins_f2_), spfh_f3 (1, nr_bins_f3_);
+  std::vector<float> spfh (nr_bins);
+  Eigen::VectorXf fpfh_histogram;
 
   // Iterate over the entire index vector
 #pragma omp parallel for \
-  default(none) \
-  shared(nr_bins, output, spfh_hist_lookup) \
-  firstprivate(nn_dists, nn_indices) \
+  shared(cache, nr_bins, output) \
+  firstprivate(nn_indices, nn_dists, spfh_nn_indices, spfh_nn_dists, hist_f1, hist_f2, hist_f3, \
+               spfh_f1, spfh_f2, spfh_f3, spfh, fpfh_histogram) \
   num_threads(threads_)
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
@@ -155,21 +130,48 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
       continue;
     }
 
-
-    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-    // instead of indices into surface_->points
-    for (auto &nn_index : nn_indices)
-      nn_index = spfh_hist_lookup[nn_index];
+    // ... gather their SPFH signatures, computing the ones that are not in the cache yet ...
+    const auto nr_neighbors = static_cast<Eigen::Index> (nn_indices.size ());
+    hist_f1.resize (nr_neighbors, nr_bins_f1_);
+    hist_f2.resize (nr_neighbors, nr_bins_f2_);
+    hist_f3.resize (nr_neighbors, nr_bins_f3_);
+    for (Eigen::Index n = 0; n < nr_neighbors; ++n)
+    {
+      const int p_idx = nn_indices[n];
+      const pcl::index_t row = getCacheRow (p_idx);
+      const float *values = cache->find (row);
+      if (!values)
+      {
+        spfh_f1.setZero ();
+        spfh_f2.setZero ();
+        spfh_f3.setZero ();
+        // Find the neighborhood around p_idx, and estimate the SPFH signature around it
+        if (isFinite ((*surface_)[p_idx]) &&
+            this->searchForNeighbors (*surface_, p_idx, search_parameter_, spfh_nn_indices, spfh_nn_dists) != 0)
+          this->computePointSPFHSignature (*surface_, *normals_, p_idx, 0, spfh_nn_indices, spfh_f1, spfh_f2, spfh_f3);
+
+        std::copy_n (spfh_f1.data (), nr_bins_f1_, spfh.begin ());
+        std::copy_n (spfh_f2.data (), nr_bins_f2_, spfh.begin () + nr_bins_f1_);
+        std::copy_n (spfh_f3.data (), nr_bins_f3_, spfh.begin () + nr_bins_f1_ + nr_bins_f2_);
+        // Another thread might have stored it in the meantime, the values are the same
+        cache->insert (row, spfh.data ());
+        values = spfh.data ();
+      }
+      hist_f1.row (n) = Eigen::Map<const Eigen::RowVectorXf> (values, nr_bins_f1_);
+      hist_f2.row (n) = Eigen::Map<const Eigen::RowVectorXf> (values + nr_bins_f1_, nr_bins_f2_);
+      hist_f3.row (n) = Eigen::Map<const Eigen::RowVectorXf> (values + nr_bins_f1_ + nr_bins_f2_, nr_bins_f3_);
+
+      // ... and remap the nn_indices values so that they represent row indices in the hist_* matrices
+      nn_indices[n] = static_cast<int> (n);
+    }
 
     // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
-    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
+    weightPointSPFHSignature (hist_f1, hist_f2, hist_f3, nn_indices, nn_dists, fpfh_histogram);
 
     // ...and copy it into the output cloud
     for (int d = 0; d < nr_bins; ++d)
       output[idx].histogram[d] = fpfh_histogram[d];
   }
-
 }
 
 #define PCL_INSTANTIATE_FPFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimationOMP<T,NT,OutT>;
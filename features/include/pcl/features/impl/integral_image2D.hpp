@@ -41,19 +41,42 @@
 #ifndef PCL_INTEGRAL_IMAGE2D_IMPL_H_
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
+#include <pcl/console/print.h> // for PCL_DEBUG, PCL_WARN
+
+#include <algorithm> // for std::fill_n, std::min
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace pcl
 {
 
-template <typename DataType, unsigned Dimension> void
-IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_second_order_integral_images)
+namespace detail
+{
+/** \brief Add a row of an integral image to another one.
+  * \param[in,out] data the integral image, stored as consecutive rows of \a row_size values
+  * \param[in] row_size the number of values per row
+  * \param[in] target_row the row to add to
+  * \param[in] source_row the row to add
+  */
+template <typename T> inline void
+addIntegralImageRow (T *data, std::size_t row_size, std::size_t target_row, std::size_t source_row)
+{
+  Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1> > (data + target_row * row_size, row_size) +=
+    Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1> > (data + source_row * row_size, row_size);
+}
+} // namespace detail
+
+template <typename DataType, unsigned Dimension, typename IntegralType> void
+IntegralImage2D<DataType, Dimension, IntegralType>::setSecondOrderComputation (bool compute_second_order_integral_images)
 {
   compute_second_order_integral_images_ = compute_second_order_integral_images;
 }
 
 
-template <typename DataType, unsigned Dimension> void
-IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+template <typename DataType, unsigned Dimension, typename IntegralType> void
+IntegralImage2D<DataType, Dimension, IntegralType>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
   if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
   {
@@ -68,8 +91,8 @@ IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned
 }
 
 
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::ElementType
-IntegralImage2D<DataType, Dimension>::getFirstOrderSum (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::ElementType
+IntegralImage2D<DataType, Dimension, IntegralType>::getFirstOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -82,8 +105,8 @@ IntegralImage2D<DataType, Dimension>::getFirstOrderSum (
 }
 
 
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::SecondOrderType
-IntegralImage2D<DataType, Dimension>::getSecondOrderSum (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::SecondOrderType
+IntegralImage2D<DataType, Dimension, IntegralType>::getSecondOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -96,8 +119,8 @@ IntegralImage2D<DataType, Dimension>::getSecondOrderSum (
 }
 
 
-template <typename DataType, unsigned Dimension> unsigned
-IntegralImage2D<DataType, Dimension>::getFiniteElementsCount (
+template <typename DataType, unsigned Dimension, typename IntegralType> unsigned
+IntegralImage2D<DataType, Dimension, IntegralType>::getFiniteElementsCount (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -110,8 +133,8 @@ IntegralImage2D<DataType, Dimension>::getFiniteElementsCount (
 }
 
 
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::ElementType
-IntegralImage2D<DataType, Dimension>::getFirstOrderSumSE (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::ElementType
+IntegralImage2D<DataType, Dimension, IntegralType>::getFirstOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -124,8 +147,8 @@ IntegralImage2D<DataType, Dimension>::getFirstOrderSumSE (
 }
 
 
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::SecondOrderType
-IntegralImage2D<DataType, Dimension>::getSecondOrderSumSE (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::SecondOrderType
+IntegralImage2D<DataType, Dimension, IntegralType>::getSecondOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -138,8 +161,8 @@ IntegralImage2D<DataType, Dimension>::getSecondOrderSumSE (
 }
 
 
-template <typename DataType, unsigned Dimension> unsigned
-IntegralImage2D<DataType, Dimension>::getFiniteElementsCountSE (
+template <typename DataType, unsigned Dimension, typename IntegralType> unsigned
+IntegralImage2D<DataType, Dimension, IntegralType>::getFiniteElementsCountSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -152,79 +175,106 @@ IntegralImage2D<DataType, Dimension>::getFiniteElementsCountSE (
 }
 
 
-template <typename DataType, unsigned Dimension> void
-IntegralImage2D<DataType, Dimension>::computeIntegralImages (
-    const DataType *data, unsigned row_stride, unsigned element_stride)
+template <typename DataType, unsigned Dimension, typename IntegralType> void
+IntegralImage2D<DataType, Dimension, IntegralType>::setNumberOfThreads (unsigned int nr_threads)
 {
-  ElementType* previous_row = first_order_integral_image_.data();
-  ElementType* current_row  = previous_row + (width_ + 1);
-  for (unsigned int i = 0; i < (width_ + 1); ++i)
-    previous_row[i].setZero();
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::IntegralImage2D::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::IntegralImage2D::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif // _OPENMP
+}
 
-  unsigned* count_previous_row = finite_values_integral_image_.data();
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  std::fill_n(count_previous_row, width_ + 1, 0);
 
-  if (!compute_second_order_integral_images_)
+template <typename DataType, unsigned Dimension, typename IntegralType> void
+IntegralImage2D<DataType, Dimension, IntegralType>::computeIntegralImages (
+    const DataType *data, unsigned row_stride, unsigned element_stride)
+{
+  const std::size_t stride = width_ + 1;
+  const auto addRow = [this, stride] (std::size_t target_row, std::size_t source_row)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
-    {
-      current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
-      {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const auto* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (std::isfinite (element->sum ()))
-        {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
-        }
-      }
-    }
-  }
-  else
+    detail::addIntegralImageRow (first_order_integral_image_.data ()->data (), stride * Dimension, target_row, source_row);
+    detail::addIntegralImageRow (finite_values_integral_image_.data (), stride, target_row, source_row);
+    if (compute_second_order_integral_images_)
+      detail::addIntegralImageRow (second_order_integral_image_.data ()->data (), stride * second_order_size, target_row, source_row);
+  };
+
+  // The first row of the integral images is zero
+  std::fill_n (first_order_integral_image_.begin (), stride, ElementType::Zero ());
+  std::fill_n (finite_values_integral_image_.begin (), stride, 0);
+  if (compute_second_order_integral_images_)
+    std::fill_n (second_order_integral_image_.begin (), stride, SecondOrderType::Zero ());
+
+  // Every thread integrates a band of rows, as if the band started at the top of the image
+  const std::size_t nr_bands = std::max (1u, std::min (threads_, height_));
+#pragma omp parallel for \
+  shared(data) \
+  num_threads(threads_)
+  for (std::ptrdiff_t band = 0; band < static_cast<std::ptrdiff_t> (nr_bands); ++band)
   {
-    SecondOrderType* so_previous_row = second_order_integral_image_.data();
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    for (unsigned int i = 0; i < (width_ + 1); ++i)
-      so_previous_row[i].setZero();
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    const std::size_t begin = band * height_ / nr_bands;
+    const std::size_t end = (band + 1) * height_ / nr_bands;
+    for (std::size_t row_idx = begin; row_idx < end; ++row_idx)
     {
+      const DataType *row_data = data + row_idx * row_stride;
+      ElementType* current_row = &first_order_integral_image_[(row_idx + 1) * stride];
+      unsigned* count_current_row = &finite_values_integral_image_[(row_idx + 1) * stride];
+      SecondOrderType* so_current_row = compute_second_order_integral_images_ ? &second_order_integral_image_[(row_idx + 1) * stride] : nullptr;
+
       current_row [0].setZero ();
-      so_current_row [0].setZero ();
       count_current_row [0] = 0;
+      if (so_current_row)
+        so_current_row [0].setZero ();
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (so_current_row)
+          so_current_row [colIdx + 1] = so_current_row [colIdx];
 
-        const auto* element = reinterpret_cast <const InputType*> (&data [valIdx]);
+        const auto* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
         if (std::isfinite (element->sum ()))
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+          current_row [colIdx + 1] += element->template cast<IntegralType>();
           ++(count_current_row [colIdx + 1]);
-          for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
-            for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
-              so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+          if (so_current_row)
+          {
+            for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
+              for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
+                so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+          }
         }
       }
+
+      // add the sums of the rows above, while they are still cached
+      if (row_idx != begin)
+        addRow (row_idx + 1, row_idx);
     }
   }
+
+  // Carry the sums over from the bands above: first to the last row of every band, then to its other rows
+  for (std::size_t band = 1; band < nr_bands; ++band)
+    addRow ((band + 1) * height_ / nr_bands, band * height_ / nr_bands);
+#pragma omp parallel for \
+  num_threads(threads_)
+  for (std::ptrdiff_t band = 1; band < static_cast<std::ptrdiff_t> (nr_bands); ++band)
+  {
+    const std::size_t begin = band * height_ / nr_bands;
+    const std::size_t end = (band + 1) * height_ / nr_bands;
+    for (std::size_t row_idx = begin + 1; row_idx < end; ++row_idx)
+      addRow (row_idx, begin);
+  }
 }
 
 
-template <typename DataType> void
-IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+template <typename DataType, typename IntegralType> void
+IntegralImage2D<DataType, 1, IntegralType>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
   if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
   {
@@ -239,8 +289,8 @@ IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,un
 }
 
 
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::ElementType
-IntegralImage2D<DataType, 1>::getFirstOrderSum (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::ElementType
+IntegralImage2D<DataType, 1, IntegralType>::getFirstOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -253,8 +303,8 @@ IntegralImage2D<DataType, 1>::getFirstOrderSum (
 }
 
 
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::SecondOrderType
-IntegralImage2D<DataType, 1>::getSecondOrderSum (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::SecondOrderType
+IntegralImage2D<DataType, 1, IntegralType>::getSecondOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -267,8 +317,8 @@ IntegralImage2D<DataType, 1>::getSecondOrderSum (
 }
 
 
-template <typename DataType> unsigned
-IntegralImage2D<DataType, 1>::getFiniteElementsCount (
+template <typename DataType, typename IntegralType> unsigned
+IntegralImage2D<DataType, 1, IntegralType>::getFiniteElementsCount (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -281,8 +331,8 @@ IntegralImage2D<DataType, 1>::getFiniteElementsCount (
 }
 
 
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::ElementType
-IntegralImage2D<DataType, 1>::getFirstOrderSumSE (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::ElementType
+IntegralImage2D<DataType, 1, IntegralType>::getFirstOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -295,8 +345,8 @@ IntegralImage2D<DataType, 1>::getFirstOrderSumSE (
 }
 
 
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::SecondOrderType
-IntegralImage2D<DataType, 1>::getSecondOrderSumSE (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::SecondOrderType
+IntegralImage2D<DataType, 1, IntegralType>::getSecondOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -309,8 +359,8 @@ IntegralImage2D<DataType, 1>::getSecondOrderSumSE (
 }
 
 
-template <typename DataType> unsigned
-IntegralImage2D<DataType, 1>::getFiniteElementsCountSE (
+template <typename DataType, typename IntegralType> unsigned
+IntegralImage2D<DataType, 1, IntegralType>::getFiniteElementsCountSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -323,65 +373,95 @@ IntegralImage2D<DataType, 1>::getFiniteElementsCountSE (
 }
 
 
-template <typename DataType> void
-IntegralImage2D<DataType, 1>::computeIntegralImages (
-    const DataType *data, unsigned row_stride, unsigned element_stride)
+template <typename DataType, typename IntegralType> void
+IntegralImage2D<DataType, 1, IntegralType>::setNumberOfThreads (unsigned int nr_threads)
 {
-  ElementType* previous_row = first_order_integral_image_.data();
-  ElementType* current_row  = previous_row + (width_ + 1);
-  std::fill_n(previous_row, width_ + 1, 0);
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::IntegralImage2D::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::IntegralImage2D::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif // _OPENMP
+}
 
-  unsigned* count_previous_row = finite_values_integral_image_.data();
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  std::fill_n(count_previous_row, width_ + 1, 0);
 
-  if (!compute_second_order_integral_images_)
+template <typename DataType, typename IntegralType> void
+IntegralImage2D<DataType, 1, IntegralType>::computeIntegralImages (
+    const DataType *data, unsigned row_stride, unsigned element_stride)
+{
+  const std::size_t stride = width_ + 1;
+  const auto addRow = [this, stride] (std::size_t target_row, std::size_t source_row)
+  {
+    detail::addIntegralImageRow (first_order_integral_image_.data (), stride, target_row, source_row);
+    detail::addIntegralImageRow (finite_values_integral_image_.data (), stride, target_row, source_row);
+    if (compute_second_order_integral_images_)
+      detail::addIntegralImageRow (second_order_integral_image_.data (), stride, target_row, source_row);
+  };
+
+  // The first row of the integral images is zero
+  std::fill_n (first_order_integral_image_.begin (), stride, 0);
+  std::fill_n (finite_values_integral_image_.begin (), stride, 0);
+  if (compute_second_order_integral_images_)
+    std::fill_n (second_order_integral_image_.begin (), stride, 0);
+
+  // Every thread integrates a band of rows, as if the band started at the top of the image
+  const std::size_t nr_bands = std::max (1u, std::min (threads_, height_));
+#pragma omp parallel for \
+  shared(data) \
+  num_threads(threads_)
+  for (std::ptrdiff_t band = 0; band < static_cast<std::ptrdiff_t> (nr_bands); ++band)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const std::size_t begin = band * height_ / nr_bands;
+    const std::size_t end = (band + 1) * height_ / nr_bands;
+    for (std::size_t row_idx = begin; row_idx < end; ++row_idx)
     {
-      current_row [0] = 0.0;
+      const DataType *row_data = data + row_idx * row_stride;
+      ElementType* current_row = &first_order_integral_image_[(row_idx + 1) * stride];
+      unsigned* count_current_row = &finite_values_integral_image_[(row_idx + 1) * stride];
+      SecondOrderType* so_current_row = compute_second_order_integral_images_ ? &second_order_integral_image_[(row_idx + 1) * stride] : nullptr;
+
+      current_row [0] = 0;
       count_current_row [0] = 0;
+      if (so_current_row)
+        so_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data [valIdx]))
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (so_current_row)
+          so_current_row [colIdx + 1] = so_current_row [colIdx];
+
+        if (std::isfinite (row_data [valIdx]))
         {
-          current_row [colIdx + 1] += data [valIdx];
+          current_row [colIdx + 1] += row_data [valIdx];
           ++(count_current_row [colIdx + 1]);
+          if (so_current_row)
+            so_current_row [colIdx + 1] += row_data [valIdx] * row_data [valIdx];
         }
       }
+
+      // add the sums of the rows above, while they are still cached
+      if (row_idx != begin)
+        addRow (row_idx + 1, row_idx);
     }
   }
-  else
+
+  // Carry the sums over from the bands above: first to the last row of every band, then to its other rows
+  for (std::size_t band = 1; band < nr_bands; ++band)
+    addRow ((band + 1) * height_ / nr_bands, band * height_ / nr_bands);
+#pragma omp parallel for \
+  num_threads(threads_)
+  for (std::ptrdiff_t band = 1; band < static_cast<std::ptrdiff_t> (nr_bands); ++band)
   {
-    SecondOrderType* so_previous_row = second_order_integral_image_.data();
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    std::fill_n(so_previous_row, width_ + 1, 0);
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
-    {
-      current_row [0] = 0.0;
-      so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
-      {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data[valIdx]))
-        {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
-          ++(count_current_row [colIdx + 1]);
-        }
-      }
-    }
+    const std::size_t begin = band * height_ / nr_bands;
+    const std::size_t end = (band + 1) * height_ / nr_bands;
+    for (std::size_t row_idx = begin + 1; row_idx < end; ++row_idx)
+      addRow (row_idx, begin);
   }
 }
 
@@ -99,6 +99,20 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::setRectSize (const int
   rect_height_4_   = height/4;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initNormalEstimationMethod ()
+{
+  if (normal_estimation_method_ == COVARIANCE_MATRIX && !init_covariance_matrix_)
+    initCovarianceMatrixMethod ();
+  else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT && !init_average_3d_gradient_)
+    initAverage3DGradientMethod ();
+  else if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE && !init_depth_change_)
+    initAverageDepthChangeMethod ();
+  else if (normal_estimation_method_ == SIMPLE_3D_GRADIENT && !init_simple_3d_gradient_)
+    initSimple3DGradientMethod ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initSimple3DGradientMethod ()
@@ -111,6 +125,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initSimple3DGradientMet
   const float *data_ = reinterpret_cast<const float*> (&(*input_)[0]);
 
   integral_image_XYZ_.setSecondOrderComputation (false);
+  integral_image_XYZ_.setNumberOfThreads (threads_);
   integral_image_XYZ_.setInput (data_, input_->width, input_->height, element_stride, row_stride);
 
   init_simple_3d_gradient_ = true;
@@ -129,6 +144,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMet
   const float *data_ = reinterpret_cast<const float*> (&(*input_)[0]);
 
   integral_image_XYZ_.setSecondOrderComputation (true);
+  integral_image_XYZ_.setNumberOfThreads (threads_);
   integral_image_XYZ_.setInput (data_, input_->width, input_->height, element_stride, row_stride);
 
   init_covariance_matrix_ = true;
@@ -148,23 +164,20 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMe
   // x u x
   // l x r
   // x d x
-  const PointInT* point_up = &(input_->points [1]);
-  const PointInT* point_dn = point_up + (input_->width << 1);//&(input_->points [1 + (input_->width << 1)]);
-  const PointInT* point_lf = &(input_->points [input_->width]);
-  const PointInT* point_rg = point_lf + 2; //&(input_->points [input_->width + 2]);
-  float* diff_x_ptr = diff_x_ + ((input_->width + 1) << 2);
-  float* diff_y_ptr = diff_y_ + ((input_->width + 1) << 2);
-  unsigned diff_skip = 8; // skip last element in row and the first in the next row
-
-  for (std::size_t ri = 1; ri < input_->height - 1; ++ri
-                                             , point_up += input_->width
-                                             , point_dn += input_->width
-                                             , point_lf += input_->width
-                                             , point_rg += input_->width
-                                             , diff_x_ptr += diff_skip
-                                             , diff_y_ptr += diff_skip)
+  const std::size_t width = input_->width;
+#pragma omp parallel for \
+  num_threads(threads_)
+  for (std::ptrdiff_t ri = 1; ri < static_cast<std::ptrdiff_t> (input_->height) - 1; ++ri)
   {
-    for (std::size_t ci = 0; ci < input_->width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
+    const PointInT* point_up = &(input_->points [(ri - 1) * width + 1]);
+    const PointInT* point_dn = point_up + (width << 1);
+    const PointInT* point_lf = &(input_->points [ri * width]);
+    const PointInT* point_rg = point_lf + 2;
+    // skip the first element in the row
+    float* diff_x_ptr = diff_x_ + ((ri * width + 1) << 2);
+    float* diff_y_ptr = diff_y_ + ((ri * width + 1) << 2);
+
+    for (std::size_t ci = 0; ci < width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
     {
       diff_x_ptr[0] = point_rg[ci].x - point_lf[ci].x;
       diff_x_ptr[1] = point_rg[ci].y - point_lf[ci].y;
@@ -177,8 +190,20 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMe
   }
 
   // Compute integral images
-  integral_image_DX_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
-  integral_image_DY_.setInput (diff_y_, input_->width, input_->height, 4, input_->width << 2);
+  if (use_float_accumulators_)
+  {
+    integral_image_DX_float_.setNumberOfThreads (threads_);
+    integral_image_DY_float_.setNumberOfThreads (threads_);
+    integral_image_DX_float_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
+    integral_image_DY_float_.setInput (diff_y_, input_->width, input_->height, 4, input_->width << 2);
+  }
+  else
+  {
+    integral_image_DX_.setNumberOfThreads (threads_);
+    integral_image_DY_.setNumberOfThreads (threads_);
+    integral_image_DX_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
+    integral_image_DY_.setInput (diff_y_, input_->width, input_->height, 4, input_->width << 2);
+  }
   init_covariance_matrix_ = init_depth_change_ = init_simple_3d_gradient_ = false;
   init_average_3d_gradient_ = true;
 }
@@ -195,6 +220,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverageDepthChangeM
   const float *data_ = reinterpret_cast<const float*> (&(*input_)[0]);
 
   // integral image over the z - value
+  integral_image_depth_.setNumberOfThreads (threads_);
   integral_image_depth_.setInput (&(data_[2]), input_->width, input_->height, element_stride, row_stride);
   init_depth_change_ = true;
   init_covariance_matrix_ = init_average_3d_gradient_ = init_simple_3d_gradient_ = false;
@@ -204,65 +230,113 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverageDepthChangeM
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal)
+{
+  initNormalEstimationMethod ();
+  computePointNormal (pos_x, pos_y, point_index, rect_width_, rect_height_, normal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeCovarianceMatrix (
+    const int pos_x, const int pos_y, const int rect_width, const int rect_height,
+    Eigen::Matrix3f &covariance_matrix) const
+{
+  const int start_x = pos_x - rect_width / 2;
+  const int start_y = pos_y - rect_height / 2;
+  unsigned count = integral_image_XYZ_.getFiniteElementsCount (start_x, start_y, rect_width, rect_height);
+
+  // no valid points within the rectangular region?
+  if (count == 0)
+    return (false);
+
+  Eigen::Vector3f center;
+  typename IntegralImage2D<float, 3>::SecondOrderType so_elements;
+  center = integral_image_XYZ_.getFirstOrderSum (start_x, start_y, rect_width, rect_height).template cast<float> ();
+  so_elements = integral_image_XYZ_.getSecondOrderSum (start_x, start_y, rect_width, rect_height);
+
+  covariance_matrix.coeffRef (0) = static_cast<float> (so_elements [0]);
+  covariance_matrix.coeffRef (1) = covariance_matrix.coeffRef (3) = static_cast<float> (so_elements [1]);
+  covariance_matrix.coeffRef (2) = covariance_matrix.coeffRef (6) = static_cast<float> (so_elements [2]);
+  covariance_matrix.coeffRef (4) = static_cast<float> (so_elements [3]);
+  covariance_matrix.coeffRef (5) = covariance_matrix.coeffRef (7) = static_cast<float> (so_elements [4]);
+  covariance_matrix.coeffRef (8) = static_cast<float> (so_elements [5]);
+  covariance_matrix -= (center * center.transpose ()) / static_cast<float> (count);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::setCovarianceNormal (
+    const unsigned point_index, const Eigen::Matrix3f &covariance_matrix,
+    const float eigen_value, Eigen::Vector3f eigen_vector, PointOutT &normal) const
+{
+  flipNormalTowardsViewpoint ((*input_)[point_index], vpx_, vpy_, vpz_, eigen_vector[0], eigen_vector[1], eigen_vector[2]);
+  normal.getNormalVector3fMap () = eigen_vector;
+
+  // Compute the curvature surface change
+  if (eigen_value > 0.0)
+    normal.curvature = std::abs (eigen_value / (covariance_matrix.coeff (0) + covariance_matrix.coeff (4) + covariance_matrix.coeff (8)));
+  else
+    normal.curvature = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
+    const int pos_x, const int pos_y, const unsigned point_index,
+    const int rect_width, const int rect_height, PointOutT &normal) const
 {
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
+  const int rect_width_2 = rect_width / 2;
+  const int rect_width_4 = rect_width / 4;
+  const int rect_height_2 = rect_height / 2;
+  const int rect_height_4 = rect_height / 4;
+
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
   {
-    if (!init_covariance_matrix_)
-      initCovarianceMatrixMethod ();
-
-    unsigned count = integral_image_XYZ_.getFiniteElementsCount (pos_x - (rect_width_2_), pos_y - (rect_height_2_), rect_width_, rect_height_);
-
-    // no valid points within the rectangular region?
-    if (count == 0)
+    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+    if (!computeCovarianceMatrix (pos_x, pos_y, rect_width, rect_height, covariance_matrix))
     {
       normal.normal_x = normal.normal_y = normal.normal_z = normal.curvature = bad_point;
       return;
     }
 
-    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
-    Eigen::Vector3f center;
-    typename IntegralImage2D<float, 3>::SecondOrderType so_elements;
-    center = integral_image_XYZ_.getFirstOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_).template cast<float> ();
-    so_elements = integral_image_XYZ_.getSecondOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-
-    covariance_matrix.coeffRef (0) = static_cast<float> (so_elements [0]);
-    covariance_matrix.coeffRef (1) = covariance_matrix.coeffRef (3) = static_cast<float> (so_elements [1]);
-    covariance_matrix.coeffRef (2) = covariance_matrix.coeffRef (6) = static_cast<float> (so_elements [2]);
-    covariance_matrix.coeffRef (4) = static_cast<float> (so_elements [3]);
-    covariance_matrix.coeffRef (5) = covariance_matrix.coeffRef (7) = static_cast<float> (so_elements [4]);
-    covariance_matrix.coeffRef (8) = static_cast<float> (so_elements [5]);
-    covariance_matrix -= (center * center.transpose ()) / static_cast<float> (count);
     float eigen_value;
     Eigen::Vector3f eigen_vector;
     pcl::eigen33 (covariance_matrix, eigen_value, eigen_vector);
-    flipNormalTowardsViewpoint ((*input_)[point_index], vpx_, vpy_, vpz_, eigen_vector[0], eigen_vector[1], eigen_vector[2]);
-    normal.getNormalVector3fMap () = eigen_vector;
-
-    // Compute the curvature surface change
-    if (eigen_value > 0.0)
-      normal.curvature = std::abs (eigen_value / (covariance_matrix.coeff (0) + covariance_matrix.coeff (4) + covariance_matrix.coeff (8)));
-    else
-      normal.curvature = 0;
-
+    setCovarianceNormal (point_index, covariance_matrix, eigen_value, eigen_vector, normal);
     return;
   }
   if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
   {
-    if (!init_average_3d_gradient_)
-      initAverage3DGradientMethod ();
-
-    unsigned count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    unsigned count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    unsigned count_x, count_y;
+    if (use_float_accumulators_)
+    {
+      count_x = integral_image_DX_float_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+      count_y = integral_image_DY_float_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    }
+    else
+    {
+      count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+      count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    }
     if (count_x == 0 || count_y == 0)
     {
       normal.normal_x = normal.normal_y = normal.normal_z = normal.curvature = bad_point;
       return;
     }
-    Eigen::Vector3d gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    Eigen::Vector3d gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-
+    Eigen::Vector3d gradient_x, gradient_y;
+    if (use_float_accumulators_)
+    {
+      gradient_x = integral_image_DX_float_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height).template cast<double> ();
+      gradient_y = integral_image_DY_float_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height).template cast<double> ();
+    }
+    else
+    {
+      gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+      gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    }
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
     if (normal_length == 0.0f)
@@ -288,14 +362,11 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE)
   {
-    if (!init_depth_change_)
-      initAverageDepthChangeMethod ();
-
     // width and height are at least 3 x 3
-    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_);
-    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_);
+    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1           , pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2);
+    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y + 1            , rect_width_2, rect_height_2);
 
     if (count_L_z == 0 || count_R_z == 0 || count_U_z == 0 || count_D_z == 0)
     {
@@ -303,15 +374,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
       return;
     }
 
-    float mean_L_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_L_z);
-    float mean_R_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_R_z);
-    float mean_U_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_) / count_U_z);
-    float mean_D_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_) / count_D_z);
+    float mean_L_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2) / count_L_z);
+    float mean_R_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x + 1           , pos_y - rect_height_4, rect_width_2, rect_height_2) / count_R_z);
+    float mean_U_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2) / count_U_z);
+    float mean_D_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y + 1            , rect_width_2, rect_height_2) / count_D_z);
 
-    PointInT pointL = (*input_)[point_index - rect_width_4_ - 1];
-    PointInT pointR = (*input_)[point_index + rect_width_4_ + 1];
-    PointInT pointU = (*input_)[point_index - rect_height_4_ * input_->width - 1];
-    PointInT pointD = (*input_)[point_index + rect_height_4_ * input_->width + 1];
+    PointInT pointL = (*input_)[point_index - rect_width_4 - 1];
+    PointInT pointR = (*input_)[point_index + rect_width_4 + 1];
+    PointInT pointU = (*input_)[point_index - rect_height_4 * input_->width - 1];
+    PointInT pointD = (*input_)[point_index + rect_height_4 * input_->width + 1];
 
     const float mean_x_z = mean_R_z - mean_L_z;
     const float mean_y_z = mean_D_z - mean_U_z;
@@ -347,15 +418,12 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   if (normal_estimation_method_ == SIMPLE_3D_GRADIENT)
   {
-    if (!init_simple_3d_gradient_)
-      initSimple3DGradientMethod ();
-
     // this method does not work if lots of NaNs are in the neighborhood of the point
-    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2_, pos_y - rect_height_2_, 1, rect_height_) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, 1, rect_height_);
+    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2, pos_y - rect_height_2, 1, rect_height) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, 1, rect_height);
 
-    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y + rect_height_2_, rect_width_, 1) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, 1);
+    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y + rect_height_2, rect_width, 1) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, 1);
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
     if (normal_length == 0.0f)
@@ -459,22 +527,34 @@ sumArea (int start_x, int start_y, int end_x, int end_y, const int width, const
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirror (
     const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal)
+{
+  initNormalEstimationMethod ();
+  computePointNormalMirror (pos_x, pos_y, point_index, rect_width_, rect_height_, normal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirror (
+    const int pos_x, const int pos_y, const unsigned point_index,
+    const int rect_width, const int rect_height, PointOutT &normal) const
 {
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
+  const int rect_width_2 = rect_width / 2;
+  const int rect_width_4 = rect_width / 4;
+  const int rect_height_2 = rect_height / 2;
+  const int rect_height_4 = rect_height / 4;
+
   const int width = input_->width;
   const int height = input_->height;
 
   // ==============================================================
   if (normal_estimation_method_ == COVARIANCE_MATRIX) 
   {
-    if (!init_covariance_matrix_)
-      initCovarianceMatrixMethod ();
-
-    const int start_x = pos_x - rect_width_2_;
-    const int start_y = pos_y - rect_height_2_;
-    const int end_x = start_x + rect_width_;
-    const int end_y = start_y + rect_height_;
+    const int start_x = pos_x - rect_width_2;
+    const int start_y = pos_y - rect_height_2;
+    const int end_x = start_x + rect_width;
+    const int end_y = start_y + rect_height;
 
     unsigned count = 0;
     auto cb_xyz_fecse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) { return integral_image_XYZ_.getFiniteElementsCountSE (p1, p2, p3, p4); };
@@ -525,34 +605,31 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     float eigen_value;
     Eigen::Vector3f eigen_vector;
     pcl::eigen33 (covariance_matrix, eigen_value, eigen_vector);
-    flipNormalTowardsViewpoint ((*input_)[point_index], vpx_, vpy_, vpz_, eigen_vector[0], eigen_vector[1], eigen_vector[2]);
-    normal.getNormalVector3fMap () = eigen_vector;
-
-    // Compute the curvature surface change
-    if (eigen_value > 0.0)
-      normal.curvature = std::abs (eigen_value / (covariance_matrix.coeff (0) + covariance_matrix.coeff (4) + covariance_matrix.coeff (8)));
-    else
-      normal.curvature = 0;
-
+    setCovarianceNormal (point_index, covariance_matrix, eigen_value, eigen_vector, normal);
     return;
   }
   // =======================================================
   if (normal_estimation_method_ == AVERAGE_3D_GRADIENT) 
   {
-    if (!init_average_3d_gradient_)
-      initAverage3DGradientMethod ();
-
-    const int start_x = pos_x - rect_width_2_;
-    const int start_y = pos_y - rect_height_2_;
-    const int end_x = start_x + rect_width_;
-    const int end_y = start_y + rect_height_;
+    const int start_x = pos_x - rect_width_2;
+    const int start_y = pos_y - rect_height_2;
+    const int end_x = start_x + rect_width;
+    const int end_y = start_y + rect_height;
 
     unsigned count_x = 0;
     unsigned count_y = 0;
 
-    auto cb_dx_fecse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) { return integral_image_DX_.getFiniteElementsCountSE (p1, p2, p3, p4); };
+    auto cb_dx_fecse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4)
+    {
+      return use_float_accumulators_ ? integral_image_DX_float_.getFiniteElementsCountSE (p1, p2, p3, p4)
+                                     : integral_image_DX_.getFiniteElementsCountSE (p1, p2, p3, p4);
+    };
+    auto cb_dy_fecse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4)
+    {
+      return use_float_accumulators_ ? integral_image_DY_float_.getFiniteElementsCountSE (p1, p2, p3, p4)
+                                     : integral_image_DY_.getFiniteElementsCountSE (p1, p2, p3, p4);
+    };
     sumArea<unsigned>(start_x, start_y, end_x, end_y, width, height, cb_dx_fecse, count_x);
-    auto cb_dy_fecse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) { return integral_image_DY_.getFiniteElementsCountSE (p1, p2, p3, p4); };
     sumArea<unsigned>(start_x, start_y, end_x, end_y, width, height, cb_dy_fecse, count_y);
 
 
@@ -564,9 +641,19 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     Eigen::Vector3d gradient_x (0, 0, 0);
     Eigen::Vector3d gradient_y (0, 0, 0);
 
-    auto cb_dx_fosse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) { return integral_image_DX_.getFirstOrderSumSE (p1, p2, p3, p4); };
+    auto cb_dx_fosse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) -> typename IntegralImage2D<float, 3>::ElementType
+    {
+      if (use_float_accumulators_)
+        return integral_image_DX_float_.getFirstOrderSumSE (p1, p2, p3, p4).template cast<double> ();
+      return integral_image_DX_.getFirstOrderSumSE (p1, p2, p3, p4);
+    };
+    auto cb_dy_fosse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) -> typename IntegralImage2D<float, 3>::ElementType
+    {
+      if (use_float_accumulators_)
+        return integral_image_DY_float_.getFirstOrderSumSE (p1, p2, p3, p4).template cast<double> ();
+      return integral_image_DY_.getFirstOrderSumSE (p1, p2, p3, p4);
+    };
     sumArea<typename IntegralImage2D<float, 3>::ElementType>(start_x, start_y, end_x, end_y, width, height, cb_dx_fosse, gradient_x);
-    auto cb_dy_fosse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) { return integral_image_DY_.getFirstOrderSumSE (p1, p2, p3, p4); };
     sumArea<typename IntegralImage2D<float, 3>::ElementType>(start_x, start_y, end_x, end_y, width, height, cb_dy_fosse, gradient_y);
 
 
@@ -596,17 +683,14 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
   // ======================================================
   if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE) 
   {
-    if (!init_depth_change_)
-      initAverageDepthChangeMethod ();
-
-    int point_index_L_x = pos_x - rect_width_4_ - 1;
+    int point_index_L_x = pos_x - rect_width_4 - 1;
     int point_index_L_y = pos_y;
-    int point_index_R_x = pos_x + rect_width_4_ + 1;
+    int point_index_R_x = pos_x + rect_width_4 + 1;
     int point_index_R_y = pos_y;
     int point_index_U_x = pos_x - 1;
-    int point_index_U_y = pos_y - rect_height_4_;
+    int point_index_U_y = pos_y - rect_height_4;
     int point_index_D_x = pos_x + 1;
-    int point_index_D_y = pos_y + rect_height_4_;
+    int point_index_D_y = pos_y + rect_height_4;
 
     if (point_index_L_x < 0)
       point_index_L_x = -point_index_L_x;
@@ -622,25 +706,25 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     if (point_index_D_y >= height)
       point_index_D_y = height-(point_index_D_y-(height-1));
 
-    const int start_x_L = pos_x - rect_width_2_;
-    const int start_y_L = pos_y - rect_height_4_;
-    const int end_x_L = start_x_L + rect_width_2_;
-    const int end_y_L = start_y_L + rect_height_2_;
+    const int start_x_L = pos_x - rect_width_2;
+    const int start_y_L = pos_y - rect_height_4;
+    const int end_x_L = start_x_L + rect_width_2;
+    const int end_y_L = start_y_L + rect_height_2;
 
     const int start_x_R = pos_x + 1;
-    const int start_y_R = pos_y - rect_height_4_;
-    const int end_x_R = start_x_R + rect_width_2_;
-    const int end_y_R = start_y_R + rect_height_2_;
+    const int start_y_R = pos_y - rect_height_4;
+    const int end_x_R = start_x_R + rect_width_2;
+    const int end_y_R = start_y_R + rect_height_2;
 
-    const int start_x_U = pos_x - rect_width_4_;
-    const int start_y_U = pos_y - rect_height_2_;
-    const int end_x_U = start_x_U + rect_width_2_;
-    const int end_y_U = start_y_U + rect_height_2_;
+    const int start_x_U = pos_x - rect_width_4;
+    const int start_y_U = pos_y - rect_height_2;
+    const int end_x_U = start_x_U + rect_width_2;
+    const int end_y_U = start_y_U + rect_height_2;
 
-    const int start_x_D = pos_x - rect_width_4_;
+    const int start_x_D = pos_x - rect_width_4;
     const int start_y_D = pos_y + 1;
-    const int end_x_D = start_x_D + rect_width_2_;
-    const int end_y_D = start_y_D + rect_height_2_;
+    const int end_x_D = start_x_D + rect_width_2;
+    const int end_y_D = start_y_D + rect_height_2;
 
     unsigned count_L_z = 0;
     unsigned count_R_z = 0;
@@ -733,50 +817,62 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
   
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
-  // compute depth-change map
-  auto depthChangeMap = new unsigned char[input_->size ()];
-  std::fill_n(depthChangeMap, input_->size(), 255);
+  // The exception could not leave the parallel loops below
+  if (border_policy_ == BORDER_POLICY_MIRROR && normal_estimation_method_ == SIMPLE_3D_GRADIENT)
+    PCL_THROW_EXCEPTION (PCLException, "BORDER_POLICY_MIRROR not supported for normal estimation method SIMPLE_3D_GRADIENT");
+  initNormalEstimationMethod ();
 
-  unsigned index = 0;
-  for (unsigned int ri = 0; ri < input_->height-1; ++ri)
+  // compute distance map, starting at 0 for points next to a depth change
+  //float *distanceMap = new float[input_->size ()];
+  delete[] distance_map_;
+  distance_map_ = new float[input_->size ()];
+  float *distanceMap = distance_map_;
+
+  // compute the depth changes on the edges to the right (bit 0) and lower (bit 1) neighbors,
+  // the edges of the last row and of the last column are not checked
+  const auto width = static_cast<std::ptrdiff_t> (input_->width);
+  const auto height = static_cast<std::ptrdiff_t> (input_->height);
+  std::vector<unsigned char> depthChangeEdges (input_->size (), 0);
+#pragma omp parallel for \
+  shared(depthChangeEdges) \
+  num_threads(threads_)
+  for (std::ptrdiff_t ri = 0; ri < height - 1; ++ri)
   {
-    for (unsigned int ci = 0; ci < input_->width-1; ++ci, ++index)
+    for (std::ptrdiff_t ci = 0; ci < width - 1; ++ci)
     {
-      index = ri * input_->width + ci;
+      const std::ptrdiff_t index = ri * width + ci;
 
       const float depth  = input_->points [index].z;
       const float depthR = input_->points [index + 1].z;
-      const float depthD = input_->points [index + input_->width].z;
+      const float depthD = input_->points [index + width].z;
 
       //const float depthDependendDepthChange = (max_depth_change_factor_ * (std::abs(depth)+1.0f))/(500.0f*0.001f);
       const float depthDependendDepthChange = (max_depth_change_factor_ * (std::abs (depth) + 1.0f) * 2.0f);
 
       if (std::fabs (depth - depthR) > depthDependendDepthChange
         || !std::isfinite (depth) || !std::isfinite (depthR))
-      {
-        depthChangeMap[index] = 0;
-        depthChangeMap[index+1] = 0;
-      }
+        depthChangeEdges[index] |= 1;
       if (std::fabs (depth - depthD) > depthDependendDepthChange
         || !std::isfinite (depth) || !std::isfinite (depthD))
-      {
-        depthChangeMap[index] = 0;
-        depthChangeMap[index + input_->width] = 0;
-      }
+        depthChangeEdges[index] |= 2;
     }
   }
 
-  // compute distance map
-  //float *distanceMap = new float[input_->size ()];
-  delete[] distance_map_;
-  distance_map_ = new float[input_->size ()];
-  float *distanceMap = distance_map_;
-  for (std::size_t index = 0; index < input_->size (); ++index)
+  // a point is next to a depth change if one of its four edges crosses it
+  const auto max_distance = static_cast<float> (input_->width + input_->height);
+#pragma omp parallel for \
+  shared(depthChangeEdges, distanceMap) \
+  num_threads(threads_)
+  for (std::ptrdiff_t ri = 0; ri < height; ++ri)
   {
-    if (depthChangeMap[index] == 0)
-      distanceMap[index] = 0.0f;
-    else
-      distanceMap[index] = static_cast<float> (input_->width + input_->height);
+    for (std::ptrdiff_t ci = 0; ci < width; ++ci)
+    {
+      const std::ptrdiff_t index = ri * width + ci;
+      const bool depth_change = depthChangeEdges[index] != 0 ||
+                                (ci > 0 && (depthChangeEdges[index - 1] & 1) != 0) ||
+                                (ri > 0 && (depthChangeEdges[index - width] & 2) != 0);
+      distanceMap[index] = depth_change ? 0.0f : max_distance;
+    }
   }
 
   // first pass
@@ -827,8 +923,6 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
     computeFeaturePart (distanceMap, bad_point, output);
   else
     computeFeatureFull (distanceMap, bad_point, output);
-
-  delete[] depthChangeMap;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -837,8 +931,6 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
                                                                              const float &bad_point,
                                                                              PointCloudOut &output)
 {
-  unsigned index = 0;
-
   if (border_policy_ == BORDER_POLICY_IGNORE)
   {
     // Set all normals that we do not touch to NaN
@@ -872,148 +964,104 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
       }
     }
 
-    if (use_depth_dependent_smoothing_)
+    // The covariance matrices of a row are decomposed together
+    const bool decompose_rows = (normal_estimation_method_ == COVARIANCE_MATRIX);
+#pragma omp parallel for \
+  shared(distanceMap, output) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+    for (std::ptrdiff_t row = border; row < static_cast<std::ptrdiff_t> (input_->height - border); ++row)
     {
-      index = border + input_->width * border;
-      unsigned skip = (border << 1);
-      for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
+      const auto ri = static_cast<unsigned> (row);
+      std::vector<Eigen::Matrix3f> covariance_matrices;
+      std::vector<unsigned> covariance_indices;
+      for (unsigned ci = border; ci < input_->width - border; ++ci)
       {
-        for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
+        const unsigned index = ri * input_->width + ci;
+
+        const float depth = (*input_)[index].z;
+        if (!std::isfinite (depth))
         {
-          index = ri * input_->width + ci;
-
-          const float depth = (*input_)[index].z;
-          if (!std::isfinite (depth))
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            // Since depth can be anything, we have no guarantee that the border is sufficient, so we need to check
-            if(ci>static_cast<unsigned>(rect_width_2_) && ri>static_cast<unsigned>(rect_height_2_) && (ci+rect_width_2_)<input_->width && (ri+rect_height_2_)<input_->height) {
-              computePointNormal (ci, ri, index, output [index]);
-            } else {
-              output[index].getNormalVector3fMap ().setConstant (bad_point);
-              output[index].curvature = bad_point;
-            }
-          }
-          else
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-          }
+          output [index].getNormalVector3fMap ().setConstant (bad_point);
+          output [index].curvature = bad_point;
+          continue;
         }
-      }
-    }
-    else
-    {
-      index = border + input_->width * border;
-      unsigned skip = (border << 1);
-      for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
-      {
-        for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
+
+        float smoothing = use_depth_dependent_smoothing_ ? (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f)
+                                                         : (std::min)(distanceMap[index], normal_smoothing_size_);
+        const auto rect_size = static_cast<int> (smoothing);
+        const auto rect_size_2 = static_cast<unsigned> (rect_size / 2);
+
+        // With depth dependent smoothing we have no guarantee that the border is sufficient, so we need to check
+        if (!(smoothing > 2.0f) ||
+            (use_depth_dependent_smoothing_ &&
+             !(ci > rect_size_2 && ri > rect_size_2 && (ci + rect_size_2) < input_->width && (ri + rect_size_2) < input_->height)))
         {
-          index = ri * input_->width + ci;
-
-          if (!std::isfinite ((*input_)[index].z))
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormal (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-          }
+          output [index].getNormalVector3fMap ().setConstant (bad_point);
+          output [index].curvature = bad_point;
+          continue;
+        }
+
+        if (!decompose_rows)
+        {
+          computePointNormal (ci, ri, index, rect_size, rect_size, output [index]);
+          continue;
         }
+
+        Eigen::Matrix3f covariance_matrix;
+        if (computeCovarianceMatrix (ci, ri, rect_size, rect_size, covariance_matrix))
+        {
+          covariance_matrices.push_back (covariance_matrix);
+          covariance_indices.push_back (index);
+        }
+        else
+          output [index].normal_x = output [index].normal_y = output [index].normal_z = output [index].curvature = bad_point;
       }
+
+      if (covariance_matrices.empty ())
+        continue;
+      std::vector<float> eigen_values;
+      std::vector<Eigen::Vector3f> eigen_vectors;
+      pcl::eigen33 (covariance_matrices, eigen_values, eigen_vectors);
+      for (std::size_t i = 0; i < covariance_indices.size (); ++i)
+        setCovarianceNormal (covariance_indices[i], covariance_matrices[i], eigen_values[i], eigen_vectors[i], output [covariance_indices[i]]);
     }
   }
   else if (border_policy_ == BORDER_POLICY_MIRROR)
   {
     output.is_dense = false;
 
-    if (use_depth_dependent_smoothing_)
+#pragma omp parallel for \
+  shared(distanceMap, output) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+    for (std::ptrdiff_t row = 0; row < static_cast<std::ptrdiff_t> (input_->height); ++row)
     {
-      //index = 0;
-      //unsigned skip = 0;
-      //for (unsigned ri = 0; ri < input_->height; ++ri, index += skip)
-      for (unsigned ri = 0; ri < input_->height; ++ri)
+      const auto ri = static_cast<unsigned> (row);
+      for (unsigned ci = 0; ci < input_->width; ++ci)
       {
-        //for (unsigned ci = 0; ci < input_->width; ++ci, ++index)
-        for (unsigned ci = 0; ci < input_->width; ++ci)
+        const unsigned index = ri * input_->width + ci;
+
+        const float depth = (*input_)[index].z;
+        if (!std::isfinite (depth))
         {
-          index = ri * input_->width + ci;
-
-          const float depth = (*input_)[index].z;
-          if (!std::isfinite (depth))
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormalMirror (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-          }
+          output [index].getNormalVector3fMap ().setConstant (bad_point);
+          output [index].curvature = bad_point;
+          continue;
         }
-      }
-    }
-    else
-    {
-      //index = border + input_->width * border;
-      //unsigned skip = (border << 1);
-      //for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
-      for (unsigned ri = 0; ri < input_->height; ++ri)
-      {
-        //for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
-        for (unsigned ci = 0; ci < input_->width; ++ci)
+
+        float smoothing = use_depth_dependent_smoothing_ ? (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f)
+                                                         : (std::min)(distanceMap[index], normal_smoothing_size_);
+
+        if (smoothing > 2.0f)
         {
-          index = ri * input_->width + ci;
-
-          if (!std::isfinite ((*input_)[index].z))
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormalMirror (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-          }
+          const auto rect_size = static_cast<int> (smoothing);
+          computePointNormalMirror (ci, ri, index, rect_size, rect_size, output [index]);
+        }
+        else
+        {
+          output [index].getNormalVector3fMap ().setConstant (bad_point);
+          output [index].curvature = bad_point;
         }
       }
     }
@@ -1032,90 +1080,48 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (con
     const auto border = static_cast<unsigned>(normal_smoothing_size_);
     const unsigned bottom = input_->height > border ? input_->height - border : 0;
     const unsigned right = input_->width > border ? input_->width - border : 0;
-    if (use_depth_dependent_smoothing_)
+    // Iterating over the entire index vector
+#pragma omp parallel for \
+  shared(distanceMap, output) \
+  num_threads(threads_)
+    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
     {
-      // Iterating over the entire index vector
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      unsigned pt_index = (*indices_)[idx];
+      unsigned u = pt_index % input_->width;
+      unsigned v = pt_index / input_->width;
+      if (v < border || v > bottom)
       {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-        if (v < border || v > bottom)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
+        output[idx].getNormalVector3fMap ().setConstant (bad_point);
+        output[idx].curvature = bad_point;
+        continue;
+      }
 
-        if (u < border || u > right)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
+      if (u < border || u > right)
+      {
+        output[idx].getNormalVector3fMap ().setConstant (bad_point);
+        output[idx].curvature = bad_point;
+        continue;
+      }
 
-        const float depth = (*input_)[pt_index].z;
-        if (!std::isfinite (depth))
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
+      const float depth = (*input_)[pt_index].z;
+      if (!std::isfinite (depth))
+      {
+        output[idx].getNormalVector3fMap ().setConstant (bad_point);
+        output[idx].curvature = bad_point;
+        continue;
+      }
 
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormal (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-        }
+      float smoothing = use_depth_dependent_smoothing_ ? (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f)
+                                                       : (std::min)(distanceMap[pt_index], normal_smoothing_size_);
+      if (smoothing > 2.0f)
+      {
+        const auto rect_size = static_cast<int> (smoothing);
+        computePointNormal (u, v, pt_index, rect_size, rect_size, output [idx]);
       }
-    }
-    else
-    {
-      // Iterating over the entire index vector
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      else
       {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-        if (v < border || v > bottom)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        if (u < border || u > right)
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
-
-        if (!std::isfinite ((*input_)[pt_index].z))
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_);
-
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormal (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-        }
+        output[idx].getNormalVector3fMap ().setConstant (bad_point);
+        output[idx].curvature = bad_point;
       }
     }
   }// border_policy_ == BORDER_POLICY_IGNORE
@@ -1123,63 +1129,35 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (con
   {
     output.is_dense = false;
 
-    if (use_depth_dependent_smoothing_)
+#pragma omp parallel for \
+  shared(distanceMap, output) \
+  num_threads(threads_)
+    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
     {
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-      {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
+      unsigned pt_index = (*indices_)[idx];
+      unsigned u = pt_index % input_->width;
+      unsigned v = pt_index / input_->width;
 
-        const float depth = (*input_)[pt_index].z;
-        if (!std::isfinite (depth))
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
+      const float depth = (*input_)[pt_index].z;
+      if (!std::isfinite (depth))
+      {
+        output[idx].getNormalVector3fMap ().setConstant (bad_point);
+        output[idx].curvature = bad_point;
+        continue;
+      }
 
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+      float smoothing = use_depth_dependent_smoothing_ ? (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f)
+                                                       : (std::min)(distanceMap[pt_index], normal_smoothing_size_);
 
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormalMirror (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-        }
+      if (smoothing > 2.0f)
+      {
+        const auto rect_size = static_cast<int> (smoothing);
+        computePointNormalMirror (u, v, pt_index, rect_size, rect_size, output [idx]);
       }
-    }
-    else
-    {
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      else
       {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-
-        if (!std::isfinite ((*input_)[pt_index].z))
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_);
-
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormalMirror (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-        }
+        output[idx].getNormalVector3fMap ().setConstant (bad_point);
+        output[idx].curvature = bad_point;
       }
     }
   } // border_policy_ == BORDER_POLICY_MIRROR
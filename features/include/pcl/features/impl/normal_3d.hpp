@@ -47,52 +47,71 @@
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  pcl::Indices nn_indices (k_);
+  // Neighborhoods are searched for a batch of points, whose normals are then estimated together
+  constexpr std::size_t batch_size = 256;
+  std::vector<pcl::Indices> nn_indices;
   std::vector<float> nn_dists (k_);
 
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
+  for (std::size_t first = 0; first < indices_->size (); first += batch_size)
   {
-    // Iterating over the entire index vector
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+    nn_indices.resize (std::min (batch_size, indices_->size () - first));
+    for (std::size_t i = 0; i < nn_indices.size (); ++i)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !computePointNormal (*surface_, nn_indices, output[idx].normal[0], output[idx].normal[1], output[idx].normal[2], output[idx].curvature))
-      {
-        output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+      // \note This resize is irrelevant for a radiusSearch ().
+      nn_indices[i].resize (k_);
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[first + i]])) ||
+          this->searchForNeighbors ((*indices_)[first + i], search_parameter_, nn_indices[i], nn_dists) == 0)
+        nn_indices[i].clear ();
+    }
 
-        output.is_dense = false;
-        continue;
-      }
+    if (!computePointNormals (nn_indices, first, output))
+      output.is_dense = false;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::NormalEstimation<PointInT, PointOutT>::computePointNormals (
+    const std::vector<pcl::Indices> &neighborhoods, std::size_t first, PointCloudOut &output) const
+{
+  std::vector<Eigen::Matrix3f> covariance_matrices;
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > centroids;
+  std::vector<unsigned int> point_counts;
+  pcl::computeMeanAndCovarianceMatrices (*surface_, neighborhoods, covariance_matrices, centroids, point_counts);
+  for (std::size_t i = 0; i < neighborhoods.size (); ++i)
+    if (point_counts[i] == 0)
+      covariance_matrices[i].setZero ();
 
-      flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
+  std::vector<float> eigenvalues;
+  std::vector<Eigen::Vector3f> eigenvectors;
+  pcl::eigen33 (covariance_matrices, eigenvalues, eigenvectors);
 
-    }
-  }
-  else
+  bool all_valid = true;
+  for (std::size_t i = 0; i < neighborhoods.size (); ++i)
   {
-    // Iterating over the entire index vector
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+    PointOutT &point = output[first + i];
+    if (neighborhoods[i].size () < 3 || point_counts[i] == 0)
     {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !computePointNormal (*surface_, nn_indices, output[idx].normal[0], output[idx].normal[1], output[idx].normal[2], output[idx].curvature))
-      {
-        output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+      point.normal[0] = point.normal[1] = point.normal[2] = point.curvature = std::numeric_limits<float>::quiet_NaN ();
+      all_valid = false;
+      continue;
+    }
 
-        output.is_dense = false;
-        continue;
-      }
+    point.normal[0] = eigenvectors[i][0];
+    point.normal[1] = eigenvectors[i][1];
+    point.normal[2] = eigenvectors[i][2];
 
-      flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
+    // Compute the curvature surface change, as in solvePlaneParameters
+    const Eigen::Matrix3f &covariance_matrix = covariance_matrices[i];
+    const float eig_sum = covariance_matrix.coeff (0) + covariance_matrix.coeff (4) + covariance_matrix.coeff (8);
+    point.curvature = (eig_sum != 0) ? std::abs (eigenvalues[i] / eig_sum) : 0.0f;
 
-    }
+    flipNormalTowardsViewpoint ((*input_)[(*indices_)[first + i]], vpx_, vpy_, vpz_,
+                                point.normal[0], point.normal[1], point.normal[2]);
   }
+  return (all_valid);
 }
 
 #define PCL_INSTANTIATE_NormalEstimation(T,NT) template class PCL_EXPORTS pcl::NormalEstimation<T,NT>;
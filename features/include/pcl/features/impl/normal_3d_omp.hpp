@@ -43,94 +43,38 @@
 
 #include <pcl/features/normal_3d_omp.h>
 
-///////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointInT, typename PointOutT> void
-pcl::NormalEstimationOMP<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
-{
-#ifdef _OPENMP
-  if (nr_threads == 0)
-    threads_ = omp_get_num_procs();
-  else
-    threads_ = nr_threads;
-  PCL_DEBUG ("[pcl::NormalEstimationOMP::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
-#else
-  threads_ = 1;
-  if (nr_threads != 1)
-    PCL_WARN ("[pcl::NormalEstimationOMP::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
-#endif // _OPENMP
-}
-
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  pcl::Indices nn_indices (k_);
+  // Every thread searches the neighborhoods of chunk_size_ points at a time and estimates their normals together
+  const std::size_t batch_size = static_cast<std::size_t> (std::max (chunk_size_, 1));
+  const auto nr_batches = static_cast<std::ptrdiff_t> ((indices_->size () + batch_size - 1) / batch_size);
+  std::vector<pcl::Indices> nn_indices;
   std::vector<float> nn_dists (k_);
 
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
-  {
 #pragma omp parallel for \
-  default(none) \
   shared(output) \
   firstprivate(nn_indices, nn_dists) \
   num_threads(threads_) \
-  schedule(dynamic, chunk_size_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
-    {
-      Eigen::Vector4f n;
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output[idx].curvature))
-      {
-        output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
-
-        output.is_dense = false;
-        continue;
-      }
-
-      output[idx].normal_x = n[0];
-      output[idx].normal_y = n[1];
-      output[idx].normal_z = n[2];
-
-      flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
-
-    }
-  }
-  else
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t batch = 0; batch < nr_batches; ++batch)
   {
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_) \
-  schedule(dynamic, chunk_size_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+    const std::size_t first = batch * batch_size;
+    nn_indices.resize (std::min (batch_size, indices_->size () - first));
+    for (std::size_t i = 0; i < nn_indices.size (); ++i)
     {
-      Eigen::Vector4f n;
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output[idx].curvature))
-      {
-        output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
-
-        output.is_dense = false;
-        continue;
-      }
-
-      output[idx].normal_x = n[0];
-      output[idx].normal_y = n[1];
-      output[idx].normal_z = n[2];
-
-      flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
-
+      // \note This resize is irrelevant for a radiusSearch ().
+      nn_indices[i].resize (k_);
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[first + i]])) ||
+          this->searchForNeighbors ((*indices_)[first + i], search_parameter_, nn_indices[i], nn_dists) == 0)
+        nn_indices[i].clear ();
     }
+
+    if (!this->computePointNormals (nn_indices, first, output))
+      output.is_dense = false;
   }
 }
 
@@ -43,6 +43,8 @@
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
+#include <algorithm> // for std::max, std::min
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> bool
@@ -70,7 +72,7 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
   // Factorization constant
   float hist_incr = 100.0f / static_cast<float> (indices.size () * (indices.size () - 1) / 2);
 
-  std::pair<int, int> key;
+  const bool use_cache = use_cache_ && cache_;
   bool key_found = false;
 
   // Iterate over all the points in the neighborhood
@@ -82,43 +84,12 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
       if (!isFinite (cloud[indices[i_idx]]) || !isFinite (cloud[indices[j_idx]]))
         continue;
 
-      if (use_cache_)
-      {
-        // In order to create the key, always use the smaller index as the first key pair member
-        int p1, p2;
-  //      if (indices[i_idx] >= indices[j_idx])
-  //      {
-          p1 = indices[i_idx];
-          p2 = indices[j_idx];
-  //      }
-  //      else
-  //      {
-  //        p1 = indices[j_idx];
-  //        p2 = indices[i_idx];
-  //      }
-        key = std::pair<int, int> (p1, p2);
-
-        // Check to see if we already estimated this pair in the global hashmap
-        auto fm_it = feature_map_.find (key);
-        if (fm_it != feature_map_.end ())
-        {
-          pfh_tuple_ = fm_it->second;
-          key_found = true;
-        }
-        else
-        {
-          // Compute the pair NNi to NNj
-          if (!computePairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
-                                    pfh_tuple_[0], pfh_tuple_[1], pfh_tuple_[2], pfh_tuple_[3]))
-            continue;
-
-          key_found = false;
-        }
-      }
-      else
-        if (!computePairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
-                                  pfh_tuple_[0], pfh_tuple_[1], pfh_tuple_[2], pfh_tuple_[3]))
-          continue;
+      // Check to see if we already estimated this pair in the cache
+      key_found = use_cache && cache_->find (indices[i_idx], indices[j_idx], pfh_tuple_);
+      if (!key_found &&
+          !computePairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
+                                pfh_tuple_[0], pfh_tuple_[1], pfh_tuple_[2], pfh_tuple_[3]))
+        continue;
 
       // Normalize the f1, f2, f3 features and push them in the histogram
       f_index_[0] = static_cast<int> (std::floor (nr_split * ((pfh_tuple_[0] + M_PI) * d_pi_)));
@@ -143,34 +114,56 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
       }
       pfh_histogram[h_index] += hist_incr;
 
-      if (use_cache_ && !key_found)
+      // Save the value in the cache, which stops storing new pairs once it is full
+      if (use_cache && !key_found)
+        cache_->insert (indices[i_idx], indices[j_idx], pfh_tuple_);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::PFHEstimation<PointInT, PointNT, PointOutT>::initCompute ()
+{
+  if (!FeatureFromNormals<PointInT, PointNT, PointOutT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  if (use_cache_)
+  {
+    if (!cache_)
+      cache_.reset (new PairFeatureCache (max_cache_size_));
+    // Size the table for the pairs of all the neighborhoods. Their size is estimated from a few of them for
+    // a radius search
+    std::size_t nr_neighbors = k_;
+    if (nr_neighbors == 0)
+    {
+      pcl::Indices nn_indices;
+      std::vector<float> nn_dists;
+      const std::size_t nr_samples = std::min<std::size_t> (indices_->size (), 16);
+      for (std::size_t sample = 0; sample < nr_samples; ++sample)
       {
-        // Save the value in the hashmap
-        feature_map_[key] = pfh_tuple_;
-
-        // Use a maximum cache so that we don't go overboard on RAM usage
-        key_list_.push (key);
-        // Check to see if we need to remove an element due to exceeding max_size
-        if (key_list_.size () > max_cache_size_)
-        {
-          // Remove the oldest element.
-          feature_map_.erase (key_list_.front ());
-          key_list_.pop ();
-        }
+        const std::size_t index = (*indices_)[indices_->size () * sample / nr_samples];
+        nr_neighbors = std::max<std::size_t> (nr_neighbors, this->searchForNeighbors (index, search_parameter_, nn_indices, nn_dists));
       }
     }
+    const std::size_t nr_pairs = nr_neighbors > 1 ? indices_->size () * nr_neighbors * (nr_neighbors - 1) / 2 : 0;
+    // The pair features only depend on the points and normals. As changes made to them in place cannot be
+    // detected, only a cache given by setCache is reused by the next calls
+    if (cache_->bind (surface_, normals_, nr_pairs))
+      PCL_DEBUG ("[pcl::%s::initCompute] Cleared the cache of pair features.\n", getClassName ().c_str ());
+    else if (!external_cache_)
+      cache_->clear ();
   }
+  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Clear the feature map
-  feature_map_.clear ();
-  std::queue<std::pair<int, int> > empty;
-  std::swap (key_list_, empty);
-
   pfh_histogram_.setZero (nr_subdiv_ * nr_subdiv_ * nr_subdiv_);
 
   // Allocate enough space to hold the results
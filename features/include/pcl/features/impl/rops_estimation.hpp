@@ -50,8 +50,7 @@
 template <typename PointInT, typename PointOutT>
 pcl::ROPSEstimation <PointInT, PointOutT>::ROPSEstimation () :
   
-  triangles_ (0),
-  triangles_of_the_point_ (0)
+  triangles_ (0)
 {
 }
 
@@ -60,7 +59,6 @@ template <typename PointInT, typename PointOutT>
 pcl::ROPSEstimation <PointInT, PointOutT>::~ROPSEstimation ()
 {
   triangles_.clear ();
-  triangles_of_the_point_.clear ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -128,6 +126,21 @@ pcl::ROPSEstimation <PointInT, PointOutT>::getTriangles (std::vector <pcl::Verti
   triangles = triangles_;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::ROPSEstimation <PointInT, PointOutT>::initCompute ()
+{
+  if (!Feature<PointInT, PointOutT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  // Built here rather than in computeFeature, so that the copies for parallel computation share it
+  buildListOfPointsTriangles ();
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -138,8 +151,6 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
     return;
   }
 
-  buildListOfPointsTriangles ();
-
   //feature size = number_of_rotations * number_of_axis_to_rotate_around * number_of_projections * number_of_central_moments
   unsigned int feature_size = number_of_rotations_ * 3 * 3 * 5;
   const auto number_of_points = indices_->size ();
@@ -211,15 +222,23 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
 template <typename PointInT, typename PointOutT> void
 pcl::ROPSEstimation <PointInT, PointOutT>::buildListOfPointsTriangles ()
 {
-  triangles_of_the_point_.clear ();
+  // Replaced rather than modified, as copies of a previous computation may still share it
+  auto triangles_of_the_point = pcl::make_shared<std::vector <std::vector <unsigned int> > > ();
+  if (triangles_.empty ())
+  {
+    triangles_of_the_point_ = triangles_of_the_point;
+    return;
+  }
 
   std::vector <unsigned int> dummy;
   dummy.reserve (100);
-  triangles_of_the_point_.resize (surface_->points. size (), dummy);
+  triangles_of_the_point->resize (surface_->points. size (), dummy);
 
   for (std::size_t i_triangle = 0; i_triangle < triangles_.size (); i_triangle++)
     for (const auto& vertex: triangles_[i_triangle].vertices)
-      triangles_of_the_point_[vertex].push_back (i_triangle);
+      (*triangles_of_the_point)[vertex].push_back (i_triangle);
+
+  triangles_of_the_point_ = triangles_of_the_point;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -230,8 +249,8 @@ pcl::ROPSEstimation <PointInT, PointOutT>::getLocalSurface (const PointInT& poin
   tree_->radiusSearch (point, support_radius_, local_points, distances);
 
   for (const auto& pt: local_points)
-    local_triangles.insert (triangles_of_the_point_[pt].begin (),
-                            triangles_of_the_point_[pt].end ());
+    local_triangles.insert ((*triangles_of_the_point_)[pt].begin (),
+                            (*triangles_of_the_point_)[pt].end ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
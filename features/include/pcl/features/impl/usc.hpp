@@ -260,5 +260,18 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computeFeature (PointClo
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> typename pcl::Feature<PointInT, PointOutT>::Ptr
+pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::makeThreadCopy (std::size_t first, std::size_t last) const
+{
+  Ptr copy (new UniqueShapeContext<PointInT, PointOutT, PointRFT> (*this));
+
+  // The frames are stored per index, the copy only gets the ones of its range
+  typename pcl::PointCloud<PointRFT>::Ptr frames (new pcl::PointCloud<PointRFT>);
+  frames->assign (frames_->begin () + first, frames_->begin () + last);
+  copy->frames_ = frames;
+  return (copy);
+}
+
 #define PCL_INSTANTIATE_UniqueShapeContext(T,OutT,RFT) template class PCL_EXPORTS pcl::UniqueShapeContext<T,OutT,RFT>;
 
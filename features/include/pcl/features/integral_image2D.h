@@ -103,17 +103,25 @@ namespace pcl
   };
 
   /** \brief Determines an integral image representation for a given organized data array
+    *
+    * The sums are accumulated in \a IntegralType, by default the type given by IntegralImageTypeTraits (e.g.
+    * double for float data). A narrower type such as float halves the memory and bandwidth, but every entry
+    * of the integral image is rounded relative to the sum of all the data above and left of it: a rectangle
+    * sum has an absolute error of up to about 4 (width + height) * epsilon * max |integral image entry|.
+    * This is only small compared to the rectangle sums if the data is centered around zero, e.g. for
+    * differences between neighboring points.
+    *
     * \author Suat Gedikli
     */
-  template <class DataType, unsigned Dimension>
+  template <class DataType, unsigned Dimension, typename IntegralType = typename IntegralImageTypeTraits<DataType>::IntegralType>
   class IntegralImage2D
   {
     public:
-      using Ptr = shared_ptr<IntegralImage2D<DataType, Dimension>>;
-      using ConstPtr = shared_ptr<const IntegralImage2D<DataType, Dimension>>;
+      using Ptr = shared_ptr<IntegralImage2D<DataType, Dimension, IntegralType>>;
+      using ConstPtr = shared_ptr<const IntegralImage2D<DataType, Dimension, IntegralType>>;
       static const unsigned second_order_size = (Dimension * (Dimension + 1)) >> 1;
-      using ElementType = Eigen::Matrix<typename IntegralImageTypeTraits<DataType>::IntegralType, Dimension, 1>;
-      using SecondOrderType = Eigen::Matrix<typename IntegralImageTypeTraits<DataType>::IntegralType, second_order_size, 1>;
+      using ElementType = Eigen::Matrix<IntegralType, Dimension, 1>;
+      using SecondOrderType = Eigen::Matrix<IntegralType, second_order_size, 1>;
 
       /** \brief Constructor for an Integral Image
         * \param[in] compute_second_order_integral_images set to true if we want to compute a second order image
@@ -130,6 +138,12 @@ namespace pcl
       virtual
       ~IntegralImage2D () = default;
 
+      /** \brief Set the number of threads used to compute the integral images in \ref setInput.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief sets the computation for second order integral images on or off.
         * \param compute_second_order_integral_images
         */
@@ -223,21 +237,24 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to compute the integral images. */
+      unsigned int threads_{1};
    };
 
    /**
      * \brief partial template specialization for integral images with just one channel.
      */
-  template <class DataType>
-  class IntegralImage2D <DataType, 1>
+  template <class DataType, typename IntegralType>
+  class IntegralImage2D <DataType, 1, IntegralType>
   {
     public:
-      using Ptr = shared_ptr<IntegralImage2D<DataType, 1>>;
-      using ConstPtr = shared_ptr<const IntegralImage2D<DataType, 1>>;
+      using Ptr = shared_ptr<IntegralImage2D<DataType, 1, IntegralType>>;
+      using ConstPtr = shared_ptr<const IntegralImage2D<DataType, 1, IntegralType>>;
 
       static const unsigned second_order_size = 1;
-      using ElementType = typename IntegralImageTypeTraits<DataType>::IntegralType;
-      using SecondOrderType = typename IntegralImageTypeTraits<DataType>::IntegralType;
+      using ElementType = IntegralType;
+      using SecondOrderType = IntegralType;
 
       /** \brief Constructor for an Integral Image
         * \param[in] compute_second_order_integral_images set to true if we want to compute a second order image
@@ -255,6 +272,12 @@ namespace pcl
       virtual
       ~IntegralImage2D () = default;
 
+      /** \brief Set the number of threads used to compute the integral images in \ref setInput.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -342,6 +365,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to compute the integral images. */
+      unsigned int threads_{1};
    };
  }
 
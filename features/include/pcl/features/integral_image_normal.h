@@ -59,6 +59,9 @@ namespace pcl
     *        the 15th RoboCup International Symposium, Istanbul, Turkey.
     *        http://www.ais.uni-bonn.de/~holz/papers/holz_2011_robocup.pdf 
     *
+    * The integral images and the normals are computed on the number of threads set with
+    * Feature::setNumberOfThreads.
+    *
     * \author Stefan Holzer
     */
   template <typename PointInT, typename PointOutT>
@@ -69,6 +72,7 @@ namespace pcl
     using Feature<PointInT, PointOutT>::tree_;
     using Feature<PointInT, PointOutT>::k_;
     using Feature<PointInT, PointOutT>::indices_;
+    using Feature<PointInT, PointOutT>::threads_;
 
     public:
       using Ptr = shared_ptr<IntegralImageNormalEstimation<PointInT, PointOutT> >;
@@ -111,6 +115,8 @@ namespace pcl
         , integral_image_DY_ (false)
         , integral_image_depth_ (false)
         , integral_image_XYZ_ (true)
+        , integral_image_DX_float_ (false)
+        , integral_image_DY_float_ (false)
         , max_depth_change_factor_ (20.0f*0.001f)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
@@ -199,6 +205,28 @@ namespace pcl
         normal_estimation_method_ = normal_estimation_method;
       }
 
+      /** \brief Set whether the AVERAGE_3D_GRADIENT integral images accumulate in float instead of double.
+        * This halves their memory and bandwidth. Since they integrate differences between neighboring points,
+        * which are centered around zero, the rounding error stays small: a gradient sum has an absolute error
+        * of up to about 4 (width + height) * epsilon (float) times the largest coordinate difference summed
+        * along a row or column of the image. The other methods always accumulate in double, as they integrate
+        * the coordinates themselves.
+        * \param[in] use_float_accumulators whether to accumulate the gradients in float
+        */
+      void
+      setUseFloatAccumulators (bool use_float_accumulators)
+      {
+        use_float_accumulators_ = use_float_accumulators;
+        init_average_3d_gradient_ = false;
+      }
+
+      /** \brief Get whether the AVERAGE_3D_GRADIENT integral images accumulate in float instead of double. */
+      bool
+      getUseFloatAccumulators () const
+      {
+        return (use_float_accumulators_);
+      }
+
       /** \brief Set whether to use depth depending smoothing or not
         * \param[in] use_depth_dependent_smoothing decides whether the smoothing is depth dependent
         */
@@ -337,7 +365,7 @@ namespace pcl
       inline void
       flipNormalTowardsViewpoint (const PointInT &point, 
                                   float vp_x, float vp_y, float vp_z,
-                                  float &nx, float &ny, float &nz)
+                                  float &nx, float &ny, float &nz) const
       {
         // See if we need to flip any plane normals
         vp_x -= point.x;
@@ -356,6 +384,55 @@ namespace pcl
         }
       }
 
+      /** \brief Computes the normal at the specified position for a given rectangle size.
+        * The integral images of the current normal estimation method have to be initialized.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormal (const int pos_x, const int pos_y, const unsigned point_index,
+                          const int rect_width, const int rect_height, PointOutT &normal) const;
+
+      /** \brief Computes the normal at the specified position for a given rectangle size, with mirroring for
+        * border handling. The integral images of the current normal estimation method have to be initialized.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormalMirror (const int pos_x, const int pos_y, const unsigned point_index,
+                                const int rect_width, const int rect_height, PointOutT &normal) const;
+
+      /** \brief Computes the covariance matrix of a rectangle from the COVARIANCE_MATRIX integral images.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] covariance_matrix the (unnormalized) covariance matrix of the rectangle
+        * \return false if there are no valid points within the rectangle
+        */
+      bool
+      computeCovarianceMatrix (const int pos_x, const int pos_y, const int rect_width, const int rect_height,
+                               Eigen::Matrix3f &covariance_matrix) const;
+
+      /** \brief Stores the normal and curvature given by the smallest eigenpair of a covariance matrix.
+        * \param[in] point_index the position index of the point
+        * \param[in] covariance_matrix the covariance matrix of the neighborhood
+        * \param[in] eigen_value the smallest eigenvalue of the covariance matrix
+        * \param[in] eigen_vector the eigenvector belonging to \a eigen_value
+        * \param[out] normal the output estimated normal
+        */
+      void
+      setCovarianceNormal (const unsigned point_index, const Eigen::Matrix3f &covariance_matrix,
+                           const float eigen_value, Eigen::Vector3f eigen_vector, PointOutT &normal) const;
+
       /** \brief The normal estimation method to use. Currently, 3 implementations are provided:
         *
         * - COVARIANCE_MATRIX
@@ -387,6 +464,10 @@ namespace pcl
       IntegralImage2D<float, 1> integral_image_depth_;
       /** integral image xyz */
       IntegralImage2D<float, 3> integral_image_XYZ_;
+      /** integral image in x-direction, accumulated in float */
+      IntegralImage2D<float, 3, float> integral_image_DX_float_;
+      /** integral image in y-direction, accumulated in float */
+      IntegralImage2D<float, 3, float> integral_image_DY_float_;
 
       /** derivatives in x-direction */
       float *diff_x_{nullptr};
@@ -399,6 +480,9 @@ namespace pcl
       /** distance map */
       float *distance_map_{nullptr};
 
+      /** \brief Accumulate the AVERAGE_3D_GRADIENT integral images in float (true/false). */
+      bool use_float_accumulators_{false};
+
       /** \brief Smooth data based on depth (true/false). */
       bool use_depth_dependent_smoothing_{false};
 
@@ -447,6 +531,10 @@ namespace pcl
       void
       initSimple3DGradientMethod ();
 
+      /** \brief Initializes the integral images of the current normal estimation method, unless done already. */
+      void
+      initNormalEstimationMethod ();
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -64,6 +64,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::surface_;
       using Feature<PointInT, PointOutT>::k_;
       using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::threads_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
 
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
@@ -72,13 +73,9 @@ namespace pcl
       IntensityGradientEstimation () : intensity_ ()
       {
         feature_name_ = "IntensityGradientEstimation";
-      }
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      inline void
-      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+        this->setNumberOfThreads (0);
+      }
 
     protected:
       /** \brief Estimate the intensity gradients for a set of points given in <setInputCloud (), setIndices ()> using
@@ -107,8 +104,6 @@ namespace pcl
     protected:
       ///intensity field accessor structure
       IntensitySelectorT intensity_;
-      ///number of threads to be used, default 0 (auto)
-      unsigned int threads_{0};
   };
 }
 
@@ -44,6 +44,7 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/features/feature.h>
 #include <pcl/common/centroid.h>
+#include <pcl/common/eigen.h>
 
 namespace pcl
 {
@@ -397,6 +398,17 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Estimate the normals and curvatures of a batch of points at once from their neighborhoods, using the
+        * batched computeMeanAndCovarianceMatrices and eigen33 kernels. The normals are flipped towards the viewpoint.
+        * \note Points with less than 3 neighbors (e.g. an empty neighborhood after a failed search) get NaN values.
+        * \param[in] neighborhoods the indices of the neighbors in the search surface, for the points first .. first + neighborhoods.size () - 1 of indices_
+        * \param[in] first position of the first point of the batch in indices_ and in output
+        * \param[out] output the resultant point cloud model dataset that contains surface normals and curvatures
+        * \return false if the normal of at least one point could not be estimated
+        */
+      bool
+      computePointNormals (const std::vector<pcl::Indices> &neighborhoods, std::size_t first, PointCloudOut &output) const;
+
       /** \brief Values describing the viewpoint ("pinhole" camera model assumed). For per point viewpoints, inherit
         * from NormalEstimation and provide your own computeFeature (). By default, the viewpoint is set to 0,0,0. */
       float vpx_{0.0f}, vpy_{0.0f}, vpz_{0.0f};
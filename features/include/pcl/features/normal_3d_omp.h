@@ -66,6 +66,7 @@ namespace pcl
       using NormalEstimation<PointInT, PointOutT>::search_parameter_;
       using NormalEstimation<PointInT, PointOutT>::surface_;
       using NormalEstimation<PointInT, PointOutT>::getViewPoint;
+      using Feature<PointInT, PointOutT>::threads_;
 
       using PointCloudOut = typename NormalEstimation<PointInT, PointOutT>::PointCloudOut;
 
@@ -78,19 +79,10 @@ namespace pcl
       {
         feature_name_ = "NormalEstimationOMP";
 
-        setNumberOfThreads(nr_threads);
+        this->setNumberOfThreads (nr_threads);
       }
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      void
-      setNumberOfThreads (unsigned int nr_threads = 0);
-
     protected:
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
-
       /** \brief Chunk size for (dynamic) scheduling. */
       int chunk_size_;
     private:
@@ -42,8 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
-#include <map>
-#include <queue> // for std::queue
+#include <pcl/features/feature_cache.h>
 
 namespace pcl
 {
@@ -71,8 +70,9 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its PFH feature property set to NaN.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref FPFHEstimationOMP for examples on parallel implementations of the FPFH (Fast Point Feature Histogram).
+    * \note The cache of pair features (see \ref setUseInternalCache) is shared by all threads of a parallel
+    * computation (see \ref setNumberOfThreads). The internal cache is cleared by every call to compute, only a
+    * cache given by \ref setCache is reused by later calls.
     *
     * \author Radu B. Rusu
     * \ingroup features
@@ -96,25 +96,25 @@ namespace pcl
       using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
 
       /** \brief Empty constructor. 
-        * Sets \a use_cache_ to false, \a nr_subdiv_ to 5, and the internal maximum cache size to 1GB.
+        * Sets \a use_cache_ to false, \a nr_subdiv_ to 5, and the internal maximum cache size to 4M pairs.
         */
       PFHEstimation () :
          
-        d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI))), 
-        key_list_ (),
-        // Default 1GB memory size. Need to set it to something more conservative.
-        max_cache_size_ ((1ul*1024ul*1024ul*1024ul) / sizeof (std::pair<std::pair<int, int>, Eigen::Vector4f>))
+        d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI)))
       {
         feature_name_ = "PFHEstimation";
       }
 
-      /** \brief Set the maximum internal cache size. Defaults to 2GB worth of entries.
+      /** \brief Set the maximum internal cache size, in pairs. Defaults to 4M pairs (128MB). The cache only
+        * allocates the memory needed for the pairs of the neighborhoods of the input, see PairFeatureCache.
         * \param[in] cache_size maximum cache size 
         */
       inline void
       setMaximumCacheSize (unsigned int cache_size)
       {
         max_cache_size_ = cache_size;
+        if (cache_)
+          cache_->setCapacity (max_cache_size_);
       }
 
       /** \brief Get the maximum internal cache size. */
@@ -131,7 +131,8 @@ namespace pcl
         * negative influence. Please test with and without a cache on your
         * data, and choose whatever works best!
         *
-        * See \ref setMaximumCacheSize for setting the maximum cache size
+        * See \ref setMaximumCacheSize for setting the maximum cache size. The internal cache is cleared
+        * at the beginning of every call to compute, see \ref setCache for reusing the pairs across calls.
         *
         * \param[in] use_cache set to true to use the internal cache, false otherwise
         */
@@ -148,6 +149,33 @@ namespace pcl
         return (use_cache_);
       }
 
+      /** \brief Provide a pointer to the cache of pair features, e.g. to share it with other estimators that
+        * work on the same search surface and normals. Enables the use of the cache.
+        *
+        * Unlike the internal cache, this cache is kept between calls to compute as long as the search surface
+        * and the normals are the same cloud objects. It is only cleared when another surface or normals cloud
+        * is used.
+        * \note Changes made in place to the points or normals are not detected (see \ref FeatureCacheSource).
+        * Call PairFeatureCache::clear after modifying them.
+        * \param[in] cache the cache of pair features
+        */
+      inline void
+      setCache (const PairFeatureCache::Ptr &cache)
+      {
+        cache_ = cache;
+        use_cache_ = static_cast<bool> (cache_);
+        external_cache_ = use_cache_;
+      }
+
+      /** \brief Get a pointer to the cache of pair features, which is created by compute if the internal cache
+        * is used.
+        */
+      inline PairFeatureCache::Ptr
+      getCache () const
+      {
+        return (cache_);
+      }
+
       /** \brief Compute the 4-tuple representation containing the three angles and one distance between two points
         * represented by Cartesian coordinates and normals.
         * \note For explanations about the features, please see the literature mentioned above (the order of the
@@ -179,6 +207,12 @@ namespace pcl
                                 const pcl::Indices &indices, int nr_split, Eigen::VectorXf &pfh_histogram);
 
     protected:
+      /** \brief Create the cache of pair features if needed. Clear the internal cache, or a cache given by
+        * setCache if it was filled from another search surface or other normals.
+        */
+      bool
+      initCompute () override;
+
       /** \brief Estimate the Point Feature Histograms (PFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -187,6 +221,15 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Copy the estimator for parallel computation. Each copy has its own histogram
+        * placeholders and shares the cache, see Feature::makeThreadCopy.
+        */
+      typename Feature<PointInT, PointOutT>::Ptr
+      makeThreadCopy (std::size_t, std::size_t) const override
+      {
+        return (typename Feature<PointInT, PointOutT>::Ptr (new PFHEstimation<PointInT, PointNT, PointOutT> (*this)));
+      }
+
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_subdiv_{5};
 
@@ -202,14 +245,14 @@ namespace pcl
       /** \brief Float constant = 1.0 / (2.0 * M_PI) */
       float d_pi_; 
 
-      /** \brief Internal hashmap, used to optimize efficiency of redundant computations. */
-      std::map<std::pair<int, int>, Eigen::Vector4f, std::less<>, Eigen::aligned_allocator<std::pair<const std::pair<int, int>, Eigen::Vector4f> > > feature_map_;
+      /** \brief Cache of pair features, used to optimize efficiency of redundant computations. */
+      PairFeatureCache::Ptr cache_;
 
-      /** \brief Queue of pairs saved, used to constrain memory usage. */
-      std::queue<std::pair<int, int> > key_list_;
+      /** \brief Whether \a cache_ was given by setCache, and is therefore kept between calls. */
+      bool external_cache_{false};
 
-      /** \brief Maximum size of internal cache memory. */
-      unsigned int max_cache_size_;
+      /** \brief Maximum number of pairs in the internal cache. */
+      unsigned int max_cache_size_{1u << 22};
 
       /** \brief Set to true to use the internal cache for removing redundant computations. */
       bool use_cache_{false};
@@ -111,6 +111,13 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Copy the estimator for parallel computation, see Feature::makeThreadCopy. */
+      typename Feature<PointInT, PointOutT>::Ptr
+      makeThreadCopy (std::size_t, std::size_t) const override
+      {
+        return (typename Feature<PointInT, PointOutT>::Ptr (new PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT> (*this)));
+      }
+
     private:
       /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
       std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > projected_normals_;
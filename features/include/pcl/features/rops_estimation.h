@@ -61,6 +61,7 @@ namespace pcl
       using Feature <PointInT, PointOutT>::indices_;
       using Feature <PointInT, PointOutT>::surface_;
       using Feature <PointInT, PointOutT>::tree_;
+      using Feature <PointInT, PointOutT>::getClassName;
 
       using PointCloudOut = typename pcl::Feature <PointInT, PointOutT>::PointCloudOut;
       using PointCloudIn = typename pcl::Feature <PointInT, PointOutT>::PointCloudIn;
@@ -118,12 +119,28 @@ namespace pcl
 
     private:
 
+      /** \brief Initializes the computation and builds the list of triangles for every point. */
+      bool
+      initCompute () override;
+
       /** \brief Abstract feature estimation method.
         * \param[out] output the resultant features
         */
       void
       computeFeature (PointCloudOut& output) override;
 
+      /** \brief Copy the estimator for parallel computation, see Feature::makeThreadCopy.
+        * The copies share the list of triangles for every point, which is built once in initCompute.
+        * Without triangles there is nothing to compute in parallel, so a null pointer is returned.
+        */
+      typename pcl::Feature <PointInT, PointOutT>::Ptr
+      makeThreadCopy (std::size_t, std::size_t) const override
+      {
+        if (triangles_.empty ())
+          return (typename pcl::Feature <PointInT, PointOutT>::Ptr ());
+        return (typename pcl::Feature <PointInT, PointOutT>::Ptr (new ROPSEstimation <PointInT, PointOutT> (*this)));
+      }
+
       /** \brief This method simply builds the list of triangles for every point.
         * The list of triangles for each point consists of indices of triangles it belongs to.
         * The only purpose of this method is to improve performance of the algorithm.
@@ -219,8 +236,10 @@ namespace pcl
       /** \brief Stores the set of triangles representing the mesh. */
       std::vector <pcl::Vertices> triangles_;
 
-      /** \brief Stores the set of triangles for each point. Its purpose is to improve performance. */
-      std::vector <std::vector <unsigned int> > triangles_of_the_point_;
+      /** \brief Stores the set of triangles for each point. Its purpose is to improve performance.
+        * It is shared with the copies made for parallel computation.
+        */
+      shared_ptr<const std::vector <std::vector <unsigned int> > > triangles_of_the_point_;
 
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
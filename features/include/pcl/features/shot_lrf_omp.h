@@ -73,18 +73,12 @@ namespace pcl
       {
         feature_name_ = "SHOTLocalReferenceFrameEstimationOMP";
 
-        setNumberOfThreads(0);
+        this->setNumberOfThreads (0);
       }
 
     /** \brief Empty destructor */
     ~SHOTLocalReferenceFrameEstimationOMP () override = default;
 
-    /** \brief Initialize the scheduler and set the number of threads to use.
-     * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-     */
-    void
-    setNumberOfThreads (unsigned int nr_threads = 0);
-
     protected:
       using Feature<PointInT, PointOutT>::feature_name_;
       using Feature<PointInT, PointOutT>::getClassName;
@@ -94,6 +88,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::surface_;
       using Feature<PointInT, PointOutT>::tree_;
       using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::threads_;
       using SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF;
       using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
@@ -103,10 +98,6 @@ namespace pcl
         */
       void
       computeFeature (PointCloudOut &output) override;
-
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
-
   };
 }
 
@@ -80,6 +80,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::search_radius_;
       using Feature<PointInT, PointOutT>::surface_;
       using Feature<PointInT, PointOutT>::fake_surface_;
+      using Feature<PointInT, PointOutT>::threads_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::lrf_radius_;
@@ -97,15 +98,9 @@ namespace pcl
       /** \brief Empty constructor. */
       SHOTEstimationOMP (unsigned int nr_threads = 0) : SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT> ()
       {
-        setNumberOfThreads(nr_threads);
+        this->setNumberOfThreads (nr_threads);
       };
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      void
-      setNumberOfThreads (unsigned int nr_threads = 0);
-
     protected:
 
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
@@ -119,9 +114,6 @@ namespace pcl
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute () override;
-
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
   };
 
   /** \brief SHOTColorEstimationOMP estimates the Signature of Histograms of OrienTations (SHOT) descriptor for a given point cloud dataset
@@ -159,6 +151,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::search_radius_;
       using Feature<PointInT, PointOutT>::surface_;
       using Feature<PointInT, PointOutT>::fake_surface_;
+      using Feature<PointInT, PointOutT>::threads_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::lrf_radius_;
@@ -182,15 +175,9 @@ namespace pcl
                               unsigned int nr_threads = 0)
         : SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT> (describe_shape, describe_color)
       {
-        setNumberOfThreads(nr_threads);
+        this->setNumberOfThreads (nr_threads);
       }
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      void
-      setNumberOfThreads (unsigned int nr_threads = 0);
-
     protected:
 
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
@@ -204,9 +191,6 @@ namespace pcl
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute () override;
-
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
   };
 
 }
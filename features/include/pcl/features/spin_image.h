@@ -269,6 +269,13 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output) override; 
 
+      /** \brief Copy the estimator for parallel computation, see Feature::makeThreadCopy. */
+      typename Feature<PointInT, PointOutT>::Ptr
+      makeThreadCopy (std::size_t, std::size_t) const override
+      {
+        return (typename Feature<PointInT, PointOutT>::Ptr (new SpinImageEstimation<PointInT, PointNT, PointOutT> (*this)));
+      }
+
       /** \brief initializes computations specific to spin-image.
         * 
         * \return true iff input data and initialization are correct
@@ -152,6 +152,12 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Copy the estimator for parallel computation, see Feature::makeThreadCopy. The
+        * reference frames, computed per index in initCompute, are restricted to [first, last).
+        */
+      typename Feature<PointInT, PointOutT>::Ptr
+      makeThreadCopy (std::size_t first, std::size_t last) const override;
+
       /** \brief values of the radii interval. */
       std::vector<float> radii_interval_;
 
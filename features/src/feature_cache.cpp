@@ -0,0 +1,311 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/features/feature_cache.h>
+
+#include <algorithm> // for std::copy_n
+
+namespace
+{
+  /** \brief Status of a cache entry, stored in the two lowest bits of its state. The remaining bits hold the
+    * generation of the cache the entry was written in: entries of older generations are empty.
+    */
+  enum SlotStatus : std::uint32_t
+  {
+    SLOT_EMPTY = 0,
+    SLOT_BUSY = 1,
+    SLOT_READY = 2
+  };
+
+  /** \brief The number of generations before the states have to be reset. */
+  constexpr std::uint32_t max_generation = (std::uint32_t (1) << 30) - 1;
+
+  /** \brief The maximum number of slots probed by PairFeatureCache before giving up. */
+  constexpr std::size_t max_probes = 16;
+
+  inline std::uint32_t
+  makeState (std::uint32_t generation, SlotStatus status)
+  {
+    return ((generation << 2) | status);
+  }
+
+  /** \brief Mix the bits of a 64 bit key (finalizer of splitmix64). */
+  inline std::uint64_t
+  hashKey (std::uint64_t key)
+  {
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    return (key ^ (key >> 31));
+  }
+
+  inline std::uint64_t
+  pairKey (pcl::index_t p, pcl::index_t q)
+  {
+    return ((static_cast<std::uint64_t> (static_cast<std::uint32_t> (p)) << 32) |
+            static_cast<std::uint32_t> (q));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::FeatureCacheSource::matches (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+                                  const std::vector<double> &parameters) const
+{
+  return (surface && normals && surface_.lock () == surface && normals_.lock () == normals &&
+          parameters_ == parameters);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::FeatureCacheSource::assign (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+                                 const std::vector<double> &parameters)
+{
+  surface_ = surface;
+  normals_ = normals;
+  parameters_ = parameters;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::PairFeatureCache::PairFeatureCache (std::size_t capacity)
+{
+  setCapacity (capacity);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PairFeatureCache::setCapacity (std::size_t capacity)
+{
+  std::size_t new_capacity = 1;
+  while (new_capacity < capacity)
+    new_capacity <<= 1;
+  if (new_capacity == capacity_)
+    return;
+
+  capacity_ = new_capacity;
+  // The slots are only allocated when the cache is used
+  slots_.clear ();
+  slots_.shrink_to_fit ();
+  source_ = FeatureCacheSource ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PairFeatureCache::allocate (std::size_t nr_slots)
+{
+  // Value initialization sets all states to SLOT_EMPTY
+  std::vector<Slot> (nr_slots).swap (slots_);
+  generation_ = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PairFeatureCache::bind (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+                             std::size_t nr_pairs)
+{
+  // Twice as many slots as pairs keep the probe sequences short
+  std::size_t nr_slots = 1;
+  while (nr_slots < capacity_ && nr_slots / 2 < nr_pairs)
+    nr_slots <<= 1;
+
+  if (source_.matches (surface, normals, {}) && !slots_.empty ())
+  {
+    if (nr_slots > slots_.size ())
+    {
+      // Move the pairs of the current generation to the larger table
+      std::vector<Slot> old_slots (nr_slots);
+      old_slots.swap (slots_);
+      const std::uint32_t ready = makeState (generation_, SLOT_READY);
+      generation_ = 1;
+      for (const auto &slot : old_slots)
+        if (slot.state.load (std::memory_order_relaxed) == ready)
+          insertKey (slot.key, slot.features);
+    }
+    return (false);
+  }
+
+  if (nr_slots != slots_.size ())
+    allocate (nr_slots);
+  else
+    clear ();
+  source_.assign (surface, normals, {});
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PairFeatureCache::clear ()
+{
+  // Starting a new generation empties all slots at once
+  if (++generation_ > max_generation)
+  {
+    for (auto &slot : slots_)
+      slot.state.store (makeState (0, SLOT_EMPTY), std::memory_order_relaxed);
+    generation_ = 1;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PairFeatureCache::find (pcl::index_t p, pcl::index_t q, Eigen::Vector4f &features) const
+{
+  if (slots_.empty ())
+    return (false);
+
+  const std::uint64_t key = pairKey (p, q);
+  const std::size_t mask = slots_.size () - 1;
+  const std::uint32_t ready = makeState (generation_, SLOT_READY);
+  std::size_t pos = hashKey (key) & mask;
+  for (std::size_t probe = 0; probe < max_probes; ++probe, pos = (pos + 1) & mask)
+  {
+    const Slot &slot = slots_[pos];
+    const std::uint32_t state = slot.state.load (std::memory_order_acquire);
+    // Slots are filled in probing order, so the pair can not be stored after an empty slot
+    if ((state >> 2) != generation_)
+      return (false);
+    if (state == ready && slot.key == key)
+    {
+      features = Eigen::Vector4f::Map (slot.features);
+      return (true);
+    }
+  }
+  return (false);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PairFeatureCache::insert (pcl::index_t p, pcl::index_t q, const Eigen::Vector4f &features)
+{
+  if (slots_.empty ())
+    return (false);
+
+  return (insertKey (pairKey (p, q), features.data ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PairFeatureCache::insertKey (std::uint64_t key, const float *features)
+{
+  const std::size_t mask = slots_.size () - 1;
+  const std::uint32_t ready = makeState (generation_, SLOT_READY);
+  const std::uint32_t busy = makeState (generation_, SLOT_BUSY);
+  std::size_t pos = hashKey (key) & mask;
+  for (std::size_t probe = 0; probe < max_probes; ++probe, pos = (pos + 1) & mask)
+  {
+    Slot &slot = slots_[pos];
+    std::uint32_t state = slot.state.load (std::memory_order_acquire);
+    // Claim an empty slot, i.e. one of an older generation
+    while ((state >> 2) != generation_)
+    {
+      if (slot.state.compare_exchange_weak (state, busy, std::memory_order_acquire, std::memory_order_acquire))
+      {
+        slot.key = key;
+        std::copy_n (features, 4, slot.features);
+        slot.state.store (ready, std::memory_order_release);
+        return (true);
+      }
+    }
+    // A slot that is being written by another thread might hold the same pair, which only costs memory
+    if (state == ready && slot.key == key)
+      return (false);
+  }
+  return (false);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::SPFHCache::bind (const shared_ptr<const void> &surface, const shared_ptr<const void> &normals,
+                      std::size_t nr_points, std::size_t nr_values, const std::vector<double> &parameters)
+{
+  if (states_.size () == nr_points && nr_values_ == nr_values && source_.matches (surface, normals, parameters))
+    return (false);
+
+  if (states_.size () != nr_points)
+  {
+    std::vector<std::atomic<std::uint32_t> > (nr_points).swap (states_);
+    generation_ = 1;
+  }
+  else
+    clear ();
+  nr_values_ = nr_values;
+  values_.resize (nr_points * nr_values);
+  source_.assign (surface, normals, parameters);
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::SPFHCache::clear ()
+{
+  // Starting a new generation empties all rows at once
+  if (++generation_ > max_generation)
+  {
+    for (auto &state : states_)
+      state.store (makeState (0, SLOT_EMPTY), std::memory_order_relaxed);
+    generation_ = 1;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+const float*
+pcl::SPFHCache::find (pcl::index_t index) const
+{
+  if (index < 0 || static_cast<std::size_t> (index) >= states_.size () ||
+      states_[index].load (std::memory_order_acquire) != makeState (generation_, SLOT_READY))
+    return (nullptr);
+  return (values_.data () + index * nr_values_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::SPFHCache::insert (pcl::index_t index, const float *values)
+{
+  if (index < 0 || static_cast<std::size_t> (index) >= states_.size ())
+    return (false);
+
+  std::uint32_t state = states_[index].load (std::memory_order_acquire);
+  while ((state >> 2) != generation_)
+  {
+    if (states_[index].compare_exchange_weak (state, makeState (generation_, SLOT_BUSY),
+                                              std::memory_order_acquire, std::memory_order_acquire))
+    {
+      std::copy_n (values, nr_values_, values_.begin () + index * nr_values_);
+      states_[index].store (makeState (generation_, SLOT_READY), std::memory_order_release);
+      return (true);
+    }
+  }
+  return (false);
+}
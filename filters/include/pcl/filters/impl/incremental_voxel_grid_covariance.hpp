@@ -0,0 +1,353 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_INCREMENTAL_VOXEL_GRID_COVARIANCE_IMPL_H_
+#define PCL_INCREMENTAL_VOXEL_GRID_COVARIANCE_IMPL_H_
+
+#include <pcl/common/point_tests.h> // for isXYZFinite
+#include <pcl/filters/incremental_voxel_grid_covariance.h>
+#include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
+
+#include <cmath>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::setResolution (float resolution)
+{
+  if (!(resolution > 0.0f))
+  {
+    PCL_ERROR ("[pcl::IncrementalVoxelGridCovariance::setResolution] Invalid resolution %g, must be positive!\n", resolution);
+    return;
+  }
+  if (resolution_ != resolution)
+    clear ();
+  resolution_ = resolution;
+  inverse_resolution_ = 1.0f / resolution;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::setMinPointPerVoxel (int min_points_per_voxel)
+{
+  if (min_points_per_voxel > 2)
+  {
+    min_points_per_voxel_ = min_points_per_voxel;
+  }
+  else
+  {
+    PCL_WARN ("[pcl::IncrementalVoxelGridCovariance::setMinPointPerVoxel] Covariance calculation requires at least 3 points, setting Min Point per Voxel to 3\n");
+    min_points_per_voxel_ = 3;
+  }
+  for (auto &voxel : voxels_)
+    updateLeaf (voxel.second);
+  ++revision_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::setCovEigValueInflationRatio (double min_covar_eigvalue_mult)
+{
+  min_covar_eigvalue_mult_ = min_covar_eigvalue_mult;
+  for (auto &voxel : voxels_)
+    updateLeaf (voxel.second);
+  ++revision_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> typename pcl::IncrementalVoxelGridCovariance<PointT>::Voxel*
+pcl::IncrementalVoxelGridCovariance<PointT>::accumulate (const PointT &point)
+{
+  if (!isXYZFinite (point))
+    return (nullptr);
+
+  const Eigen::Vector3i coordinates = getVoxelCoordinates (point);
+  Voxel &voxel = voxels_[coordinates];
+  if (voxel.nr_points == 0)
+    voxel.coordinates = coordinates;
+
+  const Eigen::Vector3d pt3d = point.getVector3fMap ().template cast<double> ();
+  ++voxel.nr_points;
+  voxel.sum += pt3d;
+  voxel.sum_sq += pt3d * pt3d.transpose ();
+  ++nr_points_;
+  ++revision_;
+  return (&voxel);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> typename pcl::IncrementalVoxelGridCovariance<PointT>::Voxel*
+pcl::IncrementalVoxelGridCovariance<PointT>::subtract (const PointT &point)
+{
+  if (!isXYZFinite (point))
+    return (nullptr);
+
+  const auto voxel_iter = voxels_.find (getVoxelCoordinates (point));
+  if (voxel_iter == voxels_.end ())
+    return (nullptr);
+
+  Voxel &voxel = voxel_iter->second;
+  const Eigen::Vector3d pt3d = point.getVector3fMap ().template cast<double> ();
+  --voxel.nr_points;
+  voxel.sum -= pt3d;
+  voxel.sum_sq -= pt3d * pt3d.transpose ();
+  --nr_points_;
+  ++revision_;
+  return (&voxel);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::insert (const PointT &point)
+{
+  Voxel *voxel = accumulate (point);
+  if (voxel)
+    updateLeaf (*voxel);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::insert (const PointCloud &cloud)
+{
+  // Accumulate all points first, so that every modified voxel is only updated once
+  std::vector<Voxel*> modified;
+  for (const auto &point : cloud)
+  {
+    Voxel *voxel = accumulate (point);
+    if (voxel && !voxel->modified)
+    {
+      voxel->modified = true;
+      modified.push_back (voxel);
+    }
+  }
+  // The pointers remain valid, elements of an unordered_map never move
+  for (Voxel *voxel : modified)
+  {
+    voxel->modified = false;
+    updateLeaf (*voxel);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::remove (const PointT &point)
+{
+  Voxel *voxel = subtract (point);
+  if (!voxel)
+    return;
+  if (voxel->nr_points <= 0)
+    voxels_.erase (voxel->coordinates);
+  else
+    updateLeaf (*voxel);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::remove (const PointCloud &cloud)
+{
+  std::vector<Eigen::Vector3i> modified;
+  for (const auto &point : cloud)
+  {
+    Voxel *voxel = subtract (point);
+    if (voxel && !voxel->modified)
+    {
+      voxel->modified = true;
+      modified.push_back (voxel->coordinates);
+    }
+  }
+  for (const auto &coordinates : modified)
+  {
+    const auto voxel_iter = voxels_.find (coordinates);
+    voxel_iter->second.modified = false;
+    if (voxel_iter->second.nr_points <= 0)
+      voxels_.erase (voxel_iter);
+    else
+      updateLeaf (voxel_iter->second);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> std::size_t
+pcl::IncrementalVoxelGridCovariance<PointT>::removeVoxelsOutside (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt)
+{
+  const std::size_t nr_voxels = voxels_.size ();
+  for (auto voxel_iter = voxels_.begin (); voxel_iter != voxels_.end (); )
+  {
+    const Eigen::Array3f center = (voxel_iter->second.coordinates.template cast<float> ().array () + 0.5f) * resolution_;
+    if ((center < min_pt.array ()).any () || (center > max_pt.array ()).any ())
+    {
+      nr_points_ -= voxel_iter->second.nr_points;
+      ++revision_;
+      voxel_iter = voxels_.erase (voxel_iter);
+    }
+    else
+      ++voxel_iter;
+  }
+  return (nr_voxels - voxels_.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::IncrementalVoxelGridCovariance<PointT>::updateLeaf (Voxel &voxel) const
+{
+  Leaf &leaf = voxel.leaf;
+  leaf.nr_points = voxel.nr_points;
+  leaf.mean_ = voxel.sum / voxel.nr_points;
+  leaf.centroid.resize (4);
+  leaf.centroid << leaf.mean_.template cast<float> (), 0.0f;
+  voxel.valid = false;
+
+  // Voxels with less than the minimum points can not be accurately approximated using a normal distribution.
+  if (voxel.nr_points < min_points_per_voxel_)
+    return;
+
+  // Single pass covariance calculation
+  leaf.cov_ = (voxel.sum_sq - voxel.sum * leaf.mean_.transpose ()) / (voxel.nr_points - 1.0);
+
+  //Normalize Eigen Val such that max no more than 100x min.
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver (leaf.cov_);
+  Eigen::Matrix3d eigen_val = eigensolver.eigenvalues ().asDiagonal ();
+  leaf.evecs_ = eigensolver.eigenvectors ();
+
+  if (eigen_val (0, 0) < -Eigen::NumTraits<double>::dummy_precision () || eigen_val (1, 1) < -Eigen::NumTraits<double>::dummy_precision () || eigen_val (2, 2) <= 0)
+    return;
+
+  // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
+  const double min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val (2, 2);
+  if (eigen_val (0, 0) < min_covar_eigvalue)
+  {
+    eigen_val (0, 0) = min_covar_eigvalue;
+
+    if (eigen_val (1, 1) < min_covar_eigvalue)
+    {
+      eigen_val (1, 1) = min_covar_eigvalue;
+    }
+
+    leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse ();
+  }
+  leaf.evals_ = eigen_val.diagonal ();
+
+  leaf.icov_ = leaf.cov_.inverse ();
+  if (leaf.icov_.maxCoeff () == std::numeric_limits<float>::infinity ( )
+      || leaf.icov_.minCoeff () == -std::numeric_limits<float>::infinity ( ) )
+    return;
+
+  voxel.valid = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> typename pcl::IncrementalVoxelGridCovariance<PointT>::PointCloudPtr
+pcl::IncrementalVoxelGridCovariance<PointT>::getCentroids () const
+{
+  PointCloudPtr centroids (new PointCloud);
+  centroids->reserve (voxels_.size ());
+  for (const auto &voxel : voxels_)
+  {
+    if (!voxel.second.valid)
+      continue;
+    PointT centroid;
+    centroid.getVector3fMap () = voxel.second.leaf.mean_.template cast<float> ();
+    centroids->push_back (centroid);
+  }
+  return (centroids);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> typename pcl::IncrementalVoxelGridCovariance<PointT>::LeafConstPtr
+pcl::IncrementalVoxelGridCovariance<PointT>::getLeaf (const PointT &point) const
+{
+  const auto voxel_iter = voxels_.find (getVoxelCoordinates (point));
+  if (voxel_iter == voxels_.end () || !voxel_iter->second.valid)
+    return (nullptr);
+  return (&voxel_iter->second.leaf);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::IncrementalVoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const Eigen::Matrix<int, 3, Eigen::Dynamic> &relative_coordinates,
+                                                                     const PointT &reference_point, std::vector<LeafConstPtr> &neighbors) const
+{
+  neighbors.clear ();
+  const Eigen::Vector3i coordinates = getVoxelCoordinates (reference_point);
+  for (Eigen::Index ni = 0; ni < relative_coordinates.cols (); ni++)
+  {
+    const auto voxel_iter = voxels_.find (Eigen::Vector3i (coordinates + relative_coordinates.col (ni)));
+    if (voxel_iter != voxels_.end () && voxel_iter->second.valid)
+      neighbors.push_back (&voxel_iter->second.leaf);
+  }
+  return (static_cast<int> (neighbors.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::IncrementalVoxelGridCovariance<PointT>::radiusSearch (const PointT &point, double radius, std::vector<LeafConstPtr> &k_leaves,
+                                                           std::vector<float> &k_sqr_distances, unsigned int max_nn) const
+{
+  k_leaves.clear ();
+  k_sqr_distances.clear ();
+
+  // A centroid lies inside its voxel, so all centroids within the radius are in voxels at
+  // most ceil (radius / resolution) voxels away from the one containing the point
+  const int reach = static_cast<int> (std::ceil (radius * inverse_resolution_));
+  const Eigen::Vector3i coordinates = getVoxelCoordinates (point);
+  const Eigen::Vector3d query = point.getVector3fMap ().template cast<double> ();
+  const double sqr_radius = radius * radius;
+  for (int i = -reach; i <= reach; ++i)
+  {
+    for (int j = -reach; j <= reach; ++j)
+    {
+      for (int k = -reach; k <= reach; ++k)
+      {
+        const auto voxel_iter = voxels_.find (Eigen::Vector3i (coordinates + Eigen::Vector3i (i, j, k)));
+        if (voxel_iter == voxels_.end () || !voxel_iter->second.valid)
+          continue;
+        const double sqr_distance = (voxel_iter->second.leaf.mean_ - query).squaredNorm ();
+        if (sqr_distance > sqr_radius)
+          continue;
+        k_leaves.push_back (&voxel_iter->second.leaf);
+        k_sqr_distances.push_back (static_cast<float> (sqr_distance));
+        if (max_nn > 0 && k_leaves.size () == max_nn)
+          return (static_cast<int> (k_leaves.size ()));
+      }
+    }
+  }
+  return (static_cast<int> (k_leaves.size ()));
+}
+
+#define PCL_INSTANTIATE_IncrementalVoxelGridCovariance(T) template class PCL_EXPORTS pcl::IncrementalVoxelGridCovariance<T>;
+
+#endif    // PCL_INCREMENTAL_VOXEL_GRID_COVARIANCE_IMPL_H_
@@ -44,6 +44,29 @@
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 #include <pcl/search/kdtree.h> // for KdTree
 
+#include <algorithm> // for std::max
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemoval<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::RadiusOutlierRemoval::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::RadiusOutlierRemoval::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
@@ -72,12 +95,9 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
     return;
   }
 
-  // The arrays to be used
-  Indices nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
-  indices.resize (indices_->size ());
-  removed_indices_->resize (indices_->size ());
-  int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
+  // Classify the points first, possibly in parallel, then collect them in their input order
+  const auto nr_points = static_cast<std::ptrdiff_t> (indices_->size ());
+  std::vector<unsigned char> inliers (indices_->size (), 0);
 
   // If the data is dense => use nearest-k search
   if (input_->is_dense)
@@ -86,72 +106,85 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
     int mean_k = min_pts_radius_ + 1;
     double nn_dists_max = search_radius_ * search_radius_;
 
-    for (const auto& index : (*indices_))
+#pragma omp parallel num_threads(threads_)
     {
-      // Perform the nearest-k search
-      int k = searcher_->nearestKSearch (index, mean_k, nn_indices, nn_dists);
-
-      // Check the number of neighbors
-      // Note: nn_dists is sorted, so check the last item
-      bool chk_neighbors = true;
-      if (k == mean_k)
+      Indices nn_indices (mean_k);
+      std::vector<float> nn_dists (mean_k);
+#pragma omp for schedule(dynamic, 256)
+      for (std::ptrdiff_t iii = 0; iii < nr_points; ++iii)  // iii = input indices iterator
       {
-        if (negative_)
+        // Perform the nearest-k search
+        int k = searcher_->nearestKSearch ((*indices_)[iii], mean_k, nn_indices, nn_dists);
+
+        // Check the number of neighbors
+        // Note: nn_dists is sorted, so check the last item
+        bool chk_neighbors = true;
+        if (k == mean_k)
         {
-          chk_neighbors = false;
-          if (nn_dists_max < nn_dists[k-1])
+          if (negative_)
+          {
+            chk_neighbors = false;
+            if (nn_dists_max < nn_dists[k-1])
+            {
+              chk_neighbors = true;
+            }
+          }
+          else
           {
             chk_neighbors = true;
+            if (nn_dists_max < nn_dists[k-1])
+            {
+              chk_neighbors = false;
+            }
           }
         }
         else
         {
-          chk_neighbors = true;
-          if (nn_dists_max < nn_dists[k-1])
-          {
-            chk_neighbors = false;
-          }
+          chk_neighbors = negative_;
         }
+        inliers[iii] = chk_neighbors;
       }
-      else
-      {
-        chk_neighbors = negative_;
-      }
-
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if (!chk_neighbors)
-      {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = index;
-        continue;
-      }
-
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = index;
     }
   }
   // NaN or Inf values could exist => use radius search
   else
   {
-    for (const auto& index : (*indices_))
-    {
-      // Perform the radius search
-      // Note: k includes the query point, so is always at least 1
-      int k = searcher_->radiusSearch (index, search_radius_, nn_indices, nn_dists);
+    // Only whether there are more than min_pts_radius_ neighbors matters, so the search can stop
+    // after min_pts_radius_ + 1 of them (k includes the query point, so is always at least 1)
+    const auto max_nn = static_cast<unsigned int> (std::max (min_pts_radius_, 0) + 1);
 
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if ((!negative_ && k <= min_pts_radius_) || (negative_ && k > min_pts_radius_))
+#pragma omp parallel num_threads(threads_)
+    {
+      Indices nn_indices;
+      std::vector<float> nn_dists;
+#pragma omp for schedule(dynamic, 256)
+      for (std::ptrdiff_t iii = 0; iii < nr_points; ++iii)  // iii = input indices iterator
       {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = index;
-        continue;
+        // Perform the radius search
+        int k = searcher_->radiusSearch ((*indices_)[iii], search_radius_, nn_indices, nn_dists, max_nn);
+
+        // Points having too few neighbors are outliers
+        // Unless negative was set, then it's the opposite condition
+        inliers[iii] = !((!negative_ && k <= min_pts_radius_) || (negative_ && k > min_pts_radius_));
       }
+    }
+  }
 
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = index;
+  indices.resize (indices_->size ());
+  removed_indices_->resize (indices_->size ());
+  int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
+  for (std::ptrdiff_t iii = 0; iii < nr_points; ++iii)
+  {
+    // Points having too few neighbors are passed to removed indices
+    if (!inliers[iii])
+    {
+      if (extract_removed_indices_)
+        (*removed_indices_)[rii++] = (*indices_)[iii];
+      continue;
     }
+
+    // Otherwise it was a normal point for output (inlier)
+    indices[oii++] = (*indices_)[iii];
   }
 
   // Resize the output arrays
@@ -44,6 +44,27 @@
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 #include <pcl/search/kdtree.h> // for KdTree
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalOutlierRemoval<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::StatisticalOutlierRemoval::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::StatisticalOutlierRemoval::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
@@ -66,8 +87,6 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
 
   // The arrays to be used
   const int searcher_k = mean_k_ + 1;  // Find one more, since results include the query point.
-  Indices nn_indices (searcher_k);
-  std::vector<float> nn_dists (searcher_k);
   std::vector<float> distances (indices_->size ());
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
@@ -75,30 +94,36 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
 
   // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
   int valid_distances = 0;
-  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+#pragma omp parallel num_threads(threads_) reduction(+:valid_distances)
   {
-    if (!std::isfinite ((*input_)[(*indices_)[iii]].x) ||
-        !std::isfinite ((*input_)[(*indices_)[iii]].y) ||
-        !std::isfinite ((*input_)[(*indices_)[iii]].z))
+    Indices nn_indices (searcher_k);
+    std::vector<float> nn_dists (searcher_k);
+#pragma omp for schedule(dynamic, 256)
+    for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
     {
-      distances[iii] = 0.0;
-      continue;
-    }
+      if (!std::isfinite ((*input_)[(*indices_)[iii]].x) ||
+          !std::isfinite ((*input_)[(*indices_)[iii]].y) ||
+          !std::isfinite ((*input_)[(*indices_)[iii]].z))
+      {
+        distances[iii] = 0.0;
+        continue;
+      }
 
-    // Perform the nearest k search
-    if (searcher_->nearestKSearch ((*indices_)[iii], searcher_k, nn_indices, nn_dists) == 0)
-    {
-      distances[iii] = 0.0;
-      PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
-      continue;
-    }
+      // Perform the nearest k search
+      if (searcher_->nearestKSearch ((*indices_)[iii], searcher_k, nn_indices, nn_dists) == 0)
+      {
+        distances[iii] = 0.0;
+        PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
+        continue;
+      }
 
-    // Calculate the mean distance to its neighbors
-    double dist_sum = 0.0;
-    for (int k = 1; k < searcher_k; ++k)  // k = 0 is the query point
-      dist_sum += sqrt (nn_dists[k]);
-    distances[iii] = static_cast<float> (dist_sum / mean_k_);
-    valid_distances++;
+      // Calculate the mean distance to its neighbors
+      double dist_sum = 0.0;
+      for (int k = 1; k < searcher_k; ++k)  // k = 0 is the query point
+        dist_sum += sqrt (nn_dists[k]);
+      distances[iii] = static_cast<float> (dist_sum / mean_k_);
+      valid_distances++;
+    }
   }
 
   // Estimate the mean and the standard deviation of the distance vector
@@ -0,0 +1,207 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_STREAMING_VOXEL_GRID_H_
+#define PCL_FILTERS_IMPL_STREAMING_VOXEL_GRID_H_
+
+#include <limits>
+
+#include <pcl/common/point_tests.h> // for isXYZFinite
+#include <pcl/console/print.h> // for PCL_WARN
+#include <pcl/filters/streaming_voxel_grid.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::setLeafSize (float lx, float ly, float lz)
+{
+  if (!(lx > 0.0f) || !(ly > 0.0f) || !(lz > 0.0f))
+  {
+    PCL_ERROR ("[pcl::%s::setLeafSize] Invalid leaf size (%g, %g, %g), must be positive!\n", getClassName ().c_str (), lx, ly, lz);
+    return;
+  }
+  const Eigen::Vector3f leaf_size (lx, ly, lz);
+  if (leaf_size != leaf_size_)
+    clear ();
+  leaf_size_ = leaf_size;
+  inverse_leaf_size_ = Eigen::Array3f::Ones () / leaf_size_.array ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::setDownsampleAllData (bool downsample)
+{
+  if (downsample != downsample_all_data_)
+    clear ();
+  downsample_all_data_ = downsample;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::addPoint (const PointT &point)
+{
+  if (!isXYZFinite (point))
+    return;
+
+  // Casting a value that does not fit in an int is undefined, so check the range first
+  const Eigen::Array3f scaled = Eigen::floor (point.getArray3fMap () * inverse_leaf_size_);
+  if (!(scaled >= static_cast<float> (std::numeric_limits<int>::min ())).all () ||
+      !(scaled < -static_cast<float> (std::numeric_limits<int>::min ())).all ())
+  {
+    // Reported once per cloud or flush, as a stream can hold many such points
+    ++nr_ignored_points_;
+    return;
+  }
+
+  const Eigen::Vector3i coordinates = scaled.template cast<int> ();
+  Voxel &voxel = voxels_[coordinates];
+  ++voxel.nr_points;
+  voxel.sum += point.getVector3fMap ().template cast<double> ();
+  if (downsample_all_data_)
+    voxel.centroid.add (point);
+  ++nr_points_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::addPointCloud (const PointCloud &cloud)
+{
+  for (const auto &point : cloud)
+    addPoint (point);
+  warnIgnoredPoints ("addPointCloud");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::addPointCloud (const PointCloud &cloud, const Indices &indices)
+{
+  for (const auto &index : indices)
+    addPoint (cloud[index]);
+  warnIgnoredPoints ("addPointCloud");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::warnIgnoredPoints (const char *method)
+{
+  if (nr_ignored_points_ == nr_reported_ignored_points_)
+    return;
+  PCL_WARN ("[pcl::%s::%s] Leaf size is too small for %zu points. Integer indices would overflow, ignoring them.\n",
+            getClassName ().c_str (), method, nr_ignored_points_ - nr_reported_ignored_points_);
+  nr_reported_ignored_points_ = nr_ignored_points_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::getCentroid (const Voxel &voxel, PointT &point) const
+{
+  if (downsample_all_data_)
+    voxel.centroid.get (point);
+  // The coordinates are taken from the double precision sums in both cases
+  point.getVector3fMap () = (voxel.sum / static_cast<double> (voxel.nr_points)).template cast<float> ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::getCentroids (PointCloud &output) const
+{
+  output.clear ();
+  output.reserve (voxels_.size ());
+  for (const auto &voxel : voxels_)
+  {
+    if (voxel.second.nr_points < min_points_per_voxel_)
+      continue;
+    output.emplace_back ();
+    getCentroid (voxel.second, output.back ());
+  }
+  output.height = 1;
+  output.width = output.size ();
+  output.is_dense = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::StreamingVoxelGrid<PointT>::flush (PointCloud &output)
+{
+  warnIgnoredPoints ("flush");
+  getCentroids (output);
+  clear ();
+  return (output.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::StreamingVoxelGrid<PointT>::flushVoxelsOutside (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt,
+                                                     PointCloud &output)
+{
+  warnIgnoredPoints ("flushVoxelsOutside");
+  output.clear ();
+  for (auto voxel_iter = voxels_.begin (); voxel_iter != voxels_.end (); )
+  {
+    const Eigen::Array3f center = (voxel_iter->first.template cast<float> ().array () + 0.5f) * leaf_size_.array ();
+    if ((center >= min_pt.array ()).all () && (center <= max_pt.array ()).all ())
+    {
+      ++voxel_iter;
+      continue;
+    }
+
+    const Voxel &voxel = voxel_iter->second;
+    if (voxel.nr_points >= min_points_per_voxel_)
+    {
+      output.emplace_back ();
+      getCentroid (voxel, output.back ());
+    }
+    nr_points_ -= voxel.nr_points;
+    voxel_iter = voxels_.erase (voxel_iter);
+  }
+  output.height = 1;
+  output.width = output.size ();
+  output.is_dense = true;
+  return (output.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StreamingVoxelGrid<PointT>::applyFilter (PointCloud &output)
+{
+  clear ();
+  addPointCloud (*input_, *indices_);
+  flush (output);
+}
+
+#define PCL_INSTANTIATE_StreamingVoxelGrid(T) template class PCL_EXPORTS pcl::StreamingVoxelGrid<T>;
+
+#endif    // PCL_FILTERS_IMPL_STREAMING_VOXEL_GRID_H_
@@ -38,6 +38,8 @@
 #ifndef PCL_FILTERS_IMPL_VOXEL_GRID_H_
 #define PCL_FILTERS_IMPL_VOXEL_GRID_H_
 
+#include <algorithm>
+#include <array>
 #include <limits>
 
 #include <pcl/common/centroid.h>
@@ -46,6 +48,10 @@
 #include <pcl/filters/voxel_grid.h>
 #include  <boost/sort/spreadsort/integer_sort.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
@@ -221,6 +227,121 @@ struct cloud_point_index_idx
   bool operator < (const cloud_point_index_idx &p) const { return (idx < p.idx); }
 };
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief A point and the 64 bit index of its voxel. */
+    struct VoxelPointIndex
+    {
+      std::uint64_t idx;
+      unsigned int cloud_point_index;
+    };
+
+    /** \brief Sort points by voxel index with a stable LSD radix sort, 8 bits per pass.
+      * Only the passes needed for \a max_idx are run. The points are split into consecutive chunks,
+      * which are counted and scattered in parallel, so the result does not depend on the number of threads.
+      * \param[in,out] index_vector the points to sort
+      * \param[in] max_idx the largest voxel index
+      * \param[in] nr_threads the number of threads to use
+      */
+    inline void
+    radixSortVoxelIndices (std::vector<VoxelPointIndex> &index_vector, std::uint64_t max_idx, unsigned int nr_threads)
+    {
+      constexpr unsigned int radix_bits = 8;
+      constexpr std::size_t radix_size = std::size_t {1} << radix_bits;
+      const std::size_t size = index_vector.size ();
+      // Chunks of less than 64k points are not worth a thread
+      const auto nr_chunks = static_cast<std::ptrdiff_t> (std::max<std::size_t> (1, std::min<std::size_t> (nr_threads, size / 65536)));
+      const std::size_t chunk_size = (size + nr_chunks - 1) / nr_chunks;
+
+      std::vector<VoxelPointIndex> buffer (size);
+      std::vector<std::array<std::size_t, radix_size> > positions (nr_chunks);
+      for (unsigned int shift = 0; shift < 64 && (max_idx >> shift) != 0; shift += radix_bits)
+      {
+        // Count the digits in every chunk
+#pragma omp parallel for schedule(static, 1) num_threads(nr_chunks)
+        for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
+        {
+          auto &count = positions[chunk];
+          count.fill (0);
+          const std::size_t last = std::min (size, (chunk + 1) * chunk_size);
+          for (std::size_t i = chunk * chunk_size; i < last; ++i)
+            ++count[(index_vector[i].idx >> shift) & (radix_size - 1)];
+        }
+
+        // Turn the counts into the position of the first point of every digit in every chunk
+        std::size_t position = 0;
+        bool single_digit = false;
+        for (std::size_t digit = 0; digit < radix_size; ++digit)
+        {
+          const std::size_t first = position;
+          for (auto &count : positions)
+          {
+            const std::size_t nr_digits = count[digit];
+            count[digit] = position;
+            position += nr_digits;
+          }
+          single_digit = single_digit || (position - first == size);
+        }
+        // All points have the same digit, they are already in order
+        if (single_digit)
+          continue;
+
+        // Move the points to their positions, keeping the order of the chunks and within them
+#pragma omp parallel for schedule(static, 1) num_threads(nr_chunks)
+        for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
+        {
+          auto &position = positions[chunk];
+          const std::size_t last = std::min (size, (chunk + 1) * chunk_size);
+          for (std::size_t i = chunk * chunk_size; i < last; ++i)
+            buffer[position[(index_vector[i].idx >> shift) & (radix_size - 1)]++] = index_vector[i];
+        }
+        index_vector.swap (buffer);
+      }
+    }
+
+    /** \brief Find the ranges of sorted points that share a voxel and have at least \a min_points_per_voxel points.
+      * \param[in] index_vector the points, sorted by voxel index
+      * \param[in] min_points_per_voxel the minimum number of points for a voxel to be used
+      * \param[out] first_and_last_indices_vector the index of the first point of every voxel, and of the first point not belonging to it
+      */
+    inline void
+    getVoxelRanges (const std::vector<VoxelPointIndex> &index_vector, unsigned int min_points_per_voxel,
+                    std::vector<std::pair<std::size_t, std::size_t> > &first_and_last_indices_vector)
+    {
+      first_and_last_indices_vector.clear ();
+      std::size_t index = 0;
+      while (index < index_vector.size ())
+      {
+        std::size_t i = index + 1;
+        while (i < index_vector.size () && index_vector[i].idx == index_vector[index].idx)
+          ++i;
+        if (i - index >= min_points_per_voxel)
+          first_and_last_indices_vector.emplace_back (index, i);
+        index = i;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGrid<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::VoxelGrid::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::VoxelGrid::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
@@ -250,7 +371,12 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1])+1;
   std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2])+1;
 
-  if ((dx*dy*dz) > static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::max()))
+  // Voxel indices that do not fit in 32 bits are handled with 64 bit indices, but not in the leaf layout
+  const double nr_voxels = static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz);
+  const bool wide_indices = nr_voxels > static_cast<double> (std::numeric_limits<std::int32_t>::max ());
+  if (wide_indices && (save_leaf_layout_ ||
+                       nr_voxels > static_cast<double> (std::numeric_limits<std::int64_t>::max ()) ||
+                       std::max ({dx, dy, dz}) > static_cast<std::int64_t> (std::numeric_limits<std::int32_t>::max ())))
   {
     PCL_WARN("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName().c_str());
     output = *input_;
@@ -269,8 +395,14 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
   div_b_[3] = 0;
 
-  // Set up the division multiplier
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  // Set up the division multiplier (the last one wraps around for wide indices, which are not stored in the leaf layout)
+  divb_mul_ = Eigen::Vector4i (1, div_b_[0], static_cast<int> (static_cast<std::int64_t> (div_b_[0]) * div_b_[1]), 0);
+
+  if (threads_ != 1 || wide_indices)
+  {
+    applyParallelFilter (output);
+    return;
+  }
 
   // Storage for mapping leaf and pointcloud indexes
   std::vector<cloud_point_index_idx> index_vector;
@@ -316,9 +448,9 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
           continue;
       }
       
-      int ijk0 = static_cast<int> (std::floor ((*input_)[index].x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
-      int ijk1 = static_cast<int> (std::floor ((*input_)[index].y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
-      int ijk2 = static_cast<int> (std::floor ((*input_)[index].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
+      int ijk0 = static_cast<int> (std::floor ((*input_)[index].x * inverse_leaf_size_[0])) - min_b_[0];
+      int ijk1 = static_cast<int> (std::floor ((*input_)[index].y * inverse_leaf_size_[1])) - min_b_[1];
+      int ijk2 = static_cast<int> (std::floor ((*input_)[index].z * inverse_leaf_size_[2])) - min_b_[2];
 
       // Compute the centroid leaf index
       int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
@@ -338,9 +470,9 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
         if (!isXYZFinite ((*input_)[index]))
           continue;
 
-      int ijk0 = static_cast<int> (std::floor ((*input_)[index].x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
-      int ijk1 = static_cast<int> (std::floor ((*input_)[index].y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
-      int ijk2 = static_cast<int> (std::floor ((*input_)[index].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
+      int ijk0 = static_cast<int> (std::floor ((*input_)[index].x * inverse_leaf_size_[0])) - min_b_[0];
+      int ijk1 = static_cast<int> (std::floor ((*input_)[index].y * inverse_leaf_size_[1])) - min_b_[1];
+      int ijk2 = static_cast<int> (std::floor ((*input_)[index].z * inverse_leaf_size_[2])) - min_b_[2];
 
       // Compute the centroid leaf index
       int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
@@ -442,6 +574,126 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   output.width = output.size ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGrid<PointT>::applyParallelFilter (PointCloud &output)
+{
+  const std::uint64_t mul_y = div_b_[0];
+  const std::uint64_t mul_z = static_cast<std::uint64_t> (div_b_[0]) * static_cast<std::uint64_t> (div_b_[1]);
+  const std::uint64_t max_idx = mul_z * static_cast<std::uint64_t> (div_b_[2]) - 1;
+  constexpr std::uint64_t invalid_idx = std::numeric_limits<std::uint64_t>::max ();
+
+  // Get the distance field offset, if we don't want to process the entire cloud
+  std::size_t field_offset = 0;
+  if (!filter_field_name_.empty ())
+  {
+    std::vector<pcl::PCLPointField> fields;
+    int distance_idx = pcl::getFieldIndex<PointT> (filter_field_name_, fields);
+    if (distance_idx == -1) {
+      PCL_ERROR ("[pcl::%s::applyFilter] Invalid filter field name (%s).\n", getClassName ().c_str (), filter_field_name_.c_str());
+      return;
+    }
+    field_offset = fields[distance_idx].offset;
+  }
+
+  // First pass: compute the voxel index of every point, invalid and filtered points are marked and removed
+  const auto nr_points = static_cast<std::ptrdiff_t> (indices_->size ());
+  std::vector<detail::VoxelPointIndex> index_vector (indices_->size ());
+#pragma omp parallel for schedule(static) num_threads(threads_)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+  {
+    const auto index = (*indices_)[i];
+    const PointT &point = (*input_)[index];
+    index_vector[i].cloud_point_index = index;
+    index_vector[i].idx = invalid_idx;
+
+    if (!input_->is_dense && !isXYZFinite (point))
+      continue;
+
+    if (!filter_field_name_.empty ())
+    {
+      float distance_value = 0;
+      memcpy (&distance_value, reinterpret_cast<const std::uint8_t*> (&point) + field_offset, sizeof (float));
+      if (filter_limit_negative_)
+      {
+        if ((distance_value < filter_limit_max_) && (distance_value > filter_limit_min_))
+          continue;
+      }
+      else if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
+        continue;
+    }
+
+    const auto ijk0 = static_cast<std::uint64_t> (static_cast<int> (std::floor (point.x * inverse_leaf_size_[0])) - min_b_[0]);
+    const auto ijk1 = static_cast<std::uint64_t> (static_cast<int> (std::floor (point.y * inverse_leaf_size_[1])) - min_b_[1]);
+    const auto ijk2 = static_cast<std::uint64_t> (static_cast<int> (std::floor (point.z * inverse_leaf_size_[2])) - min_b_[2]);
+    index_vector[i].idx = ijk0 + ijk1 * mul_y + ijk2 * mul_z;
+  }
+  index_vector.erase (std::remove_if (index_vector.begin (), index_vector.end (),
+                                      [] (const detail::VoxelPointIndex &p) { return (p.idx == invalid_idx); }),
+                      index_vector.end ());
+
+  // Second pass: sort the points by voxel index
+  detail::radixSortVoxelIndices (index_vector, max_idx, threads_);
+
+  // Third pass: find the points of every output cell
+  std::vector<std::pair<std::size_t, std::size_t> > first_and_last_indices_vector;
+  detail::getVoxelRanges (index_vector, min_points_per_voxel_, first_and_last_indices_vector);
+
+  // Fourth pass: compute centroids in parallel, each into its final position
+  output.resize (first_and_last_indices_vector.size ());
+  if (save_leaf_layout_)
+  {
+    try
+    {
+      leaf_layout_.assign (static_cast<std::size_t> (max_idx + 1), -1);
+    }
+    catch (std::bad_alloc&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout",
+        "voxel_grid.hpp", "applyFilter");
+    }
+    catch (std::length_error&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout",
+        "voxel_grid.hpp", "applyFilter");
+    }
+  }
+
+  const auto nr_voxels = static_cast<std::ptrdiff_t> (first_and_last_indices_vector.size ());
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(threads_)
+  for (std::ptrdiff_t index = 0; index < nr_voxels; ++index)
+  {
+    const std::size_t first_index = first_and_last_indices_vector[index].first;
+    const std::size_t last_index = first_and_last_indices_vector[index].second;
+
+    if (save_leaf_layout_)
+      leaf_layout_[index_vector[first_index].idx] = static_cast<int> (index);
+
+    //Limit downsampling to coords
+    if (!downsample_all_data_)
+    {
+      Eigen::Vector4f centroid (Eigen::Vector4f::Zero ());
+
+      for (std::size_t li = first_index; li < last_index; ++li)
+        centroid += (*input_)[index_vector[li].cloud_point_index].getVector4fMap ();
+
+      centroid /= static_cast<float> (last_index - first_index);
+      output[index].getVector4fMap () = centroid;
+    }
+    else
+    {
+      CentroidPoint<PointT> centroid;
+
+      // fill in the accumulator with leaf points
+      for (std::size_t li = first_index; li < last_index; ++li)
+        centroid.add ((*input_)[index_vector[li].cloud_point_index]);
+
+      centroid.get (output[index]);
+    }
+  }
+  output.width = output.size ();
+}
+
 #define PCL_INSTANTIATE_VoxelGrid(T) template class PCL_EXPORTS pcl::VoxelGrid<T>;
 #define PCL_INSTANTIATE_getMinMax3D(T) template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool);
 
@@ -39,6 +39,7 @@
 #define PCL_VOXEL_GRID_COVARIANCE_IMPL_H_
 
 #include <pcl/common/common.h>
+#include <pcl/common/eigen.h> // for eigen33
 #include <pcl/common/point_tests.h> // for isXYZFinite
 #include <pcl/filters/voxel_grid_covariance.h>
 #include <Eigen/Cholesky>
@@ -267,13 +268,13 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
   if (save_leaf_layout_)
     leaf_layout_.resize (div_b_[0] * div_b_[1] * div_b_[2], -1);
 
-  // Eigen values and vectors calculated to prevent near singular matrices
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
-  Eigen::Matrix3d eigen_val;
   Eigen::Vector3d pt_sum;
 
-  // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the max eigen value.
-  double min_covar_eigvalue;
+  // Leaves whose covariance matrices need an eigen decomposition, which is done for all of them at once below
+  std::vector<Leaf*> covariance_leaves;
+  std::vector<Eigen::Matrix3f> covariance_matrices;
+  covariance_leaves.reserve (leaves_.size ());
+  covariance_matrices.reserve (leaves_.size ());
 
   for (auto it = leaves_.begin (); it != leaves_.end (); ++it)
   {
@@ -324,46 +325,72 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
 
       // Single pass covariance calculation
       leaf.cov_ = (leaf.cov_ - pt_sum * leaf.mean_.transpose()) / (leaf.nr_points - 1.0);
+      covariance_leaves.push_back (&leaf);
+      if (use_batched_eigen_solver_)
+        covariance_matrices.push_back (leaf.cov_.template cast<float> ());
+    }
+  }
+
+  output.width = output.size ();
+
+  // Eigen values and vectors calculated to prevent near singular matrices, optionally for all leaves in one batch
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
+  std::vector<Eigen::Matrix3f> eigen_vectors;
+  std::vector<Eigen::Vector3f> eigen_values;
+  if (use_batched_eigen_solver_)
+    pcl::eigen33 (covariance_matrices, eigen_vectors, eigen_values);
 
-      //Normalize Eigen Val such that max no more than 100x min.
+  Eigen::Matrix3d eigen_val;
+  // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the max eigen value.
+  double min_covar_eigvalue;
+  for (std::size_t i = 0; i < covariance_leaves.size (); ++i)
+  {
+    Leaf& leaf = *covariance_leaves[i];
+
+    //Normalize Eigen Val such that max no more than 100x min.
+    if (use_batched_eigen_solver_)
+    {
+      leaf.evecs_ = eigen_vectors[i].template cast<double> ();
+      // The Rayleigh quotients of the single precision eigen vectors restore double precision eigen values
+      eigen_val = (leaf.evecs_.transpose () * leaf.cov_ * leaf.evecs_).diagonal ().asDiagonal ();
+    }
+    else
+    {
       eigensolver.compute (leaf.cov_);
       eigen_val = eigensolver.eigenvalues ().asDiagonal ();
       leaf.evecs_ = eigensolver.eigenvectors ();
+    }
 
-      if (eigen_val (0, 0) < -Eigen::NumTraits<double>::dummy_precision () || eigen_val (1, 1) < -Eigen::NumTraits<double>::dummy_precision () || eigen_val (2, 2) <= 0)
-      {
-        PCL_WARN ("[VoxelGridCovariance::applyFilter] Invalid eigen value! (%g, %g, %g)\n", eigen_val (0, 0), eigen_val (1, 1), eigen_val (2, 2));
-        leaf.nr_points = -1;
-        continue;
-      }
-
-      // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
+    if (eigen_val (0, 0) < -Eigen::NumTraits<double>::dummy_precision () || eigen_val (1, 1) < -Eigen::NumTraits<double>::dummy_precision () || eigen_val (2, 2) <= 0)
+    {
+      PCL_WARN ("[VoxelGridCovariance::applyFilter] Invalid eigen value! (%g, %g, %g)\n", eigen_val (0, 0), eigen_val (1, 1), eigen_val (2, 2));
+      leaf.nr_points = -1;
+      continue;
+    }
 
-      min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val (2, 2);
-      if (eigen_val (0, 0) < min_covar_eigvalue)
-      {
-        eigen_val (0, 0) = min_covar_eigvalue;
+    // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
 
-        if (eigen_val (1, 1) < min_covar_eigvalue)
-        {
-          eigen_val (1, 1) = min_covar_eigvalue;
-        }
-
-        leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse ();
-      }
-      leaf.evals_ = eigen_val.diagonal ();
+    min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val (2, 2);
+    if (eigen_val (0, 0) < min_covar_eigvalue)
+    {
+      eigen_val (0, 0) = min_covar_eigvalue;
 
-      leaf.icov_ = leaf.cov_.inverse ();
-      if (leaf.icov_.maxCoeff () == std::numeric_limits<float>::infinity ( )
-          || leaf.icov_.minCoeff () == -std::numeric_limits<float>::infinity ( ) )
+      if (eigen_val (1, 1) < min_covar_eigvalue)
       {
-        leaf.nr_points = -1;
+        eigen_val (1, 1) = min_covar_eigvalue;
       }
 
+      leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse ();
     }
-  }
+    leaf.evals_ = eigen_val.diagonal ();
 
-  output.width = output.size ();
+    leaf.icov_ = leaf.cov_.inverse ();
+    if (leaf.icov_.maxCoeff () == std::numeric_limits<float>::infinity ( )
+        || leaf.icov_.minCoeff () == -std::numeric_limits<float>::infinity ( ) )
+    {
+      leaf.nr_points = -1;
+    }
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
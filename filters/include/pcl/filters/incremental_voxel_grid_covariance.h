@@ -0,0 +1,322 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/filters/voxel_grid_covariance.h>
+
+#include <unordered_map>
+
+namespace pcl
+{
+  /** \brief An updatable voxel structure containing the mean and covariance of the data.
+    *
+    * Unlike \ref VoxelGridCovariance, which is rebuilt from scratch for every input cloud,
+    * this map keeps the sufficient statistics (number of points, sum and sum of outer
+    * products) of every voxel. Points can be inserted and removed, and whole regions can
+    * be evicted, at a cost proportional to the number of points or voxels touched. The
+    * mean, covariance, inverse covariance and eigen decomposition of a modified voxel are
+    * updated right away, with the same eigen value inflation as \ref VoxelGridCovariance.
+    *
+    * The voxels are exposed as \ref VoxelGridCovariance::Leaf structures and can be looked
+    * up directly (\ref getLeaf, \ref getNeighborhoodAtPoint) or within a radius
+    * (\ref radiusSearch), so that NormalDistributionsTransform and
+    * VoxelizedGeneralizedIterativeClosestPoint can register against the map in place of a
+    * target cloud.
+    *
+    * \note Leaf pointers returned by the queries are invalidated by any modification of the
+    * map. Queries may run concurrently, modifications may not.
+    * \ingroup filters
+    */
+  template<typename PointT>
+  class IncrementalVoxelGridCovariance
+  {
+    public:
+      using PointCloud = pcl::PointCloud<PointT>;
+      using PointCloudPtr = typename PointCloud::Ptr;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+      using Ptr = shared_ptr<IncrementalVoxelGridCovariance<PointT> >;
+      using ConstPtr = shared_ptr<const IncrementalVoxelGridCovariance<PointT> >;
+
+      /** \brief Distribution of the points of one voxel. */
+      using Leaf = typename VoxelGridCovariance<PointT>::Leaf;
+
+      /** \brief Const pointer to a voxel distribution. */
+      using LeafConstPtr = const Leaf *;
+
+      /** \brief Constructor.
+        * \param[in] resolution the side length of the voxels
+        */
+      IncrementalVoxelGridCovariance (float resolution = 1.0f)
+      {
+        setResolution (resolution);
+      }
+
+      /** \brief Set the side length of the voxels. Changing it clears the map.
+        * \param[in] resolution the side length of the voxels
+        */
+      void
+      setResolution (float resolution);
+
+      /** \brief Get the side length of the voxels. */
+      inline float
+      getResolution () const
+      {
+        return (resolution_);
+      }
+
+      /** \brief Set the minimum number of points required for a voxel to be used (must be 3 or greater for covariance calculation).
+        * \param[in] min_points_per_voxel the minimum number of points for required for a voxel to be used
+        */
+      void
+      setMinPointPerVoxel (int min_points_per_voxel);
+
+      /** \brief Get the minimum number of points required for a voxel to be used.
+        * \return the minimum number of points for required for a voxel to be used
+        */
+      inline int
+      getMinPointPerVoxel () const
+      {
+        return (min_points_per_voxel_);
+      }
+
+      /** \brief Set the minimum allowable ratio between eigenvalues to prevent singular covariance matrices.
+        * \param[in] min_covar_eigvalue_mult the minimum allowable ratio between eigenvalues
+        */
+      void
+      setCovEigValueInflationRatio (double min_covar_eigvalue_mult);
+
+      /** \brief Get the minimum allowable ratio between eigenvalues to prevent singular covariance matrices.
+        * \return the minimum allowable ratio between eigenvalues
+        */
+      inline double
+      getCovEigValueInflationRatio () const
+      {
+        return (min_covar_eigvalue_mult_);
+      }
+
+      /** \brief Add a point to the map. Non finite points are ignored.
+        * \param[in] point the point to add
+        */
+      void
+      insert (const PointT &point);
+
+      /** \brief Add all points of a cloud to the map. Non finite points are ignored.
+        * \param[in] cloud the points to add
+        */
+      void
+      insert (const PointCloud &cloud);
+
+      /** \brief Remove a point that was previously added to the map. Voxels left without
+        * points are deleted.
+        * \param[in] point the point to remove
+        */
+      void
+      remove (const PointT &point);
+
+      /** \brief Remove all points of a cloud that was previously added to the map.
+        * \param[in] cloud the points to remove
+        */
+      void
+      remove (const PointCloud &cloud);
+
+      /** \brief Delete all voxels whose center lies outside of an axis aligned box, e.g. to
+        * keep a local map around a moving sensor.
+        * \param[in] min_pt the minimum corner of the box
+        * \param[in] max_pt the maximum corner of the box
+        * \return the number of deleted voxels
+        */
+      std::size_t
+      removeVoxelsOutside (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt);
+
+      /** \brief Delete all voxels. */
+      inline void
+      clear ()
+      {
+        voxels_.clear ();
+        nr_points_ = 0;
+        ++revision_;
+      }
+
+      /** \brief Get a counter that changes with every modification of the map, e.g. to
+        * find out whether data derived from the map is out of date.
+        */
+      inline std::size_t
+      getRevision () const
+      {
+        return (revision_);
+      }
+
+      /** \brief Get the number of voxels, including the ones with too few points to be used. */
+      inline std::size_t
+      getNumberOfVoxels () const
+      {
+        return (voxels_.size ());
+      }
+
+      /** \brief Get the number of points in the map. */
+      inline std::size_t
+      getNumberOfPoints () const
+      {
+        return (nr_points_);
+      }
+
+      /** \brief Get a pointcloud containing the centroids of the usable voxels. */
+      PointCloudPtr
+      getCentroids () const;
+
+      /** \brief Get the usable voxel containing a point.
+        * \param[in] point the point to get the leaf structure at
+        * \return the voxel, or nullptr if there is no usable voxel at the point
+        */
+      LeafConstPtr
+      getLeaf (const PointT &point) const;
+
+      /** \brief Get the usable voxels surrounding a point designated by \p relative_coordinates.
+        * \param[in] relative_coordinates 3xN matrix that represents relative coordinates of N neighboring voxels with respect to the center voxel
+        * \param[in] reference_point the point to get the leaf structures at
+        * \param[out] neighbors the voxels found
+        * \return number of neighbors found
+        */
+      int
+      getNeighborhoodAtPoint (const Eigen::Matrix<int, 3, Eigen::Dynamic> &relative_coordinates,
+                              const PointT &reference_point, std::vector<LeafConstPtr> &neighbors) const;
+
+      /** \brief Search for all usable voxels whose centroid lies within a radius of the query point.
+        * \note The voxels are visited directly, without a kd-tree, so the results are not sorted by distance.
+        * \param[in] point the given query point
+        * \param[in] radius the radius of the sphere bounding all of the centroids
+        * \param[out] k_leaves the resultant leaves of the neighboring points
+        * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+        * \param[in] max_nn if greater than 0, stop after this many voxels were found
+        * \return number of neighbors found
+        */
+      int
+      radiusSearch (const PointT &point, double radius, std::vector<LeafConstPtr> &k_leaves,
+                    std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
+
+    protected:
+      /** \brief A voxel: its sufficient statistics and the distribution derived from them. */
+      struct Voxel
+      {
+        /** \brief Integer coordinates of the voxel. */
+        Eigen::Vector3i coordinates;
+
+        /** \brief Number of points in the voxel. */
+        int nr_points{0};
+
+        /** \brief Sum of the points in the voxel. */
+        Eigen::Vector3d sum{Eigen::Vector3d::Zero ()};
+
+        /** \brief Sum of the outer products of the points in the voxel. */
+        Eigen::Matrix3d sum_sq{Eigen::Matrix3d::Zero ()};
+
+        /** \brief Whether the voxel has enough points and a valid covariance to be used. */
+        bool valid{false};
+
+        /** \brief Whether the voxel awaits the update of its distribution in a batch operation. */
+        bool modified{false};
+
+        /** \brief Distribution of the points in the voxel. */
+        Leaf leaf;
+      };
+
+      /** \brief Compute the integer coordinates of the voxel containing a point. */
+      inline Eigen::Vector3i
+      getVoxelCoordinates (const PointT &point) const
+      {
+        return (Eigen::floor (point.getArray3fMap () * inverse_resolution_).template cast<int> ());
+      }
+
+      /** \brief Hash of the integer coordinates of a voxel. */
+      struct VoxelHash
+      {
+        inline std::size_t
+        operator() (const Eigen::Vector3i &coordinates) const
+        {
+          return ((static_cast<std::size_t> (coordinates[0]) * 73856093) ^
+                  (static_cast<std::size_t> (coordinates[1]) * 19349663) ^
+                  (static_cast<std::size_t> (coordinates[2]) * 83492791));
+        }
+      };
+
+      /** \brief Add a point to the statistics of its voxel, without updating the distribution.
+        * \return the voxel, or nullptr if the point is not finite
+        */
+      Voxel*
+      accumulate (const PointT &point);
+
+      /** \brief Remove a point from the statistics of its voxel, without updating the distribution.
+        * \return the voxel, or nullptr if the point is not finite or not in the map
+        */
+      Voxel*
+      subtract (const PointT &point);
+
+      /** \brief Recompute the mean, covariance and validity of a voxel from its statistics. */
+      void
+      updateLeaf (Voxel &voxel) const;
+
+      /** \brief The side length of the voxels. */
+      float resolution_{1.0f};
+
+      /** \brief The inverse of the side length of the voxels. */
+      float inverse_resolution_{1.0f};
+
+      /** \brief Minimum points contained with in a voxel to allow it to be usable. */
+      int min_points_per_voxel_{6};
+
+      /** \brief Minimum allowable ratio between eigenvalues to prevent singular covariance matrices. */
+      double min_covar_eigvalue_mult_{0.01};
+
+      /** \brief Number of points in the map. */
+      std::size_t nr_points_{0};
+
+      /** \brief Counter of the modifications of the map. */
+      std::size_t revision_{0};
+
+      /** \brief The voxels, by integer coordinates. */
+      std::unordered_map<Eigen::Vector3i, Voxel, VoxelHash> voxels_;
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/filters/impl/incremental_voxel_grid_covariance.hpp>
+#endif
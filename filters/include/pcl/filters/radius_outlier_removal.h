@@ -142,6 +142,17 @@ namespace pcl
         */
       inline void
       setSearchMethod (const SearcherPtr &searcher) { searcher_ = searcher; }
+
+      /** \brief Set the number of threads to use for the neighbor searches.
+        * The result is the same for any number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads to use for the neighbor searches. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -177,6 +188,9 @@ namespace pcl
 
       /** \brief The minimum number of neighbors that a point needs to have in the given search radius to be considered an inlier. */
       int min_pts_radius_{1};
+
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
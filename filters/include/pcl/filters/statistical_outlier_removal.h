@@ -146,6 +146,17 @@ namespace pcl
         */
       inline void
       setSearchMethod (const SearcherPtr &searcher) { searcher_ = searcher; }
+
+      /** \brief Set the number of threads to use for the neighbor searches.
+        * The result is the same for any number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads to use for the neighbor searches. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -182,6 +193,9 @@ namespace pcl
       /** \brief Standard deviations threshold (i.e., points outside of 
         * \f$ \mu \pm \sigma \cdot std\_mul \f$ will be marked as outliers). */
       double std_mul_{0.0};
+
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
   };
 
   /** \brief @b StatisticalOutlierRemoval uses point neighborhood statistics to filter outlier data. For more
@@ -0,0 +1,282 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/centroid.h> // for CentroidPoint
+#include <pcl/filters/filter.h>
+
+#include <Eigen/StdVector> // for aligned_allocator
+
+#include <unordered_map>
+
+namespace pcl
+{
+  /** \brief StreamingVoxelGrid downsamples point clouds of any size with a hash map of voxels.
+    *
+    * Like \ref VoxelGrid, every occupied voxel is approximated by the centroid of its points. Instead of
+    * sorting the whole cloud, the points are accumulated in a single pass into a hash map that holds one
+    * running centroid per occupied voxel. The points can be added chunk by chunk (\ref addPointCloud), and
+    * the centroids can be emitted while points are still being added, either all at once (\ref flush) or only
+    * for the voxels outside of the region that will receive more points (\ref flushVoxelsOutside). The memory
+    * is therefore bounded by the number of occupied voxels that are kept, not by the number of points, and
+    * the number of voxels spanned by the bounding box is only limited by the voxel indices: points farther
+    * than 2^31 leaf sizes from the origin along any axis are ignored with a warning.
+    *
+    * Used as a \ref Filter, the input cloud is downsampled on its own and the accumulated points are discarded.
+    *
+    * \note The centroids are emitted in the order of the hash map, not in the order of the voxel indices.
+    * \ingroup filters
+    */
+  template <typename PointT>
+  class StreamingVoxelGrid: public Filter<PointT>
+  {
+    protected:
+      using Filter<PointT>::filter_name_;
+      using Filter<PointT>::getClassName;
+      using Filter<PointT>::input_;
+      using Filter<PointT>::indices_;
+
+      using PointCloud = typename Filter<PointT>::PointCloud;
+      using PointCloudPtr = typename PointCloud::Ptr;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+    public:
+
+      using Ptr = shared_ptr<StreamingVoxelGrid<PointT> >;
+      using ConstPtr = shared_ptr<const StreamingVoxelGrid<PointT> >;
+
+      /** \brief Empty constructor. */
+      StreamingVoxelGrid ()
+      {
+        filter_name_ = "StreamingVoxelGrid";
+      }
+
+      /** \brief Set the voxel grid leaf size. Changing it discards the accumulated points.
+        * \param[in] lx the leaf size for X
+        * \param[in] ly the leaf size for Y
+        * \param[in] lz the leaf size for Z
+        */
+      void
+      setLeafSize (float lx, float ly, float lz);
+
+      /** \brief Get the voxel grid leaf size. */
+      inline Eigen::Vector3f
+      getLeafSize () const { return (leaf_size_); }
+
+      /** \brief Set to true if all fields need to be downsampled, or false if just XYZ. Changing it discards the
+        * accumulated points.
+        * \param[in] downsample the new value (true/false)
+        */
+      void
+      setDownsampleAllData (bool downsample);
+
+      /** \brief Get the state of the internal downsampling parameter (true if
+        * all fields need to be downsampled, false if just XYZ).
+        */
+      inline bool
+      getDownsampleAllData () const { return (downsample_all_data_); }
+
+      /** \brief Set the minimum number of points required for a voxel to be emitted.
+        * \param[in] min_points_per_voxel the minimum number of points for required for a voxel to be used
+        */
+      inline void
+      setMinimumPointsNumberPerVoxel (unsigned int min_points_per_voxel) { min_points_per_voxel_ = min_points_per_voxel; }
+
+      /** \brief Return the minimum number of points required for a voxel to be emitted. */
+      inline unsigned int
+      getMinimumPointsNumberPerVoxel () const { return (min_points_per_voxel_); }
+
+      /** \brief Add a point to its voxel. Non finite points, and points whose voxel index does not fit in an int, are ignored.
+        * The latter are counted, and reported by a single warning by the next \ref addPointCloud or flush.
+        * \param[in] point the point to add
+        */
+      void
+      addPoint (const PointT &point);
+
+      /** \brief Add all points of a cloud to their voxels. Non finite points are ignored, and points whose voxel
+        * index does not fit in an int are ignored with a single warning for the whole cloud.
+        * \param[in] cloud the points to add
+        */
+      void
+      addPointCloud (const PointCloud &cloud);
+
+      /** \brief Add some points of a cloud to their voxels. Non finite points are ignored, and points whose voxel
+        * index does not fit in an int are ignored with a single warning for the whole cloud.
+        * \param[in] cloud the cloud
+        * \param[in] indices the indices of the points to add
+        */
+      void
+      addPointCloud (const PointCloud &cloud, const Indices &indices);
+
+      /** \brief Get the centroids of all voxels with enough points, keeping the accumulated points.
+        * \param[out] output the centroids
+        */
+      void
+      getCentroids (PointCloud &output) const;
+
+      /** \brief Get the centroids of all voxels with enough points and discard the accumulated points.
+        * \param[out] output the centroids
+        * \return the number of centroids
+        */
+      std::size_t
+      flush (PointCloud &output);
+
+      /** \brief Get the centroids of the voxels whose center lies outside of an axis aligned box, and discard
+        * these voxels. This emits the result incrementally when the points arrive in spatial order, e.g. the
+        * strips of an aerial survey, as the voxels outside of the region still being scanned are complete.
+        * \param[in] min_pt the minimum corner of the box
+        * \param[in] max_pt the maximum corner of the box
+        * \param[out] output the centroids of the discarded voxels with enough points
+        * \return the number of centroids
+        */
+      std::size_t
+      flushVoxelsOutside (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, PointCloud &output);
+
+      /** \brief Discard the accumulated points. */
+      inline void
+      clear ()
+      {
+        voxels_.clear ();
+        nr_points_ = 0;
+        nr_ignored_points_ = 0;
+        nr_reported_ignored_points_ = 0;
+      }
+
+      /** \brief Get the number of occupied voxels, including the ones with too few points to be emitted. */
+      inline std::size_t
+      getNumberOfVoxels () const
+      {
+        return (voxels_.size ());
+      }
+
+      /** \brief Get the number of accumulated points. */
+      inline std::size_t
+      getNumberOfPoints () const
+      {
+        return (nr_points_);
+      }
+
+      /** \brief Get the number of points ignored because their voxel index does not fit in an int. */
+      inline std::size_t
+      getNumberOfIgnoredPoints () const
+      {
+        return (nr_ignored_points_);
+      }
+
+    protected:
+      /** \brief The running centroid of a voxel. */
+      struct Voxel
+      {
+        /** \brief Number of points in the voxel. */
+        std::size_t nr_points{0};
+
+        /** \brief Sum of the coordinates of the points, in double precision for voxels with many points. */
+        Eigen::Vector3d sum{Eigen::Vector3d::Zero ()};
+
+        /** \brief Accumulator of all fields, only used if all data is downsampled. */
+        CentroidPoint<PointT> centroid;
+
+        PCL_MAKE_ALIGNED_OPERATOR_NEW
+      };
+
+      /** \brief Hash of the integer coordinates of a voxel. */
+      struct VoxelHash
+      {
+        inline std::size_t
+        operator() (const Eigen::Vector3i &coordinates) const
+        {
+          return ((static_cast<std::size_t> (coordinates[0]) * 73856093) ^
+                  (static_cast<std::size_t> (coordinates[1]) * 19349663) ^
+                  (static_cast<std::size_t> (coordinates[2]) * 83492791));
+        }
+      };
+
+      using VoxelMap = std::unordered_map<Eigen::Vector3i, Voxel, VoxelHash, std::equal_to<Eigen::Vector3i>,
+                                          Eigen::aligned_allocator<std::pair<const Eigen::Vector3i, Voxel> > >;
+
+      /** \brief Downsample the input cloud on its own.
+        * \param[out] output the resultant point cloud
+        */
+      void
+      applyFilter (PointCloud &output) override;
+
+      /** \brief Compute the centroid of a voxel.
+        * \param[in] voxel the voxel
+        * \param[out] point the centroid
+        */
+      void
+      getCentroid (const Voxel &voxel, PointT &point) const;
+
+      /** \brief Print a single warning for the points ignored since the last one.
+        * \param[in] method the name of the calling method
+        */
+      void
+      warnIgnoredPoints (const char *method);
+
+      /** \brief The size of a leaf. */
+      Eigen::Vector3f leaf_size_{Eigen::Vector3f::Ones ()};
+
+      /** \brief Internal leaf sizes stored as 1/leaf_size_ for efficiency reasons. */
+      Eigen::Array3f inverse_leaf_size_{Eigen::Array3f::Ones ()};
+
+      /** \brief Set to true if all fields need to be downsampled, or false if just XYZ. */
+      bool downsample_all_data_{true};
+
+      /** \brief Minimum number of points per voxel for the centroid to be emitted. */
+      unsigned int min_points_per_voxel_{0};
+
+      /** \brief Number of accumulated points. */
+      std::size_t nr_points_{0};
+
+      /** \brief Number of points ignored because their voxel index does not fit in an int. */
+      std::size_t nr_ignored_points_{0};
+
+      /** \brief Number of ignored points already reported by a warning. */
+      std::size_t nr_reported_ignored_points_{0};
+
+      /** \brief The occupied voxels, by integer coordinates. */
+      VoxelMap voxels_;
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/filters/impl/streaming_voxel_grid.hpp>
+#endif
@@ -274,6 +274,21 @@ namespace pcl
       inline bool
       getSaveLeafLayout () const { return (save_leaf_layout_); }
 
+      /** \brief Set the number of threads to use. With more than one thread, the points are sorted into their
+        * voxels with a parallel radix sort and the centroids are computed in parallel. The result is the same
+        * for any number of threads, but the centroids may differ from the single threaded ones in the last bits,
+        * since the points of a voxel are summed in a different order.
+        * \note Grids whose number of voxels does not fit in 32 bit indices always take this path, unless the
+        * leaf layout is saved.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Get the minimum coordinates of the bounding box (after
         * filtering is performed).
         */
@@ -479,6 +494,9 @@ namespace pcl
       /** \brief Minimum number of points per voxel for the centroid to be computed */
       unsigned int min_points_per_voxel_{0};
 
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
+
       using FieldList = typename pcl::traits::fieldList<PointT>::type;
 
       /** \brief Downsample a Point Cloud using a voxelized grid approach
@@ -486,6 +504,12 @@ namespace pcl
         */
       void
       applyFilter (PointCloud &output) override;
+
+      /** \brief Downsample with 64 bit voxel indices, a parallel radix sort and centroids computed in parallel.
+        * \param[out] output the resultant point cloud
+        */
+      void
+      applyParallelFilter (PointCloud &output);
   };
 
   /** \brief VoxelGrid assembles a local 3D grid over a given PointCloud, and downsamples + filters the data.
@@ -594,6 +618,21 @@ namespace pcl
       inline bool
       getSaveLeafLayout () const { return (save_leaf_layout_); }
 
+      /** \brief Set the number of threads to use. With more than one thread, the points are sorted into their
+        * voxels with a parallel radix sort and the centroids are computed in parallel. The result is the same
+        * for any number of threads, but the centroids may differ from the single threaded ones in the last bits,
+        * since the points of a voxel are summed in a different order.
+        * \note Grids whose number of voxels does not fit in 32 bit indices always take this path, unless the
+        * leaf layout is saved.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Get the minimum coordinates of the bounding box (after
         * filtering is performed).
         */
@@ -827,11 +866,22 @@ namespace pcl
       /** \brief Minimum number of points per voxel for the centroid to be computed */
       unsigned int min_points_per_voxel_{0};
 
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
+
       /** \brief Downsample a Point Cloud using a voxelized grid approach
         * \param[out] output the resultant point cloud
         */
       void
       applyFilter (PCLPointCloud2 &output) override;
+
+      /** \brief Downsample with 64 bit voxel indices, a parallel radix sort and centroids computed in parallel.
+        * \param[out] output the resultant point cloud
+        * \param[in] centroid_size the number of values accumulated for every point
+        * \param[in] rgba_index the index of the rgb(a) field, or -1
+        */
+      void
+      applyParallelFilter (PCLPointCloud2 &output, int centroid_size, int rgba_index);
   };
 }
 
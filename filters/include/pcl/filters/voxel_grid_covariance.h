@@ -251,6 +251,25 @@ namespace pcl
         return min_covar_eigvalue_mult_;
       }
 
+      /** \brief Set whether the eigen decompositions of the leaf covariances are computed in one
+        * single precision batch (pcl::eigen33) rather than by Eigen's double precision solver.
+        * The batch is faster, but less accurate for leaves with (nearly) repeated eigenvalues,
+        * where the eigen vectors may differ from those of the double precision solver.
+        * \param[in] use_batched_eigen_solver true to use the batched solver (default: false)
+        */
+      inline void
+      setUseBatchedEigenSolver (bool use_batched_eigen_solver)
+      {
+        use_batched_eigen_solver_ = use_batched_eigen_solver;
+      }
+
+      /** \brief Get whether the batched single precision eigen solver is used. */
+      inline bool
+      getUseBatchedEigenSolver () const
+      {
+        return use_batched_eigen_solver_;
+      }
+
       /** \brief Filter cloud and initializes voxel structure.
        * \param[out] output cloud containing centroids of voxels containing a sufficient number of points
        * \param[in] searchable flag if voxel structure is searchable, if true then kdtree is built
@@ -572,6 +591,9 @@ namespace pcl
       /** \brief Minimum allowable ratio between eigenvalues to prevent singular covariance matrices. */
       double min_covar_eigvalue_mult_{0.01};
 
+      /** \brief Flag to determine if the leaf covariances are decomposed in one single precision batch. */
+      bool use_batched_eigen_solver_{false};
+
       /** \brief Voxel structure containing all leaf nodes (includes voxels with less than a sufficient number of points). */
       std::map<std::size_t, Leaf> leaves_;
 
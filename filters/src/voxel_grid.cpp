@@ -44,6 +44,10 @@
 #include <boost/sort/spreadsort/integer_sort.hpp>
 #include <array>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using Array4size_t = Eigen::Array<std::size_t, 4, 1>;
 // NOLINTBEGIN(readability-container-data-pointer)
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -174,6 +178,23 @@ pcl::getMinMax3D (const pcl::PCLPointCloud2ConstPtr &cloud, int x_idx, int y_idx
   max_pt = max_p;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::VoxelGrid<pcl::PCLPointCloud2>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::VoxelGrid::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::VoxelGrid::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
@@ -228,7 +249,13 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
   std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1])+1;
   std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2])+1;
 
-  if( (dx*dy*dz) > static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::max()) )
+  // Voxel indices that do not fit in 32 bits are handled with 64 bit indices, but not in the leaf layout
+  const double nr_voxels = static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz);
+  const bool wide_indices = nr_voxels > static_cast<double> (std::numeric_limits<std::int32_t>::max ());
+  const bool fits_wide_indices = !save_leaf_layout_ &&
+                                 nr_voxels <= static_cast<double> (std::numeric_limits<std::int64_t>::max ()) &&
+                                 std::max ({dx, dy, dz}) <= static_cast<std::int64_t> (std::numeric_limits<std::int32_t>::max ());
+  if (wide_indices && !fits_wide_indices)
   {
     PCL_WARN("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName().c_str());
     //output.width = output.height = 0;
@@ -256,7 +283,7 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
                            input_->fields[y_idx_].offset,
                            input_->fields[z_idx_].offset,
                            0);
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  divb_mul_ = Eigen::Vector4i (1, div_b_[0], static_cast<int> (static_cast<std::int64_t> (div_b_[0]) * div_b_[1]), 0);
   Eigen::Vector4f pt  = Eigen::Vector4f::Zero ();
 
   int centroid_size = 4;
@@ -278,6 +305,12 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
       }
     }
   }
+
+  if ((threads_ != 1 || wide_indices) && (!wide_indices || fits_wide_indices))
+  {
+    applyParallelFilter (output, centroid_size, rgba_index);
+    return;
+  }
   
   // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
   if (!filter_field_name_.empty ())
@@ -337,9 +370,9 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
         continue;
       }
 
-      int ijk0 = static_cast<int> (std::floor (pt[0] * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (std::floor (pt[1] * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (std::floor (pt[2] * inverse_leaf_size_[2]) - min_b_[2]);
+      int ijk0 = static_cast<int> (std::floor (pt[0] * inverse_leaf_size_[0])) - min_b_[0];
+      int ijk1 = static_cast<int> (std::floor (pt[1] * inverse_leaf_size_[1])) - min_b_[1];
+      int ijk2 = static_cast<int> (std::floor (pt[2] * inverse_leaf_size_[2])) - min_b_[2];
       // Compute the centroid leaf index
       int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
       index_vector.emplace_back(idx, static_cast<unsigned int> (cp));
@@ -367,9 +400,9 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
         continue;
       }
 
-      int ijk0 = static_cast<int> (std::floor (pt[0] * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (std::floor (pt[1] * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (std::floor (pt[2] * inverse_leaf_size_[2]) - min_b_[2]);
+      int ijk0 = static_cast<int> (std::floor (pt[0] * inverse_leaf_size_[0])) - min_b_[0];
+      int ijk1 = static_cast<int> (std::floor (pt[1] * inverse_leaf_size_[1])) - min_b_[1];
+      int ijk2 = static_cast<int> (std::floor (pt[2] * inverse_leaf_size_[2])) - min_b_[2];
       // Compute the centroid leaf index
       int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
       index_vector.emplace_back(idx, static_cast<unsigned int> (cp));
@@ -525,6 +558,187 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
     ++index;
   }
 }
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::VoxelGrid<pcl::PCLPointCloud2>::applyParallelFilter (PCLPointCloud2 &output, int centroid_size, int rgba_index)
+{
+  const std::size_t nr_points = input_->width * input_->height;
+  const std::uint64_t mul_y = div_b_[0];
+  const std::uint64_t mul_z = static_cast<std::uint64_t> (div_b_[0]) * static_cast<std::uint64_t> (div_b_[1]);
+  const std::uint64_t max_idx = mul_z * static_cast<std::uint64_t> (div_b_[2]) - 1;
+  constexpr std::uint64_t invalid_idx = std::numeric_limits<std::uint64_t>::max ();
+
+  // Get the distance field offset, if we don't want to process the entire cloud
+  std::size_t distance_offset = 0;
+  if (!filter_field_name_.empty ())
+  {
+    int distance_idx = pcl::getFieldIndex (*input_, filter_field_name_);
+
+    if (input_->fields[distance_idx].datatype != pcl::PCLPointField::FLOAT32)
+    {
+      PCL_ERROR ("[pcl::%s::applyFilter] Distance filtering requested, but distances are not float/double in the dataset! Only FLOAT32/FLOAT64 distances are supported right now.\n", getClassName ().c_str ());
+      output.width = output.height = 0;
+      output.data.clear ();
+      return;
+    }
+    distance_offset = input_->fields[distance_idx].offset;
+  }
+  const std::array<std::size_t, 3> xyz_offset {input_->fields[x_idx_].offset,
+                                               input_->fields[y_idx_].offset,
+                                               input_->fields[z_idx_].offset};
+
+  // First pass: compute the voxel index of every point, invalid and filtered points are marked and removed
+  std::vector<detail::VoxelPointIndex> index_vector (nr_points);
+#pragma omp parallel for schedule(static) num_threads(threads_)
+  for (std::ptrdiff_t cp = 0; cp < static_cast<std::ptrdiff_t> (nr_points); ++cp)
+  {
+    const std::uint8_t* point = &input_->data[cp * input_->point_step];
+    index_vector[cp].cloud_point_index = static_cast<unsigned int> (cp);
+    index_vector[cp].idx = invalid_idx;
+
+    if (!filter_field_name_.empty ())
+    {
+      float distance_value = 0;
+      memcpy (&distance_value, point + distance_offset, sizeof (float));
+      if (filter_limit_negative_)
+      {
+        if (distance_value < filter_limit_max_ && distance_value > filter_limit_min_)
+          continue;
+      }
+      else if (distance_value > filter_limit_max_ || distance_value < filter_limit_min_)
+        continue;
+    }
+
+    // Unoptimized memcpys: assume fields x, y, z are in random order
+    Eigen::Array3f pt;
+    memcpy (&pt[0], point + xyz_offset[0], sizeof (float));
+    memcpy (&pt[1], point + xyz_offset[1], sizeof (float));
+    memcpy (&pt[2], point + xyz_offset[2], sizeof (float));
+
+    // Check if the point is invalid
+    if (!std::isfinite (pt[0]) || !std::isfinite (pt[1]) || !std::isfinite (pt[2]))
+      continue;
+
+    const auto ijk0 = static_cast<std::uint64_t> (static_cast<int> (std::floor (pt[0] * inverse_leaf_size_[0])) - min_b_[0]);
+    const auto ijk1 = static_cast<std::uint64_t> (static_cast<int> (std::floor (pt[1] * inverse_leaf_size_[1])) - min_b_[1]);
+    const auto ijk2 = static_cast<std::uint64_t> (static_cast<int> (std::floor (pt[2] * inverse_leaf_size_[2])) - min_b_[2]);
+    index_vector[cp].idx = ijk0 + ijk1 * mul_y + ijk2 * mul_z;
+  }
+  index_vector.erase (std::remove_if (index_vector.begin (), index_vector.end (),
+                                      [] (const detail::VoxelPointIndex &p) { return (p.idx == invalid_idx); }),
+                      index_vector.end ());
+
+  // Second pass: sort the points by voxel index
+  detail::radixSortVoxelIndices (index_vector, max_idx, threads_);
+
+  // Third pass: find the points of every output cell
+  std::vector<std::pair<std::size_t, std::size_t> > first_and_last_indices_vector;
+  detail::getVoxelRanges (index_vector, min_points_per_voxel_, first_and_last_indices_vector);
+
+  // Fourth pass: compute centroids in parallel, each into its final position
+  output.width = static_cast<std::uint32_t> (first_and_last_indices_vector.size ());
+  output.row_step = output.point_step * output.width;
+  output.data.resize (output.width * output.point_step);
+
+  if (save_leaf_layout_)
+  {
+    try
+    {
+      leaf_layout_.assign (static_cast<std::size_t> (max_idx + 1), -1);
+    }
+    catch (std::bad_alloc&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout",
+        "voxel_grid.cpp", "applyFilter");
+    }
+    catch (std::length_error&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout",
+        "voxel_grid.cpp", "applyFilter");
+    }
+  }
+
+  // If we downsample each field, the {x,y,z}_idx_ offsets should correspond in input_ and output,
+  // if not, we must have created a new xyz cloud
+  const std::array<std::size_t, 3> output_xyz_offset = downsample_all_data_ ?
+      std::array<std::size_t, 3> {output.fields[x_idx_].offset, output.fields[y_idx_].offset, output.fields[z_idx_].offset} :
+      std::array<std::size_t, 3> {0, 4, 8};
+
+  const auto nr_voxels = static_cast<std::ptrdiff_t> (first_and_last_indices_vector.size ());
+#pragma omp parallel num_threads(threads_)
+  {
+    Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
+    Eigen::VectorXf centroid (centroid_size);
+#pragma omp for schedule(dynamic, 1024)
+    for (std::ptrdiff_t index = 0; index < nr_voxels; ++index)
+    {
+      const std::size_t first_index = first_and_last_indices_vector[index].first;
+      const std::size_t last_index = first_and_last_indices_vector[index].second;
+      const std::size_t output_offset = index * output.point_step;
+
+      if (save_leaf_layout_)
+        leaf_layout_[index_vector[first_index].idx] = static_cast<int> (index);
+
+      //Limit downsampling to coords
+      if (!downsample_all_data_)
+      {
+        Eigen::Vector3f xyz_centroid (Eigen::Vector3f::Zero ());
+        for (std::size_t li = first_index; li < last_index; ++li)
+        {
+          const std::size_t point_offset = index_vector[li].cloud_point_index * input_->point_step;
+          for (std::size_t ind = 0; ind < 3; ++ind)
+          {
+            float value;
+            memcpy (&value, &input_->data[point_offset + xyz_offset[ind]], sizeof (float));
+            xyz_centroid[ind] += value;
+          }
+        }
+        xyz_centroid /= static_cast<float> (last_index - first_index);
+        for (std::size_t ind = 0; ind < 3; ++ind)
+          memcpy (&output.data[output_offset + output_xyz_offset[ind]], &xyz_centroid[ind], sizeof (float));
+      }
+      else
+      {
+        centroid.setZero ();
+        // fill in the accumulator with leaf points
+        for (std::size_t li = first_index; li < last_index; ++li)
+        {
+          const std::size_t point_offset = index_vector[li].cloud_point_index * input_->point_step;
+          // ---[ RGB special case
+          // fill extra r/g/b centroid field
+          if (rgba_index >= 0)
+          {
+            pcl::RGB rgb;
+            memcpy (&rgb, &input_->data[point_offset + input_->fields[rgba_index].offset], sizeof (RGB));
+            temporary[centroid_size-4] = rgb.r;
+            temporary[centroid_size-3] = rgb.g;
+            temporary[centroid_size-2] = rgb.b;
+            temporary[centroid_size-1] = rgb.a;
+          }
+          // Copy all the fields
+          for (std::size_t d = 0; d < input_->fields.size (); ++d)
+            memcpy (&temporary[d], &input_->data[point_offset + input_->fields[d].offset], field_sizes_[d]);
+          centroid += temporary;
+        }
+        centroid /= static_cast<float> (last_index - first_index);
+
+        // Copy all the fields
+        for (std::size_t d = 0; d < output.fields.size (); ++d)
+          memcpy (&output.data[output_offset + output.fields[d].offset], &centroid[d], field_sizes_[d]);
+
+        // ---[ RGB special case
+        // full extra r/g/b centroid field
+        if (rgba_index >= 0)
+        {
+          float r = centroid[centroid_size-4], g = centroid[centroid_size-3], b = centroid[centroid_size-2], a = centroid[centroid_size-1];
+          int rgb = (static_cast<int> (a) << 24) | (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
+          memcpy (&output.data[output_offset + output.fields[rgba_index].offset], &rgb, sizeof (float));
+        }
+      }
+    }
+  }
+}
+
 // NOLINTEND(readability-container-data-pointer)
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/impl/instantiate.hpp>
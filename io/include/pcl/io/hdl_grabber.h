@@ -42,12 +42,18 @@
 #include <pcl/pcl_macros.h>
 
 #include <pcl/io/grabber.h>
+#include <pcl/io/pcap_replay.h>
+#include <pcl/io/impl/spsc_queue.hpp>
 #include <pcl/io/impl/synchronized_queue.hpp>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
 #include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #define HDL_Grabber_toRadians(x) ((x) * M_PI / 180.0)
 
@@ -194,6 +200,53 @@ namespace pcl
       virtual std::uint8_t
       getMaximumNumberOfLasers () const;
 
+      /** \brief Hand the packets over from the reading thread to the decoding thread through a
+       *         lock-free ring of preallocated packets, instead of the default unbounded, mutex based queue.
+       *         Packets received while the ring is full are dropped, see getNumberOfDroppedPackets ().
+       *         Has no effect while the grabber is running.
+       * \param[in] capacity number of packets of the ring (rounded up to a power of two), 0 to use the default queue
+       */
+      void
+      setLockFreeQueueCapacity (std::size_t capacity);
+
+      /** \brief Returns the number of packets of the lock-free ring, 0 if the default queue is used */
+      std::size_t
+      getLockFreeQueueCapacity () const;
+
+      /** \brief Returns the number of packets dropped because the lock-free ring was full */
+      std::size_t
+      getNumberOfDroppedPackets () const;
+
+      /** \brief Set the speed at which the pcap file is replayed, driven by the capture timestamps of the packets.
+       *         Unlike live data, a replay never drops packets: it waits for the decoding thread instead,
+       *         so that it is deterministic.
+       * \param[in] rate 1 replays in real time (default), 2 twice as fast, 0.5 at half speed, 0 as fast as the packets can be decoded
+       */
+      void
+      setPcapReplayRate (double rate);
+
+      /** \brief Returns the pcap replay rate, 0 meaning as fast as possible */
+      double
+      getPcapReplayRate () const;
+
+      /** \brief Recycle the scan and sweep clouds once all the slots holding them released them,
+       *         instead of allocating new ones for every packet and sweep. A slot that keeps a cloud
+       *         keeps it unchanged, the cloud is only reused after its last shared pointer is gone.
+       * \param[in] enabled true to recycle the clouds, false (default) to always allocate new ones
+       */
+      void
+      setCloudRecycling (bool enabled);
+
+      /** \brief Returns whether the scan and sweep clouds are recycled */
+      bool
+      getCloudRecycling () const;
+
+      /** \brief Set the number of threads used to decode the firing blocks of each packet.
+       * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+       */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
     protected:
       static const std::uint16_t HDL_DATA_PORT = 2368;
       static const std::uint16_t HDL_NUM_ROT_ANGLES = 36001;
@@ -242,11 +295,86 @@ namespace pcl
           double cosVertOffsetCorrection;
       };
 
+      /** \brief Point clouds handed out again once all their owners released them.
+       *         The clouds are returned to the pool by the deleter of their shared pointer, under a mutex,
+       *         so that a cloud is only recycled after the last slot holding it is done with it.
+       *         Recycled clouds keep the capacity of their point vector, so that steady state sweeps
+       *         do not allocate. Disabled by default: every cloud is then a new one.
+       */
+      template <typename PointT>
+      class CloudPool
+      {
+        public:
+          CloudPool () : free_list_ (new FreeList) {}
+
+          /** \brief Enable or disable recycling, disabling releases the idle clouds. */
+          void
+          setEnabled (bool enabled)
+          {
+            std::vector<std::unique_ptr<pcl::PointCloud<PointT> > > clouds;
+            std::lock_guard<std::mutex> lock (free_list_->mutex);
+            free_list_->enabled = enabled;
+            if (!enabled)
+              clouds.swap (free_list_->clouds);
+          }
+
+          /** \brief Returns an empty cloud, recycled if one is available. */
+          typename pcl::PointCloud<PointT>::Ptr
+          get ()
+          {
+            std::unique_ptr<pcl::PointCloud<PointT> > cloud;
+            {
+              std::lock_guard<std::mutex> lock (free_list_->mutex);
+              if (!free_list_->enabled)
+                return (typename pcl::PointCloud<PointT>::Ptr (new pcl::PointCloud<PointT>));
+              if (!free_list_->clouds.empty ())
+              {
+                cloud = std::move (free_list_->clouds.back ());
+                free_list_->clouds.pop_back ();
+              }
+            }
+            if (cloud)
+              cloud->clear ();
+            else
+              cloud.reset (new pcl::PointCloud<PointT>);
+            // The clouds may outlive the grabber, the deleter keeps the free list alive
+            std::shared_ptr<FreeList> free_list = free_list_;
+            return (typename pcl::PointCloud<PointT>::Ptr (cloud.release (), [free_list] (pcl::PointCloud<PointT> *released)
+            {
+              free_list->release (released);
+            }));
+          }
+
+        private:
+          struct FreeList
+          {
+            void
+            release (pcl::PointCloud<PointT> *released)
+            {
+              // Declared before the lock, a cloud that is not kept is deleted after unlocking
+              std::unique_ptr<pcl::PointCloud<PointT> > cloud (released);
+              std::lock_guard<std::mutex> lock (mutex);
+              if (enabled && clouds.size () < max_size_)
+                clouds.push_back (std::move (cloud));
+            }
+
+            std::mutex mutex;
+            bool enabled = false;
+            std::vector<std::unique_ptr<pcl::PointCloud<PointT> > > clouds;
+          };
+
+          static const std::size_t max_size_ = 4;
+          std::shared_ptr<FreeList> free_list_;
+      };
+
       HDLLaserCorrection laser_corrections_[HDL_MAX_NUM_LASERS];
       std::uint16_t last_azimuth_;
       pcl::PointCloud<pcl::PointXYZ>::Ptr current_scan_xyz_, current_sweep_xyz_;
       pcl::PointCloud<pcl::PointXYZI>::Ptr current_scan_xyzi_, current_sweep_xyzi_;
       pcl::PointCloud<pcl::PointXYZRGBA>::Ptr current_scan_xyzrgba_, current_sweep_xyzrgba_;
+      CloudPool<pcl::PointXYZ> scan_xyz_pool_, sweep_xyz_pool_;
+      CloudPool<pcl::PointXYZI> scan_xyzi_pool_, sweep_xyzi_pool_;
+      CloudPool<pcl::PointXYZRGBA> scan_xyzrgba_pool_, sweep_xyzrgba_pool_;
       boost::signals2::signal<sig_cb_velodyne_hdl_sweep_point_cloud_xyz>* sweep_xyz_signal_;
       boost::signals2::signal<sig_cb_velodyne_hdl_sweep_point_cloud_xyzrgba>* sweep_xyzrgba_signal_;
       boost::signals2::signal<sig_cb_velodyne_hdl_sweep_point_cloud_xyzi>* sweep_xyzi_signal_;
@@ -266,11 +394,18 @@ namespace pcl
                    HDLLaserReturn laserReturn,
                    HDLLaserCorrection correction) const;
 
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
+
+      /** \brief Whether the scan and sweep clouds are recycled. */
+      bool recycle_clouds_{false};
 
     private:
       static double *cos_lookup_table_;
       static double *sin_lookup_table_;
       pcl::SynchronizedQueue<std::uint8_t *> hdl_data_;
+      std::unique_ptr<pcl::SPSCQueue<HDLDataPacket> > hdl_packets_;
+      std::atomic<std::size_t> dropped_packets_{0};
       boost::asio::ip::udp::endpoint udp_listener_endpoint_;
       boost::asio::ip::address source_address_filter_;
       std::uint16_t source_port_filter_;
@@ -279,7 +414,10 @@ namespace pcl
       std::string pcap_file_name_;
       std::thread *queue_consumer_thread_;
       std::thread *hdl_read_packet_thread_;
-      bool terminate_read_packet_thread_;
+      std::atomic<bool> terminate_read_packet_thread_{false};
+      /** \brief Set once the packet reading thread reached the end of the pcap file. */
+      std::atomic<bool> read_packet_thread_done_{false};
+      pcl::PcapReplay pcap_replay_;
       pcl::RGB laser_rgb_mapping_[HDL_MAX_NUM_LASERS];
       float min_distance_threshold_;
       float max_distance_threshold_;
@@ -298,7 +436,8 @@ namespace pcl
 
       void
       enqueueHDLPacket (const std::uint8_t *data,
-                        std::size_t bytesReceived);
+                        std::size_t bytesReceived,
+                        bool waitForSpace = false);
 
       void
       loadCorrectionsFile (const std::string& correctionsFile);
@@ -309,6 +448,9 @@ namespace pcl
       void
       readPacketsFromSocket ();
 
+      void
+      replayPcapFile ();
+
 #ifdef HAVE_PCAP
       void
       readPacketsFromPcap();
@@ -116,7 +116,8 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
     PCL_WARN ("[pcl::PCDWriter::writeBinary] Input point cloud has no data!\n");
   }
   std::ostringstream oss;
-  oss << generateHeader<PointT> (cloud) << "DATA binary\n";
+  const std::string header = generateHeader<PointT> (cloud);
+  oss << header << generateDataLineBinary (header.size ());
   oss.flush ();
   const auto data_idx = static_cast<unsigned int> (oss.tellp ());
 
@@ -616,7 +617,8 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
     PCL_WARN ("[pcl::PCDWriter::writeBinary] Input point cloud has no data or empty indices given!\n");
   }
   std::ostringstream oss;
-  oss << generateHeader<PointT> (cloud, static_cast<int> (indices.size ())) << "DATA binary\n";
+  const std::string header = generateHeader<PointT> (cloud, static_cast<int> (indices.size ()));
+  oss << header << generateDataLineBinary (header.size ());
   oss.flush ();
   const auto data_idx = static_cast<unsigned int> (oss.tellp ());
 
@@ -0,0 +1,158 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IO_PCD_VIEW_IMPL_H_
+#define PCL_IO_PCD_VIEW_IMPL_H_
+
+#include <pcl/common/io.h> // for getFields, getFieldSize
+#include <pcl/io/pcd_view.h>
+
+#include <algorithm>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T> T
+pcl::PCDCloudView::getFieldValue (std::size_t index, std::size_t field_index, uindex_t element) const
+{
+  const pcl::PCLPointField &field = header_.fields[field_index];
+  const std::uint8_t *value = getPointData (index) + field.offset + element * pcl::getFieldSize (field.datatype);
+  switch (field.datatype)
+  {
+#define PCL_PCD_VIEW_GET_FIELD_VALUE(CASE_LABEL)                                       \
+  case CASE_LABEL: {                                                                   \
+    pcl::traits::asType_t<CASE_LABEL> typed_value;                                     \
+    std::memcpy (&typed_value, value, sizeof (typed_value));                           \
+    return (static_cast<T> (typed_value));                                             \
+  }
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::BOOL)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::INT8)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::UINT8)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::INT16)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::UINT16)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::INT32)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::UINT32)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::INT64)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::UINT64)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::FLOAT32)
+    PCL_PCD_VIEW_GET_FIELD_VALUE(pcl::PCLPointField::FLOAT64)
+#undef PCL_PCD_VIEW_GET_FIELD_VALUE
+  }
+  return (T ());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PCDCloudView::isLayoutCompatible () const
+{
+  if (!isOpen () || header_.point_step != sizeof (PointT))
+    return (false);
+
+  for (const auto &point_field : pcl::getFields<PointT> ())
+  {
+    if (point_field.name == "_")
+      continue;
+    const int field_index = getFieldIndex (point_field.name);
+    if (field_index < 0)
+      return (false);
+    const pcl::PCLPointField &field = header_.fields[field_index];
+    // rgb is written as an unsigned integer but declared as a float
+    const bool same_datatype = (field.datatype == point_field.datatype) ||
+                               (point_field.name == "rgb" &&
+                                pcl::getFieldSize (field.datatype) == pcl::getFieldSize (point_field.datatype));
+    if (!same_datatype || field.offset != point_field.offset ||
+        field.count != std::max<uindex_t> (point_field.count, 1))
+      return (false);
+  }
+  return (true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> const PointT*
+pcl::PCDCloudView::getPoints () const
+{
+  if (!isLayoutCompatible<PointT> () || reinterpret_cast<std::uintptr_t> (data_) % alignof (PointT) != 0)
+    return (nullptr);
+  return (reinterpret_cast<const PointT*> (data_));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::PCDPointView<PointT>::PCDPointView (const PCDCloudView &cloud)
+  : cloud_ (cloud)
+  , layout_compatible_ (cloud.isLayoutCompatible<PointT> ())
+  , points_ (cloud.getPoints<PointT> ())
+{
+  if (!layout_compatible_ && cloud_.isOpen ())
+    pcl::createMapping<PointT> (cloud_.getHeader ().fields, field_map_);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> PointT
+pcl::PCDPointView<PointT>::convertPoint (std::size_t index) const
+{
+  PointT point;
+  const std::uint8_t *point_data = cloud_.getPointData (index);
+  auto *point_bytes = reinterpret_cast<std::uint8_t*> (&point);
+  if (layout_compatible_)
+  {
+    std::memcpy (point_bytes, point_data, sizeof (PointT));
+    return (point);
+  }
+  for (const auto &mapping : field_map_)
+    std::memcpy (point_bytes + mapping.struct_offset, point_data + mapping.serialized_offset, mapping.size);
+  return (point);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDPointView<PointT>::copyTo (pcl::PointCloud<PointT> &cloud) const
+{
+  cloud.resize (width (), height ());
+  cloud.is_dense = false;
+  cloud.sensor_origin_ = cloud_.getOrigin ();
+  cloud.sensor_orientation_ = cloud_.getOrientation ();
+
+  if (layout_compatible_)
+  {
+    if (!empty ())
+      std::memcpy (static_cast<void*> (cloud.data ()), cloud_.getData (), size () * sizeof (PointT));
+    return;
+  }
+  for (std::size_t i = 0; i < size (); ++i)
+    cloud[i] = convertPoint (i);
+}
+
+#endif  //#ifndef PCL_IO_PCD_VIEW_IMPL_H_
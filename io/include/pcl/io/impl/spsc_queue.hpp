@@ -0,0 +1,179 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Bounded, lock-free queue for exactly one producer and one consumer thread.
+    *
+    * All the slots are allocated at construction and reused for the lifetime of the
+    * queue. The producer writes in place in the slot returned by getWriteSlot () and
+    * makes it visible with publish (); the consumer reads in place from the slot
+    * returned by getReadSlot () and gives it back with release (). Neither side ever
+    * blocks: a full (resp. empty) queue is reported by a null slot.
+    */
+  template<typename T>
+  class SPSCQueue
+  {
+    public:
+      /** \brief Constructor.
+        * \param[in] capacity the number of slots, rounded up to the next power of two
+        */
+      explicit SPSCQueue (std::size_t capacity)
+      {
+        std::size_t size = 1;
+        while (size < capacity)
+          size <<= 1;
+        slots_.resize (size);
+        mask_ = size - 1;
+      }
+
+      SPSCQueue (const SPSCQueue&) = delete;
+      SPSCQueue& operator= (const SPSCQueue&) = delete;
+
+      /** \brief Producer side: get the next free slot, or nullptr if the queue is full. */
+      T*
+      getWriteSlot ()
+      {
+        const std::size_t tail = tail_.load (std::memory_order_relaxed);
+        if (tail - head_cache_ == slots_.size ())
+        {
+          head_cache_ = head_.load (std::memory_order_acquire);
+          if (tail - head_cache_ == slots_.size ())
+            return (nullptr);
+        }
+        return (&slots_[tail & mask_]);
+      }
+
+      /** \brief Producer side: make the slot obtained with getWriteSlot () visible to the consumer. */
+      void
+      publish ()
+      {
+        tail_.store (tail_.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+      /** \brief Producer side: copy data in the queue.
+        * \return false if the queue is full
+        */
+      bool
+      push (const T& data)
+      {
+        T* slot = getWriteSlot ();
+        if (!slot)
+          return (false);
+        *slot = data;
+        publish ();
+        return (true);
+      }
+
+      /** \brief Consumer side: get the oldest published slot, or nullptr if the queue is empty. */
+      T*
+      getReadSlot ()
+      {
+        const std::size_t head = head_.load (std::memory_order_relaxed);
+        if (head == tail_cache_)
+        {
+          tail_cache_ = tail_.load (std::memory_order_acquire);
+          if (head == tail_cache_)
+            return (nullptr);
+        }
+        return (&slots_[head & mask_]);
+      }
+
+      /** \brief Consumer side: give the slot obtained with getReadSlot () back to the producer. */
+      void
+      release ()
+      {
+        head_.store (head_.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+      /** \brief Consumer side: move the oldest element out of the queue.
+        * \return false if the queue is empty
+        */
+      bool
+      pop (T& result)
+      {
+        T* slot = getReadSlot ();
+        if (!slot)
+          return (false);
+        result = *slot;
+        release ();
+        return (true);
+      }
+
+      /** \brief Number of slots of the queue. */
+      std::size_t
+      capacity () const
+      {
+        return (slots_.size ());
+      }
+
+      /** \brief Approximate number of elements, exact when neither side is active. */
+      std::size_t
+      size () const
+      {
+        return (tail_.load (std::memory_order_acquire) - head_.load (std::memory_order_acquire));
+      }
+
+      bool
+      isEmpty () const
+      {
+        return (size () == 0);
+      }
+
+    private:
+      static constexpr std::size_t cache_line_size_ = 64;
+
+      std::vector<T> slots_;
+      std::size_t mask_;
+
+      // The consumer and producer indices live on separate cache lines, each next to
+      // the copy of the other index its owner last observed.
+      char pad0_[cache_line_size_];
+      std::atomic<std::size_t> head_{0};
+      std::size_t tail_cache_{0};
+      char pad1_[cache_line_size_ - sizeof (std::atomic<std::size_t>) - sizeof (std::size_t)];
+      std::atomic<std::size_t> tail_{0};
+      std::size_t head_cache_{0};
+      char pad2_[cache_line_size_ - sizeof (std::atomic<std::size_t>) - sizeof (std::size_t)];
+  };
+}
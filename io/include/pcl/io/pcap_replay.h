@@ -0,0 +1,160 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+
+#include <boost/asio/ip/udp.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace pcl
+{
+  /** \brief Replay the UDP packets of a pcap capture, paced by their capture timestamps.
+    *
+    * The capture is memory mapped and read ahead of the replay position, so that the
+    * replay is not slowed down by disk accesses. Packets are delivered at
+    *
+    *   start time + (capture timestamp - first capture timestamp) / rate
+    *
+    * on a monotonic clock. The schedule is absolute: a late packet does not delay the
+    * following ones, so the replay does not drift. With a rate of 0, packets are
+    * delivered as fast as the callback accepts them.
+    *
+    * Only the classic pcap format (micro or nanosecond timestamps, either byte order) is
+    * supported, with Ethernet (optionally VLAN tagged), Linux cooked or raw IP link
+    * layers. Only unfragmented IPv4 UDP packets are delivered.
+    * \ingroup io
+    */
+  class PCL_EXPORTS PcapReplay
+  {
+    public:
+      /** \brief Callback receiving the UDP payload of each packet.
+        * \param[in] payload the UDP payload, valid for the duration of the call
+        * \param[in] size the size of the payload in bytes
+        * \param[in] timestamp the capture timestamp of the packet, in nanoseconds since the epoch
+        * \param[in] source the sender of the packet
+        */
+      using PacketCallback = std::function<void (const std::uint8_t *payload, std::size_t size,
+                                                 std::uint64_t timestamp,
+                                                 const boost::asio::ip::udp::endpoint &source)>;
+
+      PcapReplay () = default;
+
+      PcapReplay (const PcapReplay&) = delete;
+      PcapReplay& operator= (const PcapReplay&) = delete;
+
+      ~PcapReplay ();
+
+      /** \brief Map a pcap file.
+        * \param[in] file_name the name of the capture
+        * \return
+        *  * < 0 (-1) on error (also if the file is not a classic pcap capture)
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name);
+
+      /** \brief Unmap the file. */
+      void
+      close ();
+
+      /** \brief Whether a file is mapped. */
+      inline bool
+      isOpen () const
+      {
+        return (map_ != nullptr);
+      }
+
+      /** \brief Set the replay rate.
+        * \param[in] rate 1 replays in real time (default), 2 twice as fast, 0.5 at half
+        * speed, and 0 as fast as possible
+        */
+      inline void
+      setRate (double rate)
+      {
+        rate_ = (rate > 0.0) ? rate : 0.0;
+      }
+
+      /** \brief Get the replay rate, 0 meaning as fast as possible. */
+      inline double
+      getRate () const
+      {
+        return (rate_);
+      }
+
+      /** \brief Replay the capture from the start, blocking until its end or until stop () is called.
+        * \param[in] callback the function receiving the packets, called from this thread
+        * \return the number of delivered packets
+        */
+      std::size_t
+      replay (const PacketCallback &callback);
+
+      /** \brief Interrupt the current replay. Can be called from any thread.
+        * The capture has to be opened again before it can be replayed anew.
+        */
+      inline void
+      stop ()
+      {
+        stop_ = true;
+      }
+
+    private:
+      /** \brief Read ahead of \a position, and release what was already replayed. */
+      void
+      prefetch (std::size_t position);
+
+      std::uint8_t *map_{nullptr};
+      std::size_t map_size_{0};
+#ifdef _WIN32
+      void *file_mapping_{nullptr};
+#endif
+      /** \brief Whether the headers are in the opposite byte order of this machine. */
+      bool swap_{false};
+      /** \brief Whether the timestamps have a nanosecond resolution, microsecond otherwise. */
+      bool nanoseconds_{false};
+      std::uint32_t link_type_{0};
+      /** \brief End of the range read ahead so far. */
+      std::size_t prefetched_{0};
+      double rate_{1.0};
+      std::atomic<bool> stop_{false};
+  };
+}
@@ -43,8 +43,12 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/point_cloud.h>
 #include <pcl/io/file_io.h>
+#include <pcl/io/pcd_view.h>
 #include <boost/interprocess/sync/file_lock.hpp> // for file_lock
 
+#include <algorithm>
+#include <limits>
+
 namespace pcl
 {
   /** \brief Point Cloud Data (PCD) file format reader.
@@ -59,6 +63,19 @@ namespace pcl
       /** Empty destructor */
       ~PCDReader () override = default;
 
+      /** \brief Set the number of threads used to decompress chunked binary compressed files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to decompress chunked binary compressed files. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Various PCD file versions.
         *
         * PCD_V6 represents PCD files with version 0.6, which contain the following fields:
@@ -102,7 +119,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed)
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed in chunks)
         * \param[out] data_idx the offset of cloud data within the file
         *
         * \return
@@ -130,7 +147,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed)
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed in chunks)
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -215,6 +232,30 @@ namespace pcl
       readBodyBinary (const unsigned char *data, pcl::PCLPointCloud2 &cloud,
                        int pcd_version, bool compressed, unsigned int data_idx);
 
+      /** \brief Read the point cloud data (body) of a chunked binary compressed PCD from a block of memory.
+        *
+        * For use after readHeader(), when the resulting data_type == 3. Only the chunks
+        * which contain the requested points are decompressed, in parallel (see
+        * \ref setNumberOfThreads). When only a part of the points is requested, cloud
+        * becomes an unorganized cloud of these points.
+        *
+        * \param[in] data the memory location from which to read the body.
+        * \param[in] data_size the number of bytes available at data.
+        * \param[out] cloud the resultant point cloud dataset to be filled.
+        * \param[in] data_idx the offset of the body, as reported by readHeader().
+        * \param[in] first_point the index of the first point to read.
+        * \param[in] nr_points the number of points to read (clamped to the number of points after first_point).
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readBodyBinaryCompressedChunked (const unsigned char *data, std::size_t data_size,
+                                       pcl::PCLPointCloud2 &cloud, unsigned int data_idx,
+                                       std::size_t first_point = 0,
+                                       std::size_t nr_points = std::numeric_limits<std::size_t>::max ());
+
       /** \brief Read a point cloud data from a PCD file and store it into a pcl/PCLPointCloud2.
         * \param[in] file_name the name of the file containing the actual PointCloud data
         * \param[out] cloud the resultant PointCloud message read from disk
@@ -288,7 +329,64 @@ namespace pcl
         return (res);
       }
 
+      /** \brief Map a binary PCD file into a read-only view, without copying its points.
+        *
+        * Only the header is parsed. The points are read lazily from the mapping through
+        * the view, see \ref PCDCloudView and \ref PCDPointView.
+        *
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[out] view the resultant view of the file
+        * \param[in] offset the offset of where to expect the PCD Header in the
+        * file (optional parameter), see \ref read
+        *
+        * \return
+        *  * < 0 (-1) on error, e.g. for ASCII and binary compressed files
+        *  * == 0 on success
+        */
+      int
+      read (const std::string &file_name, pcl::PCDCloudView &view, const int offset = 0);
+
+      /** \brief Read a subset of the fields and/or a range of the points of a PCD file.
+        *
+        * Only the requested fields are stored in cloud, packed in the order of
+        * field_names. For binary files only the bytes of the requested points
+        * are mapped, and for chunked binary compressed files only the chunks
+        * holding them are decompressed. Binary compressed files are decompressed
+        * as a whole, but only the planes of the requested fields are unpacked.
+        * ASCII files are read entirely.
+        *
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[out] cloud the resultant point cloud, organized only when all
+        * the points are requested
+        * \param[in] field_names the names of the fields to read (all the fields but
+        * the padding ones if empty)
+        * \param[in] first_point the index of the first point to read
+        * \param[in] nr_points the number of points to read (clamped to the number of points after first_point)
+        * \param[in] offset the offset of where to expect the PCD Header in the
+        * file (optional parameter), see \ref read
+        *
+        * \return
+        *  * < 0 (-1) on error, e.g. if a field is not in the file
+        *  * == 0 on success
+        */
+      int
+      readPartial (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
+                   const std::vector<std::string> &field_names,
+                   std::size_t first_point = 0,
+                   std::size_t nr_points = std::numeric_limits<std::size_t>::max (),
+                   const int offset = 0);
+
       PCL_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+      /** \brief Parse a PCD header like \ref readHeader, but without allocating cloud.data. */
+      int
+      parseHeader (std::istream &binary_istream, pcl::PCLPointCloud2 &cloud,
+                   Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, int &pcd_version,
+                   int &data_type, unsigned int &data_idx);
+
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
   };
 
   /** \brief Point Cloud Data (PCD) file format writer.
@@ -315,6 +413,57 @@ namespace pcl
         map_synchronization_ = sync;
       }
 
+      /** \brief Set the number of threads used to compress the chunks of
+        * \ref writeBinaryCompressedChunked.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to compress the chunks of \ref writeBinaryCompressedChunked. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
+      /** \brief Set the number of points per chunk of \ref writeBinaryCompressedChunked.
+        * Smaller chunks allow reading smaller ranges of points, at the expense of compression ratio.
+        * Default: 65536
+        * \param[in] nr_points the number of points per chunk
+        */
+      inline void
+      setCompressionChunkSize (unsigned int nr_points)
+      {
+        chunk_size_ = std::max (nr_points, 1u);
+      }
+
+      /** \brief Get the number of points per chunk of \ref writeBinaryCompressedChunked. */
+      inline unsigned int
+      getCompressionChunkSize () const
+      {
+        return (chunk_size_);
+      }
+
+      /** \brief Set whether the uncompressed binary writers pad the header with a comment line, so
+        * that the binary data starts at a multiple of 32 bytes in the file. This lets \ref PCDCloudView
+        * hand out typed pointers into the memory mapped data. Readers skip the comment line.
+        * Default: false
+        * \param[in] align set to true to align the binary data
+        */
+      inline void
+      setAlignBinaryData (bool align)
+      {
+        align_binary_data_ = align;
+      }
+
+      /** \brief Get whether the uncompressed binary writers align the binary data. */
+      inline bool
+      getAlignBinaryData () const
+      {
+        return (align_binary_data_);
+      }
+
       /** \brief Generate the header of a PCD file format
         * \param[in] cloud the point cloud data message
         * \param[in] origin the sensor acquisition origin
@@ -325,6 +474,14 @@ namespace pcl
                             const Eigen::Vector4f &origin,
                             const Eigen::Quaternionf &orientation);
 
+      /** \brief Generate the DATA line of an uncompressed binary PCD file. If \ref setAlignBinaryData
+        * is on, it is preceded by a comment line that pads the header, so that the binary data starts
+        * at a multiple of 32 bytes in the file.
+        * \param[in] header_size the number of bytes written before the DATA line
+        */
+      std::string
+      generateDataLineBinary (std::size_t header_size) const;
+
       /** \brief Generate the header of a BINARY_COMPRESSED PCD file format
         * \param[out] os the stream into which to write the header
         * \param[in] cloud the point cloud data message
@@ -444,6 +601,43 @@ namespace pcl
                              const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
                              const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
 
+      /** \brief Save point cloud data to a PCD file containing n-D points, in chunked BINARY_COMPRESSED format
+        *
+        * The points are split into chunks of \ref getCompressionChunkSize points, which
+        * are compressed independently, in parallel (see \ref setNumberOfThreads), and
+        * indexed by their offset in the file. Unlike \ref writeBinaryCompressed, the size
+        * of the data is not limited to 4 GB, and readers can decompress the chunks in
+        * parallel or decompress only the chunks of a range of points.
+        *
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data message
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        * \return
+        * (-1) for a general error
+        * (-2) if a chunk is too large for the file format
+        * 0 on success
+        */
+      int
+      writeBinaryCompressedChunked (const std::string &file_name, const pcl::PCLPointCloud2 &cloud,
+                                    const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+                                    const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
+      /** \brief Save point cloud data to a std::ostream containing n-D points, in chunked BINARY_COMPRESSED format
+        * \param[out] os the stream into which to write the data
+        * \param[in] cloud the point cloud data message
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        * \return
+        * (-1) for a general error
+        * (-2) if a chunk is too large for the file format
+        * 0 on success
+        */
+      int
+      writeBinaryCompressedChunked (std::ostream &os, const pcl::PCLPointCloud2 &cloud,
+                                    const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+                                    const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
       /** \brief Save point cloud data to a PCD file containing n-D points
         * \param[in] file_name the output file name
         * \param[in] cloud the point cloud data message
@@ -616,6 +810,15 @@ namespace pcl
     private:
       /** \brief Set to true if msync() should be called before munmap(). Prevents data loss on NFS systems. */
       bool map_synchronization_{false};
+
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
+
+      /** \brief The number of points per chunk of the chunked binary compressed format. */
+      unsigned int chunk_size_{65536};
+
+      /** \brief Set to true if the binary data is aligned to 32 bytes in the file. */
+      bool align_binary_data_{false};
   };
 
   namespace io
@@ -665,6 +868,18 @@ namespace pcl
       return (p.read (file_name, cloud));
     }
 
+    /** \brief Map a binary PCD file into a read-only view, without copying its points.
+      * \param[in] file_name the name of the file to map
+      * \param[out] view the resultant view of the file
+      * \ingroup io
+      */
+    inline int
+    loadPCDFile (const std::string &file_name, pcl::PCDCloudView &view)
+    {
+      pcl::PCDReader p;
+      return (p.read (file_name, view));
+    }
+
     /** \brief Save point cloud data to a PCD file containing n-D points
       * \param[in] file_name the output file name
       * \param[in] cloud the point cloud data message
@@ -0,0 +1,354 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/conversions.h>
+#include <pcl/point_cloud.h>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/type_traits.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace pcl
+{
+  class PCDReader;
+
+  /** \brief Read-only view of the points of a binary PCD file, backed by a memory mapping of the file.
+    *
+    * Unlike PCDReader::read (), which copies the whole body of the file into
+    * PCLPointCloud2::data, the view only parses the header and maps the file. Points and
+    * fields are read lazily from the mapping, so that pages which are never accessed are
+    * never loaded, and the memory used by the mapped pages can be reclaimed by the
+    * operating system at any time.
+    *
+    * Copies of a view share the same mapping, which is released when the last copy is
+    * destroyed or closed. The file must not be modified while it is mapped.
+    *
+    * \note Only uncompressed binary files (DATA binary) can be viewed, as ASCII and
+    * binary_compressed files do not store the points in their in-memory layout.
+    * \ingroup io
+    */
+  class PCL_EXPORTS PCDCloudView
+  {
+    public:
+      using Ptr = shared_ptr<PCDCloudView>;
+      using ConstPtr = shared_ptr<const PCDCloudView>;
+
+      /** \brief Empty constructor. Use PCDReader::read () or \ref open to map a file. */
+      PCDCloudView () = default;
+
+      /** \brief Map a PCD file.
+        * \param[in] file_name the name of the file to map
+        * \param[in] offset the offset of where to expect the PCD header in the file
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name, const int offset = 0);
+
+      /** \brief Release this view of the mapping. The file is unmapped once no view uses it anymore. */
+      void
+      close ();
+
+      /** \brief Whether a file is mapped. */
+      inline bool
+      isOpen () const
+      {
+        return (static_cast<bool> (mapping_));
+      }
+
+      /** \brief Get the meta information of the file: width, height, point_step, row_step and fields.
+        * \note The data vector is empty, and is_dense is not computed as it would require to
+        * read every point.
+        */
+      inline const pcl::PCLPointCloud2&
+      getHeader () const
+      {
+        return (header_);
+      }
+
+      /** \brief Get the sensor acquisition origin. */
+      inline const Eigen::Vector4f&
+      getOrigin () const
+      {
+        return (origin_);
+      }
+
+      /** \brief Get the sensor acquisition orientation. */
+      inline const Eigen::Quaternionf&
+      getOrientation () const
+      {
+        return (orientation_);
+      }
+
+      /** \brief Get the number of points. */
+      inline std::size_t
+      size () const
+      {
+        return (static_cast<std::size_t> (header_.width) * header_.height);
+      }
+
+      /** \brief Whether the view contains no points. */
+      inline bool
+      empty () const
+      {
+        return (size () == 0);
+      }
+
+      /** \brief Get the width of the cloud. */
+      inline uindex_t
+      width () const
+      {
+        return (header_.width);
+      }
+
+      /** \brief Get the height of the cloud. */
+      inline uindex_t
+      height () const
+      {
+        return (header_.height);
+      }
+
+      /** \brief Get the mapped body of the file, i.e. size () * getHeader ().point_step bytes. */
+      inline const std::uint8_t*
+      getData () const
+      {
+        return (data_);
+      }
+
+      /** \brief Get the mapped bytes of a point.
+        * \param[in] index the index of the point
+        */
+      inline const std::uint8_t*
+      getPointData (std::size_t index) const
+      {
+        return (data_ + index * header_.point_step);
+      }
+
+      /** \brief Get the index of a field in getHeader ().fields, or -1 if the file has no such field.
+        * \param[in] field_name the name of the field
+        */
+      int
+      getFieldIndex (const std::string &field_name) const;
+
+      /** \brief Read one element of a field of a point, converted to T.
+        * \param[in] index the index of the point
+        * \param[in] field_index the index of the field, see \ref getFieldIndex
+        * \param[in] element the element of the field, for fields with a count greater than 1
+        */
+      template <typename T> T
+      getFieldValue (std::size_t index, std::size_t field_index, uindex_t element = 0) const;
+
+      /** \brief Whether the records of the file have exactly the memory layout of PointT, in
+        * which case the view can be accessed as an array of PointT without any conversion.
+        * Padding bytes are ignored, and rgb fields match both as float and as unsigned integer.
+        */
+      template <typename PointT> bool
+      isLayoutCompatible () const;
+
+      /** \brief Get the points as an array of PointT, without any copy.
+        * \return the points, or nullptr if the layout of the file does not match PointT (see
+        * \ref isLayoutCompatible) or if the body of the file is not suitably aligned for PointT.
+        * PCDWriter::writeBinary aligns the body to 32 bytes if PCDWriter::setAlignBinaryData is on.
+        */
+      template <typename PointT> const PointT*
+      getPoints () const;
+
+    protected:
+      /** \brief Memory mapping of a file, unmapped on destruction. */
+      struct Mapping;
+
+      /** \brief Map the first map_size bytes of a file.
+        * \param[in] file_name the name of the file to map
+        * \param[in] map_size the number of bytes to map
+        * \param[in] data_offset the position of the body of the file
+        */
+      int
+      map (const std::string &file_name, std::size_t map_size, std::size_t data_offset);
+
+      /** \brief The mapping of the file, shared by all copies of the view. */
+      shared_ptr<const Mapping> mapping_;
+
+      /** \brief The body of the file, within the mapping. */
+      const std::uint8_t *data_{nullptr};
+
+      /** \brief The meta information of the file, without data. */
+      pcl::PCLPointCloud2 header_;
+
+      /** \brief The sensor acquisition origin. */
+      Eigen::Vector4f origin_{Eigen::Vector4f::Zero ()};
+
+      /** \brief The sensor acquisition orientation. */
+      Eigen::Quaternionf orientation_{Eigen::Quaternionf::Identity ()};
+
+      friend class PCDReader;
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief Typed, read-only view of the points of a binary PCD file.
+    *
+    * If the records of the file have the layout of PointT and are suitably aligned, the
+    * points are accessed in place (\ref isZeroCopy, \ref data). Otherwise every access
+    * converts a single point from the mapping, matching the fields by name like
+    * pcl::fromPCLPointCloud2 () does.
+    *
+    * The view keeps the mapping of the file alive.
+    * \ingroup io
+    */
+  template <typename PointT>
+  class PCDPointView
+  {
+    public:
+      using Ptr = shared_ptr<PCDPointView<PointT> >;
+      using ConstPtr = shared_ptr<const PCDPointView<PointT> >;
+
+      /** \brief Empty constructor. */
+      PCDPointView () = default;
+
+      /** \brief Constructor.
+        * \param[in] cloud the untyped view of the file
+        */
+      explicit PCDPointView (const PCDCloudView &cloud);
+
+      /** \brief Get the untyped view of the file. */
+      inline const PCDCloudView&
+      getCloudView () const
+      {
+        return (cloud_);
+      }
+
+      /** \brief Get the number of points. */
+      inline std::size_t
+      size () const
+      {
+        return (cloud_.size ());
+      }
+
+      /** \brief Whether the view contains no points. */
+      inline bool
+      empty () const
+      {
+        return (cloud_.empty ());
+      }
+
+      /** \brief Get the width of the cloud. */
+      inline uindex_t
+      width () const
+      {
+        return (cloud_.width ());
+      }
+
+      /** \brief Get the height of the cloud. */
+      inline uindex_t
+      height () const
+      {
+        return (cloud_.height ());
+      }
+
+      /** \brief Whether the points are accessed in place, without conversion. */
+      inline bool
+      isZeroCopy () const
+      {
+        return (points_ != nullptr);
+      }
+
+      /** \brief Get the points in place, or nullptr if the view is not zero copy. */
+      inline const PointT*
+      data () const
+      {
+        return (points_);
+      }
+
+      /** \brief Get a point.
+        * \param[in] index the index of the point
+        */
+      inline PointT
+      operator[] (std::size_t index) const
+      {
+        if (points_)
+          return (points_[index]);
+        return (convertPoint (index));
+      }
+
+      /** \brief Get a point of an organized cloud.
+        * \param[in] column the column of the point
+        * \param[in] row the row of the point
+        */
+      inline PointT
+      at (uindex_t column, uindex_t row) const
+      {
+        return ((*this)[static_cast<std::size_t> (row) * width () + column]);
+      }
+
+      /** \brief Copy all points into a point cloud, along with its size and viewpoint.
+        * is_dense is set to false, as it is not computed.
+        * \param[out] cloud the resultant point cloud
+        */
+      void
+      copyTo (pcl::PointCloud<PointT> &cloud) const;
+
+    protected:
+      /** \brief Convert a point of the mapping which is not accessible in place. */
+      PointT
+      convertPoint (std::size_t index) const;
+
+      /** \brief The untyped view of the file. */
+      PCDCloudView cloud_;
+
+      /** \brief The mapping between the fields of the file and the fields of PointT. */
+      MsgFieldMap field_map_;
+
+      /** \brief Whether the records of the file have the layout of PointT. */
+      bool layout_compatible_{false};
+
+      /** \brief The points in place, if accessible without conversion. */
+      const PointT *points_{nullptr};
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#include <pcl/io/impl/pcd_view.hpp>
@@ -46,6 +46,7 @@
 #include <pcl/io/ply/ply_parser.h>
 #include <pcl/PolygonMesh.h>
 
+#include <functional>
 #include <sstream>
 #include <tuple>
 
@@ -105,6 +106,8 @@ namespace pcl
         orientation_ = p.orientation_;
         range_grid_ = p.range_grid_;
         polygons_ = p.polygons_;
+        binary_fast_path_ = p.binary_fast_path_;
+        memory_mapping_ = p.memory_mapping_;
         return (*this);
       }
 
@@ -226,6 +229,52 @@ namespace pcl
       int
       read (const std::string &file_name, pcl::PolygonMesh &mesh, const int offset = 0);
 
+      /** \brief Enable or disable the fast path for binary PLY files (enabled by default).
+        *
+        * When the vertex element of a binary_little_endian or binary_big_endian
+        * file only holds scalar properties, its records have a fixed size and
+        * are copied (or byte swapped, when the file byte order differs from the
+        * host one) record by record into the cloud buffer, instead of going
+        * through the per property callbacks of the generic parser. The
+        * resulting cloud is identical to the one of the generic parser. Files
+        * which need the generic parser (ASCII files, list properties in the
+        * vertex element, range grids, ...) are always read through it.
+        * \param[in] enabled set to false to always use the generic parser
+        */
+      inline void
+      setBinaryFastPath (bool enabled) { binary_fast_path_ = enabled; }
+
+      /** \brief Get whether the fast path for binary PLY files is enabled. */
+      inline bool
+      getBinaryFastPath () const { return (binary_fast_path_); }
+
+      /** \brief Set whether the binary fast path maps the file into memory
+        * instead of streaming it through a fixed size buffer (disabled by default).
+        * \param[in] enabled set to true to memory map the file
+        */
+      inline void
+      setMemoryMapping (bool enabled) { memory_mapping_ = enabled; }
+
+      /** \brief Get whether the binary fast path maps the file into memory. */
+      inline bool
+      getMemoryMapping () const { return (memory_mapping_); }
+
+      /** \brief Read the vertices of a binary PLY file chunk by chunk, without
+        * holding the whole cloud in memory.
+        *
+        * Only files eligible for the binary fast path (see setBinaryFastPath ())
+        * can be read this way. Each chunk is an unorganized cloud of at most
+        * \a chunk_size points with the same fields as the ones read by read ().
+        * \param[in] file_name the name of the file to load
+        * \param[in] chunk_size the maximum number of points per chunk
+        * \param[in] callback function called for every chunk with the chunk and
+        * the index of its first point in the file, return false to stop reading
+        * \return 0 on success, -1 on error or if the file is not eligible
+        */
+      int
+      readChunks (const std::string &file_name, std::size_t chunk_size,
+                  const std::function<bool (const pcl::PCLPointCloud2 &chunk, std::size_t first_point)> &callback);
+
     private:
       ::pcl::io::ply::ply_parser parser_;
 
@@ -515,6 +564,9 @@ namespace pcl
       bool do_resize_{false};
       //face element artifact
       std::vector<pcl::Vertices> *polygons_{nullptr};
+      //binary fast path settings
+      bool binary_fast_path_{true};
+      bool memory_mapping_{false};
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
       
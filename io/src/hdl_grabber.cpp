@@ -36,6 +36,8 @@
  *
  */
 
+#include <chrono>
+#include <cstring>
 #include <thread>
 
 #include <pcl/console/print.h>
@@ -46,6 +48,9 @@
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/array.hpp>
 #include <boost/math/special_functions.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #ifdef HAVE_PCAP
 #include <pcap.h>
 #endif // #ifdef HAVE_PCAP
@@ -294,6 +299,31 @@ pcl::HDLGrabber::getDefaultNetworkAddress ()
 void
 pcl::HDLGrabber::processVelodynePackets ()
 {
+  if (hdl_packets_)
+  {
+    unsigned int idle_iterations = 0;
+    while (!terminate_read_packet_thread_)
+    {
+      HDLDataPacket *packet = hdl_packets_->getReadSlot ();
+      if (packet == nullptr)
+      {
+        // Nothing to decode: spin for a while, then back off to avoid burning a core
+        // between two packets (~1.8 kHz for the HDL-32)
+        if (++idle_iterations < 64)
+          std::this_thread::yield ();
+        else
+          std::this_thread::sleep_for (std::chrono::microseconds (100));
+        continue;
+      }
+      idle_iterations = 0;
+
+      toPointClouds (packet);
+
+      hdl_packets_->release ();
+    }
+    return;
+  }
+
   while (true)
   {
     std::uint8_t *data;
@@ -315,9 +345,9 @@ pcl::HDLGrabber::toPointClouds (HDLDataPacket *dataPacket)
   if (sizeof(HDLLaserReturn) != 3)
     return;
 
-  current_scan_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-  current_scan_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-  current_scan_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
+  current_scan_xyz_ = scan_xyz_pool_.get ();
+  current_scan_xyzrgba_ = scan_xyzrgba_pool_.get ();
+  current_scan_xyzi_ = scan_xyzi_pool_.get ();
 
   time_t system_time;
   time (&system_time);
@@ -331,8 +361,23 @@ pcl::HDLGrabber::toPointClouds (HDLDataPacket *dataPacket)
   current_scan_xyzi_->header.seq = scan_counter;
   scan_counter++;
 
-  for (const auto &firing_data : dataPacket->firingData)
+  // The firing blocks are independent of each other: decode them first, possibly in
+  // parallel, then split them into scans and sweeps in order
+  pcl::PointXYZI points[HDL_FIRING_PER_PKT][HDL_LASER_PER_FIRING];
+#pragma omp parallel for \
+  num_threads(threads_) \
+  if(threads_ > 1)
+  for (int i = 0; i < HDL_FIRING_PER_PKT; ++i)
   {
+    const HDLFiringData &firing_data = dataPacket->firingData[i];
+    const std::uint8_t offset = (firing_data.blockIdentifier == BLOCK_0_TO_31) ? 0 : 32;
+    for (std::uint8_t j = 0; j < HDL_LASER_PER_FIRING; j++)
+      computeXYZI (points[i][j], firing_data.rotationalPosition, firing_data.laserReturns[j], laser_corrections_[j + offset]);
+  }
+
+  for (std::uint8_t i = 0; i < HDL_FIRING_PER_PKT; ++i)
+  {
+    const HDLFiringData &firing_data = dataPacket->firingData[i];
     std::uint8_t offset = (firing_data.blockIdentifier == BLOCK_0_TO_31) ? 0 : 32;
 
     for (std::uint8_t j = 0; j < HDL_LASER_PER_FIRING; j++)
@@ -353,16 +398,14 @@ pcl::HDLGrabber::toPointClouds (HDLDataPacket *dataPacket)
 
           fireCurrentSweep ();
         }
-        current_sweep_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-        current_sweep_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-        current_sweep_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
+        current_sweep_xyz_ = sweep_xyz_pool_.get ();
+        current_sweep_xyzrgba_ = sweep_xyzrgba_pool_.get ();
+        current_sweep_xyzi_ = sweep_xyzi_pool_.get ();
       }
 
       PointXYZ xyz;
-      PointXYZI xyzi;
       PointXYZRGBA xyzrgba;
-
-      computeXYZI (xyzi, firing_data.rotationalPosition, firing_data.laserReturns[j], laser_corrections_[j + offset]);
+      const PointXYZI &xyzi = points[i][j];
 
       xyz.x = xyzrgba.x = xyzi.x;
       xyz.y = xyzrgba.y = xyzi.y;
@@ -468,10 +511,36 @@ pcl::HDLGrabber::fireCurrentScan (const std::uint16_t startAngle,
 /////////////////////////////////////////////////////////////////////////////
 void
 pcl::HDLGrabber::enqueueHDLPacket (const std::uint8_t *data,
-                                   std::size_t bytesReceived)
+                                   std::size_t bytesReceived,
+                                   bool waitForSpace)
 {
+  // Bound of the default queue when waiting for space
+  const unsigned int max_queued_packets = 4096;
+
   if (bytesReceived == 1206)
   {
+    if (hdl_packets_)
+    {
+      HDLDataPacket *packet = hdl_packets_->getWriteSlot ();
+      while (packet == nullptr && waitForSpace && !terminate_read_packet_thread_)
+      {
+        std::this_thread::yield ();
+        packet = hdl_packets_->getWriteSlot ();
+      }
+      if (packet == nullptr)
+      {
+        if (!waitForSpace)
+          ++dropped_packets_;
+        return;
+      }
+      std::memcpy (packet, data, bytesReceived);
+      hdl_packets_->publish ();
+      return;
+    }
+
+    while (waitForSpace && hdl_data_.size () >= max_queued_packets && !terminate_read_packet_thread_)
+      std::this_thread::sleep_for (std::chrono::microseconds (100));
+
     auto *dup = static_cast<std::uint8_t *> (malloc (bytesReceived * sizeof(std::uint8_t)));
     std::copy(data, data + bytesReceived, dup);
 
@@ -484,6 +553,7 @@ void
 pcl::HDLGrabber::start ()
 {
   terminate_read_packet_thread_ = false;
+  read_packet_thread_done_ = false;
 
   if (isRunning ())
     return;
@@ -522,9 +592,7 @@ pcl::HDLGrabber::start ()
   }
   else
   {
-#ifdef HAVE_PCAP
-    hdl_read_packet_thread_ = new std::thread (&HDLGrabber::readPacketsFromPcap, this);
-#endif // #ifdef HAVE_PCAP
+    hdl_read_packet_thread_ = new std::thread (&HDLGrabber::replayPcapFile, this);
   }
 }
 
@@ -534,6 +602,7 @@ pcl::HDLGrabber::stop ()
 {
   // triggers the exit condition
   terminate_read_packet_thread_ = true;
+  pcap_replay_.stop ();
   hdl_data_.stopQueue ();
 
   if (hdl_read_socket_ != nullptr)
@@ -563,6 +632,13 @@ pcl::HDLGrabber::stop ()
     queue_consumer_thread_ = nullptr;
   }
 
+  // Both threads are gone: discard what was not decoded, as the default queue does
+  if (hdl_packets_)
+  {
+    while (hdl_packets_->getReadSlot () != nullptr)
+      hdl_packets_->release ();
+  }
+
   delete hdl_read_socket_;
   hdl_read_socket_ = nullptr;
 }
@@ -571,7 +647,8 @@ pcl::HDLGrabber::stop ()
 bool
 pcl::HDLGrabber::isRunning () const
 {
-  return (!hdl_data_.isEmpty () || hdl_read_packet_thread_);
+  return (!hdl_data_.isEmpty () || (hdl_packets_ && !hdl_packets_->isEmpty ()) ||
+          (hdl_read_packet_thread_ && !read_packet_thread_done_));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -650,6 +727,86 @@ pcl::HDLGrabber::getMaximumNumberOfLasers () const
     return (HDL_MAX_NUM_LASERS);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::setLockFreeQueueCapacity (std::size_t capacity)
+{
+  if (queue_consumer_thread_ != nullptr)
+  {
+    PCL_WARN ("[pcl::HDLGrabber::setLockFreeQueueCapacity] The queue cannot be changed while the grabber is running.\n");
+    return;
+  }
+  if (capacity == 0)
+    hdl_packets_.reset ();
+  else
+    hdl_packets_.reset (new pcl::SPSCQueue<HDLDataPacket> (capacity));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::HDLGrabber::getLockFreeQueueCapacity () const
+{
+  return (hdl_packets_ ? hdl_packets_->capacity () : 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::HDLGrabber::getNumberOfDroppedPackets () const
+{
+  return (dropped_packets_);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::setPcapReplayRate (double rate)
+{
+  pcap_replay_.setRate (rate);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+double
+pcl::HDLGrabber::getPcapReplayRate () const
+{
+  return (pcap_replay_.getRate ());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::setCloudRecycling (bool enabled)
+{
+  recycle_clouds_ = enabled;
+  scan_xyz_pool_.setEnabled (enabled);
+  scan_xyzi_pool_.setEnabled (enabled);
+  scan_xyzrgba_pool_.setEnabled (enabled);
+  sweep_xyz_pool_.setEnabled (enabled);
+  sweep_xyzi_pool_.setEnabled (enabled);
+  sweep_xyzrgba_pool_.setEnabled (enabled);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+bool
+pcl::HDLGrabber::getCloudRecycling () const
+{
+  return (recycle_clouds_);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::HDLGrabber::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::HDLGrabber::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif // _OPENMP
+}
+
 /////////////////////////////////////////////////////////////////////////////
 void
 pcl::HDLGrabber::readPacketsFromSocket ()
@@ -678,6 +835,37 @@ pcl::HDLGrabber::readPacketsFromSocket ()
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::replayPcapFile ()
+{
+  if (pcap_replay_.open (pcap_file_name_) != 0)
+  {
+#ifdef HAVE_PCAP
+    // Captures the replay engine cannot read (e.g. pcapng) are still played in real time by libpcap
+    PCL_WARN ("[pcl::HDLGrabber::replayPcapFile] Falling back to libpcap, the replay rate is ignored.\n");
+    readPacketsFromPcap ();
+#endif // #ifdef HAVE_PCAP
+    read_packet_thread_done_ = true;
+    return;
+  }
+  // stop () may have been called before the capture was opened
+  if (terminate_read_packet_thread_)
+    return;
+
+  pcap_replay_.replay ([this] (const std::uint8_t *payload, std::size_t size, std::uint64_t,
+                               const udp::endpoint &source)
+  {
+    if (isAddressUnspecified (source_address_filter_)
+        || (source_address_filter_ == source.address () && source_port_filter_ == source.port ()))
+    {
+      enqueueHDLPacket (payload, size, true);
+    }
+  });
+  pcap_replay_.close ();
+  read_packet_thread_done_ = true;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 #ifdef HAVE_PCAP
 void
@@ -0,0 +1,321 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/console/print.h>
+#include <pcl/io/low_level_io.h>
+#include <pcl/io/pcap_replay.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+  const std::size_t pcap_file_header_size = 24;
+  const std::size_t pcap_record_header_size = 16;
+  /** \brief How far ahead of the replay position the capture is read. */
+  const std::size_t pcap_prefetch_size = 16 * 1024 * 1024;
+  /** \brief Longest uninterrupted sleep, so that stop () is honored quickly. */
+  const std::chrono::milliseconds pcap_max_sleep (10);
+
+  enum PcapLinkType
+  {
+    LINKTYPE_ETHERNET = 1,
+    LINKTYPE_RAW = 101,
+    LINKTYPE_LINUX_SLL = 113
+  };
+
+  inline std::uint32_t
+  readUInt32 (const std::uint8_t *data, bool swap)
+  {
+    std::uint32_t value;
+    std::memcpy (&value, data, sizeof (value));
+    if (swap)
+      value = ((value & 0x000000ffu) << 24) | ((value & 0x0000ff00u) << 8) |
+              ((value & 0x00ff0000u) >> 8)  | ((value & 0xff000000u) >> 24);
+    return (value);
+  }
+
+  /** \brief Network byte order. */
+  inline std::uint16_t
+  readBigEndian16 (const std::uint8_t *data)
+  {
+    return (static_cast<std::uint16_t> ((data[0] << 8) | data[1]));
+  }
+
+  /** \brief Find the IP header of a captured frame.
+    * \return false if the frame does not carry IPv4
+    */
+  bool
+  getIPv4Offset (const std::uint8_t *frame, std::size_t size, std::uint32_t link_type, std::size_t &offset)
+  {
+    std::uint16_t ether_type = 0;
+    switch (link_type)
+    {
+      case LINKTYPE_ETHERNET:
+        offset = 14;
+        if (size < offset)
+          return (false);
+        ether_type = readBigEndian16 (frame + 12);
+        // 802.1Q / 802.1ad tags
+        while ((ether_type == 0x8100 || ether_type == 0x88a8) && size >= offset + 4)
+        {
+          ether_type = readBigEndian16 (frame + offset + 2);
+          offset += 4;
+        }
+        break;
+      case LINKTYPE_LINUX_SLL:
+        offset = 16;
+        if (size < offset)
+          return (false);
+        ether_type = readBigEndian16 (frame + 14);
+        break;
+      case LINKTYPE_RAW:
+        offset = 0;
+        return (size > 0 && (frame[0] >> 4) == 4);
+      default:
+        return (false);
+    }
+    return (ether_type == 0x0800);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::PcapReplay::~PcapReplay ()
+{
+  close ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PcapReplay::open (const std::string &file_name)
+{
+  close ();
+
+  int fd = io::raw_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::PcapReplay::open] Failure to open file %s\n", file_name.c_str ());
+    return (-1);
+  }
+  const std::size_t file_size = io::raw_lseek (fd, 0, SEEK_END);
+  io::raw_lseek (fd, 0, SEEK_SET);
+  if (file_size < pcap_file_header_size)
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PcapReplay::open] File %s is too small to be a pcap capture.\n", file_name.c_str ());
+    return (-1);
+  }
+
+#ifdef _WIN32
+  HANDLE file_mapping = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  std::uint8_t *map = nullptr;
+  if (file_mapping != NULL)
+  {
+    map = static_cast<std::uint8_t*> (MapViewOfFile (file_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (map == NULL)
+      CloseHandle (file_mapping);
+  }
+  io::raw_close (fd);
+  if (map == nullptr)
+  {
+    PCL_ERROR ("[pcl::PcapReplay::open] Error mapping view of file, %s\n", file_name.c_str ());
+    return (-1);
+  }
+  file_mapping_ = file_mapping;
+#else
+  auto *map = static_cast<std::uint8_t*> (::mmap (nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0));
+  // The mapping stays valid after the file descriptor is closed
+  io::raw_close (fd);
+  if (map == reinterpret_cast<std::uint8_t*> (-1))    // MAP_FAILED
+  {
+    PCL_ERROR ("[pcl::PcapReplay::open] Error preparing mmap for file %s: %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  ::madvise (map, file_size, MADV_SEQUENTIAL);
+#endif
+  map_ = map;
+  map_size_ = file_size;
+  stop_ = false;
+
+  const std::uint32_t magic = readUInt32 (map_, false);
+  switch (magic)
+  {
+    case 0xa1b2c3d4: swap_ = false; nanoseconds_ = false; break;
+    case 0xd4c3b2a1: swap_ = true;  nanoseconds_ = false; break;
+    case 0xa1b23c4d: swap_ = false; nanoseconds_ = true;  break;
+    case 0x4d3cb2a1: swap_ = true;  nanoseconds_ = true;  break;
+    default:
+      PCL_ERROR ("[pcl::PcapReplay::open] File %s is not a pcap capture (pcapng captures are not supported).\n", file_name.c_str ());
+      close ();
+      return (-1);
+  }
+
+  link_type_ = readUInt32 (map_ + 20, swap_) & 0x0fffffff;
+  if (link_type_ != LINKTYPE_ETHERNET && link_type_ != LINKTYPE_LINUX_SLL && link_type_ != LINKTYPE_RAW)
+  {
+    PCL_ERROR ("[pcl::PcapReplay::open] Unsupported link layer type %u in file %s.\n", link_type_, file_name.c_str ());
+    close ();
+    return (-1);
+  }
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PcapReplay::close ()
+{
+  if (!map_)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile (map_);
+  CloseHandle (static_cast<HANDLE> (file_mapping_));
+  file_mapping_ = nullptr;
+#else
+  if (::munmap (map_, map_size_) == -1)
+    PCL_ERROR ("[pcl::PcapReplay::close] Munmap failure\n");
+#endif
+  map_ = nullptr;
+  map_size_ = 0;
+  prefetched_ = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PcapReplay::prefetch (std::size_t position)
+{
+  if (position + pcap_prefetch_size / 2 < prefetched_ || prefetched_ >= map_size_)
+    return;
+#ifndef _WIN32
+  const std::size_t page_size = static_cast<std::size_t> (::sysconf (_SC_PAGESIZE));
+  const std::size_t begin = (prefetched_ / page_size) * page_size;
+  const std::size_t end = std::min (map_size_, position + pcap_prefetch_size);
+  ::madvise (map_ + begin, end - begin, MADV_WILLNEED);
+
+  // The pages already replayed will not be needed again: keep the resident size bounded
+  // for long captures
+  const std::size_t done = (position / page_size) * page_size;
+  if (done > pcap_prefetch_size)
+    ::madvise (map_, done - pcap_prefetch_size, MADV_DONTNEED);
+  prefetched_ = end;
+#else
+  prefetched_ = std::min (map_size_, position + pcap_prefetch_size);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::PcapReplay::replay (const PacketCallback &callback)
+{
+  if (!map_)
+  {
+    PCL_ERROR ("[pcl::PcapReplay::replay] No capture is open.\n");
+    return (0);
+  }
+
+  using Clock = std::chrono::steady_clock;
+  prefetched_ = 0;
+
+  std::size_t nr_packets = 0;
+  std::size_t position = pcap_file_header_size;
+  bool first = true;
+  std::uint64_t first_timestamp = 0;
+  Clock::time_point start;
+  while (!stop_ && position + pcap_record_header_size <= map_size_)
+  {
+    prefetch (position);
+
+    const std::uint8_t *record = map_ + position;
+    const std::uint64_t seconds = readUInt32 (record, swap_);
+    const std::uint64_t fraction = readUInt32 (record + 4, swap_);
+    const std::size_t captured_size = readUInt32 (record + 8, swap_);
+    position += pcap_record_header_size;
+    if (position + captured_size > map_size_)
+    {
+      PCL_WARN ("[pcl::PcapReplay::replay] The capture is truncated, stopping at the last complete packet.\n");
+      break;
+    }
+    const std::uint8_t *frame = map_ + position;
+    position += captured_size;
+
+    const std::uint64_t timestamp = seconds * 1000000000ull + (nanoseconds_ ? fraction : fraction * 1000ull);
+
+    // Extract the UDP payload
+    std::size_t ip_offset;
+    if (!getIPv4Offset (frame, captured_size, link_type_, ip_offset))
+      continue;
+    const std::uint8_t *ip = frame + ip_offset;
+    const std::size_t ip_size = captured_size - ip_offset;
+    if (ip_size < 20 || (ip[0] >> 4) != 4 || ip[9] != 17)
+      continue;
+    // Skip fragments: the payload would not be complete
+    if ((readBigEndian16 (ip + 6) & 0x3fff) != 0)
+      continue;
+    const std::size_t ip_header_size = (ip[0] & 0x0f) * 4;
+    if (ip_size < ip_header_size + 8)
+      continue;
+    const std::uint8_t *udp = ip + ip_header_size;
+    const std::size_t udp_size = readBigEndian16 (udp + 4);
+    if (udp_size < 8 || ip_header_size + udp_size > ip_size)
+      continue;
+
+    // Wait for the time of the packet
+    if (first)
+    {
+      first = false;
+      first_timestamp = timestamp;
+      start = Clock::now ();
+    }
+    else if (rate_ > 0.0 && timestamp > first_timestamp)
+    {
+      const auto offset = std::chrono::nanoseconds (static_cast<std::int64_t> ((timestamp - first_timestamp) / rate_));
+      const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration> (offset);
+      for (Clock::time_point now = Clock::now (); now < deadline && !stop_; now = Clock::now ())
+        std::this_thread::sleep_until (std::min (deadline, now + pcap_max_sleep));
+      if (stop_)
+        break;
+    }
+
+    const boost::asio::ip::address_v4 address ((static_cast<std::uint32_t> (ip[12]) << 24) | (ip[13] << 16) | (ip[14] << 8) | ip[15]);
+    const boost::asio::ip::udp::endpoint source (address, readBigEndian16 (udp));
+    callback (udp + 8, udp_size - 8, timestamp, source);
+    ++nr_packets;
+  }
+  return (nr_packets);
+}
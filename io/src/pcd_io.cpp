@@ -53,6 +53,296 @@
 #include <cstring>
 #include <cerrno>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+  /** \brief First value of the body of chunked binary compressed files. It is an impossible
+    * compressed size for the single block format, so that readers which do not support
+    * chunks report a corrupted file.
+    */
+  constexpr std::uint32_t pcd_chunked_marker = 0xFFFFFFFF;
+
+  /** \brief Version of the chunked binary compressed format. */
+  constexpr std::uint32_t pcd_chunked_version = 1;
+
+  /** \brief Set cloud.is_dense to false if any value of the cloud is not finite. */
+  void
+  checkIsDense (pcl::PCLPointCloud2 &cloud)
+  {
+    int point_size = (cloud.width * cloud.height == 0) ? 0 : static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
+    for (pcl::uindex_t i = 0; i < cloud.width * cloud.height; ++i)
+    {
+      for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+      {
+        for (pcl::uindex_t c = 0; c < cloud.fields[d].count; ++c)
+        {
+#define SET_CLOUD_DENSE(CASE_LABEL)                                                    \
+  case CASE_LABEL: {                                                                   \
+    if (!pcl::isValueFinite<pcl::traits::asType_t<CASE_LABEL>>(cloud, i, point_size, d, c)) \
+      cloud.is_dense = false;                                                          \
+    break;                                                                             \
+  }
+          switch (cloud.fields[d].datatype)
+          {
+            SET_CLOUD_DENSE(pcl::PCLPointField::BOOL)
+            SET_CLOUD_DENSE(pcl::PCLPointField::INT8)
+            SET_CLOUD_DENSE(pcl::PCLPointField::UINT8)
+            SET_CLOUD_DENSE(pcl::PCLPointField::INT16)
+            SET_CLOUD_DENSE(pcl::PCLPointField::UINT16)
+            SET_CLOUD_DENSE(pcl::PCLPointField::INT32)
+            SET_CLOUD_DENSE(pcl::PCLPointField::UINT32)
+            SET_CLOUD_DENSE(pcl::PCLPointField::INT64)
+            SET_CLOUD_DENSE(pcl::PCLPointField::UINT64)
+            SET_CLOUD_DENSE(pcl::PCLPointField::FLOAT32)
+            SET_CLOUD_DENSE(pcl::PCLPointField::FLOAT64)
+          }
+#undef SET_CLOUD_DENSE
+        }
+      }
+    }
+  }
+
+  /** \brief A field of a PCD file to copy into a cloud. */
+  struct PCDFieldCopy
+  {
+    /** \brief Offset of the field in a binary point. */
+    std::size_t src_offset;
+    /** \brief Offset of the field plane in binary compressed data, per point of the block. */
+    std::size_t plane_offset;
+    /** \brief Offset of the field in the cloud point. */
+    std::size_t dst_offset;
+    /** \brief Size of the field. */
+    std::size_t size;
+  };
+
+  /** \brief Get the offsets of the planes of the fields in binary compressed data,
+    * where padding fields are not stored.
+    * \return the number of bytes per point of the planes
+    */
+  std::size_t
+  getPlanesOffsets (const pcl::PCLPointCloud2 &cloud, std::vector<std::size_t> &planes_offsets)
+  {
+    std::size_t fsize = 0;
+    planes_offsets.resize (cloud.fields.size ());
+    for (std::size_t d = 0; d < cloud.fields.size (); ++d)
+    {
+      planes_offsets[d] = fsize;
+      if (cloud.fields[d].name != "_")
+        fsize += cloud.fields[d].count * pcl::getFieldSize (cloud.fields[d].datatype);
+    }
+    return (fsize);
+  }
+
+  /** \brief Copy the fields of nr_points binary points to the cloud points at out. */
+  void
+  copyPoints (const unsigned char *points, std::size_t nr_points, std::size_t point_step,
+              const std::vector<PCDFieldCopy> &copies, unsigned char *out, std::size_t out_step)
+  {
+    // Fields which follow each other in both layouts are copied at once
+    std::vector<PCDFieldCopy> merged;
+    for (const auto &copy : copies)
+    {
+      if (!merged.empty () &&
+          merged.back ().src_offset + merged.back ().size == copy.src_offset &&
+          merged.back ().dst_offset + merged.back ().size == copy.dst_offset)
+        merged.back ().size += copy.size;
+      else
+        merged.push_back (copy);
+    }
+
+    if (merged.size () == 1 && merged[0].size == point_step && point_step == out_step)
+    {
+      memcpy (out, points, nr_points * point_step);
+      return;
+    }
+    for (std::size_t i = 0; i < nr_points; ++i, points += point_step, out += out_step)
+      for (const auto &copy : merged)
+        memcpy (out + copy.dst_offset, points + copy.src_offset, copy.size);
+  }
+
+  /** \brief Copy the fields of the points [first, last) of a block of block_points
+    * binary compressed points, stored as one plane per field, to the cloud points at out.
+    */
+  void
+  unpackPlanes (const char *planes, std::size_t block_points, std::size_t first, std::size_t last,
+                const std::vector<PCDFieldCopy> &copies, unsigned char *out, std::size_t out_step)
+  {
+    for (const auto &copy : copies)
+    {
+      const char *plane = planes + copy.plane_offset * block_points + first * copy.size;
+      unsigned char *dst = out + copy.dst_offset;
+      for (std::size_t i = first; i < last; ++i, plane += copy.size, dst += out_step)
+        memcpy (dst, plane, copy.size);
+    }
+  }
+
+  /** \brief Decompress the chunks of a chunked binary compressed body which hold the
+    * points [first_point, first_point + nr_points), and copy their fields to the cloud
+    * points at out.
+    * \param[in] caller the class and method to report errors for, e.g. "pcl::PCDReader::readPartial"
+    */
+  int
+  decodeChunks (const unsigned char *map, std::size_t map_size, std::size_t data_idx,
+                std::size_t total_points, const std::vector<PCDFieldCopy> &copies, std::size_t fsize,
+                std::size_t first_point, std::size_t nr_points, unsigned char *out, std::size_t out_step,
+                unsigned int threads, const char *caller)
+  {
+    // Read the preamble and the index of the chunks
+    std::uint32_t preamble[4];
+    if (data_idx + sizeof (preamble) > map_size)
+    {
+      PCL_ERROR ("[%s] Corrupted PCD file. The file is smaller than expected!\n", caller);
+      return (-1);
+    }
+    memcpy (preamble, &map[data_idx], sizeof (preamble));
+    if (preamble[0] != pcd_chunked_marker || preamble[1] != pcd_chunked_version)
+    {
+      PCL_ERROR ("[%s] Unsupported version %u of the chunked binary compressed format.\n", caller, preamble[1]);
+      return (-1);
+    }
+    const std::size_t chunk_size = preamble[2];
+    const std::size_t nr_chunks = preamble[3];
+    if (chunk_size == 0 || nr_chunks != (total_points + chunk_size - 1) / chunk_size)
+    {
+      PCL_ERROR ("[%s] %zu chunks of %zu points do not match the %zu points of the cloud!\n", caller,
+                 nr_chunks, chunk_size, total_points);
+      return (-1);
+    }
+
+    const std::size_t index_idx = data_idx + sizeof (preamble);
+    const std::size_t chunks_idx = index_idx + (nr_chunks + 1) * sizeof (std::uint64_t);
+    if (chunks_idx > map_size)
+    {
+      PCL_ERROR ("[%s] Corrupted PCD file. The file is smaller than expected!\n", caller);
+      return (-1);
+    }
+    std::vector<std::uint64_t> offsets (nr_chunks + 1);
+    memcpy (offsets.data (), &map[index_idx], offsets.size () * sizeof (std::uint64_t));
+    for (std::size_t c = 0; c < nr_chunks; ++c)
+    {
+      if (offsets[c + 1] < offsets[c])
+      {
+        PCL_ERROR ("[%s] Corrupted index of chunks!\n", caller);
+        return (-1);
+      }
+    }
+    if (chunks_idx + offsets.back () > map_size)
+    {
+      PCL_ERROR ("[%s] Corrupted PCD file. The file is smaller than expected!\n", caller);
+      return (-1);
+    }
+
+    const std::size_t last_point = first_point + nr_points;
+    const std::size_t first_chunk = first_point / chunk_size;
+    const std::size_t end_chunk = (nr_points == 0) ? first_chunk : (last_point - 1) / chunk_size + 1;
+    int nr_failed = 0;
+#pragma omp parallel num_threads(threads)
+    {
+      std::vector<char> buf;
+#pragma omp for schedule(dynamic, 1) reduction(+:nr_failed)
+      for (std::ptrdiff_t c = first_chunk; c < static_cast<std::ptrdiff_t> (end_chunk); ++c)
+      {
+        const std::size_t begin = c * chunk_size;
+        const std::size_t end = std::min (begin + chunk_size, total_points);
+        const std::size_t chunk_bytes = (end - begin) * fsize;
+        const std::size_t stored_bytes = offsets[c + 1] - offsets[c];
+        const unsigned char *stored = &map[chunks_idx + offsets[c]];
+
+        // Chunks which did not compress are stored as is
+        const char *planes = reinterpret_cast<const char*> (stored);
+        if (stored_bytes != chunk_bytes)
+        {
+          buf.resize (chunk_bytes);
+          if (pcl::lzfDecompress (stored, static_cast<unsigned int> (stored_bytes), buf.data (),
+                                  static_cast<unsigned int> (chunk_bytes)) != chunk_bytes)
+          {
+            ++nr_failed;
+            continue;
+          }
+          planes = buf.data ();
+        }
+
+        // Unpack the xxyyzz of the requested points of the chunk to xyz
+        const std::size_t copy_begin = std::max (begin, first_point);
+        const std::size_t copy_end = std::min (end, last_point);
+        unpackPlanes (planes, end - begin, copy_begin - begin, copy_end - begin, copies,
+                      out + (copy_begin - first_point) * out_step, out_step);
+      }
+    }
+    if (nr_failed != 0)
+    {
+      PCL_ERROR ("[%s] Size of decompressed lzf data does not match the size of %d chunks.\n", caller, nr_failed);
+      return (-1);
+    }
+    return (0);
+  }
+
+  /** \brief Read only mapping of a range of a file. */
+  class PCDFileRange
+  {
+    public:
+      PCDFileRange () = default;
+      PCDFileRange (const PCDFileRange&) = delete;
+      PCDFileRange& operator = (const PCDFileRange&) = delete;
+
+      ~PCDFileRange ()
+      {
+        if (!map_)
+          return;
+#ifdef _WIN32
+        UnmapViewOfFile (map_);
+        CloseHandle (fm_);
+#else
+        ::munmap (map_, map_size_);
+#endif
+      }
+
+      /** \brief Map size bytes of fd starting at offset.
+        * \return a pointer to the byte at offset, nullptr on error
+        */
+      const unsigned char*
+      map (int fd, std::size_t offset, std::size_t size)
+      {
+        // Mappings have to start at a multiple of the page size (allocation granularity on Windows)
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo (&info);
+        const std::size_t aligned = offset - offset % info.dwAllocationGranularity;
+        map_size_ = size + (offset - aligned);
+        fm_ = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+        if (fm_ == NULL)
+          return (nullptr);
+        map_ = static_cast<unsigned char*> (MapViewOfFile (fm_, FILE_MAP_READ, static_cast<DWORD> (static_cast<std::uint64_t> (aligned) >> 32),
+                                                           static_cast<DWORD> (aligned & 0xFFFFFFFF), map_size_));
+        if (map_ == NULL)
+        {
+          CloseHandle (fm_);
+          return (nullptr);
+        }
+#else
+        const std::size_t page_size = static_cast<std::size_t> (sysconf (_SC_PAGESIZE));
+        const std::size_t aligned = offset - offset % page_size;
+        map_size_ = size + (offset - aligned);
+        void *map = ::mmap (nullptr, map_size_, PROT_READ, MAP_SHARED, fd, static_cast<off_t> (aligned));
+        if (map == MAP_FAILED)
+          return (nullptr);
+        map_ = static_cast<unsigned char*> (map);
+#endif
+        return (map_ + (offset - aligned));
+      }
+
+    private:
+      unsigned char *map_{nullptr};
+      std::size_t map_size_{0};
+#ifdef _WIN32
+      HANDLE fm_{nullptr};
+#endif
+  };
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::PCDWriter::setLockingPermissions (const std::string &file_name,
@@ -110,11 +400,42 @@ pcl::PCDWriter::resetLockingPermissions (const std::string &file_name,
 #endif
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDReader::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    nr_threads = omp_get_num_procs ();
+  threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::PCDReader::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::PCDReader::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif // _OPENMP
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
                             Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, 
                             int &pcd_version, int &data_type, unsigned int &data_idx)
+{
+  int res = parseHeader (fs, cloud, origin, orientation, pcd_version, data_type, data_idx);
+  if (res < 0)
+    return (res);
+
+  // Need to allocate: N * point_step
+  cloud.data.resize (static_cast<std::size_t> (cloud.width) * cloud.height * cloud.point_step);
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::parseHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
+                             Eigen::Vector4f &origin, Eigen::Quaternionf &orientation,
+                             int &pcd_version, int &data_type, unsigned int &data_idx)
 {
   // Default values
   data_idx = 0;
@@ -317,8 +638,6 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
         if (!cloud.point_step)
           throw "Number of POINTS specified before COUNT in header!";
         sstream >> nr_points;
-        // Need to allocate: N * point_step
-        cloud.data.resize (nr_points * cloud.point_step);
         continue;
       }
 
@@ -326,7 +645,9 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
       if (line_type.substr (0, 4) == "DATA")
       {
         data_idx = static_cast<int> (fs.tellg ());
-        if (st.at (1).substr (0, 17) == "binary_compressed")
+        if (st.at (1).substr (0, 25) == "binary_compressed_chunked")
+          data_type = 3;
+        else if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
         else
           if (st.at (1).substr (0, 6) == "binary")
@@ -632,38 +953,50 @@ pcl::PCDReader::readBodyBinary (const unsigned char *map, pcl::PCLPointCloud2 &c
     memcpy ((cloud.data).data(), &map[0] + data_idx, cloud.data.size ());
 
   // Extra checks (not needed for ASCII)
-  int point_size = (cloud.width * cloud.height == 0) ? 0 : static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
   // Once copied, we need to go over each field and check if it has NaN/Inf values and assign cloud.is_dense to true or false
-  for (uindex_t i = 0; i < cloud.width * cloud.height; ++i)
+  checkIsDense (cloud);
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBodyBinaryCompressedChunked (const unsigned char *map, std::size_t map_size,
+                                                 pcl::PCLPointCloud2 &cloud, unsigned int data_idx,
+                                                 std::size_t first_point, std::size_t nr_points)
+{
+  // Setting the is_dense property to true by default
+  cloud.is_dense = true;
+
+  // Get the fields sizes, and the offsets of the fields planes in the chunks
+  std::vector<std::size_t> planes_offsets;
+  const std::size_t fsize = getPlanesOffsets (cloud, planes_offsets);
+  std::vector<PCDFieldCopy> copies;
+  for (std::size_t d = 0; d < cloud.fields.size (); ++d)
   {
-    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
-    {
-      for (uindex_t c = 0; c < cloud.fields[d].count; ++c)
-      {
-#define SET_CLOUD_DENSE(CASE_LABEL)                                                    \
-  case CASE_LABEL: {                                                                   \
-    if (!isValueFinite<pcl::traits::asType_t<CASE_LABEL>>(cloud, i, point_size, d, c)) \
-      cloud.is_dense = false;                                                          \
-    break;                                                                             \
+    const auto &field = cloud.fields[d];
+    if (field.name == "_")
+      continue;
+    copies.push_back ({field.offset, planes_offsets[d], field.offset, field.count * pcl::getFieldSize (field.datatype)});
   }
-        switch (cloud.fields[d].datatype)
-        {
-          SET_CLOUD_DENSE(pcl::PCLPointField::BOOL)
-          SET_CLOUD_DENSE(pcl::PCLPointField::INT8)
-          SET_CLOUD_DENSE(pcl::PCLPointField::UINT8)
-          SET_CLOUD_DENSE(pcl::PCLPointField::INT16)
-          SET_CLOUD_DENSE(pcl::PCLPointField::UINT16)
-          SET_CLOUD_DENSE(pcl::PCLPointField::INT32)
-          SET_CLOUD_DENSE(pcl::PCLPointField::UINT32)
-          SET_CLOUD_DENSE(pcl::PCLPointField::INT64)
-          SET_CLOUD_DENSE(pcl::PCLPointField::UINT64)
-          SET_CLOUD_DENSE(pcl::PCLPointField::FLOAT32)
-          SET_CLOUD_DENSE(pcl::PCLPointField::FLOAT64)
-        }
-#undef SET_CLOUD_DENSE
-      }
-    }
+
+  // Clamp the requested range of points. A part of the cloud is not organized anymore
+  const std::size_t total_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+  first_point = std::min (first_point, total_points);
+  nr_points = std::min (nr_points, total_points - first_point);
+  if (nr_points != total_points)
+  {
+    cloud.width = static_cast<uindex_t> (nr_points);
+    cloud.height = 1;
+    cloud.row_step = cloud.point_step * cloud.width;
   }
+  cloud.data.resize (nr_points * cloud.point_step);
+
+  if (decodeChunks (map, map_size, data_idx, total_points, copies, fsize, first_point, nr_points,
+                    cloud.data.data (), cloud.point_step, threads_, "pcl::PCDReader::readBodyBinaryCompressedChunked") < 0)
+    return (-1);
+
+  checkIsDense (cloud);
 
   return (0);
 }
@@ -763,6 +1096,11 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
       // Reset position
       io::raw_lseek (fd, 0, SEEK_SET);
     }
+    else if (data_type == 3)
+    {
+      // The size of the chunks is stored in their index, map the whole file
+      mmap_size = file_size;
+    }
     else
     {
       mmap_size += cloud.data.size ();
@@ -800,7 +1138,10 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
     }
 #endif
 
-    res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
+    if (data_type == 3)
+      res = readBodyBinaryCompressedChunked (map, mmap_size, cloud, offset + data_idx);
+    else
+      res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
 
     // Unmap the pages of memory
 #ifdef _WIN32
@@ -839,6 +1180,228 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
   return (0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readPartial (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
+                             const std::vector<std::string> &field_names,
+                             std::size_t first_point, std::size_t nr_points, const int offset)
+{
+  pcl::console::TicToc tt;
+  tt.tic ();
+
+  if (file_name.empty ())
+  {
+    PCL_ERROR ("[pcl::PCDReader::readPartial] No file name given!\n");
+    return (-1);
+  }
+
+  std::ifstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDReader::readPartial] Could not open file '%s'! Error : %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  fs.seekg (offset, std::ios::beg);
+
+  // Parse the header only, the points are read below
+  pcl::PCLPointCloud2 header;
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  int res = parseHeader (fs, header, origin, orientation, pcd_version, data_type, data_idx);
+  fs.close ();
+  if (res < 0)
+    return (res);
+
+  // Select the fields, all of them but the padding ones by default
+  std::vector<std::size_t> selection;
+  if (field_names.empty ())
+  {
+    for (std::size_t d = 0; d < header.fields.size (); ++d)
+      if (header.fields[d].name != "_")
+        selection.push_back (d);
+  }
+  for (const auto &field_name : field_names)
+  {
+    const int d = pcl::getFieldIndex (header, field_name);
+    if (d < 0)
+    {
+      PCL_ERROR ("[pcl::PCDReader::readPartial] Field '%s' not found in '%s'. Available dimensions: %s.\n",
+                 field_name.c_str (), file_name.c_str (), pcl::getFieldsList (header).c_str ());
+      return (-1);
+    }
+    selection.push_back (d);
+  }
+
+  // The selected fields are packed in the order of the selection
+  std::vector<std::size_t> planes_offsets;
+  const std::size_t fsize = getPlanesOffsets (header, planes_offsets);
+  std::vector<PCDFieldCopy> copies;
+  cloud.fields.clear ();
+  cloud.point_step = 0;
+  for (const auto &d : selection)
+  {
+    pcl::PCLPointField field = header.fields[d];
+    const std::size_t size = field.count * pcl::getFieldSize (field.datatype);
+    copies.push_back ({field.offset, planes_offsets[d], cloud.point_step, size});
+    field.offset = cloud.point_step;
+    cloud.fields.push_back (field);
+    cloud.point_step += static_cast<uindex_t> (size);
+  }
+
+  // Clamp the requested range of points. A part of the cloud is not organized anymore
+  const std::size_t total_points = static_cast<std::size_t> (header.width) * header.height;
+  first_point = std::min (first_point, total_points);
+  nr_points = std::min (nr_points, total_points - first_point);
+  cloud.width = header.width;
+  cloud.height = header.height;
+  if (nr_points != total_points)
+  {
+    cloud.width = static_cast<uindex_t> (nr_points);
+    cloud.height = 1;
+  }
+  cloud.row_step = cloud.point_step * cloud.width;
+  cloud.is_bigendian = header.is_bigendian;
+  cloud.is_dense = true;
+  cloud.data.clear ();
+  cloud.data.resize (nr_points * cloud.point_step);
+  if (cloud.data.empty ())
+    return (0);
+
+  if (data_type == 0)
+  {
+    // ASCII files cannot be seeked into, parse the whole file
+    pcl::PCLPointCloud2 full;
+    res = read (file_name, full, offset);
+    if (res < 0)
+      return (res);
+    copyPoints (&full.data[first_point * full.point_step], nr_points, full.point_step,
+                copies, cloud.data.data (), cloud.point_step);
+  }
+  else
+  {
+    int fd = io::raw_open (file_name.c_str (), O_RDONLY);
+    if (fd == -1)
+    {
+      PCL_ERROR ("[pcl::PCDReader::readPartial] Failure to open file %s\n", file_name.c_str () );
+      return (-1);
+    }
+    const std::size_t file_size = io::raw_lseek (fd, 0, SEEK_END);
+
+    // Only the range of the file holding the requested points is mapped
+    std::size_t begin = offset + data_idx;
+    std::size_t size = (begin < file_size) ? file_size - begin : 0;
+    if (data_type == 1)
+    {
+      begin += first_point * header.point_step;
+      size = nr_points * header.point_step;
+    }
+    if (size == 0 || begin + size > file_size)
+    {
+      io::raw_close (fd);
+      PCL_ERROR ("[pcl::PCDReader::readPartial] Corrupted PCD file. The file is smaller than expected!\n");
+      return (-1);
+    }
+    PCDFileRange range;
+    const unsigned char *map = range.map (fd, begin, size);
+    io::raw_close (fd);
+    if (!map)
+    {
+      PCL_ERROR ("[pcl::PCDReader::readPartial] Error preparing mmap for binary PCD file.\n");
+      return (-1);
+    }
+
+    if (data_type == 1)
+      copyPoints (map, nr_points, header.point_step, copies, cloud.data.data (), cloud.point_step);
+    else if (data_type == 2)
+    {
+      // The whole block has to be decompressed, but only the planes of the selected fields are unpacked
+      unsigned int sizes[2] = {0, 0};
+      if (size >= sizeof (sizes))
+        memcpy (sizes, map, sizeof (sizes));
+      if (size < sizeof (sizes) + sizes[0] || sizes[1] != total_points * fsize)
+      {
+        PCL_ERROR ("[pcl::PCDReader::readPartial] Corrupted PCD file. The compressed data does not match the header!\n");
+        return (-1);
+      }
+      std::vector<char> buf (sizes[1]);
+      if (pcl::lzfDecompress (map + sizeof (sizes), sizes[0], buf.data (), sizes[1]) != sizes[1])
+      {
+        PCL_ERROR ("[pcl::PCDReader::readPartial] Size of decompressed lzf data does not match value stored in PCD header (%u).\n", sizes[1]);
+        return (-1);
+      }
+      unpackPlanes (buf.data (), total_points, first_point, first_point + nr_points, copies,
+                    cloud.data.data (), cloud.point_step);
+    }
+    // Only the chunks holding the requested points are decompressed
+    else if (decodeChunks (map, size, 0, total_points, copies, fsize, first_point, nr_points,
+                           cloud.data.data (), cloud.point_step, threads_, "pcl::PCDReader::readPartial") < 0)
+      return (-1);
+  }
+
+  checkIsDense (cloud);
+
+  PCL_DEBUG ("[pcl::PCDReader::readPartial] Loaded %zu points of %s in %g ms. Dimensions: %s.\n",
+             nr_points, file_name.c_str (), tt.toc (), pcl::getFieldsList (cloud).c_str ());
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::read (const std::string &file_name, pcl::PCDCloudView &view, const int offset)
+{
+  view.close ();
+
+  if (file_name.empty ())
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] No file name given!\n");
+    return (-1);
+  }
+
+  std::ifstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] Could not open file '%s'! Error : %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  fs.seekg (offset, std::ios::beg);
+
+  // Parse the header only, the body is accessed through the mapping
+  pcl::PCLPointCloud2 header;
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  int res = parseHeader (fs, header, origin, orientation, pcd_version, data_type, data_idx);
+  fs.close ();
+  if (res < 0)
+    return (res);
+
+  if (data_type != 1)
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] Only binary PCD files can be mapped, but '%s' is %s.\n",
+               file_name.c_str (), data_type == 0 ? "ASCII" : "binary compressed");
+    return (-1);
+  }
+
+  const std::size_t data_offset = offset + data_idx;
+  const std::size_t data_size = static_cast<std::size_t> (header.width) * header.height * header.point_step;
+  res = view.map (file_name, data_offset + data_size, data_offset);
+  if (res < 0)
+    return (res);
+
+  view.header_ = std::move (header);
+  view.origin_ = origin;
+  view.orientation_ = orientation;
+
+  PCL_DEBUG ("[pcl::PCDReader::read] Mapped %s with %zu points. Available dimensions: %s.\n",
+             file_name.c_str (), view.size (), pcl::getFieldsList (view.header_).c_str ());
+  return (0);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::PCDWriter::generateHeaderASCII (const pcl::PCLPointCloud2 &cloud,
@@ -1210,6 +1773,20 @@ pcl::PCDWriter::writeASCII (const std::string &file_name, const pcl::PCLPointClo
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string
+pcl::PCDWriter::generateDataLineBinary (std::size_t header_size) const
+{
+  const std::string data_line = "DATA binary\n";
+  if (!align_binary_data_)
+    return (data_line);
+  constexpr std::size_t data_alignment = 32;
+  // The padding comment takes at least "#\n"
+  const std::size_t unpadded_size = header_size + 2 + data_line.size ();
+  const std::size_t padding = (data_alignment - unpadded_size % data_alignment) % data_alignment;
+  return ("#" + std::string (padding, ' ') + "\n" + data_line);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDWriter::writeBinary (std::ostream &os, const pcl::PCLPointCloud2 &cloud,
@@ -1226,7 +1803,8 @@ pcl::PCDWriter::writeBinary (std::ostream &os, const pcl::PCLPointCloud2 &cloud,
   }
 
   os.imbue (std::locale::classic ());
-  os << generateHeaderBinary (cloud, origin, orientation) << "DATA binary\n";
+  const std::string header = generateHeaderBinary (cloud, origin, orientation);
+  os << header << generateDataLineBinary (header.size ());
   std::copy (cloud.data.cbegin(), cloud.data.cend(), std::ostream_iterator<char> (os));
   os.flush ();
 
@@ -1251,7 +1829,8 @@ pcl::PCDWriter::writeBinary (const std::string &file_name, const pcl::PCLPointCl
   std::ostringstream oss;
   oss.imbue (std::locale::classic ());
 
-  oss << generateHeaderBinary (cloud, origin, orientation) << "DATA binary\n";
+  const std::string header = generateHeaderBinary (cloud, origin, orientation);
+  oss << header << generateDataLineBinary (header.size ());
   oss.flush();
   const auto data_idx = static_cast<unsigned int> (oss.tellp ());
 
@@ -1572,3 +2151,138 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const pcl::
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDWriter::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    nr_threads = omp_get_num_procs ();
+  threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::PCDWriter::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::PCDWriter::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif // _OPENMP
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryCompressedChunked (std::ostream &os, const pcl::PCLPointCloud2 &cloud,
+                                              const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  if (cloud.data.empty ())
+  {
+    PCL_WARN ("[pcl::PCDWriter::writeBinaryCompressedChunked] Input point cloud has no data!\n");
+  }
+  if (cloud.fields.empty())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Input point cloud has no field data!\n");
+    return (-1);
+  }
+
+  if (generateHeaderBinaryCompressed (os, cloud, origin, orientation))
+  {
+    return (-1);
+  }
+
+  // Compute the total size of the fields, without padding
+  std::size_t fsize = 0;
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<std::size_t> fields_sizes;
+  for (const auto &field : cloud.fields)
+  {
+    if (field.name == "_")
+      continue;
+    fields.push_back (field);
+    fields_sizes.push_back (field.count * pcl::getFieldSize (field.datatype));
+    fsize += fields_sizes.back ();
+  }
+
+  // Each chunk is compressed as a single LZF block, whose size is stored on 32 bits
+  const std::size_t chunk_size = chunk_size_;
+  if (chunk_size * fsize * 17 / 16 + 64 > std::numeric_limits<std::uint32_t>::max ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Chunks of %u points of %zu bytes exceed the maximum size of a compressed block.\n",
+               chunk_size_, fsize);
+    return (-2);
+  }
+
+  const std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+  const std::size_t nr_chunks = (nr_points + chunk_size - 1) / chunk_size;
+  std::vector<std::vector<char> > chunks (nr_chunks);
+
+#pragma omp parallel num_threads(threads_)
+  {
+    std::vector<char> transposed;
+#pragma omp for schedule(dynamic, 1)
+    for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t> (nr_chunks); ++c)
+    {
+      const std::size_t begin = c * chunk_size;
+      const std::size_t end = std::min (begin + chunk_size, nr_points);
+
+      // Convert the XYZRGBXYZRGB structure of the chunk to XXYYZZRGBRGB to aid compression
+      transposed.resize ((end - begin) * fsize);
+      char *plane = transposed.data ();
+      for (std::size_t j = 0; j < fields.size (); ++j)
+        for (std::size_t i = begin; i < end; ++i, plane += fields_sizes[j])
+          memcpy (plane, &cloud.data[i * cloud.point_step + fields[j].offset], fields_sizes[j]);
+
+      // Chunks which do not compress are stored as is, the reader recognizes them by their size
+      auto &chunk = chunks[c];
+      chunk.resize (transposed.size () * 17 / 16 + 64);
+      unsigned int compressed_size = 0;
+      if (!transposed.empty ())
+        compressed_size = pcl::lzfCompress (transposed.data (), static_cast<unsigned int> (transposed.size ()),
+                                            chunk.data (), static_cast<unsigned int> (chunk.size ()));
+      if (compressed_size == 0 || compressed_size >= transposed.size ())
+        chunk.swap (transposed);
+      else
+        chunk.resize (compressed_size);
+    }
+  }
+
+  // The body starts with the marker, the version, the chunk size, the number of chunks,
+  // and the offsets of the chunks after the index, followed by the end of the last chunk
+  const std::uint32_t preamble[4] = {pcd_chunked_marker, pcd_chunked_version,
+                                     static_cast<std::uint32_t> (chunk_size),
+                                     static_cast<std::uint32_t> (nr_chunks)};
+  std::vector<std::uint64_t> offsets (nr_chunks + 1, 0);
+  for (std::size_t c = 0; c < nr_chunks; ++c)
+    offsets[c + 1] = offsets[c] + chunks[c].size ();
+
+  os.imbue (std::locale::classic ());
+  os << "DATA binary_compressed_chunked\n";
+  os.write (reinterpret_cast<const char*> (preamble), sizeof (preamble));
+  os.write (reinterpret_cast<const char*> (offsets.data ()), offsets.size () * sizeof (std::uint64_t));
+  for (const auto &chunk : chunks)
+    os.write (chunk.data (), chunk.size ());
+  os.flush ();
+
+  return (os ? 0 : -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryCompressedChunked (const std::string &file_name, const pcl::PCLPointCloud2 &cloud,
+                                              const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  std::ofstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);      // Open file
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Could not open file '%s' for writing! Error : %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  // Mandatory lock file
+  boost::interprocess::file_lock file_lock;
+  setLockingPermissions (file_name, file_lock);
+
+  int status = writeBinaryCompressedChunked (fs, cloud, origin, orientation);
+
+  fs.close ();              // Close file
+  resetLockingPermissions (file_name, file_lock);
+  return (status);
+}
+
@@ -0,0 +1,151 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/io.h> // for getFieldIndex
+#include <pcl/console/print.h>
+#include <pcl/io/low_level_io.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/io/pcd_view.h>
+
+#include <cerrno>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+struct pcl::PCDCloudView::Mapping
+{
+  ~Mapping ()
+  {
+    if (!map)
+      return;
+#ifdef _WIN32
+    UnmapViewOfFile (map);
+    CloseHandle (file_mapping);
+#else
+    if (::munmap (map, size) == -1)
+      PCL_ERROR ("[pcl::PCDCloudView] Munmap failure\n");
+#endif
+  }
+
+  unsigned char *map{nullptr};
+  std::size_t size{0};
+#ifdef _WIN32
+  HANDLE file_mapping{nullptr};
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDCloudView::open (const std::string &file_name, const int offset)
+{
+  pcl::PCDReader reader;
+  return (reader.read (file_name, *this, offset));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDCloudView::close ()
+{
+  mapping_.reset ();
+  data_ = nullptr;
+  header_ = pcl::PCLPointCloud2 ();
+  origin_ = Eigen::Vector4f::Zero ();
+  orientation_ = Eigen::Quaternionf::Identity ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDCloudView::getFieldIndex (const std::string &field_name) const
+{
+  return (pcl::getFieldIndex (header_, field_name));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDCloudView::map (const std::string &file_name, std::size_t map_size, std::size_t data_offset)
+{
+  int fd = io::raw_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::PCDCloudView::map] Failure to open file %s\n", file_name.c_str ());
+    return (-1);
+  }
+
+  const std::size_t file_size = io::raw_lseek (fd, 0, SEEK_END);
+  io::raw_lseek (fd, 0, SEEK_SET);
+  if (map_size > file_size)
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PCDCloudView::map] Corrupted PCD file. The file is smaller than expected!\n");
+    return (-1);
+  }
+
+  auto mapping = std::make_shared<Mapping> ();
+  mapping->size = map_size;
+#ifdef _WIN32
+  mapping->file_mapping = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping->file_mapping == NULL)
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PCDCloudView::map] Error creating the mapping of file %s\n", file_name.c_str ());
+    return (-1);
+  }
+  mapping->map = static_cast<unsigned char*> (MapViewOfFile (mapping->file_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (mapping->map == NULL)
+  {
+    CloseHandle (mapping->file_mapping);
+    mapping->file_mapping = NULL;
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PCDCloudView::map] Error mapping view of file, %s\n", file_name.c_str ());
+    return (-1);
+  }
+#else
+  auto *map = static_cast<unsigned char*> (::mmap (nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0));
+  if (map == reinterpret_cast<unsigned char*> (-1))    // MAP_FAILED
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PCDCloudView::map] Error preparing mmap for binary PCD file: %s\n", strerror (errno));
+    return (-1);
+  }
+  mapping->map = map;
+#endif
+  // The mapping stays valid after the file descriptor is closed
+  io::raw_close (fd);
+
+  mapping_ = mapping;
+  data_ = mapping->map + data_offset;
+  return (0);
+}
@@ -38,17 +38,576 @@
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
 #include <pcl/common/pcl_filesystem.h>
+#include <pcl/io/low_level_io.h>
 #include <pcl/io/ply_io.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <sstream>
 #include <string>
 #include <tuple>
 
 #include <boost/algorithm/string.hpp> // for split
 
+namespace
+{
+  /** \brief How a vertex property of a binary PLY file is stored in the cloud. */
+  struct PLYBinaryProperty
+  {
+    enum Kind { COPY, RED, GREEN, BLUE, ALPHA, INTENSITY };
+
+    Kind kind{COPY};
+    /** \brief Offset of the property in the file record. */
+    std::size_t in_offset{0};
+    /** \brief Offset of the property in the cloud point. */
+    std::size_t out_offset{0};
+    /** \brief Size of the property in the file record. */
+    std::size_t size{0};
+    /** \brief Datatype of the property in the file record. */
+    std::uint8_t datatype{0};
+  };
+
+  /** \brief Layout of a binary PLY file whose vertices can be read without the generic parser. */
+  struct PLYBinaryLayout
+  {
+    /** \brief Whether the file byte order differs from the host one. */
+    bool swap{false};
+    /** \brief Whether the records can be copied as they are. */
+    bool verbatim{false};
+    /** \brief File offset of the first vertex record. */
+    std::size_t data_start{0};
+    std::size_t nr_vertices{0};
+    std::size_t record_size{0};
+    std::vector<PLYBinaryProperty> properties;
+    std::vector<pcl::PCLPointField> fields;
+    std::uint32_t point_step{0};
+    std::uint32_t width{0}, height{0};
+    Eigen::Vector4f origin{Eigen::Vector4f::Zero ()};
+    Eigen::Matrix3f orientation{Eigen::Matrix3f::Identity ()};
+  };
+
+  /** \brief Size of the buffer the binary fast path streams the vertices through. */
+  constexpr std::size_t ply_binary_buffer_size = 4 * 1024 * 1024;
+
+  template <typename Scalar> bool
+  isPLYType (const std::string &type)
+  {
+    return ((type == pcl::io::ply::type_traits<Scalar>::name ()) ||
+            (type == pcl::io::ply::type_traits<Scalar>::old_name ()));
+  }
+
+  std::uint8_t
+  getPLYDatatype (const std::string &type)
+  {
+    if (isPLYType<pcl::io::ply::int8> (type))
+      return (pcl::PCLPointField::INT8);
+    if (isPLYType<pcl::io::ply::uint8> (type))
+      return (pcl::PCLPointField::UINT8);
+    if (isPLYType<pcl::io::ply::int16> (type))
+      return (pcl::PCLPointField::INT16);
+    if (isPLYType<pcl::io::ply::uint16> (type))
+      return (pcl::PCLPointField::UINT16);
+    if (isPLYType<pcl::io::ply::int32> (type))
+      return (pcl::PCLPointField::INT32);
+    if (isPLYType<pcl::io::ply::uint32> (type))
+      return (pcl::PCLPointField::UINT32);
+    if (isPLYType<pcl::io::ply::float32> (type))
+      return (pcl::PCLPointField::FLOAT32);
+    if (isPLYType<pcl::io::ply::float64> (type))
+      return (pcl::PCLPointField::FLOAT64);
+    return (0);
+  }
+
+  inline void
+  swapBytes (std::uint8_t *value, std::size_t size)
+  {
+    switch (size)
+    {
+      case 2: pcl::io::ply::swap_byte_order<2> (reinterpret_cast<char*> (value)); break;
+      case 4: pcl::io::ply::swap_byte_order<4> (reinterpret_cast<char*> (value)); break;
+      case 8: pcl::io::ply::swap_byte_order<8> (reinterpret_cast<char*> (value)); break;
+      default: break;
+    }
+  }
+
+  /** \brief Parse the header of a PLY file and, for binary files the fast path
+    * can handle, compute the layout of the vertex records and of the cloud.
+    * The fields, dimensions, origin and orientation match the ones produced by
+    * the callbacks of pcl::PLYReader.
+    * \return false if the file has to go through the generic parser
+    */
+  bool
+  parsePLYBinaryLayout (const std::string &file_name, PLYBinaryLayout &layout)
+  {
+    struct PLYElement
+    {
+      std::string name;
+      std::size_t count{0};
+      std::size_t size{0};
+      bool fixed_size{true};
+      // name, datatype and offset in the record of the scalar properties
+      std::vector<std::tuple<std::string, std::uint8_t, std::size_t> > properties;
+    };
+
+    std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+    if (!fs.is_open ())
+      return (false);
+
+    std::string line;
+    if (!std::getline (fs, line) || boost::trim_right_copy (line) != "ply")
+      return (false);
+
+    bool binary = false, end_header = false;
+    std::vector<PLYElement> elements;
+    std::uint32_t width = 0, height = 0;
+    while (!end_header && std::getline (fs, line))
+    {
+      boost::trim_right (line);
+      std::istringstream ss (line);
+      ss.imbue (std::locale::classic ());
+      std::string keyword;
+      ss >> keyword;
+      if (keyword == "format")
+      {
+        std::string format;
+        ss >> format;
+        if (format == "binary_little_endian")
+          layout.swap = (pcl::io::ply::host_byte_order != pcl::io::ply::little_endian_byte_order);
+        else if (format == "binary_big_endian")
+          layout.swap = (pcl::io::ply::host_byte_order != pcl::io::ply::big_endian_byte_order);
+        else
+          return (false);
+        binary = true;
+      }
+      else if (keyword == "element")
+      {
+        PLYElement element;
+        if (!(ss >> element.name >> element.count))
+          return (false);
+        // Same rule as pcl::PLYReader::elementDefinitionCallback ()
+        if (element.name == "vertex" && (width == 0 || height == 0))
+        {
+          width = static_cast<std::uint32_t> (element.count);
+          height = 1;
+        }
+        elements.push_back (element);
+      }
+      else if (keyword == "property")
+      {
+        if (elements.empty ())
+          return (false);
+        PLYElement &element = elements.back ();
+        std::string type, name;
+        if (!(ss >> type))
+          return (false);
+        if (type == "list")
+        {
+          element.fixed_size = false;
+          continue;
+        }
+        const std::uint8_t datatype = getPLYDatatype (type);
+        if (datatype == 0 || !(ss >> name))
+          return (false);
+        element.properties.emplace_back (name, datatype, element.size);
+        element.size += pcl::getFieldSize (datatype);
+      }
+      else if (keyword == "obj_info")
+      {
+        // Same rules as pcl::PLYReader::objInfoCallback ()
+        std::string key, value;
+        if (!(ss >> key >> value))
+          continue;
+        if (key == "num_cols")
+          width = atoi (value.c_str ());
+        else if (key == "num_rows")
+          height = atoi (value.c_str ());
+        else if (key == "echo_rgb_offset_x")
+          layout.origin[0] = static_cast<float> (atof (value.c_str ()));
+        else if (key == "echo_rgb_offset_y")
+          layout.origin[1] = static_cast<float> (atof (value.c_str ()));
+        else if (key == "echo_rgb_offset_z")
+          layout.origin[2] = static_cast<float> (atof (value.c_str ()));
+      }
+      else if (keyword == "end_header")
+        end_header = true;
+    }
+    if (!binary || !end_header)
+      return (false);
+
+    // Locate the vertex and camera records. Elements of variable size can only
+    // be skipped when nothing we need comes after them.
+    std::size_t offset = static_cast<std::size_t> (fs.tellg ());
+    bool offset_known = true;
+    const PLYElement *vertex = nullptr, *camera = nullptr;
+    std::size_t camera_offset = 0;
+    for (const auto &element : elements)
+    {
+      if (element.name == "vertex")
+      {
+        if (vertex || !element.fixed_size || !offset_known || element.count == 0)
+          return (false);
+        vertex = &element;
+        layout.data_start = offset;
+      }
+      else if (element.name == "range_grid" && element.count > 0)
+        return (false);
+      else if (element.name == "camera" && element.count > 0)
+      {
+        if (!element.fixed_size || !offset_known || element.count != 1)
+          return (false);
+        camera = &element;
+        camera_offset = offset;
+      }
+
+      if (element.count > 0 && !element.fixed_size)
+        offset_known = false;
+      else
+        offset += element.count * element.size;
+    }
+    if (!vertex || static_cast<std::size_t> (width) * height != vertex->count)
+      return (false);
+
+    layout.nr_vertices = vertex->count;
+    layout.record_size = vertex->size;
+
+    // Map the vertex properties to the cloud fields, handling colors and
+    // intensities the way the callbacks of pcl::PLYReader do
+    enum { NO_COLOR, HAS_RED, HAS_GREEN, HAS_RGB, HAS_RGBA } color = NO_COLOR;
+    std::size_t rgb_field = 0;
+    layout.verbatim = !layout.swap;
+    for (const auto &vertex_property : vertex->properties)
+    {
+      PLYBinaryProperty property;
+      const std::string &name = std::get<0> (vertex_property);
+      property.datatype = std::get<1> (vertex_property);
+      property.in_offset = std::get<2> (vertex_property);
+      property.size = pcl::getFieldSize (property.datatype);
+      property.out_offset = layout.point_step;
+
+      std::uint8_t field_datatype = property.datatype;
+      std::string field_name = name;
+      if (property.datatype == pcl::PCLPointField::UINT8)
+      {
+        if (name == "red" || name == "diffuse_red")
+        {
+          if (color != NO_COLOR)
+            return (false);
+          color = HAS_RED;
+          property.kind = PLYBinaryProperty::RED;
+          rgb_field = layout.fields.size ();
+          field_name = "rgb";
+          field_datatype = pcl::PCLPointField::FLOAT32;
+        }
+        else if (name == "green" || name == "diffuse_green")
+        {
+          if (color != HAS_RED)
+            return (false);
+          color = HAS_GREEN;
+          property.kind = PLYBinaryProperty::GREEN;
+          property.out_offset = layout.fields[rgb_field].offset;
+        }
+        else if (name == "blue" || name == "diffuse_blue")
+        {
+          if (color != HAS_GREEN)
+            return (false);
+          color = HAS_RGB;
+          property.kind = PLYBinaryProperty::BLUE;
+          property.out_offset = layout.fields[rgb_field].offset;
+        }
+        else if (name == "alpha")
+        {
+          if (color != HAS_RGB)
+            return (false);
+          color = HAS_RGBA;
+          property.kind = PLYBinaryProperty::ALPHA;
+          property.out_offset = layout.fields[rgb_field].offset;
+          layout.fields[rgb_field].name = "rgba";
+          layout.fields[rgb_field].datatype = pcl::PCLPointField::UINT32;
+        }
+        else if (name == "intensity")
+        {
+          property.kind = PLYBinaryProperty::INTENSITY;
+          field_datatype = pcl::PCLPointField::FLOAT32;
+        }
+      }
+      layout.properties.push_back (property);
+      if (property.kind != PLYBinaryProperty::COPY || property.in_offset != property.out_offset)
+        layout.verbatim = false;
+
+      // Green, blue and alpha are packed in the rgb field
+      if (property.out_offset != layout.point_step)
+        continue;
+      if (field_name == "nx")
+        field_name = "normal_x";
+      else if (field_name == "ny")
+        field_name = "normal_y";
+      else if (field_name == "nz")
+        field_name = "normal_z";
+      pcl::PCLPointField field;
+      field.name = field_name;
+      field.offset = layout.point_step;
+      field.datatype = field_datatype;
+      field.count = 1;
+      layout.fields.push_back (field);
+      layout.point_step += static_cast<std::uint32_t> (pcl::getFieldSize (field_datatype));
+    }
+    if (color == HAS_RED || color == HAS_GREEN)
+      return (false);
+
+    layout.width = width;
+    layout.height = height;
+    if (!camera)
+      return (true);
+
+    // Read the single camera record, same rules as pcl::PLYReader::scalarPropertyDefinitionCallback ()
+    std::vector<std::uint8_t> record (camera->size);
+    fs.clear ();
+    fs.seekg (camera_offset);
+    if (!fs.read (reinterpret_cast<char*> (record.data ()), record.size ()))
+      return (false);
+    for (const auto &camera_property : camera->properties)
+    {
+      const std::string &name = std::get<0> (camera_property);
+      std::uint8_t *value = &record[std::get<2> (camera_property)];
+      if (std::get<1> (camera_property) == pcl::PCLPointField::FLOAT32)
+      {
+        if (layout.swap)
+          swapBytes (value, sizeof (float));
+        float v;
+        memcpy (&v, value, sizeof (float));
+        if (name == "view_px") layout.origin[0] = v;
+        else if (name == "view_py") layout.origin[1] = v;
+        else if (name == "view_pz") layout.origin[2] = v;
+        else if (name == "x_axisx") layout.orientation (0, 0) = v;
+        else if (name == "x_axisy") layout.orientation (0, 1) = v;
+        else if (name == "x_axisz") layout.orientation (0, 2) = v;
+        else if (name == "y_axisx") layout.orientation (1, 0) = v;
+        else if (name == "y_axisy") layout.orientation (1, 1) = v;
+        else if (name == "y_axisz") layout.orientation (1, 2) = v;
+        else if (name == "z_axisx") layout.orientation (2, 0) = v;
+        else if (name == "z_axisy") layout.orientation (2, 1) = v;
+        else if (name == "z_axisz") layout.orientation (2, 2) = v;
+      }
+      else if (std::get<1> (camera_property) == pcl::PCLPointField::INT32)
+      {
+        if (layout.swap)
+          swapBytes (value, sizeof (std::int32_t));
+        std::int32_t v;
+        memcpy (&v, value, sizeof (std::int32_t));
+        if (name == "viewportx") layout.width = v;
+        else if (name == "viewporty") layout.height = v;
+      }
+    }
+    return (true);
+  }
+
+  /** \brief Convert \a nr_points vertex records to cloud points. */
+  void
+  convertPLYRecords (const PLYBinaryLayout &layout, const std::uint8_t *in,
+                     std::size_t nr_points, std::uint8_t *out)
+  {
+    if (layout.verbatim)
+      memcpy (out, in, nr_points * layout.record_size);
+    else
+    {
+      for (std::size_t i = 0; i < nr_points; ++i, in += layout.record_size, out += layout.point_step)
+      {
+        for (const auto &property : layout.properties)
+        {
+          const std::uint8_t *src = in + property.in_offset;
+          std::uint8_t *dst = out + property.out_offset;
+          std::uint32_t rgba;
+          switch (property.kind)
+          {
+            case PLYBinaryProperty::COPY:
+              memcpy (dst, src, property.size);
+              if (layout.swap)
+                swapBytes (dst, property.size);
+              break;
+            case PLYBinaryProperty::RED:
+              rgba = static_cast<std::uint32_t> (*src) << 16;
+              memcpy (dst, &rgba, sizeof (rgba));
+              break;
+            case PLYBinaryProperty::GREEN:
+            case PLYBinaryProperty::BLUE:
+            case PLYBinaryProperty::ALPHA:
+            {
+              const int shift = (property.kind == PLYBinaryProperty::GREEN) ? 8 :
+                                (property.kind == PLYBinaryProperty::ALPHA) ? 24 : 0;
+              memcpy (&rgba, dst, sizeof (rgba));
+              rgba |= static_cast<std::uint32_t> (*src) << shift;
+              memcpy (dst, &rgba, sizeof (rgba));
+              break;
+            }
+            case PLYBinaryProperty::INTENSITY:
+            {
+              const float intensity = *src;
+              memcpy (dst, &intensity, sizeof (intensity));
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /** \brief Check whether the floating point values read from the file are
+    * all finite, the rule used by the callbacks of pcl::PLYReader.
+    */
+  bool
+  isDensePLYPoints (const PLYBinaryLayout &layout, const std::uint8_t *out, std::size_t nr_points)
+  {
+    bool is_dense = true;
+    for (const auto &property : layout.properties)
+    {
+      if (property.kind != PLYBinaryProperty::COPY)
+        continue;
+      const std::uint8_t *value = out + property.out_offset;
+      if (property.datatype == pcl::PCLPointField::FLOAT32)
+      {
+        for (std::size_t i = 0; i < nr_points; ++i, value += layout.point_step)
+        {
+          float v;
+          memcpy (&v, value, sizeof (v));
+          is_dense &= std::isfinite (v);
+        }
+      }
+      else if (property.datatype == pcl::PCLPointField::FLOAT64)
+      {
+        for (std::size_t i = 0; i < nr_points; ++i, value += layout.point_step)
+        {
+          double v;
+          memcpy (&v, value, sizeof (v));
+          is_dense &= std::isfinite (v);
+        }
+      }
+    }
+    return (is_dense);
+  }
+
+  /** \brief Reads the vertex records of a binary PLY file, either through a
+    * memory map of the file or by streaming them through a fixed size buffer.
+    */
+  class PLYBinaryVertexReader
+  {
+    public:
+      explicit PLYBinaryVertexReader (const PLYBinaryLayout &layout) : layout_ (layout) {}
+
+      ~PLYBinaryVertexReader ()
+      {
+        if (map_)
+        {
+#ifdef _WIN32
+          UnmapViewOfFile (map_);
+          CloseHandle (fm_);
+#else
+          ::munmap (map_, map_size_);
+#endif
+        }
+      }
+
+      PLYBinaryVertexReader (const PLYBinaryVertexReader&) = delete;
+      PLYBinaryVertexReader& operator = (const PLYBinaryVertexReader&) = delete;
+
+      /** \brief Open the file, checking that it holds all the vertex records. */
+      bool
+      open (const std::string &file_name, bool memory_mapping)
+      {
+        const std::size_t data_end = layout_.data_start + layout_.nr_vertices * layout_.record_size;
+        if (!memory_mapping)
+        {
+          fs_.open (file_name.c_str (), std::ios::in | std::ios::binary);
+          if (!fs_.is_open ())
+            return (false);
+          fs_.seekg (0, std::ios::end);
+          if (static_cast<std::size_t> (fs_.tellg ()) < data_end)
+            return (false);
+          fs_.seekg (layout_.data_start);
+          return (true);
+        }
+
+        int fd = pcl::io::raw_open (file_name.c_str (), O_RDONLY);
+        if (fd == -1)
+          return (false);
+        const std::size_t file_size = pcl::io::raw_lseek (fd, 0, SEEK_END);
+        if (file_size < data_end)
+        {
+          pcl::io::raw_close (fd);
+          return (false);
+        }
+        map_size_ = data_end;
+#ifdef _WIN32
+        fm_ = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+        map_ = static_cast<std::uint8_t*> (MapViewOfFile (fm_, FILE_MAP_READ, 0, 0, 0));
+        if (map_ == NULL)
+          CloseHandle (fm_);
+#else
+        map_ = static_cast<std::uint8_t*> (::mmap (nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+        if (map_ == reinterpret_cast<std::uint8_t*> (-1))    // MAP_FAILED
+          map_ = nullptr;
+        else
+          ::madvise (map_, map_size_, MADV_SEQUENTIAL);
+#endif
+        pcl::io::raw_close (fd);
+        return (map_ != nullptr);
+      }
+
+      /** \brief Convert \a nr_points vertex records starting at \a first_point to cloud points.
+        * \return false on read error
+        */
+      bool
+      read (std::size_t first_point, std::size_t nr_points, std::uint8_t *out, bool &is_dense)
+      {
+        is_dense = true;
+        if (map_)
+        {
+          convertPLYRecords (layout_, map_ + layout_.data_start + first_point * layout_.record_size,
+                             nr_points, out);
+          is_dense = isDensePLYPoints (layout_, out, nr_points);
+          return (true);
+        }
+
+        const std::streampos position = layout_.data_start + first_point * layout_.record_size;
+        if (fs_.tellg () != position)
+          fs_.seekg (position);
+        if (layout_.verbatim)
+        {
+          // Records are read straight into the cloud
+          if (!fs_.read (reinterpret_cast<char*> (out), nr_points * layout_.record_size))
+            return (false);
+          is_dense = isDensePLYPoints (layout_, out, nr_points);
+          return (true);
+        }
+
+        const std::size_t buffer_points = std::max<std::size_t> (1, ply_binary_buffer_size / layout_.record_size);
+        buffer_.resize (std::min (buffer_points, nr_points) * layout_.record_size);
+        for (std::size_t i = 0; i < nr_points; i += buffer_points)
+        {
+          const std::size_t n = std::min (buffer_points, nr_points - i);
+          if (!fs_.read (reinterpret_cast<char*> (buffer_.data ()), n * layout_.record_size))
+            return (false);
+          convertPLYRecords (layout_, buffer_.data (), n, out + i * layout_.point_step);
+          is_dense &= isDensePLYPoints (layout_, out + i * layout_.point_step, n);
+        }
+        return (true);
+      }
+
+    private:
+      const PLYBinaryLayout &layout_;
+      std::ifstream fs_;
+      std::vector<std::uint8_t> buffer_;
+      std::uint8_t *map_{nullptr};
+      std::size_t map_size_{0};
+#ifdef _WIN32
+      HANDLE fm_{nullptr};
+#endif
+  };
+}
+
 std::tuple<std::function<void ()>, std::function<void ()> >
 pcl::PLYReader::elementDefinitionCallback (const std::string& element_name, std::size_t count)
 {
@@ -584,6 +1143,30 @@ pcl::PLYReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
     return (-1);
   }
 
+  PLYBinaryLayout layout;
+  if (binary_fast_path_ && parsePLYBinaryLayout (file_name, layout))
+  {
+    PLYBinaryVertexReader vertices (layout);
+    cloud.fields = layout.fields;
+    cloud.point_step = layout.point_step;
+    cloud.data.clear ();
+    cloud.data.resize (layout.nr_vertices * layout.point_step);
+    bool is_dense = true;
+    if (!vertices.open (file_name, memory_mapping_) ||
+        !vertices.read (0, layout.nr_vertices, cloud.data.data (), is_dense))
+    {
+      PCL_ERROR ("[pcl::PLYReader::read] Failed to read %zu vertices from %s!\n", layout.nr_vertices, file_name.c_str ());
+      return (-1);
+    }
+    cloud.is_dense = is_dense;
+    cloud.width = layout.width;
+    cloud.height = layout.height;
+    cloud.row_step = cloud.point_step * cloud.width;
+    origin = layout.origin;
+    orientation = Eigen::Quaternionf (layout.orientation);
+    return (0);
+  }
+
   if (this->readHeader (file_name, cloud, origin, orientation, ply_version, data_type, data_idx))
   {
     PCL_ERROR ("[pcl::PLYReader::read] problem parsing header!\n");
@@ -666,6 +1249,55 @@ pcl::PLYReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
   return (0);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PLYReader::readChunks (const std::string &file_name, std::size_t chunk_size,
+                            const std::function<bool (const pcl::PCLPointCloud2 &chunk, std::size_t first_point)> &callback)
+{
+  if (chunk_size == 0)
+  {
+    PCL_ERROR ("[pcl::PLYReader::readChunks] The chunk size must be positive!\n");
+    return (-1);
+  }
+
+  PLYBinaryLayout layout;
+  if (!parsePLYBinaryLayout (file_name, layout))
+  {
+    PCL_ERROR ("[pcl::PLYReader::readChunks] %s is not a binary PLY file with fixed size vertices!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  PLYBinaryVertexReader vertices (layout);
+  if (!vertices.open (file_name, memory_mapping_))
+  {
+    PCL_ERROR ("[pcl::PLYReader::readChunks] Failed to open %s!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  pcl::PCLPointCloud2 chunk;
+  chunk.fields = layout.fields;
+  chunk.point_step = layout.point_step;
+  chunk.height = 1;
+  for (std::size_t first_point = 0; first_point < layout.nr_vertices; first_point += chunk_size)
+  {
+    const std::size_t nr_points = std::min (chunk_size, layout.nr_vertices - first_point);
+    chunk.width = static_cast<std::uint32_t> (nr_points);
+    chunk.row_step = chunk.point_step * chunk.width;
+    chunk.data.resize (nr_points * chunk.point_step);
+    bool is_dense = true;
+    if (!vertices.read (first_point, nr_points, chunk.data.data (), is_dense))
+    {
+      PCL_ERROR ("[pcl::PLYReader::readChunks] Failed to read vertices %zu to %zu from %s!\n",
+                 first_point, first_point + nr_points, file_name.c_str ());
+      return (-1);
+    }
+    chunk.is_dense = is_dense;
+    if (!callback (chunk, first_point))
+      break;
+  }
+  return (0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PLYReader::read (const std::string &file_name, pcl::PolygonMesh &mesh,
@@ -123,10 +123,22 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
     interpolated_azimuth_delta = (dataPacket->firingData[index].rotationalPosition - dataPacket->firingData[0].rotationalPosition) / 2.0;
   }
 
-  for (std::uint8_t i = 0; i < HDL_FIRING_PER_PKT; ++i)
+  // The firing blocks are independent of each other: decode them first, possibly in
+  // parallel, then split them into sweeps in order
+  const bool dual_mode = (dataPacket->mode == VLP_DUAL_MODE);
+  double azimuths[HDL_FIRING_PER_PKT][HDL_LASER_PER_FIRING];
+  pcl::PointXYZI points[HDL_FIRING_PER_PKT][HDL_LASER_PER_FIRING];
+  pcl::PointXYZI dual_points[HDL_FIRING_PER_PKT][HDL_LASER_PER_FIRING];
+#pragma omp parallel for \
+  num_threads(threads_) \
+  if(threads_ > 1)
+  for (int i = 0; i < HDL_FIRING_PER_PKT; ++i)
   {
-    HDLFiringData firing_data = dataPacket->firingData[i];
+    // In dual return mode, the odd blocks hold the second returns of the even ones
+    if (dual_mode && i % 2 == 1)
+      continue;
 
+    const HDLFiringData &firing_data = dataPacket->firingData[i];
     for (std::uint8_t j = 0; j < HDL_LASER_PER_FIRING; j++)
     {
       double current_azimuth = firing_data.rotationalPosition;
@@ -138,6 +150,19 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
       {
         current_azimuth -= 36000;
       }
+      azimuths[i][j] = current_azimuth;
+
+      HDLGrabber::computeXYZI (points[i][j], current_azimuth, firing_data.laserReturns[j], laser_corrections_[j % VLP_MAX_NUM_LASERS]);
+      if (dual_mode)
+        HDLGrabber::computeXYZI (dual_points[i][j], current_azimuth, dataPacket->firingData[i + 1].laserReturns[j], laser_corrections_[j % VLP_MAX_NUM_LASERS]);
+    }
+  }
+
+  for (std::uint8_t i = 0; i < HDL_FIRING_PER_PKT; ++i)
+  {
+    for (std::uint8_t j = 0; j < HDL_LASER_PER_FIRING; j++)
+    {
+      const double current_azimuth = azimuths[i][j];
       if (current_azimuth < HDLGrabber::last_azimuth_)
       {
         if (!current_sweep_xyz_->empty ())
@@ -154,19 +179,17 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
 
           HDLGrabber::fireCurrentSweep ();
         }
-        current_sweep_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-        current_sweep_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-        current_sweep_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
+        current_sweep_xyz_ = sweep_xyz_pool_.get ();
+        current_sweep_xyzrgba_ = sweep_xyzrgba_pool_.get ();
+        current_sweep_xyzi_ = sweep_xyzi_pool_.get ();
       }
 
       PointXYZ xyz;
-      PointXYZI xyzi;
       PointXYZRGBA xyzrgba;
       PointXYZ dual_xyz;
-      PointXYZI dual_xyzi;
       PointXYZRGBA dual_xyzrgba;
-
-      HDLGrabber::computeXYZI (xyzi, current_azimuth, firing_data.laserReturns[j], laser_corrections_[j % VLP_MAX_NUM_LASERS]);
+      const PointXYZI &xyzi = points[i][j];
+      const PointXYZI &dual_xyzi = dual_points[i][j];
 
       xyz.x = xyzrgba.x = xyzi.x;
       xyz.y = xyzrgba.y = xyzi.y;
@@ -174,10 +197,8 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
 
       xyzrgba.rgba = laser_rgb_mapping_[j % VLP_MAX_NUM_LASERS].rgba;
 
-      if (dataPacket->mode == VLP_DUAL_MODE)
+      if (dual_mode)
       {
-        HDLGrabber::computeXYZI (dual_xyzi, current_azimuth, dataPacket->firingData[i + 1].laserReturns[j], laser_corrections_[j % VLP_MAX_NUM_LASERS]);
-
         dual_xyz.x = dual_xyzrgba.x = dual_xyzi.x;
         dual_xyz.y = dual_xyzrgba.y = dual_xyzi.y;
         dual_xyz.z = dual_xyzrgba.z = dual_xyzi.z;
@@ -193,7 +214,7 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
 
         last_azimuth_ = current_azimuth;
       }
-      if (dataPacket->mode == VLP_DUAL_MODE)
+      if (dual_mode)
       {
         if ((dual_xyz.x != xyz.x || dual_xyz.y != xyz.y || dual_xyz.z != xyz.z)
             && ! (std::isnan (dual_xyz.x) || std::isnan (dual_xyz.y) || std::isnan (dual_xyz.z)))
@@ -204,7 +225,7 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
         }
       }
     }
-    if (dataPacket->mode == VLP_DUAL_MODE)
+    if (dual_mode)
     {
       i++;
     }
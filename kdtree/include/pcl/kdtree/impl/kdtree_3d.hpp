@@ -0,0 +1,558 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_KDTREE_KDTREE_IMPL_3D_H_
+#define PCL_KDTREE_KDTREE_IMPL_3D_H_
+
+#ifdef __SSE__
+#include <xmmintrin.h> // for __m128
+#endif // ifdef __SSE__
+#ifdef __AVX__
+#include <immintrin.h> // for __m256
+#endif // ifdef __AVX__
+
+#include <pcl/kdtree/kdtree_3d.h>
+#include <pcl/console/print.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace pcl {
+namespace detail {
+/** \brief Restore the max-heap property (on the distances) of the n first entries of
+ * the parallel arrays, starting at position i. */
+inline void
+kdtree3DSiftDown(index_t* indices, float* dists, std::size_t i, std::size_t n)
+{
+  const float dist = dists[i];
+  const index_t index = indices[i];
+  for (std::size_t child = 2 * i + 1; child < n; child = 2 * i + 1) {
+    if (child + 1 < n && dists[child + 1] > dists[child])
+      ++child;
+    if (dists[child] <= dist)
+      break;
+    dists[i] = dists[child];
+    indices[i] = indices[child];
+    i = child;
+  }
+  dists[i] = dist;
+  indices[i] = index;
+}
+
+/** \brief Sort n entries of the parallel arrays, already organized as a max-heap, by
+ * increasing distance. */
+inline void
+kdtree3DSortHeap(index_t* indices, float* dists, std::size_t n)
+{
+  for (std::size_t end = n; end > 1; --end) {
+    std::swap(dists[0], dists[end - 1]);
+    std::swap(indices[0], indices[end - 1]);
+    kdtree3DSiftDown(indices, dists, 0, end - 1);
+  }
+}
+
+/** \brief Sort n entries of the parallel arrays by increasing distance, in place. */
+inline void
+kdtree3DSort(index_t* indices, float* dists, std::size_t n)
+{
+  for (std::size_t i = n / 2; i > 0; --i)
+    kdtree3DSiftDown(indices, dists, i - 1, n);
+  kdtree3DSortHeap(indices, dists, n);
+}
+
+/** \brief Keeps the k closest points in a max-heap stored in caller provided arrays. */
+class KdTree3DKnnResult {
+public:
+  KdTree3DKnnResult(index_t* indices, float* dists, std::size_t k, float bound)
+  : indices_(indices), dists_(dists), k_(k), bound_(bound)
+  {}
+
+  inline float
+  worstDist() const
+  {
+    return (size_ < k_ ? bound_ : dists_[0]);
+  }
+
+  inline void
+  addPoint(float dist, index_t index)
+  {
+    if (size_ < k_) {
+      // sift up
+      std::size_t i = size_++;
+      while (i > 0) {
+        const std::size_t parent = (i - 1) / 2;
+        if (dists_[parent] >= dist)
+          break;
+        dists_[i] = dists_[parent];
+        indices_[i] = indices_[parent];
+        i = parent;
+      }
+      dists_[i] = dist;
+      indices_[i] = index;
+    }
+    else if (dist < dists_[0]) {
+      dists_[0] = dist;
+      indices_[0] = index;
+      kdtree3DSiftDown(indices_, dists_, 0, k_);
+    }
+  }
+
+  inline std::size_t
+  size() const
+  {
+    return (size_);
+  }
+
+  /** \brief Sort the results by increasing distance. */
+  inline void
+  sort()
+  {
+    kdtree3DSortHeap(indices_, dists_, size_);
+  }
+
+private:
+  index_t* indices_;
+  float* dists_;
+  std::size_t k_;
+  std::size_t size_{0};
+  float bound_;
+};
+
+/** \brief Collects all points closer than a given bound. */
+class KdTree3DRadiusResult {
+public:
+  KdTree3DRadiusResult(Indices& indices, std::vector<float>& dists, float bound)
+  : indices_(indices), dists_(dists), bound_(bound)
+  {}
+
+  inline float
+  worstDist() const
+  {
+    return (bound_);
+  }
+
+  inline void
+  addPoint(float dist, index_t index)
+  {
+    dists_.push_back(dist);
+    indices_.push_back(index);
+  }
+
+private:
+  Indices& indices_;
+  std::vector<float>& dists_;
+  float bound_;
+};
+} // namespace detail
+} // namespace pcl
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void
+pcl::KdTree3D<PointT>::setInputCloud(const PointCloudConstPtr& cloud,
+                                     const IndicesConstPtr& indices)
+{
+  nodes_.clear();
+  buckets_.clear();
+  bucket_indices_.clear();
+  total_nr_points_ = 0;
+
+  epsilon_ = 0.0f; // default error bound value
+
+  input_ = cloud;
+  indices_ = indices;
+
+  if (!input_) {
+    PCL_ERROR("[pcl::KdTree3D::setInputCloud] Invalid input!\n");
+    return;
+  }
+  if (point_representation_->getNumberOfDimensions() != 3) {
+    PCL_ERROR("[pcl::KdTree3D::setInputCloud] The point representation has %d "
+              "dimensions, only 3 are supported!\n",
+              point_representation_->getNumberOfDimensions());
+    return;
+  }
+
+  // Vectorize the valid points, remembering their index in the input cloud
+  const std::size_t nr_candidates = indices_ ? indices_->size() : input_->size();
+  std::vector<float> points;
+  points.reserve(3 * nr_candidates);
+  Indices point_indices;
+  point_indices.reserve(nr_candidates);
+  for (std::size_t i = 0; i < nr_candidates; ++i) {
+    const index_t index = indices_ ? (*indices_)[i] : static_cast<index_t>(i);
+    const PointT& point = (*input_)[index];
+    if (!point_representation_->isValid(point))
+      continue;
+    float vec[3];
+    point_representation_->vectorize(point, vec);
+    points.insert(points.end(), vec, vec + 3);
+    point_indices.push_back(index);
+  }
+
+  total_nr_points_ = static_cast<uindex_t>(point_indices.size());
+  if (total_nr_points_ == 0) {
+    PCL_ERROR("[pcl::KdTree3D::setInputCloud] Cannot create a KDTree with an empty "
+              "input cloud!\n");
+    return;
+  }
+
+  min_pt_.fill(std::numeric_limits<float>::max());
+  max_pt_.fill(std::numeric_limits<float>::lowest());
+  for (std::size_t i = 0; i < points.size(); i += 3) {
+    for (std::size_t d = 0; d < 3; ++d) {
+      min_pt_[d] = std::min(min_pt_[d], points[i + d]);
+      max_pt_[d] = std::max(max_pt_[d], points[i + d]);
+    }
+  }
+
+  // A leaf holds between max_leaf_size_ / 2 and max_leaf_size_ points
+  const std::size_t half_leaf = std::max<std::size_t>(max_leaf_size_ / 2, 1);
+  const std::size_t leaves = (total_nr_points_ + half_leaf - 1) / half_leaf;
+  nodes_.reserve(2 * leaves);
+  buckets_.reserve(3 * (total_nr_points_ + leaves * (bucket_size - 1)));
+
+  std::vector<uindex_t> order(total_nr_points_);
+  for (uindex_t i = 0; i < total_nr_points_; ++i)
+    order[i] = i;
+  buildLevel(points, order, 0, order.size());
+
+  // Translate the bucket slots into indices of the input cloud
+  for (auto& index : bucket_indices_)
+    if (index != -1)
+      index = point_indices[index];
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void
+pcl::KdTree3D<PointT>::buildLevel(const std::vector<float>& points,
+                                  std::vector<uindex_t>& order,
+                                  std::size_t begin,
+                                  std::size_t end)
+{
+  const std::size_t node_index = nodes_.size();
+  nodes_.emplace_back();
+
+  const std::size_t nr_points = end - begin;
+  if (nr_points <= max_leaf_size_) {
+    const std::size_t nr_buckets = (nr_points + bucket_size - 1) / bucket_size;
+    const std::size_t first_bucket = bucket_indices_.size() / bucket_size;
+    nodes_[node_index].first_ = static_cast<std::uint32_t>(first_bucket);
+    nodes_[node_index].info_ = static_cast<std::uint32_t>(nr_buckets) | leaf_flag;
+
+    buckets_.resize(3 * bucket_size * (first_bucket + nr_buckets),
+                    std::numeric_limits<float>::quiet_NaN());
+    bucket_indices_.resize(bucket_size * (first_bucket + nr_buckets), -1);
+    for (std::size_t i = 0; i < nr_points; ++i) {
+      const std::size_t bucket = first_bucket + i / bucket_size;
+      const std::size_t slot = i % bucket_size;
+      const float* point = &points[3 * order[begin + i]];
+      for (std::size_t d = 0; d < 3; ++d)
+        buckets_[(3 * bucket + d) * bucket_size + slot] = point[d];
+      bucket_indices_[bucket * bucket_size + slot] =
+          static_cast<index_t>(order[begin + i]);
+    }
+    return;
+  }
+
+  // Split at the median of the dimension with the largest spread
+  std::array<float, 3> min_pt, max_pt;
+  min_pt.fill(std::numeric_limits<float>::max());
+  max_pt.fill(std::numeric_limits<float>::lowest());
+  for (std::size_t i = begin; i < end; ++i) {
+    const float* point = &points[3 * order[i]];
+    for (std::size_t d = 0; d < 3; ++d) {
+      min_pt[d] = std::min(min_pt[d], point[d]);
+      max_pt[d] = std::max(max_pt[d], point[d]);
+    }
+  }
+  std::uint32_t dim = 0;
+  for (std::uint32_t d = 1; d < 3; ++d)
+    if (max_pt[d] - min_pt[d] > max_pt[dim] - min_pt[dim])
+      dim = d;
+
+  const std::size_t mid = begin + nr_points / 2;
+  std::nth_element(order.begin() + begin,
+                   order.begin() + mid,
+                   order.begin() + end,
+                   [&points, dim](uindex_t a, uindex_t b) {
+                     return (points[3 * a + dim] < points[3 * b + dim]);
+                   });
+
+  float split_low = std::numeric_limits<float>::lowest();
+  for (std::size_t i = begin; i < mid; ++i)
+    split_low = std::max(split_low, points[3 * order[i] + dim]);
+  nodes_[node_index].split_low_ = split_low;
+  nodes_[node_index].split_high_ = points[3 * order[mid] + dim];
+  nodes_[node_index].info_ = dim;
+
+  buildLevel(points, order, begin, mid);
+  nodes_[node_index].first_ = static_cast<std::uint32_t>(nodes_.size());
+  buildLevel(points, order, mid, end);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+float
+pcl::KdTree3D<PointT>::initialDistances(const float* query,
+                                        std::array<float, 3>& dists) const
+{
+  float min_dist = 0.0f;
+  for (std::size_t d = 0; d < 3; ++d) {
+    dists[d] = 0.0f;
+    if (query[d] < min_pt_[d])
+      dists[d] = (min_pt_[d] - query[d]) * (min_pt_[d] - query[d]);
+    else if (query[d] > max_pt_[d])
+      dists[d] = (query[d] - max_pt_[d]) * (query[d] - max_pt_[d]);
+    min_dist += dists[d];
+  }
+  return (min_dist);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+template <typename ResultSet>
+void
+pcl::KdTree3D<PointT>::searchLevel(std::uint32_t node_index,
+                                   const float* query,
+                                   float min_dist,
+                                   std::array<float, 3>& dists,
+                                   float eps_factor,
+                                   ResultSet& result) const
+{
+  const Node& node = nodes_[node_index];
+  if (node.info_ & leaf_flag) {
+    searchLeaf(node, query, result);
+    return;
+  }
+
+  // Descend into the closer child first
+  const std::uint32_t dim = node.info_;
+  const float diff_low = query[dim] - node.split_low_;
+  const float diff_high = query[dim] - node.split_high_;
+  std::uint32_t best_child, other_child;
+  float cut_dist;
+  if (diff_low + diff_high < 0.0f) {
+    best_child = node_index + 1;
+    other_child = node.first_;
+    cut_dist = diff_high * diff_high;
+  }
+  else {
+    best_child = node.first_;
+    other_child = node_index + 1;
+    cut_dist = diff_low * diff_low;
+  }
+  searchLevel(best_child, query, min_dist, dists, eps_factor, result);
+
+  // Visit the other child only if it may contain closer points
+  const float dim_dist = dists[dim];
+  min_dist += cut_dist - dim_dist;
+  if (min_dist * eps_factor < result.worstDist()) {
+    dists[dim] = cut_dist;
+    searchLevel(other_child, query, min_dist, dists, eps_factor, result);
+    dists[dim] = dim_dist;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+template <typename ResultSet>
+void
+pcl::KdTree3D<PointT>::searchLeaf(const Node& leaf,
+                                  const float* query,
+                                  ResultSet& result) const
+{
+  const std::uint32_t nr_buckets = leaf.info_ & ~leaf_flag;
+  const float* bucket = &buckets_[3 * bucket_size * leaf.first_];
+  const index_t* bucket_indices = &bucket_indices_[bucket_size * leaf.first_];
+  float dists[bucket_size];
+#if defined(__AVX__)
+  const __m256 qx = _mm256_set1_ps(query[0]);
+  const __m256 qy = _mm256_set1_ps(query[1]);
+  const __m256 qz = _mm256_set1_ps(query[2]);
+  for (std::uint32_t b = 0; b < nr_buckets;
+       ++b, bucket += 3 * bucket_size, bucket_indices += bucket_size) {
+    const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(bucket), qx);
+    const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(bucket + 8), qy);
+    const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(bucket + 16), qz);
+    const __m256 dist = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+        _mm256_mul_ps(dz, dz));
+    // Unused slots are NaN, so they never pass the comparison
+    const int mask = _mm256_movemask_ps(
+        _mm256_cmp_ps(dist, _mm256_set1_ps(result.worstDist()), _CMP_LT_OQ));
+    if (mask == 0)
+      continue;
+    _mm256_storeu_ps(dists, dist);
+#elif defined(__SSE__)
+  const __m128 qx = _mm_set1_ps(query[0]);
+  const __m128 qy = _mm_set1_ps(query[1]);
+  const __m128 qz = _mm_set1_ps(query[2]);
+  for (std::uint32_t b = 0; b < nr_buckets;
+       ++b, bucket += 3 * bucket_size, bucket_indices += bucket_size) {
+    const __m128 worst = _mm_set1_ps(result.worstDist());
+    int mask = 0;
+    for (std::size_t half = 0; half < 2; ++half) {
+      const __m128 dx = _mm_sub_ps(_mm_loadu_ps(bucket + 4 * half), qx);
+      const __m128 dy = _mm_sub_ps(_mm_loadu_ps(bucket + 8 + 4 * half), qy);
+      const __m128 dz = _mm_sub_ps(_mm_loadu_ps(bucket + 16 + 4 * half), qz);
+      const __m128 dist = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+      // Unused slots are NaN, so they never pass the comparison
+      mask |= _mm_movemask_ps(_mm_cmplt_ps(dist, worst)) << (4 * half);
+      _mm_storeu_ps(dists + 4 * half, dist);
+    }
+    if (mask == 0)
+      continue;
+#else
+  for (std::uint32_t b = 0; b < nr_buckets;
+       ++b, bucket += 3 * bucket_size, bucket_indices += bucket_size) {
+    const float worst = result.worstDist();
+    int mask = 0;
+    for (std::size_t i = 0; i < bucket_size; ++i) {
+      const float dx = bucket[i] - query[0];
+      const float dy = bucket[bucket_size + i] - query[1];
+      const float dz = bucket[2 * bucket_size + i] - query[2];
+      dists[i] = dx * dx + dy * dy + dz * dz;
+      // Unused slots are NaN, so they never pass the comparison
+      if (dists[i] < worst)
+        mask |= 1 << i;
+    }
+    if (mask == 0)
+      continue;
+#endif
+    for (std::size_t i = 0; i < bucket_size; ++i)
+      if ((mask & (1 << i)) && dists[i] < result.worstDist())
+        result.addPoint(dists[i], bucket_indices[i]);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+int
+pcl::KdTree3D<PointT>::nearestKSearch(const PointT& point,
+                                      unsigned int k,
+                                      Indices& k_indices,
+                                      std::vector<float>& k_distances) const
+{
+  assert(point_representation_->isValid(point) &&
+         "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  if (k > total_nr_points_)
+    k = total_nr_points_;
+
+  k_indices.resize(k);
+  k_distances.resize(k);
+
+  if (k == 0)
+    return 0;
+
+  float query[3];
+  point_representation_->vectorize(point, query);
+
+  std::array<float, 3> dists;
+  const float min_dist = initialDistances(query, dists);
+  const float eps_factor = (1.0f + epsilon_) * (1.0f + epsilon_);
+
+  pcl::detail::KdTree3DKnnResult result(k_indices.data(),
+                                        k_distances.data(),
+                                        k,
+                                        std::numeric_limits<float>::infinity());
+  searchLevel(0, query, min_dist, dists, eps_factor, result);
+  result.sort();
+
+  return (k);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+int
+pcl::KdTree3D<PointT>::radiusSearch(const PointT& point,
+                                    double radius,
+                                    Indices& k_indices,
+                                    std::vector<float>& k_sqr_dists,
+                                    unsigned int max_nn) const
+{
+  assert(point_representation_->isValid(point) &&
+         "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  if (total_nr_points_ == 0) {
+    k_indices.clear();
+    k_sqr_dists.clear();
+    return 0;
+  }
+
+  float query[3];
+  point_representation_->vectorize(point, query);
+
+  std::array<float, 3> dists;
+  const float min_dist = initialDistances(query, dists);
+  const float eps_factor = (1.0f + epsilon_) * (1.0f + epsilon_);
+  const auto sqr_radius = static_cast<float>(radius * radius);
+
+  // Has max_nn been set properly?
+  if (max_nn == 0 || max_nn > total_nr_points_)
+    max_nn = total_nr_points_;
+
+  if (max_nn < total_nr_points_) {
+    // Keep the max_nn closest points in radius
+    k_indices.resize(max_nn);
+    k_sqr_dists.resize(max_nn);
+    pcl::detail::KdTree3DKnnResult result(
+        k_indices.data(), k_sqr_dists.data(), max_nn, sqr_radius);
+    searchLevel(0, query, min_dist, dists, eps_factor, result);
+    if (sorted_)
+      result.sort();
+    k_indices.resize(result.size());
+    k_sqr_dists.resize(result.size());
+  }
+  else {
+    k_indices.clear();
+    k_sqr_dists.clear();
+    pcl::detail::KdTree3DRadiusResult result(k_indices, k_sqr_dists, sqr_radius);
+    searchLevel(0, query, min_dist, dists, eps_factor, result);
+    if (sorted_)
+      pcl::detail::kdtree3DSort(k_indices.data(), k_sqr_dists.data(), k_indices.size());
+  }
+
+  return (static_cast<int>(k_indices.size()));
+}
+
+#define PCL_INSTANTIATE_KdTree3D(T) template class PCL_EXPORTS pcl::KdTree3D<T>;
+
+#endif // PCL_KDTREE_KDTREE_IMPL_3D_H_
@@ -0,0 +1,278 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/kdtree/kdtree.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace pcl {
+/** \brief KdTree3D is a kd-tree specialized for three dimensional point
+ * representations (i.e. x, y and z), implemented natively in PCL.
+ *
+ * Compared to \ref KdTreeFLANN, which handles an arbitrary number of dimensions, the
+ * layout of the tree is tailored to 3D:
+ *  - the nodes are stored in a single array in depth-first order, 16 bytes each. The
+ *    left child of an inner node is the node that directly follows it, so only the
+ *    right child has to be referenced;
+ *  - the points of a leaf are stored in buckets of 8 (x[8], y[8], z[8]), so that the
+ *    squared distances of a whole bucket are computed with a few SSE or AVX
+ *    instructions (if available);
+ *  - nearest neighbor searches collect the results in a binary heap that lives in the
+ *    output vectors, so no memory is allocated per query once the output vectors have
+ *    the required capacity.
+ *
+ * The point representation must have exactly 3 dimensions. The tree can be used through
+ * \ref pcl::search::KdTree by passing it as the second template argument, e.g.
+ * pcl::search::KdTree<pcl::PointXYZ, pcl::KdTree3D<pcl::PointXYZ>>.
+ *
+ * \ingroup kdtree
+ */
+template <typename PointT>
+class KdTree3D : public pcl::KdTree<PointT> {
+public:
+  using KdTree<PointT>::input_;
+  using KdTree<PointT>::indices_;
+  using KdTree<PointT>::epsilon_;
+  using KdTree<PointT>::sorted_;
+  using KdTree<PointT>::point_representation_;
+  using KdTree<PointT>::nearestKSearch;
+  using KdTree<PointT>::radiusSearch;
+
+  using PointCloud = typename KdTree<PointT>::PointCloud;
+  using PointCloudConstPtr = typename KdTree<PointT>::PointCloudConstPtr;
+
+  using IndicesPtr = shared_ptr<Indices>;
+  using IndicesConstPtr = shared_ptr<const Indices>;
+
+  // Boost shared pointers
+  using Ptr = shared_ptr<KdTree3D<PointT>>;
+  using ConstPtr = shared_ptr<const KdTree3D<PointT>>;
+
+  /** \brief Default Constructor for KdTree3D.
+   * \param[in] sorted set to true if the application that the tree will be used for
+   * requires sorted nearest neighbor indices (default). False otherwise.
+   *
+   * By setting sorted to false, the \ref radiusSearch operations will be faster.
+   */
+  KdTree3D(bool sorted = true) : pcl::KdTree<PointT>(sorted) {}
+
+  /** \brief Destructor for KdTree3D. */
+  ~KdTree3D() override = default;
+
+  inline Ptr
+  makeShared()
+  {
+    return Ptr(new KdTree3D<PointT>(*this));
+  }
+
+  /** \brief Sets whether the results of \ref radiusSearch have to be sorted or not.
+   * \param[in] sorted set to true if the radius search results should be sorted
+   */
+  inline void
+  setSortedResults(bool sorted)
+  {
+    sorted_ = sorted;
+  }
+
+  /** \brief Set the maximum number of points stored in a leaf. The new value is used
+   * the next time the tree is built (i.e. by \ref setInputCloud).
+   * \param[in] max_leaf_size the maximum number of points per leaf (default: 16)
+   */
+  inline void
+  setMaxLeafSize(unsigned int max_leaf_size)
+  {
+    max_leaf_size_ = max_leaf_size > 0 ? max_leaf_size : 1;
+  }
+
+  /** \brief Get the maximum number of points stored in a leaf. */
+  inline unsigned int
+  getMaxLeafSize() const
+  {
+    return (max_leaf_size_);
+  }
+
+  /** \brief Provide a pointer to the input dataset and build the tree.
+   * \param[in] cloud the const boost shared pointer to a PointCloud message
+   * \param[in] indices the point indices subset that is to be used from \a cloud - if
+   * NULL the whole cloud is used
+   */
+  void
+  setInputCloud(const PointCloudConstPtr& cloud,
+                const IndicesConstPtr& indices = IndicesConstPtr()) override;
+
+  /** \brief Search for k-nearest neighbors for the given query point.
+   *
+   * \attention This method does not do any bounds checking for the input index
+   * (i.e., index >= cloud.size () || index < 0), and assumes valid (i.e., finite) data.
+   *
+   * \param[in] point a given \a valid (i.e., finite) query point
+   * \param[in] k the number of neighbors to search for
+   * \param[out] k_indices the resultant indices of the neighboring points, sorted by
+   * increasing distance
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points
+   * \return number of neighbors found
+   */
+  int
+  nearestKSearch(const PointT& point,
+                 unsigned int k,
+                 Indices& k_indices,
+                 std::vector<float>& k_sqr_distances) const override;
+
+  /** \brief Search for all the nearest neighbors of the query point in a given radius.
+   *
+   * \attention This method does not do any bounds checking for the input index
+   * (i.e., index >= cloud.size () || index < 0), and assumes valid (i.e., finite) data.
+   *
+   * \param[in] point a given \a valid (i.e., finite) query point
+   * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+   * \param[out] k_indices the resultant indices of the neighboring points
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points
+   * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+   * (the \a max_nn closest ones are returned). If \a max_nn is set to 0 or to a number
+   * higher than the number of points in the input cloud, all neighbors in \a radius
+   * will be returned.
+   * \return number of neighbors found in radius
+   */
+  int
+  radiusSearch(const PointT& point,
+               double radius,
+               Indices& k_indices,
+               std::vector<float>& k_sqr_distances,
+               unsigned int max_nn = 0) const override;
+
+protected:
+  /** \brief A node of the tree. Inner nodes store the split dimension in \a info_
+   * and the index of their right child in \a first_; the left child directly follows
+   * the node. Leaves have \ref leaf_flag set in \a info_, the remaining bits hold the
+   * number of buckets, and \a first_ is the index of their first bucket.
+   */
+  struct Node {
+    /** \brief Largest coordinate of the left subtree along the split dimension. */
+    float split_low_;
+    /** \brief Smallest coordinate of the right subtree along the split dimension. */
+    float split_high_;
+    std::uint32_t first_;
+    std::uint32_t info_;
+  };
+
+  static constexpr std::uint32_t leaf_flag = 0x80000000u;
+
+  /** \brief Number of points per bucket. */
+  static constexpr unsigned int bucket_size = 8;
+
+  /** \brief Recursively build the subtree holding the points order[begin, end).
+   * \param[in] points the vectorized points (x, y, z interleaved)
+   * \param[in,out] order the permutation of the points, reordered in place
+   * \param[in] begin first position in \a order
+   * \param[in] end one past the last position in \a order
+   */
+  void
+  buildLevel(const std::vector<float>& points,
+             std::vector<uindex_t>& order,
+             std::size_t begin,
+             std::size_t end);
+
+  /** \brief Recursively search the subtree rooted at \a node_index.
+   * \param[in] node_index the index of the subtree root in nodes_
+   * \param[in] query the query point
+   * \param[in] min_dist a lower bound of the squared distance from \a query to the
+   * subtree
+   * \param[in,out] dists per dimension contributions to \a min_dist
+   * \param[in] eps_factor the pruning factor derived from epsilon_
+   * \param[in,out] result the result set, see \ref searchLeaf
+   */
+  template <typename ResultSet>
+  void
+  searchLevel(std::uint32_t node_index,
+              const float* query,
+              float min_dist,
+              std::array<float, 3>& dists,
+              float eps_factor,
+              ResultSet& result) const;
+
+  /** \brief Compute the squared distances from \a query to the points of a leaf and add
+   * the ones closer than result.worstDist () to \a result.
+   */
+  template <typename ResultSet>
+  void
+  searchLeaf(const Node& leaf, const float* query, ResultSet& result) const;
+
+  /** \brief Compute the initial per dimension distances from \a query to the bounding
+   * box of the tree, and return their sum.
+   */
+  float
+  initialDistances(const float* query, std::array<float, 3>& dists) const;
+
+private:
+  /** \brief Class getName method. */
+  std::string
+  getName() const override
+  {
+    return ("KdTree3D");
+  }
+
+  /** \brief The nodes of the tree, in depth-first order. */
+  std::vector<Node> nodes_;
+
+  /** \brief The coordinates of the points in buckets of \ref bucket_size points, stored
+   * as x[bucket_size], y[bucket_size], z[bucket_size]. Unused slots are NaN. */
+  std::vector<float> buckets_;
+
+  /** \brief The index (in the input cloud) of every bucket slot, -1 for unused ones. */
+  Indices bucket_indices_;
+
+  /** \brief Bounding box of the points in the tree. */
+  std::array<float, 3> min_pt_{};
+  std::array<float, 3> max_pt_{};
+
+  /** \brief The number of valid points in the tree. */
+  uindex_t total_nr_points_{0};
+
+  /** \brief The maximum number of points per leaf. */
+  unsigned int max_leaf_size_{16};
+};
+} // namespace pcl
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/kdtree/impl/kdtree_3d.hpp>
+#endif
@@ -177,6 +177,36 @@ OctreeBase<LeafContainerT, BranchContainerT>::deleteTree()
     leaf_count_ = 0;
     branch_count_ = 1;
   }
+
+  branch_array_.release();
+  leaf_array_.release();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT, typename BranchContainerT>
+void
+OctreeBase<LeafContainerT, BranchContainerT>::compact()
+{
+  std::size_t branch_count = 0;
+  std::size_t leaf_count = 0;
+  countNodesRecursive(*root_node_, branch_count, leaf_count);
+
+  OctreeNodeArray<BranchNode> branch_array;
+  OctreeNodeArray<LeafNode> leaf_array;
+  branch_array.allocate(branch_count);
+  leaf_array.allocate(leaf_count);
+
+  // collect the copied children of the root in a temporary branch node
+  BranchNode root_children;
+  compactRecursive(*root_node_, root_children, branch_array, leaf_array);
+
+  // delete the old nodes before their storage is replaced
+  deleteBranch(*root_node_);
+  branch_array_.swap(branch_array);
+  leaf_array_.swap(leaf_array);
+
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++)
+    root_node_->setChildPtr(root_children.getChildPtr(child_idx), child_idx);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -439,6 +469,62 @@ OctreeBase<LeafContainerT, BranchContainerT>::deleteLeafRecursive(
   return (b_has_children);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT, typename BranchContainerT>
+void
+OctreeBase<LeafContainerT, BranchContainerT>::countNodesRecursive(
+    const BranchNode& branch_arg,
+    std::size_t& branch_count_arg,
+    std::size_t& leaf_count_arg) const
+{
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++) {
+    const OctreeNode* child_node = branch_arg.getChildPtr(child_idx);
+    if (!child_node)
+      continue;
+
+    if (child_node->getNodeType() == BRANCH_NODE) {
+      branch_count_arg++;
+      countNodesRecursive(
+          *static_cast<const BranchNode*>(child_node), branch_count_arg, leaf_count_arg);
+    }
+    else
+      leaf_count_arg++;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT, typename BranchContainerT>
+void
+OctreeBase<LeafContainerT, BranchContainerT>::compactRecursive(
+    const BranchNode& source_arg,
+    BranchNode& target_arg,
+    OctreeNodeArray<BranchNode>& branch_array_arg,
+    OctreeNodeArray<LeafNode>& leaf_array_arg)
+{
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++) {
+    const OctreeNode* child_node = source_arg.getChildPtr(child_idx);
+    if (!child_node)
+      continue;
+
+    if (child_node->getNodeType() == BRANCH_NODE) {
+      const auto* child_branch = static_cast<const BranchNode*>(child_node);
+
+      // the branch copy constructor would deep copy the children, so only the
+      // container is copied here and the children are placed depth-first below
+      BranchNode* new_branch = branch_array_arg.construct();
+      new_branch->getContainer() = child_branch->getContainer();
+      target_arg.setChildPtr(new_branch, child_idx);
+
+      compactRecursive(*child_branch, *new_branch, branch_array_arg, leaf_array_arg);
+    }
+    else {
+      LeafNode* new_leaf =
+          leaf_array_arg.construct(*static_cast<const LeafNode*>(child_node));
+      target_arg.setChildPtr(new_leaf, child_idx);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename LeafContainerT, typename BranchContainerT>
 void
@@ -43,7 +43,76 @@
 #include <pcl/octree/impl/octree_base.hpp>
 #include <pcl/types.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl {
+namespace octree {
+namespace detail {
+/** \brief Spread the 21 lower bits of a key, two zero bits apart. */
+inline std::uint64_t
+spreadMortonBits(uindex_t key_arg)
+{
+  std::uint64_t bits = key_arg & 0x1fffff;
+  bits = (bits | bits << 32) & 0x1f00000000ffffull;
+  bits = (bits | bits << 16) & 0x1f0000ff0000ffull;
+  bits = (bits | bits << 8) & 0x100f00f00f00f00full;
+  bits = (bits | bits << 4) & 0x10c30c30c30c30c3ull;
+  bits = (bits | bits << 2) & 0x1249249249249249ull;
+  return bits;
+}
+
+/** \brief Morton code of an octree key: bits 3d+2, 3d+1 and 3d hold the child index of
+ * the key at depth mask 1 << d (see OctreeKey::getChildIdxWithDepthMask).
+ */
+inline std::uint64_t
+getMortonCode(const OctreeKey& key_arg)
+{
+  return (spreadMortonBits(key_arg.x) << 2) | (spreadMortonBits(key_arg.y) << 1) |
+         spreadMortonBits(key_arg.z);
+}
+
+/** \brief Sort chunks of the vector in parallel, then merge them pairwise. */
+template <typename T>
+void
+parallelSort(std::vector<T>& data, unsigned int nr_threads)
+{
+  const std::size_t nr_chunks = nr_threads;
+  if (nr_chunks <= 1 || data.size() < 8 * 1024 * nr_chunks) {
+    std::sort(data.begin(), data.end());
+    return;
+  }
+
+  std::vector<std::size_t> bounds(nr_chunks + 1);
+  for (std::size_t i = 0; i <= nr_chunks; ++i)
+    bounds[i] = data.size() * i / nr_chunks;
+
+#pragma omp parallel for num_threads(nr_threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nr_chunks); ++i)
+    std::sort(data.begin() + bounds[i], data.begin() + bounds[i + 1]);
+
+  for (std::size_t width = 1; width < nr_chunks; width *= 2) {
+#pragma omp parallel for num_threads(nr_threads)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nr_chunks);
+         i += static_cast<std::ptrdiff_t>(2 * width)) {
+      const auto first = static_cast<std::size_t>(i);
+      if (first + width < nr_chunks)
+        std::inplace_merge(data.begin() + bounds[first],
+                           data.begin() + bounds[first + width],
+                           data.begin() + bounds[std::min(first + 2 * width, nr_chunks)]);
+    }
+  }
+}
+} // namespace detail
+} // namespace octree
+} // namespace pcl
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
@@ -76,6 +145,9 @@ void
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
     addPointsFromInputCloud()
 {
+  if (bulk_build_ && addPointsFromInputCloudBulk())
+    return;
+
   if (indices_) {
     for (const auto& index : *indices_) {
       assert((index >= 0) && (static_cast<std::size_t>(index) < input_->size()));
@@ -96,6 +168,188 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    setNumberOfThreads(unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG("[pcl::octree::OctreePointCloud::setNumberOfThreads] Setting number of "
+            "threads to %u.\n",
+            threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN("[pcl::octree::OctreePointCloud::setNumberOfThreads] Parallelization is "
+             "requested, but OpenMP is not available! Continuing without "
+             "parallelization.\n");
+#endif // _OPENMP
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+bool
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    addPointsFromInputCloudBulk()
+{
+  if (this->leaf_count_ != 0 || this->dynamic_depth_enabled_)
+    return false;
+
+  const std::size_t nr_points = indices_ ? indices_->size() : input_->size();
+  if (nr_points == 0)
+    return true;
+
+  if (!bounding_box_defined_)
+    defineBoundingBox();
+
+  // Morton codes of 64 bits hold the keys of 21 levels
+  if (this->octree_depth_ > 21)
+    return false;
+
+  // Compute the Morton codes of the points. Invalid points get the largest code and are
+  // dropped after the sort.
+  constexpr std::uint64_t invalid_code = std::numeric_limits<std::uint64_t>::max();
+  std::vector<MortonPoint> points(nr_points);
+  std::size_t nr_outside = 0;
+#pragma omp parallel for num_threads(threads_) reduction(+ : nr_outside)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nr_points); ++i) {
+    const auto index = indices_ ? static_cast<uindex_t>((*indices_)[i])
+                                : static_cast<uindex_t>(i);
+    const PointT& point = (*input_)[index];
+    points[i].index = index;
+    points[i].code = invalid_code;
+    if (!isFinite(point))
+      continue;
+    if (!isPointWithinBoundingBox(point)) {
+      ++nr_outside;
+      continue;
+    }
+    OctreeKey key;
+    genOctreeKeyforPoint(point, key);
+    points[i].code = detail::getMortonCode(key);
+  }
+
+  // The bounding box has to grow: insert the points one by one
+  if (nr_outside != 0)
+    return false;
+
+  detail::parallelSort(points, threads_);
+
+  const MortonPoint* begin = points.data();
+  const MortonPoint* end = std::lower_bound(
+      begin, begin + points.size(), MortonPoint{invalid_code, 0});
+  if (begin == end)
+    return true;
+
+  // Create the top levels of the tree until there are enough independent subtrees to
+  // build in parallel
+  struct BulkSubtree {
+    BranchNode* branch;
+    const MortonPoint* begin;
+    const MortonPoint* end;
+    uindex_t depth_mask;
+  };
+  std::vector<BulkSubtree> subtrees{{this->root_node_, begin, end, this->depth_mask_}};
+  std::size_t branch_count = 0;
+  std::size_t leaf_count = 0;
+  while (subtrees.size() < 8 * threads_ && subtrees.front().depth_mask > 1) {
+    std::vector<BulkSubtree> children;
+    for (const auto& subtree : subtrees) {
+      unsigned int shift = 0;
+      while ((uindex_t{1} << shift) < subtree.depth_mask)
+        ++shift;
+      const MortonPoint* child_begin = subtree.begin;
+      while (child_begin != subtree.end) {
+        const auto child_idx = static_cast<unsigned char>((child_begin->code >> (3 * shift)) & 7);
+        const MortonPoint* child_end =
+            std::partition_point(child_begin, subtree.end, [&](const MortonPoint& p) {
+              return ((p.code >> (3 * shift)) & 7) == child_idx;
+            });
+        BranchNode* child_branch =
+            this->reuseOrCreateBranchChild(*subtree.branch, child_idx);
+        ++branch_count;
+        children.push_back(
+            {child_branch, child_begin, child_end, subtree.depth_mask >> 1});
+        child_begin = child_end;
+      }
+    }
+    subtrees.swap(children);
+  }
+
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 1)                   \
+    reduction(+ : branch_count, leaf_count)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(subtrees.size()); ++i) {
+    buildBulkRecursive(*subtrees[i].branch,
+                       subtrees[i].begin,
+                       subtrees[i].end,
+                       subtrees[i].depth_mask,
+                       branch_count,
+                       leaf_count);
+  }
+
+  this->branch_count_ += branch_count;
+  this->leaf_count_ += leaf_count;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    buildBulkRecursive(BranchNode& branch_arg,
+                       const MortonPoint* begin_arg,
+                       const MortonPoint* end_arg,
+                       uindex_t depth_mask_arg,
+                       std::size_t& branch_count_arg,
+                       std::size_t& leaf_count_arg)
+{
+  unsigned int shift = 0;
+  while ((uindex_t{1} << shift) < depth_mask_arg)
+    ++shift;
+
+  // The points of each child are contiguous, in increasing child index order
+  const MortonPoint* child_begin = begin_arg;
+  while (child_begin != end_arg) {
+    const auto child_idx = static_cast<unsigned char>((child_begin->code >> (3 * shift)) & 7);
+    const MortonPoint* child_end =
+        std::partition_point(child_begin, end_arg, [&](const MortonPoint& p) {
+          return ((p.code >> (3 * shift)) & 7) == child_idx;
+        });
+
+    if (depth_mask_arg > 1) {
+      BranchNode* child_branch = this->reuseOrCreateBranchChild(branch_arg, child_idx);
+      ++branch_count_arg;
+      buildBulkRecursive(*child_branch,
+                         child_begin,
+                         child_end,
+                         depth_mask_arg >> 1,
+                         branch_count_arg,
+                         leaf_count_arg);
+    }
+    else {
+      LeafNode* child_leaf = this->reuseOrCreateLeafChild(branch_arg, child_idx);
+      ++leaf_count_arg;
+      for (const MortonPoint* point = child_begin; point != child_end; ++point)
+        addPointToLeaf(child_leaf->getContainer(), point->index);
+    }
+    child_begin = child_end;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
           typename LeafContainerT,
@@ -95,7 +95,12 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   }
   this->defineBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
 
+  // The bulk build computes the keys without the transform function
+  const bool bulk_build = this->bulk_build_;
+  if (transform_func_)
+    this->bulk_build_ = false;
   OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::addPointsFromInputCloud();
+  this->bulk_build_ = bulk_build;
 
   leaf_vector_.reserve(this->getLeafCount());
   for (auto leaf_itr = this->leaf_depth_begin(); leaf_itr != this->leaf_depth_end();
@@ -114,6 +119,27 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   assert(leaf_vector_.size() == this->getLeafCount());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+void
+pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::
+    compact()
+{
+  OctreeBaseT::compact();
+
+  // The copied leaves still point to the neighbors they had before compacting
+  leaf_vector_.clear();
+  for (auto leaf_itr = this->leaf_depth_begin(); leaf_itr != this->leaf_depth_end();
+       ++leaf_itr) {
+    OctreeKey leaf_key = leaf_itr.getCurrentOctreeKey();
+    LeafContainerT* leaf_container = &(leaf_itr.getLeafContainer());
+    leaf_container->setNeighbors(typename LeafContainerT::NeighborListT());
+    computeNeighbors(leaf_key, leaf_container);
+
+    leaf_vector_.push_back(leaf_container);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename LeafContainerT, typename BranchContainerT>
 void
@@ -813,6 +813,58 @@ protected:
     return new_leaf_child;
   }
 
+  /** \brief Fetch a branch child in current buffer during a bulk build. As in
+   * createLeafRecursive, a branch of the previous buffer is reused, so that the changes
+   * between the buffers can be detected. The node counters are not updated.
+   *  \param branch_arg: reference to octree branch class
+   *  \param child_idx_arg: index to child node
+   *  \return pointer of branch child to this reference
+   */
+  BranchNode*
+  reuseOrCreateBranchChild(BranchNode& branch_arg, unsigned char child_idx_arg)
+  {
+    if (branch_arg.hasChild(!buffer_selector_, child_idx_arg)) {
+      OctreeNode* child_node = branch_arg.getChildPtr(!buffer_selector_, child_idx_arg);
+      if (child_node->getNodeType() == BRANCH_NODE) {
+        auto* child_branch = static_cast<BranchNode*>(child_node);
+        branch_arg.setChildPtr(buffer_selector_, child_idx_arg, child_node);
+
+        // reset the children of the stolen branch in current buffer
+        for (unsigned char child_idx = 0; child_idx < 8; child_idx++)
+          child_branch->setChildPtr(buffer_selector_, child_idx, nullptr);
+
+        return child_branch;
+      }
+      // depth has changed.. child in preceding buffer is a leaf node.
+      deleteBranchChild(branch_arg, !buffer_selector_, child_idx_arg);
+    }
+    return createBranchChild(branch_arg, child_idx_arg);
+  }
+
+  /** \brief Fetch a leaf child in current buffer during a bulk build. As in
+   * createLeafRecursive, a leaf of the previous buffer is reused and cleared. The node
+   * counters are not updated.
+   *  \param branch_arg: reference to octree branch class
+   *  \param child_idx_arg: index to child node
+   *  \return pointer of leaf child to this reference
+   */
+  LeafNode*
+  reuseOrCreateLeafChild(BranchNode& branch_arg, unsigned char child_idx_arg)
+  {
+    if (branch_arg.hasChild(!buffer_selector_, child_idx_arg)) {
+      OctreeNode* child_node = branch_arg.getChildPtr(!buffer_selector_, child_idx_arg);
+      if (child_node->getNodeType() == LEAF_NODE) {
+        auto* child_leaf = static_cast<LeafNode*>(child_node);
+        child_leaf->getContainer() = LeafContainer(); // Clear contents of leaf
+        branch_arg.setChildPtr(buffer_selector_, child_idx_arg, child_node);
+        return child_leaf;
+      }
+      // depth has changed.. child in preceding buffer is a branch node.
+      deleteBranchChild(branch_arg, !buffer_selector_, child_idx_arg);
+    }
+    return createLeafChild(branch_arg, child_idx_arg);
+  }
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Recursive octree methods
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
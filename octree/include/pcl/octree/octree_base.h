@@ -41,6 +41,7 @@
 #include <pcl/octree/octree_container.h>
 #include <pcl/octree/octree_iterator.h>
 #include <pcl/octree/octree_key.h>
+#include <pcl/octree/octree_node_pool.h>
 #include <pcl/octree/octree_nodes.h>
 #include <pcl/pcl_macros.h>
 
@@ -95,6 +96,12 @@ protected:
   /** \brief key range */
   OctreeKey max_key_;
 
+  /** \brief Contiguous storage of the branch nodes placed by compact() */
+  OctreeNodeArray<BranchNode> branch_array_;
+
+  /** \brief Contiguous storage of the leaf nodes placed by compact() */
+  OctreeNodeArray<LeafNode> leaf_array_;
+
 public:
   // iterators are friends
   friend class OctreeIteratorBase<OctreeT>;
@@ -328,6 +335,7 @@ public:
   OctreeBase&
   operator=(const OctreeBase& source)
   {
+    deleteTree();
     leaf_count_ = source.leaf_count_;
     branch_count_ = source.branch_count_;
     delete root_node_;
@@ -422,6 +430,19 @@ public:
   void
   deleteTree();
 
+  /** \brief Move all nodes below the root into two contiguous arrays, one for branch
+   * nodes and one for leaf nodes, in depth-first order. Nodes that are close in space
+   * are then close in memory, and the per node allocation overhead goes away. Use this
+   * for octrees that are built once and searched many times.
+   * \note Nodes created afterwards are allocated individually again. Nodes removed
+   * afterwards keep their memory until the octree is deleted or compacted again.
+   * \note Pointers to nodes and leaf containers are invalidated. The memory of the
+   * octree nodes is held twice while compacting. Derived classes that keep such
+   * pointers override this method to rebuild them.
+   */
+  virtual void
+  compact();
+
   /** \brief Serialize octree into a binary output vector describing its branch node
    * structure.
    * \param binary_tree_out_arg: reference to output vector for writing binary tree
@@ -603,12 +624,18 @@ protected:
         // free child branch recursively
         deleteBranch(*static_cast<BranchNode*>(branch_child));
         // delete branch node
-        delete branch_child;
+        if (branch_array_.contains(branch_child))
+          branch_array_.destroy(static_cast<BranchNode*>(branch_child));
+        else
+          delete branch_child;
       } break;
 
       case LEAF_NODE: {
         // delete leaf node
-        delete branch_child;
+        if (leaf_array_.contains(branch_child))
+          leaf_array_.destroy(static_cast<LeafNode*>(branch_child));
+        else
+          delete branch_child;
         break;
       }
       default:
@@ -659,6 +686,32 @@ protected:
     return new_leaf_child;
   }
 
+  /** \brief Create a new branch child during a bulk build. A single buffered octree
+   * has no node to reuse, so this is the same as createBranchChild. The node counters
+   * are not updated.
+   *  \param branch_arg: reference to octree branch class
+   *  \param child_idx_arg: index to child node
+   *  \return pointer of new branch child to this reference
+   */
+  BranchNode*
+  reuseOrCreateBranchChild(BranchNode& branch_arg, unsigned char child_idx_arg)
+  {
+    return createBranchChild(branch_arg, child_idx_arg);
+  }
+
+  /** \brief Create a new leaf child during a bulk build. A single buffered octree has
+   * no node to reuse, so this is the same as createLeafChild. The node counters are not
+   * updated.
+   *  \param branch_arg: reference to octree branch class
+   *  \param child_idx_arg: index to child node
+   *  \return pointer of new leaf child to this reference
+   */
+  LeafNode*
+  reuseOrCreateLeafChild(BranchNode& branch_arg, unsigned char child_idx_arg)
+  {
+    return createLeafChild(branch_arg, child_idx_arg);
+  }
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Recursive octree methods
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -707,6 +760,28 @@ protected:
                       uindex_t depth_mask_arg,
                       BranchNode* branch_arg);
 
+  /** \brief Recursively count the nodes below a branch node
+   *  \param branch_arg: current branch node
+   *  \param branch_count_arg: incremented by the amount of branch nodes
+   *  \param leaf_count_arg: incremented by the amount of leaf nodes
+   **/
+  void
+  countNodesRecursive(const BranchNode& branch_arg,
+                      std::size_t& branch_count_arg,
+                      std::size_t& leaf_count_arg) const;
+
+  /** \brief Recursively copy the children of a branch node into contiguous node arrays
+   *  \param source_arg: branch node to copy the children from
+   *  \param target_arg: branch node receiving the copied children
+   *  \param branch_array_arg: storage for the copied branch nodes
+   *  \param leaf_array_arg: storage for the copied leaf nodes
+   **/
+  void
+  compactRecursive(const BranchNode& source_arg,
+                   BranchNode& target_arg,
+                   OctreeNodeArray<BranchNode>& branch_array_arg,
+                   OctreeNodeArray<LeafNode>& leaf_array_arg);
+
   /** \brief Recursively explore the octree and output binary octree description
    * together with a vector of leaf node LeafContainerTs.
    * \param branch_arg: current branch node
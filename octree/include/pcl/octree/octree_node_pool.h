@@ -37,8 +37,14 @@
 
 #pragma once
 
+#include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace pcl {
@@ -108,5 +114,95 @@ protected:
   std::vector<NodeT*> nodePool_;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief @b Contiguous octree node array
+ * \note Holds a fixed number of octree nodes in a single allocation. Nodes are
+ * constructed in place one after the other and destroyed individually, but their
+ * memory is only released together with the array.
+ */
+template <typename NodeT>
+class OctreeNodeArray {
+public:
+  /** \brief Empty constructor. */
+  OctreeNodeArray() = default;
+
+  OctreeNodeArray(const OctreeNodeArray&) = delete;
+
+  OctreeNodeArray&
+  operator=(const OctreeNodeArray&) = delete;
+
+  /** \brief Release the current storage and reserve memory for a number of nodes.
+   *  \note All nodes of the previous storage must have been destroyed.
+   *  \param size_arg: amount of nodes the array can hold
+   *  */
+  void
+  allocate(std::size_t size_arg)
+  {
+    nodes_.clear();
+    nodes_.shrink_to_fit();
+    nodes_.resize(size_arg);
+    used_ = 0;
+  }
+
+  /** \brief Release the storage of the array.
+   *  \note All nodes of the array must have been destroyed.
+   *  */
+  void
+  release()
+  {
+    allocate(0);
+  }
+
+  /** \brief Construct a node in the next free slot of the array.
+   *  \return Pointer to octree node
+   *  */
+  template <typename... Args>
+  NodeT*
+  construct(Args&&... args)
+  {
+    assert(used_ < nodes_.size());
+    return new (&nodes_[used_++]) NodeT(std::forward<Args>(args)...);
+  }
+
+  /** \brief Destroy a node of the array. Its slot is not reused. */
+  void
+  destroy(NodeT* node_arg)
+  {
+    assert(contains(node_arg));
+    node_arg->~NodeT();
+  }
+
+  /** \brief Check if a node is stored in this array. */
+  bool
+  contains(const void* node_arg) const
+  {
+    const auto address = reinterpret_cast<std::uintptr_t>(node_arg);
+    const auto begin = reinterpret_cast<std::uintptr_t>(nodes_.data());
+    return (address >= begin && address < begin + nodes_.size() * sizeof(Storage));
+  }
+
+  /** \brief Exchange the storage of two arrays. */
+  void
+  swap(OctreeNodeArray& other_arg)
+  {
+    nodes_.swap(other_arg.nodes_);
+    std::swap(used_, other_arg.used_);
+  }
+
+  /** \brief Amount of nodes constructed in the array. */
+  std::size_t
+  size() const
+  {
+    return used_;
+  }
+
+protected:
+  using Storage = typename std::aligned_storage<sizeof(NodeT), alignof(NodeT)>::type;
+
+  std::vector<Storage, Eigen::aligned_allocator<Storage>> nodes_;
+
+  std::size_t used_{0};
+};
+
 } // namespace octree
 } // namespace pcl
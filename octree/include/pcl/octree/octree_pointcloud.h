@@ -42,6 +42,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
+#include <cstdint>
 #include <vector>
 
 namespace pcl {
@@ -197,6 +198,39 @@ public:
   void
   addPointsFromInputCloud();
 
+  /** \brief Enable or disable the bulk build of the octree by addPointsFromInputCloud.
+   *
+   * In bulk mode, the octree keys of all points are computed and sorted in Morton order
+   * first. Then the branch and leaf nodes are built subtree by subtree. Both steps run
+   * in parallel, see setNumberOfThreads. The octree is the same as when the points are
+   * inserted one by one within a fixed bounding box. If no bounding box was defined, it
+   * is defined from the input cloud first (see defineBoundingBox).
+   *
+   * The points are still inserted one by one if the octree is not empty, if dynamic
+   * depth is enabled, if the octree is deeper than 21 levels, or if a point lies outside
+   * of the bounding box.
+   * \param[in] bulk_build_arg true to enable the bulk build
+   */
+  inline void
+  setBulkBuild(bool bulk_build_arg)
+  {
+    bulk_build_ = bulk_build_arg;
+  }
+
+  /** \brief Get whether addPointsFromInputCloud builds the octree in bulk. */
+  inline bool
+  getBulkBuild() const
+  {
+    return (bulk_build_);
+  }
+
+  /** \brief Set the number of threads used by the bulk build.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   * to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief Add point at given index from input point cloud to octree. Index will be
    * also added to indices vector.
    * \param[in] point_idx_arg index of point to be added
@@ -438,6 +472,54 @@ protected:
   virtual void
   addPointIdx(uindex_t point_idx_arg);
 
+  /** \brief Add point at index from input pointcloud dataset to a leaf created by the
+   * bulk build. Octrees whose leaves store more than point indices override it, as they
+   * override addPointIdx.
+   * \param[in] leaf_container_arg the container of the leaf the point belongs to
+   * \param[in] point_idx_arg the index representing the point in the dataset given by
+   * \a setInputCloud to be added
+   */
+  virtual void
+  addPointToLeaf(LeafContainerT& leaf_container_arg, uindex_t point_idx_arg)
+  {
+    leaf_container_arg.addPointIndex(point_idx_arg);
+  }
+
+  /** \brief Point index along with the Morton code of the key of its voxel. */
+  struct MortonPoint {
+    std::uint64_t code;
+    uindex_t index;
+
+    bool
+    operator<(const MortonPoint& other) const
+    {
+      return (code < other.code) || ((code == other.code) && (index < other.index));
+    }
+  };
+
+  /** \brief Build the octree from all points of the input cloud at once, see
+   * setBulkBuild.
+   * \return false if the points have to be inserted one by one instead
+   */
+  bool
+  addPointsFromInputCloudBulk();
+
+  /** \brief Recursively build the subtree of a branch node from its points.
+   * \param[in] branch_arg the branch node
+   * \param[in] begin_arg first point of the branch, in Morton order
+   * \param[in] end_arg end of the points of the branch
+   * \param[in] depth_mask_arg depth mask of the children of the branch
+   * \param[out] branch_count_arg incremented by the number of created branch nodes
+   * \param[out] leaf_count_arg incremented by the number of created leaf nodes
+   */
+  void
+  buildBulkRecursive(BranchNode& branch_arg,
+                     const MortonPoint* begin_arg,
+                     const MortonPoint* end_arg,
+                     uindex_t depth_mask_arg,
+                     std::size_t& branch_count_arg,
+                     std::size_t& leaf_count_arg);
+
   /** \brief Add point at index from input pointcloud dataset to octree
    * \param[in] leaf_node to be expanded
    * \param[in] parent_branch parent of leaf node to be expanded
@@ -605,6 +687,12 @@ protected:
    *  \note zero indicates a fixed/maximum depth octree structure
    * **/
   std::size_t max_objs_per_leaf_{0};
+
+  /** \brief Whether addPointsFromInputCloud builds the octree in bulk. */
+  bool bulk_build_{false};
+
+  /** \brief The number of threads to use. */
+  unsigned int threads_{1};
 };
 
 } // namespace octree
@@ -142,6 +142,13 @@ public:
   void
   addPointsFromInputCloud();
 
+  /** \brief Moves the octree nodes into contiguous arrays, see OctreeBase::compact().
+   *
+   * \note The leaf vector and the neighbors of each leaf refer to leaf containers by
+   * address, so they are rebuilt afterwards. */
+  void
+  compact() override;
+
   /** \brief Gets the leaf container for a given point.
    *
    * \param[in] point_arg Point to search for
@@ -197,6 +204,18 @@ protected:
   void
   addPointIdx(uindex_t point_idx_arg) override;
 
+  /** \brief Add point at index from input pointcloud dataset to a leaf created by the
+   * bulk build.
+   *
+   * \param[in] leaf_container_arg The container of the leaf the point belongs to
+   * \param[in] point_idx_arg The index representing the point in the dataset given by
+   * setInputCloud() to be added */
+  void
+  addPointToLeaf(LeafContainerT& leaf_container_arg, uindex_t point_idx_arg) override
+  {
+    leaf_container_arg.addPoint((*input_)[point_idx_arg]);
+  }
+
   /** \brief Fills in the neighbors fields for new voxels.
    *
    * \param[in] key_arg Key of the voxel to check neighbors for
@@ -175,6 +175,16 @@ public:
     container->addPoint(point);
   }
 
+  /** \brief Add point at index to a leaf created by the bulk build.
+   * \param leaf_container_arg
+   * \param pointIdx_arg
+   */
+  void
+  addPointToLeaf(LeafContainerT& leaf_container_arg, const uindex_t pointIdx_arg) override
+  {
+    leaf_container_arg.addPoint((*this->input_)[pointIdx_arg]);
+  }
+
   /** \brief Get centroid for a single voxel addressed by a PointT point.
    * \param[in] point_arg point addressing a voxel in octree
    * \param[out] voxel_centroid_arg centroid is written to this PointT reference
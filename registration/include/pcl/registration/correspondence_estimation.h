@@ -304,6 +304,22 @@ public:
   virtual typename CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::Ptr
   clone() const = 0;
 
+  /** \brief Set the number of threads to use for the correspondence search.
+   * The result does not depend on the number of threads: the correspondences are
+   * returned in the same order as with a single thread.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value
+   * back to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Get the number of threads used for the correspondence search. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return (num_threads_);
+  }
+
 protected:
   /** \brief The correspondence estimation method name. */
   std::string corr_name_;
@@ -362,6 +378,9 @@ protected:
   /** \brief A flag which, if set, means the tree operating on the source cloud
    * will never be recomputed*/
   bool force_no_recompute_reciprocal_{false};
+
+  /** \brief The number of threads used for the correspondence search. */
+  unsigned int num_threads_{1};
 };
 
 /** \brief @b CorrespondenceEstimation represents the base class for
@@ -410,6 +429,7 @@ public:
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::indices_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_fields_;
+  using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::num_threads_;
   using PCLBase<PointSource>::deinitCompute;
 
   using KdTree =
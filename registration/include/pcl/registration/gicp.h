@@ -169,6 +169,16 @@ public:
     input_covariances_ = covariances;
   }
 
+  /** \brief Get the covariances of the input source. These are either the covariances
+   * set with setSourceCovariances or the ones computed during the last alignment, and
+   * an empty pointer if none are available yet.
+   */
+  inline MatricesVectorPtr
+  getSourceCovariances() const
+  {
+    return (input_covariances_);
+  }
+
   /** \brief Provide a pointer to the input target (e.g., the point cloud that we want
    * to align the input source to) \param[in] target the input point cloud target
    */
@@ -192,6 +202,18 @@ public:
     target_covariances_ = covariances;
   }
 
+  /** \brief Get the covariances of the input target. These are either the covariances
+   * set with setTargetCovariances or the ones computed during the last alignment, and
+   * an empty pointer if none are available yet. Pass them to setTargetCovariances
+   * after setting the same target again to avoid recomputing them, e.g. when aligning
+   * many source clouds against one map.
+   */
+  inline MatricesVectorPtr
+  getTargetCovariances() const
+  {
+    return (target_covariances_);
+  }
+
   /** \brief Estimate a rigid rotation transformation between a source and a target
    * point cloud using an iterative non-linear BFGS approach.
    * \param[in] cloud_src the source point cloud dataset
@@ -355,6 +377,23 @@ public:
     return rotation_gradient_tolerance_;
   }
 
+  /** \brief Set the number of threads to use for the covariance computation, the
+   * correspondence search and the evaluation of the cost function, its gradient and
+   * its hessian. The results only depend on the number of threads through the order in
+   * which floating point sums are accumulated.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value
+   * back to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Return the number of threads used. */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
 protected:
   /** \brief The number of neighbors used for covariances computation.
    * default: 20
@@ -406,6 +445,9 @@ protected:
   /** \brief minimal rotation gradient for early optimization stop */
   double rotation_gradient_tolerance_{1e-2};
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_{1};
+
   /** \brief compute points covariances matrices according to the K nearest
    * neighbors. K is set via setCorrespondenceRandomness() method.
    * \param[in] cloud pointer to point cloud
@@ -463,6 +505,17 @@ protected:
   void
   applyState(Matrix4& t, const Vector6d& x) const;
 
+  /** \brief Sum the terms of all correspondences in [0, m) on threads_ threads.
+   * Every thread accumulates one contiguous block of correspondences into its own
+   * accumulator, and the blocks are added up in order afterwards.
+   * \param[in] m the number of correspondences
+   * \param[in] add function adding the terms of correspondence i to an accumulator
+   * \param[out] result the sum over all correspondences
+   */
+  template <typename Accumulator, typename Function>
+  void
+  reduceCorrespondences(int m, const Function& add, Accumulator& result) const;
+
   /// \brief optimization functor structure
   struct OptimizationFunctorWithIndices : public BFGSDummyFunctor<double, 6> {
     OptimizationFunctorWithIndices(const GeneralizedIterativeClosestPoint* gicp)
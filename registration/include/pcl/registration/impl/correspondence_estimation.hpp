@@ -44,6 +44,12 @@
 #include <pcl/common/copy_point.h>
 #include <pcl/common/io.h>
 
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl {
 
 namespace registration {
@@ -112,6 +118,30 @@ CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initComputeRecip
   return (true);
 }
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    num_threads_ = omp_get_num_procs();
+  else
+    num_threads_ = nr_threads;
+  PCL_DEBUG("[pcl::registration::%s::setNumberOfThreads] Setting number of threads to "
+            "%u.\n",
+            getClassName().c_str(),
+            num_threads_);
+#else
+  num_threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN("[pcl::registration::%s::setNumberOfThreads] Parallelization is "
+             "requested, but OpenMP is not available! Continuing without "
+             "parallelization.\n",
+             getClassName().c_str());
+#endif // _OPENMP
+}
+
 namespace detail {
 
 template <
@@ -149,31 +179,42 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::determineCorresponde
   if (!initCompute())
     return;
 
+  // Every source index owns one slot, so that the result is independent of the number
+  // of threads. Slots without a valid match are marked and compacted afterwards.
   correspondences.resize(indices_->size());
 
   pcl::Indices index(1);
   std::vector<float> distance(1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  double max_dist_sqr = max_distance * max_distance;
+  const double max_dist_sqr = max_distance * max_distance;
 
   // Iterate over the input set of source indices
-  for (const auto& idx : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences)                         \
+    firstprivate(index, distance, max_dist_sqr) num_threads(num_threads_)            \
+    schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); ++i) {
+    const auto idx = (*indices_)[i];
     // Check if the template types are the same. If true, avoid a copy.
     // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
     // macro!
     const auto& pt = detail::pointCopyOrRef<PointTarget, PointSource>(input_, idx);
     tree_->nearestKSearch(pt, 1, index, distance);
-    if (distance[0] > max_dist_sqr)
-      continue;
 
+    pcl::Correspondence& corr = correspondences[i];
     corr.index_query = idx;
+    if (distance[0] > max_dist_sqr) {
+      corr.index_match = UNAVAILABLE;
+      continue;
+    }
     corr.index_match = index[0];
     corr.distance = distance[0];
-    correspondences[nr_valid_correspondences++] = corr;
   }
 
-  correspondences.resize(nr_valid_correspondences);
+  correspondences.erase(std::remove_if(correspondences.begin(),
+                                       correspondences.end(),
+                                       [](const pcl::Correspondence& corr) {
+                                         return (corr.index_match == UNAVAILABLE);
+                                       }),
+                        correspondences.end());
   deinitCompute();
 }
 
@@ -190,30 +231,35 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::
   // Set the internal point representation of choice
   if (!initComputeReciprocal())
     return;
-  double max_dist_sqr = max_distance * max_distance;
+  const double max_dist_sqr = max_distance * max_distance;
 
+  // One slot per source index, see determineCorrespondences
   correspondences.resize(indices_->size());
   pcl::Indices index(1);
   std::vector<float> distance(1);
   pcl::Indices index_reciprocal(1);
   std::vector<float> distance_reciprocal(1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
 
   // Iterate over the input set of source indices
-  for (const auto& idx : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences)                         \
+    firstprivate(index, distance, index_reciprocal, distance_reciprocal, max_dist_sqr) \
+    num_threads(num_threads_) schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); ++i) {
+    const auto idx = (*indices_)[i];
+    pcl::Correspondence& corr = correspondences[i];
+    corr.index_query = idx;
+    corr.index_match = UNAVAILABLE;
+
     // Check if the template types are the same. If true, avoid a copy.
     // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
     // macro!
-
     const auto& pt_src = detail::pointCopyOrRef<PointTarget, PointSource>(input_, idx);
 
     tree_->nearestKSearch(pt_src, 1, index, distance);
     if (distance[0] > max_dist_sqr)
       continue;
 
-    target_idx = index[0];
+    const auto target_idx = index[0];
     const auto& pt_tgt =
         detail::pointCopyOrRef<PointSource, PointTarget>(target_, target_idx);
 
@@ -221,12 +267,16 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::
     if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
       continue;
 
-    corr.index_query = idx;
-    corr.index_match = index[0];
+    corr.index_match = target_idx;
     corr.distance = distance[0];
-    correspondences[nr_valid_correspondences++] = corr;
   }
-  correspondences.resize(nr_valid_correspondences);
+
+  correspondences.erase(std::remove_if(correspondences.begin(),
+                                       correspondences.end(),
+                                       [](const pcl::Correspondence& corr) {
+                                         return (corr.index_match == UNAVAILABLE);
+                                       }),
+                        correspondences.end());
   deinitCompute();
 }
 
@@ -43,8 +43,108 @@
 
 #include <pcl/registration/exceptions.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl {
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG("[pcl::%s::setNumberOfThreads] Setting number of threads to %u.\n",
+            getClassName().c_str(),
+            threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN("[pcl::%s::setNumberOfThreads] Parallelization is requested, but OpenMP "
+             "is not available! Continuing without parallelization.\n",
+             getClassName().c_str());
+#endif // _OPENMP
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+template <typename Accumulator, typename Function>
+void
+GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+    reduceCorrespondences(int m, const Function& add, Accumulator& result) const
+{
+  const int nr_blocks = std::max(1, std::min(static_cast<int>(threads_), m));
+  if (nr_blocks == 1) {
+    for (int i = 0; i < m; ++i)
+      add(i, result);
+    return;
+  }
+
+  std::vector<Accumulator, Eigen::aligned_allocator<Accumulator>> partial(nr_blocks);
+#pragma omp parallel for num_threads(nr_blocks) schedule(static, 1)
+  for (int block = 0; block < nr_blocks; ++block) {
+    const int begin = static_cast<int>(static_cast<std::int64_t>(m) * block / nr_blocks);
+    const int end =
+        static_cast<int>(static_cast<std::int64_t>(m) * (block + 1) / nr_blocks);
+    for (int i = begin; i < end; ++i)
+      add(i, partial[block]);
+  }
+  for (const auto& block_result : partial)
+    result += block_result;
+}
+
+namespace detail {
+
+/** \brief Accumulator for the cost and gradient terms of GICP. */
+struct GICPGradientAccumulator {
+  double f{0.0};
+  Eigen::Vector3d g_t{Eigen::Vector3d::Zero()};
+  Eigen::Matrix3d dCost_dR_T{Eigen::Matrix3d::Zero()};
+
+  GICPGradientAccumulator&
+  operator+=(const GICPGradientAccumulator& other)
+  {
+    f += other.f;
+    g_t += other.g_t;
+    dCost_dR_T += other.dCost_dR_T;
+    return *this;
+  }
+
+  PCL_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/** \brief Accumulator for the gradient and hessian terms of GICP. */
+struct GICPHessianAccumulator {
+  Eigen::Vector3d g_t{Eigen::Vector3d::Zero()};
+  Eigen::Matrix3d hessian_t{Eigen::Matrix3d::Zero()};
+  Eigen::Matrix3d dCost_dR_T{Eigen::Matrix3d::Zero()};
+  Eigen::Matrix3d dCost_dR_T1b{Eigen::Matrix3d::Zero()};
+  Eigen::Matrix3d dCost_dR_T2b{Eigen::Matrix3d::Zero()};
+  Eigen::Matrix3d dCost_dR_T3b{Eigen::Matrix3d::Zero()};
+  Eigen::Matrix<double, 9, 6> hessian_rot_tmp{Eigen::Matrix<double, 9, 6>::Zero()};
+
+  GICPHessianAccumulator&
+  operator+=(const GICPHessianAccumulator& other)
+  {
+    g_t += other.g_t;
+    hessian_t += other.hessian_t;
+    dCost_dR_T += other.dCost_dR_T;
+    dCost_dR_T1b += other.dCost_dR_T1b;
+    dCost_dR_T2b += other.dCost_dR_T2b;
+    dCost_dR_T3b += other.dCost_dR_T3b;
+    hessian_rot_tmp += other.hessian_rot_tmp;
+    return *this;
+  }
+
+  PCL_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace detail
+
 template <typename PointSource, typename PointTarget, typename Scalar>
 template <typename PointT>
 void
@@ -61,7 +161,6 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::computeCovar
     return;
   }
 
-  Eigen::Vector3d mean;
   pcl::Indices nn_indices(k_correspondences_);
   std::vector<float> nn_dist_sq(k_correspondences_);
 
@@ -69,14 +168,14 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::computeCovar
   if (cloud_covariances.size() < cloud->size())
     cloud_covariances.resize(cloud->size());
 
-  auto matrices_iterator = cloud_covariances.begin();
-  for (auto points_iterator = cloud->begin(); points_iterator != cloud->end();
-       ++points_iterator, ++matrices_iterator) {
-    const PointT& query_point = *points_iterator;
-    Eigen::Matrix3d& cov = *matrices_iterator;
+#pragma omp parallel for firstprivate(nn_indices, nn_dist_sq) num_threads(threads_)    \
+    schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(cloud->size()); ++i) {
+    const PointT& query_point = (*cloud)[i];
+    Eigen::Matrix3d& cov = cloud_covariances[i];
     // Zero out the cov and mean
     cov.setZero();
-    mean.setZero();
+    Eigen::Vector3d mean = Eigen::Vector3d::Zero();
 
     // Search for the K nearest neighbours
     kdtree->nearestKSearch(query_point, k_correspondences_, nn_indices, nn_dist_sq);
@@ -461,27 +560,34 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
 {
   Matrix4 transformation_matrix = gicp_->base_transformation_;
   gicp_->applyState(transformation_matrix, x);
+  const Eigen::Matrix4f transformation_matrix_float =
+      transformation_matrix.template cast<float>();
   double f = 0;
   int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-    Eigen::Vector4f p_trans_src(transformation_matrix.template cast<float>() * p_src);
-    // Estimate the distance (cost function)
-    // The last coordinate is still guaranteed to be set to 1.0
-    // The d here is the negative of the d in the paper
-    Eigen::Vector3d d(p_trans_src[0] - p_tgt[0],
-                      p_trans_src[1] - p_tgt[1],
-                      p_trans_src[2] - p_tgt[2]);
-    Eigen::Vector3d Md(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * d);
-    // increment= d'*Md/num_matches = d'*M*d/num_matches (we postpone
-    // 1/num_matches after the loop closes)
-    f += static_cast<double>(d.transpose() * Md);
-  }
+  gicp_->reduceCorrespondences(
+      m,
+      [&](int i, double& f_acc) {
+        // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in
+        // registration.hpp
+        Vector4fMapConst p_src =
+            (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
+        // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in
+        // registration.hpp
+        Vector4fMapConst p_tgt =
+            (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
+        Eigen::Vector4f p_trans_src(transformation_matrix_float * p_src);
+        // Estimate the distance (cost function)
+        // The last coordinate is still guaranteed to be set to 1.0
+        // The d here is the negative of the d in the paper
+        Eigen::Vector3d d(p_trans_src[0] - p_tgt[0],
+                          p_trans_src[1] - p_tgt[1],
+                          p_trans_src[2] - p_tgt[2]);
+        Eigen::Vector3d Md(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * d);
+        // increment= d'*Md/num_matches = d'*M*d/num_matches (we postpone
+        // 1/num_matches after the loop closes)
+        f_acc += static_cast<double>(d.transpose() * Md);
+      },
+      f);
   return f / m;
 }
 
@@ -490,42 +596,8 @@ inline void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
     OptimizationFunctorWithIndices::df(const Vector6d& x, Vector6d& g)
 {
-  Matrix4 transformation_matrix = gicp_->base_transformation_;
-  gicp_->applyState(transformation_matrix, x);
-  // Zero out g
-  g.setZero();
-  // Eigen::Vector3d g_t = g.head<3> ();
-  // the transpose of the derivative of the cost function w.r.t rotation matrix
-  Eigen::Matrix3d dCost_dR_T = Eigen::Matrix3d::Zero();
-  int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-
-    Eigen::Vector4f p_trans_src(transformation_matrix.template cast<float>() * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    // The d here is the negative of the d in the paper
-    Eigen::Vector3d d(p_trans_src[0] - p_tgt[0],
-                      p_trans_src[1] - p_tgt[1],
-                      p_trans_src[2] - p_tgt[2]);
-    // Md = M*d
-    Eigen::Vector3d Md(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * d);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*d/num_matches (we postpone 2/num_matches after the loop
-    // closes)
-    g.head<3>() += Md;
-    // Increment rotation gradient
-    p_trans_src = gicp_->base_transformation_.template cast<float>() * p_src;
-    Eigen::Vector3d p_base_src(p_trans_src[0], p_trans_src[1], p_trans_src[2]);
-    dCost_dR_T += p_base_src * Md.transpose();
-  }
-  g.head<3>() *= 2.0 / m;
-  dCost_dR_T *= 2.0 / m;
-  gicp_->computeRDerivative(x, dCost_dR_T, g);
+  double f;
+  fdf(x, f, g);
 }
 
 template <typename PointSource, typename PointTarget, typename Scalar>
@@ -535,40 +607,49 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
 {
   Matrix4 transformation_matrix = gicp_->base_transformation_;
   gicp_->applyState(transformation_matrix, x);
-  f = 0;
+  const Eigen::Matrix4f transformation_matrix_float =
+      transformation_matrix.template cast<float>();
+  const Eigen::Matrix4f base_transformation_float =
+      gicp_->base_transformation_.template cast<float>();
   g.setZero();
-  // the transpose of the derivative of the cost function w.r.t rotation matrix
-  Eigen::Matrix3d dCost_dR_T = Eigen::Matrix3d::Zero();
+  // acc.dCost_dR_T is the transpose of the derivative of the cost function w.r.t
+  // rotation matrix
+  detail::GICPGradientAccumulator acc;
   const int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-    Eigen::Vector4f p_trans_src(transformation_matrix.template cast<float>() * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    // The d here is the negative of the d in the paper
-    Eigen::Vector3d d(p_trans_src[0] - p_tgt[0],
-                      p_trans_src[1] - p_tgt[1],
-                      p_trans_src[2] - p_tgt[2]);
-    // Md = M*d
-    Eigen::Vector3d Md(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * d);
-    // Increment total error
-    f += static_cast<double>(d.transpose() * Md);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*d/num_matches (we postpone 2/num_matches after the loop
-    // closes)
-    g.head<3>() += Md;
-    p_trans_src = gicp_->base_transformation_.template cast<float>() * p_src;
-    Eigen::Vector3d p_base_src(p_trans_src[0], p_trans_src[1], p_trans_src[2]);
-    // Increment rotation gradient
-    dCost_dR_T += p_base_src * Md.transpose();
-  }
-  f /= static_cast<double>(m);
-  g.head<3>() *= (2.0 / m);
-  dCost_dR_T *= 2.0 / m;
+  gicp_->reduceCorrespondences(
+      m,
+      [&](int i, detail::GICPGradientAccumulator& acc_i) {
+        // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in
+        // registration.hpp
+        Vector4fMapConst p_src =
+            (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
+        // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in
+        // registration.hpp
+        Vector4fMapConst p_tgt =
+            (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
+        Eigen::Vector4f p_trans_src(transformation_matrix_float * p_src);
+        // The last coordinate is still guaranteed to be set to 1.0
+        // The d here is the negative of the d in the paper
+        Eigen::Vector3d d(p_trans_src[0] - p_tgt[0],
+                          p_trans_src[1] - p_tgt[1],
+                          p_trans_src[2] - p_tgt[2]);
+        // Md = M*d
+        Eigen::Vector3d Md(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * d);
+        // Increment total error
+        acc_i.f += static_cast<double>(d.transpose() * Md);
+        // Increment translation gradient
+        // g.head<3> ()+= 2*M*d/num_matches (we postpone 2/num_matches after the loop
+        // closes)
+        acc_i.g_t += Md;
+        p_trans_src = base_transformation_float * p_src;
+        Eigen::Vector3d p_base_src(p_trans_src[0], p_trans_src[1], p_trans_src[2]);
+        // Increment rotation gradient
+        acc_i.dCost_dR_T += p_base_src * Md.transpose();
+      },
+      acc);
+  f = acc.f / static_cast<double>(m);
+  g.head<3>() = acc.g_t * (2.0 / m);
+  const Eigen::Matrix3d dCost_dR_T = acc.dCost_dR_T * (2.0 / m);
   gicp_->computeRDerivative(x, dCost_dR_T, g);
 }
 
@@ -608,52 +689,61 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
                             ddR_dTheta_dTheta,
                             ddR_dTheta_dPsi,
                             ddR_dPsi_dPsi);
-  Eigen::Matrix3d dCost_dR_T = Eigen::Matrix3d::Zero();
   Eigen::Matrix3d dCost_dR_T1 = Eigen::Matrix3d::Zero();
   Eigen::Matrix3d dCost_dR_T2 = Eigen::Matrix3d::Zero();
   Eigen::Matrix3d dCost_dR_T3 = Eigen::Matrix3d::Zero();
-  Eigen::Matrix3d dCost_dR_T1b = Eigen::Matrix3d::Zero();
-  Eigen::Matrix3d dCost_dR_T2b = Eigen::Matrix3d::Zero();
-  Eigen::Matrix3d dCost_dR_T3b = Eigen::Matrix3d::Zero();
   Eigen::Matrix3d hessian_rot_phi = Eigen::Matrix3d::Zero();
   Eigen::Matrix3d hessian_rot_theta = Eigen::Matrix3d::Zero();
   Eigen::Matrix3d hessian_rot_psi = Eigen::Matrix3d::Zero();
-  Eigen::Matrix<double, 9, 6> hessian_rot_tmp = Eigen::Matrix<double, 9, 6>::Zero();
 
+  detail::GICPHessianAccumulator acc;
   int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    const auto& src_idx = (*gicp_->tmp_idx_src_)[i];
-    Vector4fMapConst p_src = (*gicp_->tmp_src_)[src_idx].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-    Eigen::Vector4f p_trans_src(transformation_matrix_float * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    // The d here is the negative of the d in the paper
-    const Eigen::Vector3d d(p_trans_src[0] - p_tgt[0],
-                            p_trans_src[1] - p_tgt[1],
-                            p_trans_src[2] - p_tgt[2]);
-    const Eigen::Matrix3d& M = gicp_->mahalanobis(src_idx);
-    const Eigen::Vector3d Md(M * d); // Md = M*d
-    gradient.head<3>() += Md;        // translation gradient
-    hessian.block<3, 3>(0, 0) += M;  // translation-translation hessian
-    p_trans_src = base_transformation_float * p_src;
-    const Eigen::Vector3d p_base_src(p_trans_src[0], p_trans_src[1], p_trans_src[2]);
-    dCost_dR_T.noalias() += p_base_src * Md.transpose();
-    dCost_dR_T1b += p_base_src[0] * M;
-    dCost_dR_T2b += p_base_src[1] * M;
-    dCost_dR_T3b += p_base_src[2] * M;
-    hessian_rot_tmp.noalias() +=
-        Eigen::Map<const Eigen::Matrix<double, 9, 1>>{M.data()} *
-        (Eigen::Matrix<double, 1, 6>() << p_base_src[0] * p_base_src[0],
-         p_base_src[0] * p_base_src[1],
-         p_base_src[0] * p_base_src[2],
-         p_base_src[1] * p_base_src[1],
-         p_base_src[1] * p_base_src[2],
-         p_base_src[2] * p_base_src[2])
-            .finished();
-  }
+  gicp_->reduceCorrespondences(
+      m,
+      [&](int i, detail::GICPHessianAccumulator& acc_i) {
+        // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in
+        // registration.hpp
+        const auto& src_idx = (*gicp_->tmp_idx_src_)[i];
+        Vector4fMapConst p_src = (*gicp_->tmp_src_)[src_idx].getVector4fMap();
+        // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in
+        // registration.hpp
+        Vector4fMapConst p_tgt =
+            (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
+        Eigen::Vector4f p_trans_src(transformation_matrix_float * p_src);
+        // The last coordinate is still guaranteed to be set to 1.0
+        // The d here is the negative of the d in the paper
+        const Eigen::Vector3d d(p_trans_src[0] - p_tgt[0],
+                                p_trans_src[1] - p_tgt[1],
+                                p_trans_src[2] - p_tgt[2]);
+        const Eigen::Matrix3d& M = gicp_->mahalanobis(src_idx);
+        const Eigen::Vector3d Md(M * d); // Md = M*d
+        acc_i.g_t += Md;                 // translation gradient
+        acc_i.hessian_t += M;            // translation-translation hessian
+        p_trans_src = base_transformation_float * p_src;
+        const Eigen::Vector3d p_base_src(
+            p_trans_src[0], p_trans_src[1], p_trans_src[2]);
+        acc_i.dCost_dR_T.noalias() += p_base_src * Md.transpose();
+        acc_i.dCost_dR_T1b += p_base_src[0] * M;
+        acc_i.dCost_dR_T2b += p_base_src[1] * M;
+        acc_i.dCost_dR_T3b += p_base_src[2] * M;
+        acc_i.hessian_rot_tmp.noalias() +=
+            Eigen::Map<const Eigen::Matrix<double, 9, 1>>{M.data()} *
+            (Eigen::Matrix<double, 1, 6>() << p_base_src[0] * p_base_src[0],
+             p_base_src[0] * p_base_src[1],
+             p_base_src[0] * p_base_src[2],
+             p_base_src[1] * p_base_src[1],
+             p_base_src[1] * p_base_src[2],
+             p_base_src[2] * p_base_src[2])
+                .finished();
+      },
+      acc);
+  gradient.head<3>() = acc.g_t;
+  hessian.block<3, 3>(0, 0) = acc.hessian_t;
+  Eigen::Matrix3d& dCost_dR_T = acc.dCost_dR_T;
+  const Eigen::Matrix3d& dCost_dR_T1b = acc.dCost_dR_T1b;
+  const Eigen::Matrix3d& dCost_dR_T2b = acc.dCost_dR_T2b;
+  const Eigen::Matrix3d& dCost_dR_T3b = acc.dCost_dR_T3b;
+  const Eigen::Matrix<double, 9, 6>& hessian_rot_tmp = acc.hessian_rot_tmp;
   gradient.head<3>() *= 2.0 / m; // translation gradient
   dCost_dR_T *= 2.0 / m;
   gicp_->computeRDerivative(x, dCost_dR_T, gradient); // rotation gradient
@@ -774,9 +864,11 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
   pcl::transformPointCloud(output, output, guess);
 
   while (!converged_) {
-    std::size_t cnt = 0;
-    pcl::Indices source_indices(indices_->size());
-    pcl::Indices target_indices(indices_->size());
+    // One slot per source point, so that the correspondences do not depend on the
+    // number of threads. Slots without a valid correspondence stay UNAVAILABLE.
+    pcl::Indices nn_matches(N, UNAVAILABLE);
+    // Smallest source position for which the nearest neighbor search failed
+    std::ptrdiff_t first_failure = static_cast<std::ptrdiff_t>(N);
 
     // guess corresponds to base_t and transformation_ to t
     Eigen::Matrix4d transform_R = Eigen::Matrix4d::Zero();
@@ -786,19 +878,18 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
           transform_R(i, j) += static_cast<double>(transformation_(i, k)) *
                                static_cast<double>(guess(k, j));
 
-    Eigen::Matrix3d R = transform_R.topLeftCorner<3, 3>();
+    const Eigen::Matrix3d R = transform_R.topLeftCorner<3, 3>();
+    const Eigen::Matrix4f transformation_float = transformation_.template cast<float>();
 
-    for (std::size_t i = 0; i < N; i++) {
+#pragma omp parallel for firstprivate(nn_indices, nn_dists) num_threads(threads_)      \
+    schedule(dynamic, 256) reduction(min : first_failure)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(N); i++) {
       PointSource query = output[i];
-      query.getVector4fMap() =
-          transformation_.template cast<float>() * query.getVector4fMap();
+      query.getVector4fMap() = transformation_float * query.getVector4fMap();
 
       if (!searchForNeighbors(query, nn_indices, nn_dists)) {
-        PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
-                  "in the target dataset for point %d in the source!\n",
-                  getClassName().c_str(),
-                  (*indices_)[i]);
-        return;
+        first_failure = std::min(first_failure, i);
+        continue;
       }
 
       // Check if the distance to the nearest neighbor is smaller than the user imposed
@@ -814,14 +905,29 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
         temp += C2;
         // M = temp^-1
         M = temp.inverse();
-        source_indices[cnt] = static_cast<int>(i);
-        target_indices[cnt] = nn_indices[0];
-        cnt++;
+        nn_matches[i] = nn_indices[0];
+      }
+    }
+
+    if (first_failure < static_cast<std::ptrdiff_t>(N)) {
+      PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
+                "in the target dataset for point %d in the source!\n",
+                getClassName().c_str(),
+                (*indices_)[first_failure]);
+      return;
+    }
+
+    // Collect the valid correspondences in source order
+    pcl::Indices source_indices;
+    pcl::Indices target_indices;
+    source_indices.reserve(N);
+    target_indices.reserve(N);
+    for (std::size_t i = 0; i < N; i++) {
+      if (nn_matches[i] != UNAVAILABLE) {
+        source_indices.push_back(static_cast<int>(i));
+        target_indices.push_back(nn_matches[i]);
       }
     }
-    // Resize to the actual number of valid correspondences
-    source_indices.resize(cnt);
-    target_indices.resize(cnt);
     /* optimize transformation using the current assignment and Mahalanobis metrics*/
     previous_transformation_ = transformation_;
     // optimization right here
@@ -41,6 +41,12 @@
 #ifndef PCL_REGISTRATION_NDT_IMPL_H_
 #define PCL_REGISTRATION_NDT_IMPL_H_
 
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl {
 
 template <typename PointSource, typename PointTarget, typename Scalar>
@@ -63,6 +69,58 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::
   max_iterations_ = 35;
 }
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+NormalDistributionsTransform<PointSource, PointTarget, Scalar>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG("[pcl::%s::setNumberOfThreads] Setting number of threads to %u.\n",
+            getClassName().c_str(),
+            threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN("[pcl::%s::setNumberOfThreads] Parallelization is requested, but OpenMP "
+             "is not available! Continuing without parallelization.\n",
+             getClassName().c_str());
+#endif // _OPENMP
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+NormalDistributionsTransform<PointSource, PointTarget, Scalar>::setNeighborSearchMethod(
+    NeighborSearchMethod method)
+{
+  search_method_ = method;
+  switch (search_method_) {
+  case NeighborSearchMethod::KDTREE:
+    neighbor_offsets_.resize(3, 0);
+    break;
+  case NeighborSearchMethod::DIRECT1:
+    neighbor_offsets_.setZero(3, 1);
+    break;
+  case NeighborSearchMethod::DIRECT7:
+    neighbor_offsets_.setZero(3, 7);
+    neighbor_offsets_(0, 1) = 1;
+    neighbor_offsets_(0, 2) = -1;
+    neighbor_offsets_(1, 3) = 1;
+    neighbor_offsets_(1, 4) = -1;
+    neighbor_offsets_(2, 5) = 1;
+    neighbor_offsets_(2, 6) = -1;
+    break;
+  case NeighborSearchMethod::DIRECT27:
+    neighbor_offsets_.resize(3, 27);
+    neighbor_offsets_.col(0).setZero();
+    neighbor_offsets_.rightCols(26) = pcl::getAllNeighborCellIndices();
+    break;
+  }
+}
+
 template <typename PointSource, typename PointTarget, typename Scalar>
 void
 NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computeTransformation(
@@ -70,7 +128,7 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computeTransform
 {
   nr_iterations_ = 0;
   converged_ = false;
-  if (target_cells_.getCentroids()->empty()) {
+  if (target_map_ ? target_->empty() : target_cells_.getCentroids()->empty()) {
     PCL_ERROR("[%s::computeTransformation] Voxel grid is not searchable!\n",
               getClassName().c_str());
     return;
@@ -189,48 +247,104 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computeDerivativ
     const Eigen::Matrix<double, 6, 1>& transform,
     bool compute_hessian)
 {
-  score_gradient.setZero();
-  hessian.setZero();
-  double score = 0;
-
   // Precompute Angular Derivatives (eq. 6.19 and 6.21)[Magnusson 2009]
   computeAngleDerivatives(transform);
 
-  // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (std::size_t idx = 0; idx < input_->size(); idx++) {
-    // Transformed Point
-    const auto& x_trans_pt = trans_cloud[idx];
-
-    // Find neighbors (Radius search has been experimentally faster than direct neighbor
-    // checking.
+  // The points are split into one contiguous block per thread. Each block accumulates
+  // its own score, gradient and hessian, which are then summed in block order.
+  const std::size_t nr_points = input_->size();
+  const int nr_blocks = static_cast<int>(
+      std::max<std::size_t>(1, std::min<std::size_t>(threads_, nr_points)));
+  std::vector<double> block_scores(nr_blocks, 0.0);
+  std::vector<Eigen::Matrix<double, 6, 1>,
+              Eigen::aligned_allocator<Eigen::Matrix<double, 6, 1>>>
+      block_gradients(nr_blocks, Eigen::Matrix<double, 6, 1>::Zero());
+  std::vector<Eigen::Matrix<double, 6, 6>,
+              Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6>>>
+      block_hessians(nr_blocks, Eigen::Matrix<double, 6, 6>::Zero());
+
+#pragma omp parallel for num_threads(nr_blocks) schedule(static, 1)
+  for (int block = 0; block < nr_blocks; ++block) {
+    // Each block has its own copy of the point derivatives
+    Eigen::Matrix<double, 3, 6> point_jacobian = point_jacobian_;
+    Eigen::Matrix<double, 18, 6> point_hessian = point_hessian_;
     std::vector<TargetGridLeafConstPtr> neighborhood;
     std::vector<float> distances;
-    target_cells_.radiusSearch(x_trans_pt, resolution_, neighborhood, distances);
 
-    for (const auto& cell : neighborhood) {
+    const std::size_t begin = nr_points * block / nr_blocks;
+    const std::size_t end = nr_points * (block + 1) / nr_blocks;
+    // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson
+    // 2009]
+    for (std::size_t idx = begin; idx < end; idx++) {
+      // Transformed Point
+      const auto& x_trans_pt = trans_cloud[idx];
+
+      findNeighborhood(x_trans_pt, neighborhood, distances);
+      if (neighborhood.empty())
+        continue;
+
       // Original Point
       const auto& x_pt = (*input_)[idx];
       const Eigen::Vector3d x = x_pt.getVector3fMap().template cast<double>();
-
-      // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-      const Eigen::Vector3d x_trans =
-          x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
-      // Inverse Covariance of Occupied Voxel
-      // Uses precomputed covariance for speed.
-      const Eigen::Matrix3d c_inv = cell->getInverseCov();
-
       // Compute derivative of transform function w.r.t. transform vector, J_E and H_E
       // in Equations 6.18 and 6.20 [Magnusson 2009]
-      computePointDerivatives(x);
-      // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to
-      // Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-      score +=
-          updateDerivatives(score_gradient, hessian, x_trans, c_inv, compute_hessian);
+      computePointDerivatives(x, point_jacobian, point_hessian, compute_hessian);
+
+      for (const auto& cell : neighborhood) {
+        // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+        const Eigen::Vector3d x_trans =
+            x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
+        // Inverse Covariance of Occupied Voxel
+        // Uses precomputed covariance for speed.
+        const Eigen::Matrix3d c_inv = cell->getInverseCov();
+
+        // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to
+        // Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
+        block_scores[block] += updateDerivatives(block_gradients[block],
+                                                 block_hessians[block],
+                                                 x_trans,
+                                                 c_inv,
+                                                 point_jacobian,
+                                                 point_hessian,
+                                                 compute_hessian);
+      }
     }
   }
+
+  score_gradient.setZero();
+  hessian.setZero();
+  double score = 0;
+  for (int block = 0; block < nr_blocks; ++block) {
+    score += block_scores[block];
+    score_gradient += block_gradients[block];
+    hessian += block_hessians[block];
+  }
   return score;
 }
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+NormalDistributionsTransform<PointSource, PointTarget, Scalar>::findNeighborhood(
+    const PointSource& x_trans_pt,
+    std::vector<TargetGridLeafConstPtr>& neighborhood,
+    std::vector<float>& distances) const
+{
+  if (target_map_) {
+    // The map has no kd-tree, its radius search visits the surrounding voxels
+    if (search_method_ == NeighborSearchMethod::KDTREE)
+      target_map_->radiusSearch(x_trans_pt, resolution_, neighborhood, distances);
+    else
+      target_map_->getNeighborhoodAtPoint(neighbor_offsets_, x_trans_pt, neighborhood);
+  }
+  else if (search_method_ == NeighborSearchMethod::KDTREE)
+    // Radius search has been experimentally faster than direct neighbor checking
+    // against all 27 surrounding voxels.
+    target_cells_.radiusSearch(x_trans_pt, resolution_, neighborhood, distances);
+  else
+    // Direct lookup of the voxels at the precomputed relative coordinates
+    target_cells_.getNeighborhoodAtPoint(neighbor_offsets_, x_trans_pt, neighborhood);
+}
+
 template <typename PointSource, typename PointTarget, typename Scalar>
 void
 NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computeAngleDerivatives(
@@ -320,20 +434,31 @@ template <typename PointSource, typename PointTarget, typename Scalar>
 void
 NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computePointDerivatives(
     const Eigen::Vector3d& x, bool compute_hessian)
+{
+  computePointDerivatives(x, point_jacobian_, point_hessian_, compute_hessian);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computePointDerivatives(
+    const Eigen::Vector3d& x,
+    Eigen::Matrix<double, 3, 6>& point_jacobian,
+    Eigen::Matrix<double, 18, 6>& point_hessian,
+    bool compute_hessian) const
 {
   // Calculate first derivative of Transformation Equation 6.17 w.r.t. transform vector.
   // Derivative w.r.t. ith element of transform vector corresponds to column i,
   // Equation 6.18 and 6.19 [Magnusson 2009]
   Eigen::Matrix<double, 8, 1> point_angular_jacobian =
       angular_jacobian_ * Eigen::Vector4d(x[0], x[1], x[2], 0.0);
-  point_jacobian_(1, 3) = point_angular_jacobian[0];
-  point_jacobian_(2, 3) = point_angular_jacobian[1];
-  point_jacobian_(0, 4) = point_angular_jacobian[2];
-  point_jacobian_(1, 4) = point_angular_jacobian[3];
-  point_jacobian_(2, 4) = point_angular_jacobian[4];
-  point_jacobian_(0, 5) = point_angular_jacobian[5];
-  point_jacobian_(1, 5) = point_angular_jacobian[6];
-  point_jacobian_(2, 5) = point_angular_jacobian[7];
+  point_jacobian(1, 3) = point_angular_jacobian[0];
+  point_jacobian(2, 3) = point_angular_jacobian[1];
+  point_jacobian(0, 4) = point_angular_jacobian[2];
+  point_jacobian(1, 4) = point_angular_jacobian[3];
+  point_jacobian(2, 4) = point_angular_jacobian[4];
+  point_jacobian(0, 5) = point_angular_jacobian[5];
+  point_jacobian(1, 5) = point_angular_jacobian[6];
+  point_jacobian(2, 5) = point_angular_jacobian[7];
 
   if (compute_hessian) {
     Eigen::Matrix<double, 15, 1> point_angular_hessian =
@@ -350,15 +475,15 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computePointDeri
     // Calculate second derivative of Transformation Equation 6.17 w.r.t. transform
     // vector. Derivative w.r.t. ith and jth elements of transform vector corresponds to
     // the 3x1 block matrix starting at (3i,j), Equation 6.20 and 6.21 [Magnusson 2009]
-    point_hessian_.block<3, 1>(9, 3) = a;
-    point_hessian_.block<3, 1>(12, 3) = b;
-    point_hessian_.block<3, 1>(15, 3) = c;
-    point_hessian_.block<3, 1>(9, 4) = b;
-    point_hessian_.block<3, 1>(12, 4) = d;
-    point_hessian_.block<3, 1>(15, 4) = e;
-    point_hessian_.block<3, 1>(9, 5) = c;
-    point_hessian_.block<3, 1>(12, 5) = e;
-    point_hessian_.block<3, 1>(15, 5) = f;
+    point_hessian.block<3, 1>(9, 3) = a;
+    point_hessian.block<3, 1>(12, 3) = b;
+    point_hessian.block<3, 1>(15, 3) = c;
+    point_hessian.block<3, 1>(9, 4) = b;
+    point_hessian.block<3, 1>(12, 4) = d;
+    point_hessian.block<3, 1>(15, 4) = e;
+    point_hessian.block<3, 1>(9, 5) = c;
+    point_hessian.block<3, 1>(12, 5) = e;
+    point_hessian.block<3, 1>(15, 5) = f;
   }
 }
 
@@ -370,6 +495,26 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::updateDerivative
     const Eigen::Vector3d& x_trans,
     const Eigen::Matrix3d& c_inv,
     bool compute_hessian) const
+{
+  return updateDerivatives(score_gradient,
+                           hessian,
+                           x_trans,
+                           c_inv,
+                           point_jacobian_,
+                           point_hessian_,
+                           compute_hessian);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+double
+NormalDistributionsTransform<PointSource, PointTarget, Scalar>::updateDerivatives(
+    Eigen::Matrix<double, 6, 1>& score_gradient,
+    Eigen::Matrix<double, 6, 6>& hessian,
+    const Eigen::Vector3d& x_trans,
+    const Eigen::Matrix3d& c_inv,
+    const Eigen::Matrix<double, 3, 6>& point_jacobian,
+    const Eigen::Matrix<double, 18, 6>& point_hessian,
+    bool compute_hessian) const
 {
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
   double e_x_cov_x = std::exp(-gauss_d2_ * x_trans.dot(c_inv * x_trans) / 2);
@@ -390,7 +535,7 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::updateDerivative
   for (int i = 0; i < 6; i++) {
     // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson
     // 2009]
-    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian_.col(i);
+    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian.col(i);
 
     // Update gradient, Equation 6.12 [Magnusson 2009]
     score_gradient(i) += x_trans.dot(cov_dxd_pi) * e_x_cov_x;
@@ -400,9 +545,9 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::updateDerivative
         // Update hessian, Equation 6.13 [Magnusson 2009]
         hessian(i, j) +=
             e_x_cov_x * (-gauss_d2_ * x_trans.dot(cov_dxd_pi) *
-                             x_trans.dot(c_inv * point_jacobian_.col(j)) +
-                         x_trans.dot(c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                         point_jacobian_.col(j).dot(cov_dxd_pi));
+                             x_trans.dot(c_inv * point_jacobian.col(j)) +
+                         x_trans.dot(c_inv * point_hessian.block<3, 1>(3 * i, j)) +
+                         point_jacobian.col(j).dot(cov_dxd_pi));
       }
     }
   }
@@ -415,41 +560,60 @@ void
 NormalDistributionsTransform<PointSource, PointTarget, Scalar>::computeHessian(
     Eigen::Matrix<double, 6, 6>& hessian, const PointCloudSource& trans_cloud)
 {
-  hessian.setZero();
-
   // Precompute Angular Derivatives unnecessary because only used after regular
-  // derivative calculation Update hessian for each point, line 17 in Algorithm 2
-  // [Magnusson 2009]
-  for (std::size_t idx = 0; idx < input_->size(); idx++) {
-    // Transformed Point
-    const auto& x_trans_pt = trans_cloud[idx];
-
-    // Find neighbors (Radius search has been experimentally faster than direct neighbor
-    // checking.
+  // derivative calculation. As in computeDerivatives, the points are split into one
+  // contiguous block per thread whose hessians are summed in block order.
+  const std::size_t nr_points = input_->size();
+  const int nr_blocks = static_cast<int>(
+      std::max<std::size_t>(1, std::min<std::size_t>(threads_, nr_points)));
+  std::vector<Eigen::Matrix<double, 6, 6>,
+              Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6>>>
+      block_hessians(nr_blocks, Eigen::Matrix<double, 6, 6>::Zero());
+
+#pragma omp parallel for num_threads(nr_blocks) schedule(static, 1)
+  for (int block = 0; block < nr_blocks; ++block) {
+    Eigen::Matrix<double, 3, 6> point_jacobian = point_jacobian_;
+    Eigen::Matrix<double, 18, 6> point_hessian = point_hessian_;
     std::vector<TargetGridLeafConstPtr> neighborhood;
     std::vector<float> distances;
-    target_cells_.radiusSearch(x_trans_pt, resolution_, neighborhood, distances);
 
-    for (const auto& cell : neighborhood) {
+    const std::size_t begin = nr_points * block / nr_blocks;
+    const std::size_t end = nr_points * (block + 1) / nr_blocks;
+    // Update hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
+    for (std::size_t idx = begin; idx < end; idx++) {
+      // Transformed Point
+      const auto& x_trans_pt = trans_cloud[idx];
+
+      findNeighborhood(x_trans_pt, neighborhood, distances);
+      if (neighborhood.empty())
+        continue;
+
       // Original Point
       const auto& x_pt = (*input_)[idx];
       const Eigen::Vector3d x = x_pt.getVector3fMap().template cast<double>();
-
-      // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-      const Eigen::Vector3d x_trans =
-          x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
-      // Inverse Covariance of Occupied Voxel
-      // Uses precomputed covariance for speed.
-      const Eigen::Matrix3d c_inv = cell->getInverseCov();
-
       // Compute derivative of transform function w.r.t. transform vector, J_E and H_E
       // in Equations 6.18 and 6.20 [Magnusson 2009]
-      computePointDerivatives(x);
-      // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12
-      // and 6.13, respectively [Magnusson 2009]
-      updateHessian(hessian, x_trans, c_inv);
+      computePointDerivatives(x, point_jacobian, point_hessian);
+
+      for (const auto& cell : neighborhood) {
+        // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+        const Eigen::Vector3d x_trans =
+            x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
+        // Inverse Covariance of Occupied Voxel
+        // Uses precomputed covariance for speed.
+        const Eigen::Matrix3d c_inv = cell->getInverseCov();
+
+        // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12
+        // and 6.13, respectively [Magnusson 2009]
+        updateHessian(
+            block_hessians[block], x_trans, c_inv, point_jacobian, point_hessian);
+      }
     }
   }
+
+  hessian.setZero();
+  for (int block = 0; block < nr_blocks; ++block)
+    hessian += block_hessians[block];
 }
 
 template <typename PointSource, typename PointTarget, typename Scalar>
@@ -458,6 +622,18 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::updateHessian(
     Eigen::Matrix<double, 6, 6>& hessian,
     const Eigen::Vector3d& x_trans,
     const Eigen::Matrix3d& c_inv) const
+{
+  updateHessian(hessian, x_trans, c_inv, point_jacobian_, point_hessian_);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+NormalDistributionsTransform<PointSource, PointTarget, Scalar>::updateHessian(
+    Eigen::Matrix<double, 6, 6>& hessian,
+    const Eigen::Vector3d& x_trans,
+    const Eigen::Matrix3d& c_inv,
+    const Eigen::Matrix<double, 3, 6>& point_jacobian,
+    const Eigen::Matrix<double, 18, 6>& point_hessian) const
 {
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
   double e_x_cov_x =
@@ -474,15 +650,15 @@ NormalDistributionsTransform<PointSource, PointTarget, Scalar>::updateHessian(
   for (int i = 0; i < 6; i++) {
     // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson
     // 2009]
-    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian_.col(i);
+    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian.col(i);
 
     for (Eigen::Index j = 0; j < hessian.cols(); j++) {
       // Update hessian, Equation 6.13 [Magnusson 2009]
       hessian(i, j) +=
           e_x_cov_x * (-gauss_d2_ * x_trans.dot(cov_dxd_pi) *
-                           x_trans.dot(c_inv * point_jacobian_.col(j)) +
-                       x_trans.dot(c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                       point_jacobian_.col(j).dot(cov_dxd_pi));
+                           x_trans.dot(c_inv * point_jacobian.col(j)) +
+                       x_trans.dot(c_inv * point_hessian.block<3, 1>(3 * i, j)) +
+                       point_jacobian.col(j).dot(cov_dxd_pi));
     }
   }
 }
@@ -0,0 +1,293 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_IMPL_VGICP_HPP_
+#define PCL_REGISTRATION_IMPL_VGICP_HPP_
+
+#include <pcl/common/transforms.h>
+
+#include <numeric>
+
+namespace pcl {
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i>>
+VoxelizedGeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+    getNeighborOffsets() const
+{
+  std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i>> offsets;
+  switch (search_method_) {
+  case NeighborSearchMethod::DIRECT1:
+    offsets.emplace_back(0, 0, 0);
+    break;
+  case NeighborSearchMethod::DIRECT7:
+    offsets.emplace_back(0, 0, 0);
+    offsets.emplace_back(-1, 0, 0);
+    offsets.emplace_back(1, 0, 0);
+    offsets.emplace_back(0, -1, 0);
+    offsets.emplace_back(0, 1, 0);
+    offsets.emplace_back(0, 0, -1);
+    offsets.emplace_back(0, 0, 1);
+    break;
+  case NeighborSearchMethod::DIRECT27:
+    for (int i = -1; i <= 1; ++i)
+      for (int j = -1; j <= 1; ++j)
+        for (int k = -1; k <= 1; ++k)
+          offsets.emplace_back(i, j, k);
+    break;
+  }
+  return (offsets);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+VoxelizedGeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+    voxelizeTarget()
+{
+  voxels_.clear();
+  voxel_map_.clear();
+
+  // Accumulate the sums of the points and of their covariances per voxel
+  for (std::size_t i = 0; i < target_->size(); ++i) {
+    const PointTarget& pt = (*target_)[i];
+    if (!pcl::isXYZFinite(pt))
+      continue;
+    const auto inserted =
+        voxel_map_.emplace(getVoxelCoordinates(pt.getVector3fMap()), voxels_.size());
+    if (inserted.second)
+      voxels_.emplace_back();
+    GaussianVoxel& voxel = voxels_[inserted.first->second];
+    ++voxel.nr_points;
+    voxel.mean += pt.getVector3fMap().template cast<double>();
+    voxel.cov += (*target_covariances_)[i];
+  }
+
+  for (auto& voxel : voxels_) {
+    voxel.mean /= static_cast<double>(voxel.nr_points);
+    voxel.cov /= static_cast<double>(voxel.nr_points);
+  }
+  voxelized_covariances_ = target_covariances_;
+
+  PCL_DEBUG("[pcl::%s::voxelizeTarget] Aggregated %zu target points into %zu voxels "
+            "of size %g.\n",
+            getClassName().c_str(),
+            static_cast<std::size_t>(target_->size()),
+            voxels_.size(),
+            resolution_);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+VoxelizedGeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+    computeTransformation(PointCloudSource& output, const Matrix4& guess)
+{
+  pcl::IterativeClosestPoint<PointSource, PointTarget, Scalar>::initComputeReciprocal();
+  // Difference between consecutive transforms
+  double delta = 0;
+  // Get the size of the source point cloud
+  const std::size_t N = indices_->size();
+  // Compute target cloud covariance matrices, unless the voxels come from a map
+  if (!target_map_ && ((!target_covariances_) || (target_covariances_->empty()))) {
+    target_covariances_.reset(new MatricesVector);
+    this->template computeCovariances<PointTarget>(
+        target_, tree_, *target_covariances_);
+  }
+  // Compute input cloud covariance matrices
+  if ((!input_covariances_) || (input_covariances_->empty())) {
+    input_covariances_.reset(new MatricesVector);
+    this->template computeCovariances<PointSource>(
+        input_, tree_reciprocal_, *input_covariances_);
+  }
+  // Aggregate the target distributions, unless they are up to date
+  if (!target_map_ && (voxels_.empty() || voxelized_covariances_ != target_covariances_))
+    voxelizeTarget();
+
+  const auto offsets = getNeighborOffsets();
+  const std::size_t nr_offsets = offsets.size();
+  Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates(3, nr_offsets);
+  for (std::size_t j = 0; j < nr_offsets; ++j)
+    relative_coordinates.col(j) = offsets[j];
+
+  base_transformation_ = Matrix4::Identity();
+  nr_iterations_ = 0;
+  converged_ = false;
+
+  pcl::transformPointCloud(output, output, guess);
+
+  // Source points and voxel means of the correspondences, passed to the optimizer
+  PointCloudSource correspondences_source;
+  PointCloudTarget correspondences_target;
+
+  while (!converged_) {
+    // guess corresponds to base_t and transformation_ to t
+    Eigen::Matrix4d transform_R = Eigen::Matrix4d::Zero();
+    for (std::size_t i = 0; i < 4; i++)
+      for (std::size_t j = 0; j < 4; j++)
+        for (std::size_t k = 0; k < 4; k++)
+          transform_R(i, j) += static_cast<double>(transformation_(i, k)) *
+                               static_cast<double>(guess(k, j));
+
+    const Eigen::Matrix3d R = transform_R.topLeftCorner<3, 3>();
+    const Eigen::Matrix4f transformation_float = transformation_.template cast<float>();
+
+    // Look up the voxels of every source point. There is one slot per source point and
+    // offset, so that the correspondences do not depend on the number of threads.
+    std::vector<VoxelView> voxel_slots(N * nr_offsets);
+    // The voxels of the map found for a point, reused by all points of a thread
+    std::vector<typename TargetMap::LeafConstPtr> leaves;
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 256) firstprivate(leaves)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(N); i++) {
+      const Eigen::Vector4f query = transformation_float * output[i].getVector4fMap();
+      VoxelView* slots = &voxel_slots[i * nr_offsets];
+      if (target_map_) {
+        PointTarget query_pt;
+        query_pt.getVector3fMap() = query.head<3>();
+        target_map_->getNeighborhoodAtPoint(relative_coordinates, query_pt, leaves);
+        for (std::size_t j = 0; j < leaves.size(); ++j)
+          slots[j] = {&leaves[j]->mean_, &leaves[j]->cov_, leaves[j]->nr_points};
+        continue;
+      }
+      const Eigen::Vector3i coordinates = getVoxelCoordinates(query.head<3>());
+      for (std::size_t j = 0; j < nr_offsets; ++j) {
+        const auto voxel = voxel_map_.find(Eigen::Vector3i(coordinates + offsets[j]));
+        if (voxel != voxel_map_.end()) {
+          const GaussianVoxel& gaussian = voxels_[voxel->second];
+          slots[j] = {&gaussian.mean, &gaussian.cov, gaussian.nr_points};
+        }
+      }
+    }
+
+    // Collect the correspondences in source order
+    pcl::Indices source_indices;
+    std::vector<VoxelView> target_voxels;
+    source_indices.reserve(N);
+    target_voxels.reserve(N);
+    for (std::size_t slot = 0; slot < voxel_slots.size(); ++slot) {
+      if (voxel_slots[slot].mean) {
+        source_indices.push_back(static_cast<index_t>(slot / nr_offsets));
+        target_voxels.push_back(voxel_slots[slot]);
+      }
+    }
+    const std::size_t nr_correspondences = source_indices.size();
+
+    // Fill in the correspondences and their weighted mahalanobis matrices
+    correspondences_source.resize(nr_correspondences);
+    correspondences_target.resize(nr_correspondences);
+    mahalanobis_.resize(nr_correspondences);
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(nr_correspondences);
+         c++) {
+      const VoxelView& voxel = target_voxels[c];
+      const Eigen::Vector3d& mean = *voxel.mean;
+      correspondences_source[c] = output[source_indices[c]];
+      correspondences_target[c].getVector4fMap() =
+          Eigen::Vector4f(static_cast<float>(mean[0]),
+                          static_cast<float>(mean[1]),
+                          static_cast<float>(mean[2]),
+                          1.0f);
+      // M = N * (R*C1*R' + C2)^-1
+      const Eigen::Matrix3d& C1 = (*input_covariances_)[source_indices[c]];
+      const Eigen::Matrix3d temp = R * C1 * R.transpose() + *voxel.cov;
+      mahalanobis_[c] = static_cast<double>(voxel.nr_points) * temp.inverse();
+    }
+
+    pcl::Indices indices(nr_correspondences);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    /* optimize transformation using the current assignment and Mahalanobis metrics*/
+    previous_transformation_ = transformation_;
+    // optimization right here
+    try {
+      rigid_transformation_estimation_(correspondences_source,
+                                       indices,
+                                       correspondences_target,
+                                       indices,
+                                       transformation_);
+      /* compute the delta from this iteration */
+      delta = 0.;
+      for (int k = 0; k < 4; k++) {
+        for (int l = 0; l < 4; l++) {
+          double ratio = 1;
+          if (k < 3 && l < 3) // rotation part of the transform
+            ratio = 1. / rotation_epsilon_;
+          else
+            ratio = 1. / transformation_epsilon_;
+          double c_delta =
+              ratio * std::abs(previous_transformation_(k, l) - transformation_(k, l));
+          if (c_delta > delta)
+            delta = c_delta;
+        }
+      }
+    } catch (PCLException& e) {
+      PCL_DEBUG("[pcl::%s::computeTransformation] Optimization issue %s\n",
+                getClassName().c_str(),
+                e.what());
+      break;
+    }
+    nr_iterations_++;
+
+    if (update_visualizer_ != nullptr) {
+      PointCloudSourcePtr input_transformed(new PointCloudSource);
+      pcl::transformPointCloud(
+          correspondences_source, *input_transformed, transformation_);
+      update_visualizer_(*input_transformed, indices, correspondences_target, indices);
+    }
+
+    // Check for convergence
+    if (nr_iterations_ >= max_iterations_ || delta < 1) {
+      converged_ = true;
+      PCL_DEBUG("[pcl::%s::computeTransformation] Convergence reached. Number of "
+                "iterations: %d out of %d. Transformation difference: %f\n",
+                getClassName().c_str(),
+                nr_iterations_,
+                max_iterations_,
+                (transformation_ - previous_transformation_).array().abs().sum());
+      previous_transformation_ = transformation_;
+    }
+    else
+      PCL_DEBUG("[pcl::%s::computeTransformation] Convergence failed\n",
+                getClassName().c_str());
+  }
+  final_transformation_ = previous_transformation_ * guess;
+
+  // Transform the point cloud
+  pcl::transformPointCloud(*input_, output, final_transformation_);
+}
+
+} // namespace pcl
+
+#endif // PCL_REGISTRATION_IMPL_VGICP_HPP_
@@ -41,6 +41,7 @@
 #pragma once
 
 #include <pcl/common/utils.h>
+#include <pcl/filters/incremental_voxel_grid_covariance.h>
 #include <pcl/filters/voxel_grid_covariance.h>
 #include <pcl/registration/registration.h>
 #include <pcl/memory.h>
@@ -94,10 +95,29 @@ public:
       shared_ptr<NormalDistributionsTransform<PointSource, PointTarget, Scalar>>;
   using ConstPtr =
       shared_ptr<const NormalDistributionsTransform<PointSource, PointTarget, Scalar>>;
+
+  /** \brief Typename of an incremental voxel map the source can be aligned to. */
+  using TargetMap = IncrementalVoxelGridCovariance<PointTarget>;
+  /** \brief Typename of const pointer to an incremental voxel map. */
+  using TargetMapConstPtr = typename TargetMap::ConstPtr;
+
   using Vector3 = typename Eigen::Matrix<Scalar, 3, 1>;
   using Matrix4 = typename Registration<PointSource, PointTarget, Scalar>::Matrix4;
   using Affine3 = typename Eigen::Transform<Scalar, 3, Eigen::Affine>;
 
+  /** \brief Voxels of the target a transformed source point is compared to. */
+  enum class NeighborSearchMethod {
+    /** \brief All voxels whose centroid lies within one resolution of the point,
+     * found with a radius search in the kd-tree of the voxel centroids. */
+    KDTREE,
+    /** \brief Only the voxel containing the point, found by a direct lookup. */
+    DIRECT1,
+    /** \brief The voxel containing the point and its 6 face neighbors. */
+    DIRECT7,
+    /** \brief The voxel containing the point and all its 26 neighbors. */
+    DIRECT27
+  };
+
   /** \brief Constructor.  Sets \ref outlier_ratio_ to 0.55, \ref step_size_ to
    * 0.1 and \ref resolution_ to 1.0
    */
@@ -113,16 +133,50 @@ public:
   inline void
   setInputTarget(const PointCloudTargetConstPtr& cloud) override
   {
+    target_map_.reset();
     Registration<PointSource, PointTarget, Scalar>::setInputTarget(cloud);
     init();
   }
 
+  /** \brief Provide an incremental voxel map to align the input source to, in place of
+   * a target cloud. The voxels of the map are used as they are, so that a map that is
+   * updated between alignments does not need to be rebuilt. The resolution of the map
+   * becomes the resolution of the NDT, and the centroids of its voxels become the target
+   * cloud (used e.g. by getFitnessScore).
+   * \note Call this function again after the map was modified. Calling it again with
+   * an unmodified map keeps the target cloud and its kd-tree.
+   * \param[in] map the incremental voxel map
+   */
+  inline void
+  setTargetMap(const TargetMapConstPtr& map)
+  {
+    if (map == target_map_ && map->getRevision() == target_map_revision_)
+      return;
+    target_map_ = map;
+    target_map_revision_ = map->getRevision();
+    resolution_ = map->getResolution();
+    Registration<PointSource, PointTarget, Scalar>::setInputTarget(map->getCentroids());
+  }
+
+  /** \brief Get the incremental voxel map the source is aligned to, if any. */
+  inline TargetMapConstPtr
+  getTargetMap() const
+  {
+    return target_map_;
+  }
+
   /** \brief Set/change the voxel grid resolution.
+   * \note Has no effect while a target map is set, the resolution of the map is used.
    * \param[in] resolution side length of voxels
    */
   inline void
   setResolution(float resolution)
   {
+    if (target_map_) {
+      PCL_WARN("[pcl::%s::setResolution] The resolution of the target map is used.\n",
+               getClassName().c_str());
+      return;
+    }
     // Prevents unnecessary voxel initiations
     if (resolution_ != resolution) {
       resolution_ = resolution;
@@ -211,6 +265,38 @@ public:
     return trans_likelihood_;
   }
 
+  /** \brief Set how the voxels a transformed source point is compared to are found.
+   * The direct lookups avoid the kd-tree search and are considerably faster, DIRECT7
+   * usually being a good trade-off between speed and robustness. Defaults to KDTREE.
+   * \param[in] method KDTREE, DIRECT1, DIRECT7 or DIRECT27
+   */
+  void
+  setNeighborSearchMethod(NeighborSearchMethod method);
+
+  /** \brief Get how the voxels a transformed source point is compared to are found.
+   */
+  inline NeighborSearchMethod
+  getNeighborSearchMethod() const
+  {
+    return search_method_;
+  }
+
+  /** \brief Set the number of threads to use for the evaluation of the score, its
+   * gradient and its hessian. The results only depend on the number of threads
+   * through the order in which floating point sums are accumulated.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value
+   * back to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Return the number of threads used. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
   /** \brief Get the number of iterations required to calculate alignment.
    * \return final number of iterations
    */
@@ -352,6 +438,56 @@ protected:
   void
   computePointDerivatives(const Eigen::Vector3d& x, bool compute_hessian = true);
 
+  /** \brief Compute point derivatives into the given matrices.
+   * \note Equation 6.18-21 [Magnusson 2009].
+   * \param[in] x point from the input cloud
+   * \param[in,out] point_jacobian \f$ J_E \f$ in Equation 6.18 [Magnusson 2009]
+   * \param[in,out] point_hessian \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]
+   * \param[in] compute_hessian flag to calculate hessian, unnecessary for step
+   * calculation.
+   */
+  void
+  computePointDerivatives(const Eigen::Vector3d& x,
+                          Eigen::Matrix<double, 3, 6>& point_jacobian,
+                          Eigen::Matrix<double, 18, 6>& point_hessian,
+                          bool compute_hessian = true) const;
+
+  /** \brief Compute individual point contributions to derivatives of
+   * likelihood function w.r.t. the transformation vector, using the given point
+   * derivatives.
+   * \note Equation 6.10, 6.12 and 6.13 [Magnusson 2009].
+   * \param[in,out] score_gradient the gradient vector of the likelihood
+   * function w.r.t. the transformation vector
+   * \param[in,out] hessian the hessian matrix of the likelihood function
+   * w.r.t. the transformation vector
+   * \param[in] x_trans transformed point minus mean of occupied covariance
+   * voxel
+   * \param[in] c_inv covariance of occupied covariance voxel
+   * \param[in] point_jacobian \f$ J_E \f$ in Equation 6.18 [Magnusson 2009]
+   * \param[in] point_hessian \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]
+   * \param[in] compute_hessian flag to calculate hessian, unnecessary for step
+   * calculation.
+   */
+  double
+  updateDerivatives(Eigen::Matrix<double, 6, 1>& score_gradient,
+                    Eigen::Matrix<double, 6, 6>& hessian,
+                    const Eigen::Vector3d& x_trans,
+                    const Eigen::Matrix3d& c_inv,
+                    const Eigen::Matrix<double, 3, 6>& point_jacobian,
+                    const Eigen::Matrix<double, 18, 6>& point_hessian,
+                    bool compute_hessian = true) const;
+
+  /** \brief Find the voxels a transformed source point is compared to, according to
+   * the neighbor search method.
+   * \param[in] x_trans_pt transformed point
+   * \param[out] neighborhood the voxels found
+   * \param[out] distances buffer for the distances of the kd-tree search
+   */
+  void
+  findNeighborhood(const PointSource& x_trans_pt,
+                   std::vector<TargetGridLeafConstPtr>& neighborhood,
+                   std::vector<float>& distances) const;
+
   /** \brief Compute hessian of likelihood function w.r.t. the transformation
    * vector.
    * \note Equation 6.13 [Magnusson 2009].
@@ -395,6 +531,24 @@ protected:
                 const Eigen::Vector3d& x_trans,
                 const Eigen::Matrix3d& c_inv) const;
 
+  /** \brief Compute individual point contributions to hessian of likelihood
+   * function w.r.t. the transformation vector, using the given point derivatives.
+   * \note Equation 6.13 [Magnusson 2009].
+   * \param[in,out] hessian the hessian matrix of the likelihood function
+   * w.r.t. the transformation vector
+   * \param[in] x_trans transformed point minus mean of occupied covariance
+   * voxel
+   * \param[in] c_inv covariance of occupied covariance voxel
+   * \param[in] point_jacobian \f$ J_E \f$ in Equation 6.18 [Magnusson 2009]
+   * \param[in] point_hessian \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]
+   */
+  void
+  updateHessian(Eigen::Matrix<double, 6, 6>& hessian,
+                const Eigen::Vector3d& x_trans,
+                const Eigen::Matrix3d& c_inv,
+                const Eigen::Matrix<double, 3, 6>& point_jacobian,
+                const Eigen::Matrix<double, 18, 6>& point_hessian) const;
+
   /** \brief Compute line search step length and update transform and
    * likelihood derivatives using More-Thuente method.
    * \note Search Algorithm [More, Thuente 1994]
@@ -556,6 +710,12 @@ protected:
    * and covariances. */
   TargetGrid target_cells_;
 
+  /** \brief The incremental voxel map used in place of \ref target_cells_, if set. */
+  TargetMapConstPtr target_map_;
+
+  /** \brief The revision of \ref target_map_ the target cloud was taken from. */
+  std::size_t target_map_revision_{0};
+
   /** \brief The side length of voxels. */
   float resolution_{1.0f};
 
@@ -604,6 +764,16 @@ protected:
    * 2009]. */
   Eigen::Matrix<double, 18, 6> point_hessian_;
 
+  /** \brief How the voxels a transformed source point is compared to are found. */
+  NeighborSearchMethod search_method_{NeighborSearchMethod::KDTREE};
+
+  /** \brief Relative coordinates of the voxels looked up by the direct neighbor
+   * search methods. */
+  Eigen::Matrix<int, 3, Eigen::Dynamic> neighbor_offsets_;
+
+  /** \brief The number of threads the derivatives are computed with. */
+  unsigned int threads_{1};
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -0,0 +1,348 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/filters/incremental_voxel_grid_covariance.h>
+#include <pcl/registration/gicp.h>
+
+#include <unordered_map>
+
+namespace pcl {
+/** \brief VoxelizedGeneralizedIterativeClosestPoint is a variant of
+ * GeneralizedIterativeClosestPoint that aggregates the target distributions per voxel.
+ *
+ * The per-point covariances of the target are averaged over a regular voxel grid, so
+ * that every voxel holds the mean, the mean covariance and the number of target
+ * points inside it. During the alignment each source point is associated with the
+ * voxel it falls into (and optionally its neighboring voxels) by a direct lookup
+ * instead of a nearest neighbor search in the target. Each correspondence is weighted
+ * by the number of points of its voxel.
+ *
+ * The optimizer (Newton, or BFGS via `useBFGS`), the convergence criteria and the
+ * source covariances are shared with GeneralizedIterativeClosestPoint.
+ *
+ * \note If you use this code in any academic work, please cite:
+ *
+ * - K. Koide, M. Yokozuka, S. Oishi, A. Banno
+ * Voxelized GICP for Fast and Accurate 3D Point Cloud Registration.
+ * In Proceedings of the IEEE International Conference on Robotics and Automation
+ * (ICRA), 2021.
+ *
+ * \ingroup registration
+ */
+template <typename PointSource, typename PointTarget, typename Scalar = float>
+class VoxelizedGeneralizedIterativeClosestPoint
+: public GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar> {
+public:
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::reg_name_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      getClassName;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::indices_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::target_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::input_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::tree_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      tree_reciprocal_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      nr_iterations_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      max_iterations_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      previous_transformation_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      final_transformation_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      transformation_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      transformation_epsilon_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::converged_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      update_visualizer_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      rotation_epsilon_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      base_transformation_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      input_covariances_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      target_covariances_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      mahalanobis_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::threads_;
+  using GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::
+      rigid_transformation_estimation_;
+
+  using PointCloudSource = pcl::PointCloud<PointSource>;
+  using PointCloudSourcePtr = typename PointCloudSource::Ptr;
+  using PointCloudSourceConstPtr = typename PointCloudSource::ConstPtr;
+
+  using PointCloudTarget = pcl::PointCloud<PointTarget>;
+  using PointCloudTargetPtr = typename PointCloudTarget::Ptr;
+  using PointCloudTargetConstPtr = typename PointCloudTarget::ConstPtr;
+
+  using MatricesVector = typename GeneralizedIterativeClosestPoint<PointSource,
+                                                                   PointTarget,
+                                                                   Scalar>::
+      MatricesVector;
+  using MatricesVectorPtr = typename GeneralizedIterativeClosestPoint<PointSource,
+                                                                      PointTarget,
+                                                                      Scalar>::
+      MatricesVectorPtr;
+  using Matrix4 = typename GeneralizedIterativeClosestPoint<PointSource,
+                                                            PointTarget,
+                                                            Scalar>::Matrix4;
+
+  using Ptr = shared_ptr<
+      VoxelizedGeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>>;
+  using ConstPtr = shared_ptr<
+      const VoxelizedGeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>>;
+
+  /** \brief Voxels a source point is associated with. */
+  enum class NeighborSearchMethod {
+    /** \brief Only the voxel containing the point. */
+    DIRECT1,
+    /** \brief The voxel containing the point and its 6 face neighbors. */
+    DIRECT7,
+    /** \brief The voxel containing the point and all its 26 neighbors. */
+    DIRECT27
+  };
+
+  /** \brief Mean, mean covariance and number of target points of one voxel. */
+  struct GaussianVoxel {
+    /** \brief Number of target points in the voxel. */
+    int nr_points{0};
+
+    /** \brief Mean of the target points in the voxel. */
+    Eigen::Vector3d mean{Eigen::Vector3d::Zero()};
+
+    /** \brief Mean of the covariances of the target points in the voxel. */
+    Eigen::Matrix3d cov{Eigen::Matrix3d::Zero()};
+
+    PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  using GaussianVoxels =
+      std::vector<GaussianVoxel, Eigen::aligned_allocator<GaussianVoxel>>;
+
+  /** \brief Incremental voxel map the source can be aligned to. */
+  using TargetMap = IncrementalVoxelGridCovariance<PointTarget>;
+  using TargetMapConstPtr = typename TargetMap::ConstPtr;
+
+  PCL_MAKE_ALIGNED_OPERATOR_NEW
+
+  /** \brief Empty constructor. */
+  VoxelizedGeneralizedIterativeClosestPoint()
+  {
+    reg_name_ = "VoxelizedGeneralizedIterativeClosestPoint";
+  }
+
+  /** \brief Provide a pointer to the input target (e.g., the point cloud that we want
+   * to align the input source to) \param[in] target the input point cloud target
+   */
+  inline void
+  setInputTarget(const PointCloudTargetConstPtr& target) override
+  {
+    GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::setInputTarget(
+        target);
+    target_map_.reset();
+    voxels_.clear();
+    voxel_map_.clear();
+  }
+
+  /** \brief Provide an incremental voxel map to align the input source to, in place of
+   * a target cloud. Each source point is associated with the voxels of the map as set by
+   * setNeighborSearchMethod, using their mean and covariance instead of aggregated point
+   * covariances, so that a map that is updated between alignments does not need to be
+   * rebuilt. The centroids of the voxels become the target cloud (used e.g. by
+   * getFitnessScore).
+   * \note The covariances of the map describe the spread of the points within each
+   * voxel, so neighboring voxels overlap much more than with setInputTarget, and
+   * NeighborSearchMethod::DIRECT1 is usually the best choice.
+   * \note The resolution of the map becomes the resolution of the VGICP.
+   * \note Call this function again after the map was modified. Calling it again with
+   * an unmodified map keeps the target cloud and its kd-tree.
+   * \param[in] map the incremental voxel map
+   */
+  inline void
+  setTargetMap(const TargetMapConstPtr& map)
+  {
+    if (map == target_map_ && map->getRevision() == target_map_revision_)
+      return;
+    GeneralizedIterativeClosestPoint<PointSource, PointTarget, Scalar>::setInputTarget(
+        map->getCentroids());
+    target_map_ = map;
+    target_map_revision_ = map->getRevision();
+    resolution_ = map->getResolution();
+    voxels_.clear();
+    voxel_map_.clear();
+  }
+
+  /** \brief Get the incremental voxel map the source is aligned to, if any. */
+  inline TargetMapConstPtr
+  getTargetMap() const
+  {
+    return (target_map_);
+  }
+
+  /** \brief Set the side length of the voxels the target distributions are aggregated
+   * in.
+   * \note Has no effect while a target map is set, the resolution of the map is used.
+   * \param[in] resolution the voxel side length
+   */
+  inline void
+  setResolution(float resolution)
+  {
+    if (target_map_) {
+      PCL_WARN("[pcl::%s::setResolution] The resolution of the target map is used.\n",
+               getClassName().c_str());
+      return;
+    }
+    if (resolution <= 0.0f) {
+      PCL_ERROR("[pcl::%s::setResolution] Invalid resolution %g, must be positive!\n",
+                getClassName().c_str(),
+                resolution);
+      return;
+    }
+    if (resolution_ != resolution) {
+      resolution_ = resolution;
+      voxels_.clear();
+      voxel_map_.clear();
+    }
+  }
+
+  /** \brief Get the side length of the voxels. */
+  inline float
+  getResolution() const
+  {
+    return (resolution_);
+  }
+
+  /** \brief Set which voxels a source point is associated with.
+   * \param[in] method DIRECT1, DIRECT7 or DIRECT27
+   */
+  inline void
+  setNeighborSearchMethod(NeighborSearchMethod method)
+  {
+    search_method_ = method;
+  }
+
+  /** \brief Get which voxels a source point is associated with. */
+  inline NeighborSearchMethod
+  getNeighborSearchMethod() const
+  {
+    return (search_method_);
+  }
+
+  /** \brief Get the voxels of the target, as computed by the last alignment. */
+  inline const GaussianVoxels&
+  getVoxels() const
+  {
+    return (voxels_);
+  }
+
+protected:
+  /** \brief Rigid transformation computation method with initial guess.
+   * \param output the transformed input point cloud dataset using the rigid
+   * transformation found \param guess the initial guess of the transformation to
+   * compute
+   */
+  void
+  computeTransformation(PointCloudSource& output, const Matrix4& guess) override;
+
+  /** \brief Aggregate the target points and their covariances into voxels. */
+  void
+  voxelizeTarget();
+
+  /** \brief Mean, covariance and number of points of a voxel a source point is
+   * associated with, pointing into either \ref voxels_ or \ref target_map_. */
+  struct VoxelView {
+    const Eigen::Vector3d* mean{nullptr};
+    const Eigen::Matrix3d* cov{nullptr};
+    int nr_points{0};
+  };
+
+  /** \brief Compute the integer coordinates of the voxel containing a point. */
+  inline Eigen::Vector3i
+  getVoxelCoordinates(const Eigen::Vector3f& p) const
+  {
+    const float inverse_resolution = 1.0f / resolution_;
+    return {static_cast<int>(std::floor(p[0] * inverse_resolution)),
+            static_cast<int>(std::floor(p[1] * inverse_resolution)),
+            static_cast<int>(std::floor(p[2] * inverse_resolution))};
+  }
+
+  /** \brief Hash of the integer coordinates of a voxel. */
+  struct VoxelHash {
+    inline std::size_t
+    operator()(const Eigen::Vector3i& coordinates) const
+    {
+      return (static_cast<std::size_t>(coordinates[0]) * 73856093) ^
+             (static_cast<std::size_t>(coordinates[1]) * 19349663) ^
+             (static_cast<std::size_t>(coordinates[2]) * 83492791);
+    }
+  };
+
+  /** \brief Offsets of the voxels associated with a source point, relative to the voxel
+   * containing it. */
+  std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i>>
+  getNeighborOffsets() const;
+
+  /** \brief The side length of the voxels. */
+  float resolution_{1.0f};
+
+  /** \brief Which voxels a source point is associated with. */
+  NeighborSearchMethod search_method_{NeighborSearchMethod::DIRECT1};
+
+  /** \brief The voxels of the target. */
+  GaussianVoxels voxels_;
+
+  /** \brief Map from the integer coordinates of a voxel to its position in voxels_. */
+  std::unordered_map<Eigen::Vector3i, std::size_t, VoxelHash> voxel_map_;
+
+  /** \brief The target covariances the voxels were computed from. */
+  MatricesVectorPtr voxelized_covariances_;
+
+  /** \brief The incremental voxel map used in place of \ref voxels_, if set. */
+  TargetMapConstPtr target_map_;
+
+  /** \brief The revision of \ref target_map_ the target cloud was taken from. */
+  std::size_t target_map_revision_{0};
+};
+} // namespace pcl
+
+#include <pcl/registration/impl/vgicp.hpp>
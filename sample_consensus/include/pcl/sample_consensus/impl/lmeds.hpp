@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_LMEDS_H_
 
 #include <pcl/sample_consensus/lmeds.h>
+#include <pcl/sample_consensus/impl/sac.hpp> // for computeHypotheses
 #include <pcl/common/common.h> // for computeMedian
 
 //////////////////////////////////////////////////////////////////////////
@@ -55,81 +56,31 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
     return (false);
   }
 
-  iterations_ = 0;
-  double d_best_penalty = std::numeric_limits<double>::max();
-
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
-  std::vector<double> distances;
-
-  unsigned skipped_count = 0;
-  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
-  const unsigned max_skip = max_iterations_ * 10;
-  
-  // Iterate
-  while ((iterations_ < max_iterations_) && (skipped_count < max_skip))
-  {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ())
-    {
-      PCL_ERROR ("[pcl::LeastMedianSquares::computeModel] No samples could be selected!\n");
-      break;
-    }
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++skipped_count;
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] The function computeModelCoefficients failed, so continue with next iteration.\n");
-      continue;
-    }
-
-    double d_cur_penalty;
-    // d_cur_penalty = sum (min (dist, threshold))
-
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-    
-    // No distances? The model must not respect the user given constraints
-    if (distances.empty ())
+  const int threads = this->getComputeThreads ("LeastMedianSquares");
+  this->computeHypotheses (threads,
+    [this] (boost::mt19937 &, const Eigen::VectorXf &model_coefficients, std::vector<double> &distances, double &penalty, std::size_t &nr_inliers)
     {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-    // Move all NaNs in distances to the end
-    const auto new_end = (sac_model_->getInputCloud()->is_dense ? distances.end() : std::partition (distances.begin(), distances.end(), [](double d){return !std::isnan (d);}));
-    const auto nr_valid_dists = std::distance (distances.begin (), new_end);
-
-    // d_cur_penalty = median (distances)
-    PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] There are %lu valid distances remaining after removing NaN values.\n", nr_valid_dists);
-    if (nr_valid_dists == 0)
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-    d_cur_penalty = pcl::computeMedian (distances.begin (), new_end, static_cast<double(*)(double)>(std::sqrt));
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (model_coefficients, distances);
+      if (distances.empty ())
+        return (false);
+
+      // Move all NaNs in distances to the end
+      const auto new_end = (sac_model_->getInputCloud()->is_dense ? distances.end() : std::partition (distances.begin(), distances.end(), [](double d){return !std::isnan (d);}));
+      if (new_end == distances.begin ())
+        return (false);
+
+      // penalty = median (distances)
+      penalty = pcl::computeMedian (distances.begin (), new_end, static_cast<double(*)(double)>(std::sqrt));
+      nr_inliers = 0;
+      return (true);
+    },
+    // LMedS does not adapt the number of trials, it always tries max_iterations_ models
+    [] (const Indices &, const Eigen::VectorXf &, double, std::size_t)
     {
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
-    }
-  }
+      return (std::numeric_limits<double>::max ());
+    },
+    "LeastMedianSquares", debug_verbosity_level);
 
   if (model_.empty ())
   {
@@ -147,6 +98,7 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
   //double threshold = 2.5 * sigma;
 
   // Iterate through the 3d points and calculate the distances from them to the model again
+  std::vector<double> distances;
   sac_model_->getDistancesToModel (model_coefficients_, distances);
   // No distances? The model must not respect the user given constraints
   if (distances.empty ())
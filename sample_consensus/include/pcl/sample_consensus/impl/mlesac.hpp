@@ -41,8 +41,10 @@
 #ifndef PCL_SAMPLE_CONSENSUS_IMPL_MLESAC_H_
 #define PCL_SAMPLE_CONSENSUS_IMPL_MLESAC_H_
 
+#include <algorithm> // for count_if
 #include <limits>
 #include <pcl/sample_consensus/mlesac.h>
+#include <pcl/sample_consensus/impl/sac.hpp> // for computeHypotheses
 #include <pcl/common/common.h> // for computeMedian
 
 //////////////////////////////////////////////////////////////////////////
@@ -56,17 +58,6 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
     return (false);
   }
 
-  iterations_ = 0;
-  double d_best_penalty = std::numeric_limits<double>::max();
-  double k = 1.0;
-
-  const double log_probability  = std::log (1.0 - probability_);
-  const double one_over_indices = 1.0 / static_cast<double> (sac_model_->getIndices ()->size ());
-
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
-  std::vector<double> distances;
-
   // Compute sigma - remember to set threshold_ correctly !
   sigma_ = computeMedianAbsoluteDeviation (sac_model_->getInputCloud (), sac_model_->getIndices (), threshold_);
   const double dist_scaling_factor = -1.0 / (2.0 * sigma_ * sigma_); // Precompute since this does not change
@@ -80,100 +71,26 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   max_pt -= min_pt;
   double v = sqrt (max_pt.dot (max_pt));
 
-  int n_inliers_count = 0;
-  std::size_t indices_size;
-  unsigned skipped_count = 0;
-  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
-  const unsigned max_skip = max_iterations_ * 10;
-  
-  // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
-  {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
-
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-
-    if (distances.empty ())
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-    
-    // Use Expectation-Maximization to find out the right value for d_cur_penalty
-    // ---[ Initial estimate for the gamma mixing parameter = 1/2
-    double gamma = 0.5;
-    double p_outlier_prob = 0;
-
-    indices_size = sac_model_->getIndices ()->size ();
-    std::vector<double> p_inlier_prob (indices_size);
-    for (int j = 0; j < iterations_EM_; ++j)
-    {
-      const double weighted_normalization_factor = gamma * normalization_factor;
-      // Likelihood of a datum given that it is an inlier
-      for (std::size_t i = 0; i < indices_size; ++i)
-        p_inlier_prob[i] = weighted_normalization_factor * std::exp ( dist_scaling_factor * distances[i] * distances[i] );
-
-      // Likelihood of a datum given that it is an outlier
-      p_outlier_prob = (1 - gamma) / v;
-
-      gamma = 0;
-      for (std::size_t i = 0; i < indices_size; ++i)
-        gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
-      gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
-    }
-
-    // Find the std::log likelihood of the model -L = -sum [std::log (pInlierProb + pOutlierProb)]
-    double d_cur_penalty = 0;
-    for (std::size_t i = 0; i < indices_size; ++i)
-      d_cur_penalty += std::log (p_inlier_prob[i] + p_outlier_prob);
-    d_cur_penalty = - d_cur_penalty;
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
+  const int threads = this->getComputeThreads ("MaximumLikelihoodSampleConsensus");
+  this->computeHypotheses (threads,
+    [&] (boost::mt19937 &, const Eigen::VectorXf &model_coefficients, std::vector<double> &distances, double &penalty, std::size_t &nr_inliers)
     {
-      d_best_penalty = d_cur_penalty;
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (model_coefficients, distances);
+      if (distances.empty ())
+        return (false);
 
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
+      penalty = computeNegativeLogLikelihood (distances, dist_scaling_factor, normalization_factor, v);
 
-      n_inliers_count = 0;
       // Need to compute the number of inliers for this model to adapt k
-      for (const double &distance : distances)
-        if (distance <= 2 * sigma_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      const double w = static_cast<double> (n_inliers_count) * one_over_indices;
-      double p_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));       // Probability that selection is contaminated by at least one outlier
-      p_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_outliers);         // Avoid division by -Inf
-      p_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_outliers);   // Avoid division by 0.
-      k = log_probability / std::log (p_outliers);
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
+      nr_inliers = std::count_if (distances.cbegin (), distances.cend (), [this] (double distance) { return (distance <= 2 * sigma_); });
+      return (true);
+    },
+    [this] (const Indices &selection, const Eigen::VectorXf &, double, std::size_t nr_inliers)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
-      break;
-    }
-  }
+      return (this->computeNumberOfTrials (nr_inliers, selection.size ()));
+    },
+    "MaximumLikelihoodSampleConsensus", debug_verbosity_level);
 
   if (model_.empty ())
   {
@@ -183,6 +100,7 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   }
 
   // Iterate through the 3d points and calculate the distances from them to the model again
+  std::vector<double> distances;
   sac_model_->getDistancesToModel (model_coefficients_, distances);
   Indices &indices = *sac_model_->getIndices ();
   if (distances.size () != indices.size ())
@@ -193,7 +111,7 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
 
   inliers_.resize (distances.size ());
   // Get the inliers for the best model found
-  n_inliers_count = 0;
+  int n_inliers_count = 0;
   for (std::size_t i = 0; i < distances.size (); ++i)
     if (distances[i] <= 2 * sigma_)
       inliers_[n_inliers_count++] = indices[i];
@@ -207,6 +125,43 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> double
+pcl::MaximumLikelihoodSampleConsensus<PointT>::computeNegativeLogLikelihood (
+    const std::vector<double> &distances,
+    double dist_scaling_factor,
+    double normalization_factor,
+    double v) const
+{
+  // ---[ Initial estimate for the gamma mixing parameter = 1/2
+  double gamma = 0.5;
+  double p_outlier_prob = 0;
+
+  const std::size_t indices_size = distances.size ();
+  std::vector<double> p_inlier_prob (indices_size);
+  for (int j = 0; j < iterations_EM_; ++j)
+  {
+    const double weighted_normalization_factor = gamma * normalization_factor;
+    // Likelihood of a datum given that it is an inlier
+    for (std::size_t i = 0; i < indices_size; ++i)
+      p_inlier_prob[i] = weighted_normalization_factor * std::exp ( dist_scaling_factor * distances[i] * distances[i] );
+
+    // Likelihood of a datum given that it is an outlier
+    p_outlier_prob = (1 - gamma) / v;
+
+    gamma = 0;
+    for (std::size_t i = 0; i < indices_size; ++i)
+      gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
+    gamma /= static_cast<double>(indices_size);
+  }
+
+  // Find the std::log likelihood of the model -L = -sum [std::log (pInlierProb + pOutlierProb)]
+  double penalty = 0;
+  for (std::size_t i = 0; i < indices_size; ++i)
+    penalty += std::log (p_inlier_prob[i] + p_outlier_prob);
+  return (-penalty);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> double
 pcl::MaximumLikelihoodSampleConsensus<PointT>::computeMedianAbsoluteDeviation (
@@ -49,6 +49,7 @@
 
 #include <boost/math/distributions/binomial.hpp>
 #include <pcl/sample_consensus/prosac.h>
+#include <pcl/sample_consensus/impl/sac.hpp> // for computeHypotheses
 
 //////////////////////////////////////////////////////////////////////////
 // Variable naming uses capital letters to make the comparison with the original paper easier
@@ -81,147 +82,135 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
   // Compute the I_n_star_min of Equation 8
   std::vector<unsigned int> I_n_star_min (N);
 
-  // Initialize the usual RANSAC parameters
-  iterations_ = 0;
-
-  Indices inliers;
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
+  // Estimate a better n_star from the inliers of a new best model, and update k_n_star accordingly
+  const auto update_n_star = [&] (Indices &inliers)
+  {
+    const std::size_t I_N = inliers.size ();
 
-  // We will increase the pool so the indices_ vector can only contain m elements at first
-  Indices index_pool;
-  index_pool.reserve (N);
-  for (unsigned int i = 0; i < n; ++i)
-    index_pool.push_back (sac_model_->indices_->operator[](i));
+    // We estimate I_n_star for different possible values of n_star by using the inliers
+    std::sort (inliers.begin (), inliers.end ());
 
-  // Iterate
-  while (static_cast<unsigned int> (iterations_) < k_n_star)
-  {
-    // Choose the samples
+    // Try to find a better n_star
+    // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
+    std::size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
+    float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
 
-    // Step 1
-    // According to Equation 5 in the text text, not the algorithm
-    if ((iterations_ == T_prime_n) && (n < n_star))
+    // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
+    std::size_t I_possible_n_star = I_N;
+    for (auto last_inlier = inliers.crbegin (), inliers_end = inliers.crend ();
+         last_inlier != inliers_end; 
+         ++last_inlier, --I_possible_n_star)
     {
-      // Increase the pool
-      ++n;
-      if (n >= N)
+      // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
+      unsigned int possible_n_star = (*last_inlier) + 1;
+      if (possible_n_star <= m)
         break;
-      index_pool.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-      // Update other variables
-      float T_n_minus_1 = T_n;
-      T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
-      T_prime_n += std::ceil (T_n - T_n_minus_1);
-    }
-
-    // Step 2
-    sac_model_->indices_->swap (index_pool);
-    selection.clear ();
-    sac_model_->getSamples (iterations_, selection);
-    if (T_prime_n < iterations_)
-    {
-      selection.pop_back ();
-      selection.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-    }
 
-    // Make sure we use the right indices for testing
-    sac_model_->indices_->swap (index_pool);
+      // If we find a better epsilon_n_star
+      float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
+      // Make sure we have a better epsilon_possible_n_star
+      if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+      {
+        // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
+        std::size_t I_possible_n_star_min = m
+                         + static_cast<std::size_t> (std::ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
+        // If Equation 9 is not verified, exit
+        if (I_possible_n_star < I_possible_n_star_min)
+          break;
 
-    if (selection.empty ())
-    {
-      PCL_ERROR ("[pcl::ProgressiveSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
+        possible_n_star_best = possible_n_star;
+        I_possible_n_star_best = I_possible_n_star;
+        epsilon_possible_n_star_best = epsilon_possible_n_star;
+      }
     }
 
-    // Search for inliers in the point cloud for the current model
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    // Check if we get a better epsilon
+    if (epsilon_possible_n_star_best > epsilon_n_star)
     {
-      ++iterations_;
-      continue;
+      // update the best value
+      epsilon_n_star = epsilon_possible_n_star_best;
+
+      // Compute the new k_n_star
+      float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
+      if (bottom_log == 0)
+        k_n_star = 1;
+      else if (bottom_log == 1)
+        k_n_star = T_N;
+      else
+        k_n_star = static_cast<int> (std::ceil (std::log (0.05) / std::log (bottom_log)));
+      // It seems weird to have very few iterations, so do have a few (totally empirical)
+      k_n_star = (std::max)(k_n_star, 2 * m);
     }
-
-    // Select the inliers that are within threshold_ from the model
-    inliers.clear ();
-    sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
-
-    std::size_t I_N = inliers.size ();
-
-    // If we find more inliers than before
-    if (I_N > I_N_best)
+  };
+
+  const int threads = this->getComputeThreads ("ProgressiveSampleConsensus");
+  // The growth of the sampling pool follows the order in which samples are drawn, so
+  // only this bookkeeping is serialized. The samples themselves are drawn in parallel.
+  std::size_t nr_samples_drawn = 0;
+  const double d_best_penalty = this->computeHypotheses (threads,
+    [&] (boost::mt19937 &rng, Indices &selection)
     {
-      I_N_best = I_N;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      inliers_ = inliers;
-      model_ = selection;
-      model_coefficients_ = model_coefficients;
-
-      // We estimate I_n_star for different possible values of n_star by using the inliers
-      std::sort (inliers.begin (), inliers.end ());
-
-      // Try to find a better n_star
-      // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
-      std::size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
-      float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
-
-      // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
-      std::size_t I_possible_n_star = I_N;
-      for (auto last_inlier = inliers.crbegin (), inliers_end = inliers.crend ();
-           last_inlier != inliers_end; 
-           ++last_inlier, --I_possible_n_star)
+      bool replace_last;
+      std::size_t pool_size;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp critical(prosac_samples)
+#endif
       {
-        // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
-        unsigned int possible_n_star = (*last_inlier) + 1;
-        if (possible_n_star <= m)
-          break;
-
-        // If we find a better epsilon_n_star
-        float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
-        // Make sure we have a better epsilon_possible_n_star
-        if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+        // Step 1
+        // The pool stops growing once it covers all points, but the sampling goes on
+        if ((static_cast<float> (nr_samples_drawn) == T_prime_n) && (n < n_star) && (n + 1 < N))
         {
-          // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
-          std::size_t I_possible_n_star_min = m
-                           + static_cast<std::size_t> (std::ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
-          // If Equation 9 is not verified, exit
-          if (I_possible_n_star < I_possible_n_star_min)
-            break;
-
-          possible_n_star_best = possible_n_star;
-          I_possible_n_star_best = I_possible_n_star;
-          epsilon_possible_n_star_best = epsilon_possible_n_star;
+          // Increase the pool
+          ++n;
+          // Update other variables
+          float T_n_minus_1 = T_n;
+          T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
+          T_prime_n += std::ceil (T_n - T_n_minus_1);
         }
+        replace_last = (T_prime_n < static_cast<float> (nr_samples_drawn));
+        pool_size = static_cast<std::size_t> (n);
+        ++nr_samples_drawn;
       }
 
-      // Check if we get a better epsilon
-      if (epsilon_possible_n_star_best > epsilon_n_star)
+      // Step 2
+      // Draw the sample from the first pool_size indices only. Once T_prime_n is exceeded,
+      // the last index of the pool is always part of the sample (Algorithm 1, Step 2).
+      const auto pool_begin = sac_model_->indices_->cbegin ();
+      const std::size_t nr_drawn = replace_last ? pool_size - 1 : pool_size;
+      selection.resize (m);
+      for (unsigned int iter = 0; iter < sac_model_->max_sample_checks_; ++iter)
       {
-        // update the best value
-        epsilon_n_star = epsilon_possible_n_star_best;
-
-        // Compute the new k_n_star
-        float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
-        if (bottom_log == 0)
-          k_n_star = 1;
-        else if (bottom_log == 1)
-          k_n_star = T_N;
-        else
-          k_n_star = static_cast<int> (std::ceil (std::log (0.05) / std::log (bottom_log)));
-        // It seems weird to have very few iterations, so do have a few (totally empirical)
-        k_n_star = (std::max)(k_n_star, 2 * m);
+        const auto last_drawn = replace_last ? selection.end () - 1 : selection.end ();
+        SampleConsensusModel<PointT>::drawDistinctIndices (pool_begin, pool_begin + nr_drawn, rng, selection.begin (), last_drawn);
+        if (replace_last)
+          selection.back () = (*sac_model_->indices_)[pool_size - 1];
+
+        // If it's a good sample, stop here
+        if (sac_model_->isSampleGood (selection))
+          return;
       }
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, k_n_star, I_N, I_N_best);
-    if (iterations_ > max_iterations_)
+      PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] WARNING: Could not select %lu sample points in %d iterations!\n", m, sac_model_->max_sample_checks_);
+      selection.clear ();
+    },
+    [this] (boost::mt19937 &, const Eigen::VectorXf &model_coefficients, std::vector<double> &, double &penalty, std::size_t &nr_inliers)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
-      break;
-    }
-  }
+      // Select the inliers that are within threshold_ from the model
+      nr_inliers = sac_model_->countWithinDistance (model_coefficients, threshold_);
+      penalty = -static_cast<double> (nr_inliers);
+      return (true);
+    },
+    [&] (const Indices &, const Eigen::VectorXf &model_coefficients, double, std::size_t)
+    {
+      // Never called concurrently, so the inliers can be selected with the (non thread-safe) model
+      Indices inliers;
+      sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
+      inliers_ = inliers;
+      update_n_star (inliers);
+      return (static_cast<double> (k_n_star));
+    },
+    "ProgressiveSampleConsensus", debug_verbosity_level);
+  if (d_best_penalty < std::numeric_limits<double>::max ())
+    I_N_best = static_cast<std::size_t> (-d_best_penalty);
 
   if (debug_verbosity_level > 0)
     PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Model: %lu size, %d inliers.\n", model_.size (), I_N_best);
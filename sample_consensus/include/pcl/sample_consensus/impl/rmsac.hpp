@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_RMSAC_H_
 
 #include <pcl/sample_consensus/rmsac.h>
+#include <pcl/sample_consensus/impl/sac.hpp> // for computeHypotheses
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -54,102 +55,56 @@ pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModel (int debug_verbos
     return (false);
   }
 
-  iterations_ = 0;
-  double d_best_penalty = std::numeric_limits<double>::max();
-  double k = 1.0;
-
-  const double log_probability  = std::log (1.0 - probability_);
-  const double one_over_indices = 1.0 / static_cast<double> (sac_model_->getIndices ()->size ());
-
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
-  std::vector<double> distances;
-  std::set<index_t> indices_subset;
-
-  int n_inliers_count = 0;
-  unsigned skipped_count = 0;
-  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
-  const unsigned max_skip = max_iterations_ * 10;
-  
   // Number of samples to try randomly
-  std::size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
-
-  // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
-  {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
-
-    // RMSAC addon: verify a random fraction of the data
-    // Get X random samples which satisfy the model criterion
-    this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
+  const std::size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
 
-    if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
+  const int threads = this->getComputeThreads ("RandomizedMEstimatorSampleConsensus");
+  // Hypotheses are only rejected by the pretest once k has been set by a first model
+  bool k_set = false;
+  this->computeHypotheses (threads,
+    [this, fraction_nr_points, &k_set] (boost::mt19937 &rng, const Eigen::VectorXf &model_coefficients, std::vector<double> &distances, double &penalty, std::size_t &nr_inliers)
     {
-      // Unfortunately we cannot "continue" after the first iteration, because k might not be set, while iterations gets incremented
-      if (k != 1.0)
+      bool k_set_tmp;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic read
+#endif
+      k_set_tmp = k_set;
+
+      // RMSAC addon: verify a random fraction of the data
+      std::set<index_t> indices_subset;
+      this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset, rng);
+      if (k_set_tmp && !sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
       {
-        ++iterations_;
-        continue;
+        // Counts as a trial, but can never become the best model
+        penalty = std::numeric_limits<double>::max ();
+        nr_inliers = 0;
+        return (true);
       }
-    }
 
-    double d_cur_penalty = 0;
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (model_coefficients, distances);
+      if (distances.empty ())
+        return (false);
 
-    if (distances.empty ())
-    {
-      ++ skipped_count;
-      continue;
-    }
-
-    for (const double &distance : distances)
-      d_cur_penalty += std::min (distance, threshold_);
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
+      penalty = 0;
+      nr_inliers = 0;
       for (const double &distance : distances)
+      {
+        penalty += std::min (distance, threshold_);
         if (distance <= threshold_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      const double w = static_cast<double> (n_inliers_count) * one_over_indices;
-      double p_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));       // Probability that selection is contaminated by at least one outlier
-      p_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_outliers);         // Avoid division by -Inf
-      p_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_outliers);   // Avoid division by 0.
-      k = log_probability / std::log (p_outliers);
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
+          ++nr_inliers;
+      }
+      return (true);
+    },
+    [this, &k_set] (const Indices &selection, const Eigen::VectorXf &, double, std::size_t nr_inliers)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
-      break;
-    }
-  }
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic write
+#endif
+      k_set = true;
+      return (this->computeNumberOfTrials (nr_inliers, selection.size ()));
+    },
+    "RandomizedMEstimatorSampleConsensus", debug_verbosity_level);
 
   if (model_.empty ())
   {
@@ -159,6 +114,7 @@ pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModel (int debug_verbos
   }
 
   // Iterate through the 3d points and calculate the distances from them to the model again
+  std::vector<double> distances;
   sac_model_->getDistancesToModel (model_coefficients_, distances);
   Indices &indices = *sac_model_->getIndices ();
   if (distances.size () != indices.size ())
@@ -169,7 +125,7 @@ pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModel (int debug_verbos
 
   inliers_.resize (distances.size ());
   // Get the inliers for the best model found
-  n_inliers_count = 0;
+  int n_inliers_count = 0;
   for (std::size_t i = 0; i < distances.size (); ++i)
     if (distances[i] <= threshold_)
       inliers_[n_inliers_count++] = indices[i];
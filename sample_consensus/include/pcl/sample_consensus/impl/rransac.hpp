@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_RRANSAC_H_
 
 #include <pcl/sample_consensus/rransac.h>
+#include <pcl/sample_consensus/impl/sac.hpp> // for computeHypotheses
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -54,95 +55,39 @@ pcl::RandomizedRandomSampleConsensus<PointT>::computeModel (int debug_verbosity_
     return (false);
   }
 
-  iterations_ = 0;
   std::size_t n_best_inliers_count = 0;
-  double k = std::numeric_limits<double>::max();
-
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
-  std::set<index_t> indices_subset;
-
-  const double log_probability  = std::log (1.0 - probability_);
-  const double one_over_indices = 1.0 / static_cast<double> (sac_model_->getIndices ()->size ());
-
-  std::size_t n_inliers_count;
-  unsigned skipped_count = 0;
-  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
-  const unsigned max_skip = max_iterations_ * 10;
 
   // Number of samples to try randomly
   const std::size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
 
-  // Iterate
-  while (iterations_ < k)
-  {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ())
+  const int threads = this->getComputeThreads ("RandomizedRandomSampleConsensus");
+  // The penalty is the negated number of inliers
+  const double d_best_penalty = this->computeHypotheses (threads,
+    [this, fraction_nr_points] (boost::mt19937 &rng, const Eigen::VectorXf &model_coefficients, std::vector<double> &, double &penalty, std::size_t &nr_inliers)
     {
-      PCL_ERROR ("[pcl::RandomizedRandomSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
-    }
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++skipped_count;
-      if (skipped_count < max_skip)
-      {
-        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function computeModelCoefficients failed, so continue with next iteration.\n");
-        continue;
-      }
-      else
+      // RRANSAC addon: verify a random fraction of the data
+      std::set<index_t> indices_subset;
+      this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset, rng);
+      if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
       {
-        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function computeModelCoefficients failed, and RRANSAC reached the maximum number of trials.\n");
-        break;
+        // Counts as a trial, but can never become the best model
+        penalty = std::numeric_limits<double>::max ();
+        nr_inliers = 0;
+        return (true);
       }
-    }
 
-    // RRANSAC addon: verify a random fraction of the data
-    // Get X random samples which satisfy the model criterion
-    this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
-    if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
+      // Select the inliers that are within threshold_ from the model
+      nr_inliers = sac_model_->countWithinDistance (model_coefficients, threshold_);
+      penalty = -static_cast<double> (nr_inliers);
+      return (true);
+    },
+    [this] (const Indices &selection, const Eigen::VectorXf &, double, std::size_t nr_inliers)
     {
-      ++iterations_;
-      PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function doSamplesVerifyModel failed, so continue with next iteration.\n");
-      continue;
-    }
-
-    // Select the inliers that are within threshold_ from the model
-    n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
-
-    // Better match ?
-    if (n_inliers_count > n_best_inliers_count)
-    {
-      n_best_inliers_count = n_inliers_count;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      const double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
-      double p_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));       // Probability that selection is contaminated by at least one outlier
-      p_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_outliers);         // Avoid division by -Inf
-      p_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_outliers);   // Avoid division by 0.
-      k = log_probability / std::log (p_outliers);
-    }
-
-    ++iterations_;
-
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] Trial %d out of %d: %u inliers (best is: %u so far).\n", iterations_, static_cast<int> (std::ceil (k)), n_inliers_count, n_best_inliers_count);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] RRANSAC reached the maximum number of trials.\n");
-      break;
-    }
-  }
+      return (this->computeNumberOfTrials (nr_inliers, selection.size ()));
+    },
+    "RandomizedRandomSampleConsensus", debug_verbosity_level);
+  if (d_best_penalty < std::numeric_limits<double>::max ())
+    n_best_inliers_count = static_cast<std::size_t> (-d_best_penalty);
 
   if (debug_verbosity_level > 0)
     PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] Model: %lu size, %u inliers.\n", model_.size (), n_best_inliers_count);
@@ -0,0 +1,215 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_SAMPLE_CONSENSUS_IMPL_SAC_H_
+#define PCL_SAMPLE_CONSENSUS_IMPL_SAC_H_
+
+#include <pcl/sample_consensus/sac.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined _OPENMP && _OPENMP >= 201107 // We need OpenMP 3.1 for the atomic constructs
+#define OPENMP_AVAILABLE_SAC true
+#else
+#define OPENMP_AVAILABLE_SAC false
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> int
+pcl::SampleConsensus<T>::getComputeThreads (const char *method) const
+{
+  int threads = threads_;
+  if (threads < 0)
+    return (1);
+#if OPENMP_AVAILABLE_SAC
+  if (threads == 0)
+  {
+    threads = omp_get_num_procs ();
+    PCL_DEBUG ("[pcl::%s::computeModel] Automatic number of threads requested, choosing %i threads.\n", method, threads);
+  }
+#else
+  // Parallelization desired, but not available
+  PCL_WARN ("[pcl::%s::computeModel] Parallelization is requested, but OpenMP 3.1 is not available! Continuing without parallelization.\n", method);
+  threads = 1;
+#endif
+  return (threads);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> template <typename SampleFunctor, typename ScoreFunctor, typename UpdateFunctor> double
+pcl::SampleConsensus<T>::computeHypotheses (int threads,
+                                            const SampleFunctor &sample,
+                                            const ScoreFunctor &score,
+                                            const UpdateFunctor &update,
+                                            const char *method,
+                                            int debug_verbosity_level)
+{
+  iterations_ = 0;
+  double best_penalty = std::numeric_limits<double>::max ();
+  double k = std::numeric_limits<double>::max ();
+  unsigned skipped_count = 0;
+  bool done = false;
+
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  // Seed one random number stream per thread from the (serial) generator of this object
+  std::vector<unsigned> seeds ((std::max) (threads, 1));
+  for (auto &seed : seeds)
+    seed = static_cast<unsigned> (rng_->base () ());
+
+#if OPENMP_AVAILABLE_SAC
+#pragma omp parallel if(threads > 1) num_threads(threads) shared(best_penalty, k, skipped_count, done, seeds)
+#endif
+  {
+#if OPENMP_AVAILABLE_SAC
+    const int thread_id = omp_get_thread_num ();
+    if (omp_in_parallel ())
+#pragma omp master
+      PCL_DEBUG ("[pcl::%s::computeModel] Computing in parallel with up to %i threads.\n", method, omp_get_num_threads ());
+#else
+    const int thread_id = 0;
+#endif
+    boost::mt19937 rng (seeds[thread_id]);
+    Indices selection;
+    Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
+    std::vector<double> distances;
+
+    while (true) // stops when any thread decides that the search is done
+    {
+      bool done_tmp;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic read
+#endif
+      done_tmp = done;
+      if (done_tmp)
+        break;
+
+      sample (rng, selection);
+      if (selection.empty ())
+      {
+        PCL_ERROR ("[pcl::%s::computeModel] No samples could be selected!\n", method);
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic write
+#endif
+        done = true;
+        break;
+      }
+
+      double penalty;
+      std::size_t nr_inliers;
+      if (!sac_model_->computeModelCoefficients (selection, model_coefficients) ||
+          !score (rng, model_coefficients, distances, penalty, nr_inliers))
+      {
+        unsigned skipped_count_tmp;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic capture
+#endif
+        skipped_count_tmp = ++skipped_count;
+        if (skipped_count_tmp < max_skip)
+          continue;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic write
+#endif
+        done = true;
+        break;
+      }
+
+      double best_penalty_tmp;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic read
+#endif
+      best_penalty_tmp = best_penalty;
+      if (penalty < best_penalty_tmp) // This condition is false most of the time, so the critical region is rarely entered
+      {
+#if OPENMP_AVAILABLE_SAC
+#pragma omp critical(sac_update)
+#endif
+        {
+          // Better match ?
+          if (penalty < best_penalty)
+          {
+            // Save the current model/coefficients selection as being the best so far
+            model_              = selection;
+            model_coefficients_ = model_coefficients;
+
+            const double k_new = update (selection, model_coefficients, penalty, nr_inliers);
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic write
+#endif
+            best_penalty = penalty;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic write
+#endif
+            k = k_new;
+          }
+        } // omp critical
+      }
+
+      int iterations_tmp;
+      double k_tmp;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic capture
+#endif
+      iterations_tmp = ++iterations_;
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic read
+#endif
+      k_tmp = k;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::%s::computeModel] Trial %d out of %f: penalty %f (thread %d).\n", method, iterations_tmp, k_tmp, penalty, thread_id);
+      if (iterations_tmp >= k_tmp || iterations_tmp >= max_iterations_)
+      {
+        if (debug_verbosity_level > 0 && iterations_tmp >= max_iterations_)
+          PCL_DEBUG ("[pcl::%s::computeModel] Reached the maximum number of trials.\n", method);
+#if OPENMP_AVAILABLE_SAC
+#pragma omp atomic write
+#endif
+        done = true;
+        break;
+      }
+    } // while
+  } // omp parallel
+  return (best_penalty);
+}
+
+#undef OPENMP_AVAILABLE_SAC
+
+#endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_H_
@@ -149,6 +149,19 @@ namespace pcl
                      const IndicesPtr &indices,
                      Eigen::Vector4f &median) const;
 
+      /** \brief Estimate the inlier/outlier mixing parameter with Expectation-Maximization, and return
+        * the negative log likelihood of the given point-model distances under that mixture.
+        * \param[in] distances the distances from the points to the model
+        * \param[in] dist_scaling_factor the precomputed -1 / (2 * sigma^2) of the inlier gaussian
+        * \param[in] normalization_factor the precomputed 1 / (sqrt (2 * pi) * sigma) of the inlier gaussian
+        * \param[in] v the diagonal of the bounding box of the data, the range of the uniform outlier distribution
+        */
+      double
+      computeNegativeLogLikelihood (const std::vector<double> &distances,
+                                    double dist_scaling_factor,
+                                    double normalization_factor,
+                                    double v) const;
+
     private:
       /** \brief Maximum number of EM (Expectation Maximization) iterations. */
       int iterations_EM_;
@@ -45,10 +45,15 @@
 
 #include <boost/random/mersenne_twister.hpp> // for mt19937
 #include <boost/random/uniform_01.hpp> // for uniform_01
+#include <boost/random/uniform_int.hpp> // for uniform_int
 
+#include <algorithm>
+#include <cmath>
 #include <ctime>
+#include <limits>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace pcl
 {
@@ -165,7 +170,9 @@ namespace pcl
 
       /** \brief Set the number of threads to use or turn off parallelization.
         * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically, a negative number turns parallelization off)
-        * \note Not all SAC methods have a parallel implementation. Some will ignore this setting.
+        * \note Every thread draws its samples from a generator seeded by this object, so single threaded results are
+        * reproducible (but differ from PCL 1.14.0). Parallel results differ from the single threaded ones and may vary
+        * between runs, as they depend on the thread scheduling.
         */
       inline void
       setNumberOfThreads (const int nr_threads = -1) { threads_ = nr_threads; }
@@ -297,6 +304,26 @@ namespace pcl
           indices_subset.insert ((*indices)[static_cast<index_t> (static_cast<double>(indices->size ()) * rnd ())]);
       }
 
+      /** \brief Get a set of randomly selected indices, drawn with the given generator.
+        * Does not touch the generator of this object, so it can be used concurrently
+        * from several threads, each one with its own generator.
+        * \param[in] indices the input indices vector
+        * \param[in] nr_samples the desired number of point indices to randomly select
+        * \param[out] indices_subset the resultant output set of randomly selected indices
+        * \param[in,out] rng the random number generator to draw the indices with
+        */
+      inline void
+      getRandomSamples (const IndicesPtr &indices,
+                        std::size_t nr_samples,
+                        std::set<index_t> &indices_subset,
+                        boost::mt19937 &rng) const
+      {
+        boost::uniform_int<std::size_t> dist (0, indices->size () - 1);
+        indices_subset.clear ();
+        while (indices_subset.size () < nr_samples)
+          indices_subset.insert ((*indices)[dist (rng)]);
+      }
+
       /** \brief Return the best model found so far. 
         * \param[out] model the resultant model
         */
@@ -355,5 +382,79 @@ namespace pcl
       {
         return ((*rng_) ());
       }
+
+      /** \brief Get the number of threads computeModel should use from the value set with setNumberOfThreads ().
+        * \param[in] method the name of the calling SAC method, used in the messages
+        * \return the number of threads: 0 is replaced by the number of processors, and a negative value
+        * (no parallelization) or a missing OpenMP by 1
+        */
+      int
+      getComputeThreads (const char *method) const;
+
+      /** \brief Compute the number of trials k = log(1-p) / log(1-w^n) needed to pick at least one
+        * outlier free sample with probability_, given the inlier ratio w of the best model so far.
+        * \param[in] nr_inliers the number of inliers of the best model so far
+        * \param[in] sample_size the number of points n in a sample
+        */
+      double
+      computeNumberOfTrials (std::size_t nr_inliers, std::size_t sample_size) const
+      {
+        const double w = static_cast<double> (nr_inliers) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_outliers = 1.0 - std::pow (w, static_cast<double> (sample_size));             // Probability that selection is contaminated by at least one outlier
+        p_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_outliers);         // Avoid division by -Inf
+        p_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_outliers);   // Avoid division by 0.
+        return (std::log (1.0 - probability_) / std::log (p_outliers));
+      }
+
+      /** \brief Generate and score model hypotheses on one or several threads. This is the
+        * engine shared by the SAC methods: it keeps drawing samples, fitting and scoring
+        * models until the number of trials reaches the adaptive bound returned by \a update,
+        * max_iterations_ or the limit of skipped (invalid) hypotheses.
+        *
+        * Every thread draws from its own random number stream, seeded from the generator
+        * of this object, so the samples and scores are computed without any locking. Only
+        * improvements of the best model are serialized; they are stored in model_ and
+        * model_coefficients_, and iterations_ holds the total number of trials afterwards.
+        *
+        * It is defined in impl/sac.hpp, along with the OpenMP plumbing, and is only meant to be used from
+        * the implementations of the SAC methods.
+        *
+        * \param[in] threads the number of threads to use, see getComputeThreads ()
+        * \param[in] sample thread-safe functor <tt>void (boost::mt19937 &rng, Indices &selection)</tt>
+        * drawing a sample, or leaving it empty to stop the search
+        * \param[in] score thread-safe functor <tt>bool (boost::mt19937 &rng, const Eigen::VectorXf &model_coefficients,
+        * std::vector<double> &distances, double &penalty, std::size_t &nr_inliers)</tt>, returning false
+        * if the model has to be skipped. Lower penalties are better, a hypothesis that failed a pretest
+        * should get the maximum double value. \a distances is scratch space owned by the calling thread.
+        * \param[in] update functor <tt>double (const Indices &selection, const Eigen::VectorXf &model_coefficients,
+        * double penalty, std::size_t nr_inliers)</tt> called for every new best model (never concurrently),
+        * returning the new bound on the number of trials
+        * \param[in] method the name of the calling SAC method, used in the messages
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        * \return the penalty of the best model, or the maximum double value if none was found
+        */
+      template <typename SampleFunctor, typename ScoreFunctor, typename UpdateFunctor> double
+      computeHypotheses (int threads,
+                         const SampleFunctor &sample,
+                         const ScoreFunctor &score,
+                         const UpdateFunctor &update,
+                         const char *method,
+                         int debug_verbosity_level);
+
+      /** \brief Generate and score model hypotheses on several threads, drawing uniform random
+        * samples with SampleConsensusModel::getSamples (boost::mt19937&, Indices&).
+        * See the overload above for a description of the parameters.
+        */
+      template <typename ScoreFunctor, typename UpdateFunctor> double
+      computeHypotheses (int threads,
+                         const ScoreFunctor &score,
+                         const UpdateFunctor &update,
+                         const char *method,
+                         int debug_verbosity_level)
+      {
+        return (computeHypotheses (threads,
+                                   [this] (boost::mt19937 &rng, Indices &selection) { sac_model_->getSamples (rng, selection); },
+                                   score, update, method, debug_verbosity_level));
+      }
    };
 }
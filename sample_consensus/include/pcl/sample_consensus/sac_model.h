@@ -40,6 +40,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <ctime>
 #include <limits>
 #include <memory>
@@ -205,6 +206,42 @@ namespace pcl
         samples.clear ();
       }
 
+      /** \brief Get a set of random data samples drawn with the given random
+        * number generator and return them as point indices.
+        * Unlike getSamples (int&, Indices&), this neither uses the internal
+        * generator nor the shuffled indices of the model, so several threads
+        * can draw samples concurrently, each one with its own generator.
+        * \param[in,out] rng the random number generator to draw the samples with
+        * \param[out] samples the resultant model samples (empty if no good sample was found)
+        */
+      void
+      getSamples (boost::mt19937 &rng, Indices &samples) const
+      {
+        if (indices_->size () < getSampleSize ())
+        {
+          PCL_ERROR ("[pcl::SampleConsensusModel::getSamples] Can not select %lu unique points out of %lu!\n",
+                     samples.size (), indices_->size ());
+          samples.clear ();
+          return;
+        }
+
+        samples.resize (getSampleSize ());
+        for (unsigned int iter = 0; iter < max_sample_checks_; ++iter)
+        {
+          // Choose the random indices
+          if (samples_radius_ < std::numeric_limits<double>::epsilon ())
+            drawIndexSample (rng, samples);
+          else
+            drawIndexSampleRadius (rng, samples);
+
+          // If it's a good sample, stop here
+          if (isSampleGood (samples))
+            return;
+        }
+        PCL_DEBUG ("[pcl::SampleConsensusModel::getSamples] WARNING: Could not select %d sample points in %d iterations!\n", getSampleSize (), max_sample_checks_);
+        samples.clear ();
+      }
+
       /** \brief Check whether the given index samples can form a valid model,
         * compute the model coefficients from these samples and store them
         * in model_coefficients. Pure virtual.
@@ -517,6 +554,80 @@ namespace pcl
         std::copy (shuffled_indices_.cbegin (), shuffled_indices_.cbegin () + sample_size, sample.begin ());
       }
 
+      /** \brief Fills a sample array with random samples from the indices_ vector, using the given generator
+        * \param[in,out] rng the random number generator to draw the samples with
+        * \param[out] sample the set of indices of target_ to analyze
+        */
+      inline void
+      drawIndexSample (boost::mt19937 &rng, Indices &sample) const
+      {
+        drawDistinctIndices (*indices_, rng, sample.begin (), sample.end ());
+      }
+
+      /** \brief Fills a sample array with one random sample from the indices_ vector
+        *        and other random samples that are closer than samples_radius_, using the given generator
+        * \param[in,out] rng the random number generator to draw the samples with
+        * \param[out] sample the set of indices of target_ to analyze
+        */
+      inline void
+      drawIndexSampleRadius (boost::mt19937 &rng, Indices &sample) const
+      {
+        drawDistinctIndices (*indices_, rng, sample.begin (), sample.begin () + 1);
+
+        Indices indices;
+        std::vector<float> sqr_dists;
+        samples_radius_search_->radiusSearch (input_->at(sample[0]),
+                                              samples_radius_, indices, sqr_dists );
+
+        if (indices.size () < sample.size () - 1)
+          // radius search failed, make an invalid model
+          std::fill (sample.begin () + 1, sample.end (), sample[0]);
+        else
+          drawDistinctIndices (indices, rng, sample.begin () + 1, sample.end ());
+      }
+
+      /** \brief Fills [first, last) with entries picked from distinct positions of pool.
+        * Samples are tiny compared to the pool, so rejecting repeated positions is
+        * much cheaper than shuffling a private copy of the pool.
+        * \param[in] pool the indices to pick from, at least as many as requested
+        * \param[in,out] rng the random number generator to draw the positions with
+        * \param[out] first the beginning of the range to fill
+        * \param[out] last the end of the range to fill
+        */
+      static void
+      drawDistinctIndices (const Indices &pool, boost::mt19937 &rng,
+                           Indices::iterator first, Indices::iterator last)
+      {
+        drawDistinctIndices (pool.cbegin (), pool.cend (), rng, first, last);
+      }
+
+      /** \brief Fills [first, last) with entries picked from distinct positions of [pool_first, pool_last).
+        * \param[in] pool_first the beginning of the indices to pick from
+        * \param[in] pool_last the end of the indices to pick from, at least as many as requested
+        * \param[in,out] rng the random number generator to draw the positions with
+        * \param[out] first the beginning of the range to fill
+        * \param[out] last the end of the range to fill
+        */
+      static void
+      drawDistinctIndices (Indices::const_iterator pool_first, Indices::const_iterator pool_last,
+                           boost::mt19937 &rng, Indices::iterator first, Indices::iterator last)
+      {
+        if (first == last)
+          return;
+        boost::uniform_int<std::size_t> dist (0, std::distance (pool_first, pool_last) - 1);
+        std::vector<std::size_t> positions;
+        positions.reserve (std::distance (first, last));
+        for (; first != last; ++first)
+        {
+          std::size_t position;
+          do
+            position = dist (rng);
+          while (std::find (positions.cbegin (), positions.cend (), position) != positions.cend ());
+          positions.push_back (position);
+          *first = pool_first[position];
+        }
+      }
+
       /** \brief Check whether a model is valid given the user constraints.
         *
         * Default implementation verifies that the number of coefficients in the supplied model is as expected for this
@@ -93,6 +93,9 @@ namespace pcl
         
         ~BruteForce () override = default;
 
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] point the given query point
           * \param[in] k the number of neighbors to search for
@@ -103,6 +103,7 @@ pcl::search::KdTree<PointT,Tree>::radiusSearch (
 }
 
 #define PCL_INSTANTIATE_KdTree(T) template class PCL_EXPORTS pcl::search::KdTree<T>;
+#define PCL_INSTANTIATE_KdTree3DSearch(T) template class PCL_EXPORTS pcl::search::KdTree<T, pcl::KdTree3D<T> >;
 
 #endif  //#ifndef _PCL_SEARCH_KDTREE_IMPL_HPP_
 
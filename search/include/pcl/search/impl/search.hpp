@@ -40,6 +40,12 @@
 
 #include <pcl/search/search.h>
 
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
 pcl::search::Search<PointT>::Search (const std::string& name, bool sorted)
@@ -184,6 +190,110 @@ pcl::search::Search<PointT>::radiusSearch (
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::search::Search::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::search::Search::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::nearestKSearch (
+    const PointCloud& cloud, const Indices& indices, int k, NeighborLists& neighbors) const
+{
+  const std::size_t number_of_queries = indices.empty () ? cloud.size () : indices.size ();
+  searchBatch (number_of_queries, neighbors,
+               [&] (std::size_t query, Indices& k_indices, std::vector<float>& k_sqr_distances)
+               {
+                 const auto index = indices.empty () ? static_cast<index_t> (query) : indices[query];
+                 return (nearestKSearch (cloud, index, k, k_indices, k_sqr_distances));
+               });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::radiusSearch (
+    const PointCloud& cloud, const Indices& indices, double radius, NeighborLists& neighbors,
+    unsigned int max_nn) const
+{
+  const std::size_t number_of_queries = indices.empty () ? cloud.size () : indices.size ();
+  searchBatch (number_of_queries, neighbors,
+               [&] (std::size_t query, Indices& k_indices, std::vector<float>& k_sqr_distances)
+               {
+                 const auto index = indices.empty () ? static_cast<index_t> (query) : indices[query];
+                 return (radiusSearch (cloud, index, radius, k_indices, k_sqr_distances, max_nn));
+               });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename SearchQuery> void
+pcl::search::Search<PointT>::searchBatch (
+    std::size_t number_of_queries, NeighborLists& neighbors, const SearchQuery& search_query) const
+{
+  neighbors.clear ();
+  neighbors.offsets.assign (number_of_queries + 1, 0);
+
+  // A few chunks per thread, so that threads with cheap queries can take over more chunks
+  const std::size_t number_of_chunks = threads_ > 1 ? std::min<std::size_t> (number_of_queries, 4 * threads_) : 1;
+  std::vector<NeighborLists> chunks (number_of_chunks);
+
+#pragma omp parallel for \
+  num_threads(threads_) \
+  schedule(dynamic, 1) \
+  if(number_of_chunks > 1)
+  for (std::ptrdiff_t i_chunk = 0; i_chunk < static_cast<std::ptrdiff_t> (number_of_chunks); ++i_chunk)
+  {
+    const std::size_t first_query = number_of_queries * i_chunk / number_of_chunks;
+    const std::size_t last_query = number_of_queries * (i_chunk + 1) / number_of_chunks;
+    auto& chunk = chunks[i_chunk];
+
+    Indices k_indices;
+    std::vector<float> k_sqr_distances;
+    for (std::size_t query = first_query; query < last_query; ++query)
+    {
+      const int found = search_query (query, k_indices, k_sqr_distances);
+      const auto number_of_neighbors = std::min<std::size_t> (std::max (found, 0), k_indices.size ());
+      chunk.indices.insert (chunk.indices.end (), k_indices.cbegin (), k_indices.cbegin () + number_of_neighbors);
+      chunk.sqr_distances.insert (chunk.sqr_distances.end (), k_sqr_distances.cbegin (), k_sqr_distances.cbegin () + number_of_neighbors);
+      neighbors.offsets[query + 1] = static_cast<std::size_t> (number_of_neighbors);
+    }
+  }
+
+  for (std::size_t query = 0; query < number_of_queries; ++query)
+    neighbors.offsets[query + 1] += neighbors.offsets[query];
+
+  if (number_of_chunks == 1)
+  {
+    neighbors.indices.swap (chunks[0].indices);
+    neighbors.sqr_distances.swap (chunks[0].sqr_distances);
+    return;
+  }
+
+  neighbors.indices.resize (neighbors.offsets.back ());
+  neighbors.sqr_distances.resize (neighbors.offsets.back ());
+#pragma omp parallel for \
+  num_threads(threads_) \
+  schedule(static, 1)
+  for (std::ptrdiff_t i_chunk = 0; i_chunk < static_cast<std::ptrdiff_t> (number_of_chunks); ++i_chunk)
+  {
+    const auto& chunk = chunks[i_chunk];
+    const std::size_t first = neighbors.offsets[number_of_queries * i_chunk / number_of_chunks];
+    std::copy (chunk.indices.cbegin (), chunk.indices.cend (), neighbors.indices.begin () + first);
+    std::copy (chunk.sqr_distances.cbegin (), chunk.sqr_distances.cend (), neighbors.sqr_distances.begin () + first);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::search::Search<PointT>::sortResults (
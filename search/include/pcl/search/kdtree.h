@@ -41,6 +41,7 @@
 
 #include <pcl/search/search.h>
 #include <pcl/kdtree/kdtree_flann.h>
+#include <pcl/kdtree/kdtree_3d.h>
 
 namespace pcl
 {
@@ -54,6 +55,10 @@ namespace pcl
       * The class is making use of the FLANN (Fast Library for Approximate Nearest Neighbor) project 
       * by Marius Muja and David Lowe.
       *
+      * The kd-tree implementation is selected through the \a Tree template parameter. Besides the
+      * default pcl::KdTreeFLANN, pcl::KdTree3D can be used for 3D point representations, e.g.
+      * pcl::search::KdTree<pcl::PointXYZ, pcl::KdTree3D<pcl::PointXYZ> >.
+      *
       * \author Radu B. Rusu
       * \ingroup search
       */
@@ -0,0 +1,131 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/types.h> // for pcl::Indices, pcl::index_t
+
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief Neighbors of a set of query points, stored in compressed sparse row (CSR) layout.
+      *
+      * The neighbors of query \a i are indices[offsets[i]] ... indices[offsets[i + 1] - 1]. All lists share
+      * two allocations, instead of one \ref pcl::Indices per query, which matters for large clouds.
+      * \a sqr_distances is either empty or holds the squared distance of every entry of \a indices.
+      * \ingroup search
+      */
+    struct NeighborLists
+    {
+      /** \brief Read-only view of the neighbors of one query. */
+      class List
+      {
+        public:
+          List (const index_t *first, const index_t *last) : first_ (first), last_ (last) {}
+
+          inline std::size_t
+          size () const { return (static_cast<std::size_t> (last_ - first_)); }
+
+          inline bool
+          empty () const { return (first_ == last_); }
+
+          inline index_t
+          operator[] (std::size_t i) const { return (first_[i]); }
+
+          inline const index_t*
+          begin () const { return (first_); }
+
+          inline const index_t*
+          end () const { return (last_); }
+
+        private:
+          const index_t *first_;
+          const index_t *last_;
+      };
+
+      /** \brief Start of the neighbors of every query in \a indices, followed by the total number of neighbors. */
+      std::vector<std::size_t> offsets;
+
+      /** \brief The neighbors of all queries, one list after the other. */
+      Indices indices;
+
+      /** \brief The squared distances of the neighbors, parallel to \a indices, or empty. */
+      std::vector<float> sqr_distances;
+
+      /** \brief Get the number of queries. */
+      inline std::size_t
+      size () const
+      {
+        return (offsets.empty () ? 0 : offsets.size () - 1);
+      }
+
+      /** \brief Whether there are no queries. */
+      inline bool
+      empty () const
+      {
+        return (size () == 0);
+      }
+
+      /** \brief Remove all queries and neighbors. */
+      inline void
+      clear ()
+      {
+        offsets.clear ();
+        indices.clear ();
+        sqr_distances.clear ();
+      }
+
+      /** \brief Get the neighbors of a query. */
+      inline List
+      operator[] (std::size_t query) const
+      {
+        return (List (indices.data () + offsets[query], indices.data () + offsets[query + 1]));
+      }
+
+      /** \brief Get a pointer to the squared distances of the neighbors of a query. */
+      inline const float*
+      getSqrDistances (std::size_t query) const
+      {
+        return (sqr_distances.data () + offsets[query]);
+      }
+    };
+  }
+}
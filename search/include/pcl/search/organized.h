@@ -77,6 +77,8 @@ namespace pcl
         using pcl::search::Search<PointT>::indices_;
         using pcl::search::Search<PointT>::sorted_results_;
         using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
 
         /** \brief Constructor
           * \param[in] sorted_results whether the results should be return sorted in ascending order on the distances or not.
@@ -188,7 +190,20 @@ namespace pcl
           * @return true if projection is valid, false otherwise
           */
         bool projectPoint (const PointT& p, pcl::PointXY& q) const;
-        
+
+        /** \brief Obtain a search box in 2D from a sphere with a radius in 3D. All points of the input cloud
+          * within the sphere lie in the box.
+          * \param[in] point the query point (sphere center)
+          * \param[in] squared_radius the squared sphere radius
+          * \param[out] minX the min X box coordinate
+          * \param[out] maxX the max X box coordinate
+          * \param[out] minY the min Y box coordinate
+          * \param[out] maxY the max Y box coordinate
+          */
+        void
+        getProjectedRadiusSearchBox (const PointT& point, float squared_radius, unsigned& minX, unsigned& maxX,
+                                     unsigned& minY, unsigned& maxY) const;
+
       protected:
 
         struct Entry
@@ -250,19 +265,6 @@ namespace pcl
           end   = std::min (std::max (end, min), max);
         }
 
-        /** \brief Obtain a search box in 2D from a sphere with a radius in 3D
-          * \param[in] point the query point (sphere center)
-          * \param[in] squared_radius the squared sphere radius
-          * \param[out] minX the min X box coordinate
-          * \param[out] minY the min Y box coordinate
-          * \param[out] maxX the max X box coordinate
-          * \param[out] maxY the max Y box coordinate
-          */
-        void
-        getProjectedRadiusSearchBox (const PointT& point, float squared_radius, unsigned& minX, unsigned& minY,
-                                     unsigned& maxX, unsigned& maxY) const;
-
-
         /** \brief the projection matrix. Either set by user or calculated by the first / each input cloud */
         Eigen::Matrix<float, 3, 4, Eigen::RowMajor> projection_matrix_;
 
@@ -43,6 +43,7 @@
 #include <pcl/for_each_type.h>
 #include <pcl/common/concatenate.h>
 #include <pcl/common/copy_point.h>
+#include <pcl/search/neighbor_lists.h>
 
 namespace pcl
 {
@@ -133,6 +134,19 @@ namespace pcl
           return (indices_);
         }
 
+        /** \brief Set the number of threads used by the batched searches that write into \ref NeighborLists.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
+        /** \brief Get the number of threads used by the batched searches. */
+        unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] point the given query point
           * \param[in] k the number of neighbors to search for
@@ -395,14 +409,56 @@ namespace pcl
           }
         }
 
+        /** \brief Search for the k-nearest neighbors of a set of query points, on \ref getNumberOfThreads threads.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighbors the neighbors and squared distances of every query, in the order of the queries.
+          * All queries share the storage of \a neighbors, which can be reused for the next batch.
+          * \note The queries are searched concurrently, so the single-point search must be safe to call from
+          * several threads. This holds for all search methods of libpcl_search.
+          */
+        virtual void
+        nearestKSearch (const PointCloud& cloud, const Indices& indices, int k, NeighborLists& neighbors) const;
+
+        /** \brief Search for all the nearest neighbors of a set of query points in a given radius, on
+          * \ref getNumberOfThreads threads.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] neighbors the neighbors and squared distances of every query, in the order of the queries.
+          * All queries share the storage of \a neighbors, which can be reused for the next batch.
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \note The queries are searched concurrently, so the single-point search must be safe to call from
+          * several threads. This holds for all search methods of libpcl_search.
+          */
+        virtual void
+        radiusSearch (const PointCloud& cloud, const Indices& indices, double radius, NeighborLists& neighbors,
+                      unsigned int max_nn = 0) const;
+
       protected:
         void 
         sortResults (Indices& indices, std::vector<float>& distances) const;
 
+        /** \brief Run a single-point search for every query and gather the results in \a neighbors.
+          * The queries are split into contiguous chunks, each chunk collects its results in its own buffers, and
+          * the buffers are then copied to their final position. Only the chunks allocate, never a query.
+          * \param[in] number_of_queries the number of queries
+          * \param[out] neighbors the gathered neighbors and squared distances
+          * \param[in] search_query callable taking the query number and the result vectors to fill
+          */
+        template <typename SearchQuery> void
+        searchBatch (std::size_t number_of_queries, NeighborLists& neighbors, const SearchQuery& search_query) const;
+
         PointCloudConstPtr input_;
         IndicesConstPtr indices_;
         bool sorted_results_;
         std::string name_;
+
+        /** \brief The number of threads used by the batched searches. */
+        unsigned int threads_{1};
         
       private:
         struct Compare
@@ -42,5 +42,6 @@
 #include <pcl/point_types.h>
 // Instantiations of specific point types
 PCL_INSTANTIATE(KdTree, PCL_POINT_TYPES)
+PCL_INSTANTIATE(KdTree3DSearch, PCL_XYZ_POINT_TYPES)
 #endif    // PCL_NO_PRECOMPILE
 
@@ -0,0 +1,101 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/types.h> // for pcl::index_t
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Disjoint sets over point indices that can be merged from several threads without locks.
+      * Roots are always linked below smaller roots, so the root of a set is its smallest index.
+      */
+    class ConcurrentDisjointSets
+    {
+      public:
+        ConcurrentDisjointSets (std::size_t size) : parents_ (size)
+        {
+          for (std::size_t i = 0; i < size; ++i)
+            parents_[i].store (static_cast<index_t> (i), std::memory_order_relaxed);
+        }
+
+        /** \brief Find the root of the set containing \a index, halving the path on the way. */
+        inline index_t
+        find (index_t index)
+        {
+          while (true)
+          {
+            index_t parent = parents_[index].load (std::memory_order_relaxed);
+            if (parent == index)
+              return (index);
+            const index_t grandparent = parents_[parent].load (std::memory_order_relaxed);
+            if (grandparent != parent)
+              parents_[index].compare_exchange_weak (parent, grandparent, std::memory_order_relaxed);
+            index = grandparent;
+          }
+        }
+
+        /** \brief Merge the sets containing \a a and \a b. */
+        inline void
+        unite (index_t a, index_t b)
+        {
+          while (true)
+          {
+            a = find (a);
+            b = find (b);
+            if (a == b)
+              return;
+            if (a < b)
+              std::swap (a, b);
+            // Link the larger root below the smaller one, unless another thread linked it meanwhile
+            index_t expected = a;
+            if (parents_[a].compare_exchange_strong (expected, b, std::memory_order_relaxed))
+              return;
+          }
+        }
+
+      private:
+        std::vector<std::atomic<index_t> > parents_;
+    };
+  }
+}
@@ -82,6 +82,29 @@ namespace pcl
       const typename search::Search<PointT>::Ptr &tree, float tolerance, std::vector<PointIndices> &clusters,
       unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
 
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, using several
+    * threads. The radius searches run in parallel and the points are merged with a concurrent union-find instead of
+    * growing one cluster at a time, so the clusters and their order are the same as with the serial version.
+    * If \a tree is a search::OrganizedNeighbor, the projected search box of every point is scanned directly in the
+    * image, and only the pixels after the point, so that each pair of points is tested once.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tree the spatial locator (e.g., kd-tree) used for nearest neighbors searching
+    * \note the tree has to be created as a spatial locator on \a cloud and \a indices
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain
+    * \param num_threads the number of threads to use (0: automatic)
+    * \ingroup segmentation
+    */
+  template <typename PointT> void
+  extractEuclideanClusters (
+      const PointCloud<PointT> &cloud, const Indices &indices,
+      const typename search::Search<PointT>::Ptr &tree, float tolerance, std::vector<PointIndices> &clusters,
+      unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster, unsigned int num_threads);
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the euclidean distance between points, and the normal
     * angular deviation between points. Each point added to the cluster is origin to another radius search. Each point
@@ -405,6 +428,20 @@ namespace pcl
         return (max_pts_per_cluster_); 
       }
 
+      /** \brief Set the number of threads to use. With more than one thread, or with an organized input cloud, the
+        * clusters are extracted with the union-find variant of extractEuclideanClusters, which gives the same result.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] clusters the resultant point clusters
         */
@@ -430,6 +467,9 @@ namespace pcl
       /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
       pcl::uindex_t max_pts_per_cluster_{std::numeric_limits<pcl::uindex_t>::max()};
 
+      /** \brief The number of threads to use. */
+      unsigned int threads_{1};
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("EuclideanClusterExtraction"); }
 
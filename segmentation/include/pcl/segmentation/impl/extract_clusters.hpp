@@ -39,7 +39,15 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include <pcl/segmentation/extract_clusters.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/search/organized.h> // for OrganizedNeighbor
+#include <pcl/segmentation/concurrent_disjoint_sets.h>
+
+#include <unordered_map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -217,9 +225,161 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
+                               const Indices &indices,
+                               const typename search::Search<PointT>::Ptr &tree,
+                               float tolerance, std::vector<PointIndices> &clusters,
+                               unsigned int min_pts_per_cluster,
+                               unsigned int max_pts_per_cluster,
+                               unsigned int num_threads)
+{
+  if (tree->getInputCloud()->size() != cloud.size()) {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Tree built for a different point cloud "
+              "dataset (%zu) than the input cloud (%zu)!\n",
+              static_cast<std::size_t>(tree->getInputCloud()->size()),
+              static_cast<std::size_t>(cloud.size()));
+    return;
+  }
+  if (tree->getIndices()->size() != indices.size()) {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Tree built for a different set of "
+              "indices (%zu) than the input set (%zu)!\n",
+              static_cast<std::size_t>(tree->getIndices()->size()),
+              indices.size());
+    return;
+  }
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = omp_get_num_procs ();
+#else
+  if (num_threads != 1)
+    PCL_WARN ("[pcl::extractEuclideanClusters] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+  num_threads = 1;
+#endif
+
+  const auto nr_indices = static_cast<std::ptrdiff_t> (indices.size ());
+  pcl::detail::ConcurrentDisjointSets sets (cloud.size ());
+  bool search_failed = false;
+
+  const auto organized_tree = dynamic_cast<const search::OrganizedNeighbor<PointT>*> (tree.get ());
+  if (organized_tree && cloud.isOrganized ())
+  {
+    // Only the pixels after the query in its projected search box are tested: every pair of
+    // points within the tolerance is in the search box of the first of the two
+    std::vector<unsigned char> mask (cloud.size (), 0);
+    for (const auto &index : indices)
+      mask[index] = 1;
+    const float squared_tolerance = tolerance * tolerance;
+    const auto width = static_cast<index_t> (cloud.width);
+
+#pragma omp parallel for schedule(dynamic, 256) num_threads(num_threads)
+    for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
+    {
+      const index_t query = indices[i];
+      const PointT &query_point = cloud[query];
+      if (!isFinite (query_point))
+        continue;
+      unsigned left, right, top, bottom;
+      organized_tree->getProjectedRadiusSearchBox (query_point, squared_tolerance, left, right, top, bottom);
+      const auto query_row = static_cast<unsigned> (query / width);
+      for (unsigned row = std::max (top, query_row); row <= bottom; ++row)
+      {
+        index_t index = static_cast<index_t> (row) * width + static_cast<index_t> (left);
+        const index_t row_end = static_cast<index_t> (row) * width + static_cast<index_t> (right);
+        if (row == query_row)
+          index = std::max (index, query + 1);
+        for (; index <= row_end; ++index)
+        {
+          if (!mask[index] || !isFinite (cloud[index]))
+            continue;
+          if ((cloud[index].getVector3fMap () - query_point.getVector3fMap ()).squaredNorm () <= squared_tolerance)
+            sets.unite (query, index);
+        }
+      }
+    }
+  }
+  else
+  {
+#pragma omp parallel num_threads(num_threads)
+    {
+      Indices nn_indices;
+      std::vector<float> nn_distances;
+#pragma omp for schedule(dynamic, 256)
+      for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
+      {
+        const index_t query = indices[i];
+        const int ret = tree->radiusSearch (cloud[query], tolerance, nn_indices, nn_distances);
+        if (ret == -1)
+        {
+#pragma omp atomic write
+          search_failed = true;
+          continue;
+        }
+        for (int j = 0; j < ret; ++j)
+        {
+          if (nn_indices[j] != UNAVAILABLE && nn_indices[j] != query)
+            sets.unite (query, nn_indices[j]);
+        }
+      }
+    }
+  }
+
+  if (search_failed)
+  {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Received error code -1 from radiusSearch\n");
+    return;
+  }
+
+  // Number the clusters in the order the serial version finds them, i.e. by their first point in indices
+  std::unordered_map<index_t, std::size_t> cluster_ids;
+  std::vector<Indices> cluster_points;
+  for (const auto &index : indices)
+  {
+    const auto cluster_id = cluster_ids.emplace (sets.find (index), cluster_points.size ());
+    if (cluster_id.second)
+      cluster_points.emplace_back ();
+    cluster_points[cluster_id.first->second].push_back (index);
+  }
+
+  for (auto &points : cluster_points)
+  {
+    if (points.size () >= min_pts_per_cluster && points.size () <= max_pts_per_cluster)
+    {
+      pcl::PointIndices r;
+      r.indices = std::move (points);
+      std::sort (r.indices.begin (), r.indices.end ());
+      r.header = cloud.header;
+      clusters.push_back (std::move (r));
+    }
+    else
+    {
+      PCL_DEBUG("[pcl::extractEuclideanClusters] This cluster has %zu points, which is not between %u and %u points, so it is not a final cluster\n",
+                points.size (), min_pts_per_cluster, max_pts_per_cluster);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename PointT> void
+pcl::EuclideanClusterExtraction<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::EuclideanClusterExtraction::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::EuclideanClusterExtraction::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void 
 pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clusters)
 {
@@ -242,7 +402,10 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_, indices_);
-  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  if (threads_ != 1 || input_->isOrganized ())
+    extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
+  else
+    extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
 
   //tree_->setInputCloud (input_);
   //extractEuclideanClusters (*input_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
@@ -256,5 +419,6 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 #define PCL_INSTANTIATE_EuclideanClusterExtraction(T) template class PCL_EXPORTS pcl::EuclideanClusterExtraction<T>;
 #define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
 #define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const pcl::Indices &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClusters_indices_threads(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const pcl::Indices &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
 
 #endif        // PCL_EXTRACT_CLUSTERS_IMPL_H_
@@ -47,11 +47,19 @@
 #include <pcl/console/print.h> // for PCL_ERROR
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
+#include <pcl/segmentation/concurrent_disjoint_sets.h>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <queue>
 #include <cmath>
 #include <ctime>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT>
 pcl::RegionGrowing<PointT, NormalT>::RegionGrowing() = default;
@@ -198,6 +206,44 @@ pcl::RegionGrowing<PointT, NormalT>::setNumberOfNeighbours (unsigned int neighbo
   neighbour_number_ = neighbour_number;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> bool
+pcl::RegionGrowing<PointT, NormalT>::getRegionMergingFlag () const
+{
+  return (region_merging_flag_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setRegionMergingFlag (bool value)
+{
+  region_merging_flag_ = value;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> unsigned int
+pcl::RegionGrowing<PointT, NormalT>::getNumberOfThreads () const
+{
+  return (threads_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    threads_ = omp_get_num_procs ();
+  else
+    threads_ = nr_threads;
+  PCL_DEBUG ("[pcl::RegionGrowing::setNumberOfThreads] Setting number of threads to %u.\n", threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN ("[pcl::RegionGrowing::setNumberOfThreads] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> typename pcl::RegionGrowing<PointT, NormalT>::KdTreePtr
 pcl::RegionGrowing<PointT, NormalT>::getSearchMethod () const
@@ -323,36 +369,86 @@ pcl::RegionGrowing<PointT, NormalT>::prepareForSegmentation ()
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::findPointNeighbours ()
 {
-  pcl::Indices neighbours;
-  std::vector<float> distances;
+  computeNeighbourLists (neighbour_number_, false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::computeNeighbourLists (unsigned int neighbour_number, bool store_distances)
+{
+  // The points are processed in increasing order, so that the lists can be compacted in place
+  pcl::Indices sorted_indices (*indices_);
+  std::sort (sorted_indices.begin (), sorted_indices.end ());
+  sorted_indices.erase (std::unique (sorted_indices.begin (), sorted_indices.end ()), sorted_indices.end ());
+  const auto number_of_points = static_cast<std::ptrdiff_t> (sorted_indices.size ());
 
-  point_neighbours_.resize (input_->size (), neighbours);
-  if (input_->is_dense)
+  point_neighbours_.clear ();
+  point_neighbours_.offsets.resize (input_->size () + 1, 0);
+  point_neighbours_.indices.resize (sorted_indices.size () * neighbour_number);
+  if (store_distances)
+    point_neighbours_.sqr_distances.resize (sorted_indices.size () * neighbour_number);
+
+  // Every point writes its neighbours to its own slot of neighbour_number entries, and their
+  // count to offsets[point_index + 1]
+#pragma omp parallel num_threads(threads_)
   {
-    for (const auto& point_index: (*indices_))
+    pcl::Indices neighbours;
+    std::vector<float> distances;
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i_point = 0; i_point < number_of_points; i_point++)
     {
-      neighbours.clear ();
-      search_->nearestKSearch (point_index, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
+      const auto point_index = sorted_indices[i_point];
+      if (!input_->is_dense && !pcl::isFinite ((*input_)[point_index]))
+        continue;
+      search_->nearestKSearch (point_index, neighbour_number, neighbours, distances);
+      const auto number_of_neighbours = std::min<std::size_t> (neighbours.size (), neighbour_number);
+      const auto slot = static_cast<std::size_t> (i_point) * neighbour_number;
+      std::copy (neighbours.cbegin (), neighbours.cbegin () + number_of_neighbours, point_neighbours_.indices.begin () + slot);
+      if (store_distances)
+        std::copy (distances.cbegin (), distances.cbegin () + number_of_neighbours, point_neighbours_.sqr_distances.begin () + slot);
+      point_neighbours_.offsets[point_index + 1] = number_of_neighbours;
     }
   }
-  else
+
+  // Turn the counts into offsets and move every list from its slot to its offset, which is never
+  // after the slot
+  auto& offsets = point_neighbours_.offsets;
+  for (std::size_t i = 1; i < offsets.size (); i++)
+    offsets[i] += offsets[i - 1];
+  for (std::ptrdiff_t i_point = 0; i_point < number_of_points; i_point++)
   {
-    for (const auto& point_index: (*indices_))
-    {
-      if (!pcl::isFinite ((*input_)[point_index]))
-        continue;
-      neighbours.clear ();
-      search_->nearestKSearch (point_index, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
-    }
+    const auto point_index = sorted_indices[i_point];
+    const auto slot = static_cast<std::size_t> (i_point) * neighbour_number;
+    const auto first = offsets[point_index];
+    const auto last = offsets[point_index + 1];
+    if (first == slot)
+      continue;
+    std::copy (point_neighbours_.indices.begin () + slot, point_neighbours_.indices.begin () + slot + (last - first),
+               point_neighbours_.indices.begin () + first);
+    if (store_distances)
+      std::copy (point_neighbours_.sqr_distances.begin () + slot, point_neighbours_.sqr_distances.begin () + slot + (last - first),
+                 point_neighbours_.sqr_distances.begin () + first);
   }
+  point_neighbours_.indices.resize (offsets.back ());
+  if (store_distances)
+    point_neighbours_.sqr_distances.resize (offsets.back ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm ()
 {
+  if (region_merging_flag_)
+  {
+    // Merging relies on the test between a point and its neighbour not depending on the seed
+    if (smooth_mode_flag_ || !normal_flag_)
+    {
+      applyParallelRegionGrowingAlgorithm ();
+      return;
+    }
+    PCL_WARN ("[pcl::RegionGrowing::applySmoothRegionGrowingAlgorithm] Growing regions by merging requires the smooth mode, growing them serially instead.\n");
+  }
+
   int num_of_pts = static_cast<int> (indices_->size ());
   point_labels_.resize (input_->size (), -1);
 
@@ -406,6 +502,115 @@ pcl::RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm ()
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::applyParallelRegionGrowingAlgorithm ()
+{
+  const auto num_of_pts = static_cast<std::ptrdiff_t> (indices_->size ());
+  point_labels_.assign (input_->size (), -1);
+
+  // The regions are numbered in the order of the seeds of the serial growth
+  std::vector< std::pair<float, int> > point_residual (num_of_pts);
+  for (std::ptrdiff_t i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    const auto point_index = (*indices_)[i_point];
+    point_residual[i_point].first = normal_flag_ ? (*normals_)[point_index].curvature : 0.0f;
+    point_residual[i_point].second = point_index;
+  }
+  if (normal_flag_)
+    std::sort (point_residual.begin (), point_residual.end (), comparePair);
+
+  // Points that pass the curvature test can carry on the growth, the others can only join a region
+  std::vector<unsigned char> seed_points (input_->size (), 0);
+  for (const auto& point_index : (*indices_))
+    seed_points[point_index] = !(curvature_flag_ && (*normals_)[point_index].curvature > curvature_threshold_);
+
+  // Merge every seed point with the neighbours it accepts as seeds
+  pcl::detail::ConcurrentDisjointSets regions (input_->size ());
+#pragma omp parallel for schedule(dynamic, 256) num_threads(threads_)
+  for (std::ptrdiff_t i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    const auto point_index = (*indices_)[i_point];
+    if (!seed_points[point_index])
+      continue;
+    const auto neighbours = point_neighbours_[point_index];
+    const auto number_of_neighbours = std::min<std::size_t> (neighbours.size (), neighbour_number_);
+    for (std::size_t i_nghbr = 0; i_nghbr < number_of_neighbours; i_nghbr++)
+    {
+      const auto index = neighbours[i_nghbr];
+      bool is_a_seed = false;
+      if (index != point_index && validatePoint (point_index, point_index, index, is_a_seed) && is_a_seed)
+        regions.unite (point_index, index);
+    }
+  }
+
+  int number_of_segments = 0;
+  std::vector<int> region_labels (input_->size (), -1);
+  for (const auto& residual : point_residual)
+  {
+    const auto point_index = residual.second;
+    if (!seed_points[point_index])
+      continue;
+    int& region_label = region_labels[regions.find (point_index)];
+    if (region_label == -1)
+      region_label = number_of_segments++;
+    point_labels_[point_index] = region_label;
+  }
+
+  // Every other point joins the earliest region that has a seed point accepting it
+  std::vector<std::atomic<int> > candidate_labels (input_->size ());
+  for (auto& candidate_label : candidate_labels)
+    candidate_label.store (std::numeric_limits<int>::max (), std::memory_order_relaxed);
+#pragma omp parallel for schedule(dynamic, 256) num_threads(threads_)
+  for (std::ptrdiff_t i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    const auto point_index = (*indices_)[i_point];
+    if (!seed_points[point_index])
+      continue;
+    const int label = point_labels_[point_index];
+    const auto neighbours = point_neighbours_[point_index];
+    const auto number_of_neighbours = std::min<std::size_t> (neighbours.size (), neighbour_number_);
+    for (std::size_t i_nghbr = 0; i_nghbr < number_of_neighbours; i_nghbr++)
+    {
+      const auto index = neighbours[i_nghbr];
+      bool is_a_seed = false;
+      if (seed_points[index] || !validatePoint (point_index, point_index, index, is_a_seed))
+        continue;
+      int current = candidate_labels[index].load (std::memory_order_relaxed);
+      while (label < current && !candidate_labels[index].compare_exchange_weak (current, label, std::memory_order_relaxed)) {}
+    }
+  }
+  for (const auto& point_index : (*indices_))
+  {
+    const int candidate_label = candidate_labels[point_index].load (std::memory_order_relaxed);
+    if (!seed_points[point_index] && candidate_label != std::numeric_limits<int>::max ())
+      point_labels_[point_index] = candidate_label;
+  }
+
+  // The points left are seeds of their own regions, as in the serial growth
+  for (const auto& residual : point_residual)
+  {
+    const auto point_index = residual.second;
+    if (point_labels_[point_index] != -1)
+      continue;
+    point_labels_[point_index] = number_of_segments;
+    const auto neighbours = point_neighbours_[point_index];
+    const auto number_of_neighbours = std::min<std::size_t> (neighbours.size (), neighbour_number_);
+    for (std::size_t i_nghbr = 0; i_nghbr < number_of_neighbours; i_nghbr++)
+    {
+      const auto index = neighbours[i_nghbr];
+      bool is_a_seed = false;
+      if (point_labels_[index] == -1 && validatePoint (point_index, point_index, index, is_a_seed))
+        point_labels_[index] = number_of_segments;
+    }
+    number_of_segments++;
+  }
+
+  num_pts_in_segment_.assign (number_of_segments, 0);
+  for (const auto& point_index : (*indices_))
+    num_pts_in_segment_[point_labels_[point_index]]++;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> int
 pcl::RegionGrowing<PointT, NormalT>::growRegion (int initial_seed, int segment_number)
@@ -422,10 +627,11 @@ pcl::RegionGrowing<PointT, NormalT>::growRegion (int initial_seed, int segment_n
     curr_seed = seeds.front ();
     seeds.pop ();
 
+    const auto neighbours = point_neighbours_[curr_seed];
     std::size_t i_nghbr = 0;
-    while ( i_nghbr < neighbour_number_ && i_nghbr < point_neighbours_[curr_seed].size () )
+    while ( i_nghbr < neighbour_number_ && i_nghbr < neighbours.size () )
     {
-      int index = point_neighbours_[curr_seed][i_nghbr];
+      int index = neighbours[i_nghbr];
       if (point_labels_[index] != -1)
       {
         i_nghbr++;
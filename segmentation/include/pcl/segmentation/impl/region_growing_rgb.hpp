@@ -50,7 +50,6 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT>
 pcl::RegionGrowingRGB<PointT, NormalT>::RegionGrowingRGB () :
-  point_distances_ (0),
   segment_neighbours_ (0),
   segment_distances_ (0),
   segment_labels_ (0)
@@ -65,7 +64,6 @@ pcl::RegionGrowingRGB<PointT, NormalT>::RegionGrowingRGB () :
 template <typename PointT, typename NormalT>
 pcl::RegionGrowingRGB<PointT, NormalT>::~RegionGrowingRGB ()
 {
-  point_distances_.clear ();
   segment_neighbours_.clear ();
   segment_distances_.clear ();
   segment_labels_.clear ();
@@ -164,7 +162,6 @@ pcl::RegionGrowingRGB<PointT, NormalT>::extract (std::vector <pcl::PointIndices>
   point_neighbours_.clear ();
   point_labels_.clear ();
   num_pts_in_segment_.clear ();
-  point_distances_.clear ();
   segment_neighbours_.clear ();
   segment_distances_.clear ();
   segment_labels_.clear ();
@@ -268,20 +265,7 @@ pcl::RegionGrowingRGB<PointT, NormalT>::prepareForSegmentation ()
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::findPointNeighbours ()
 {
-  pcl::Indices neighbours;
-  std::vector<float> distances;
-
-  point_neighbours_.resize (input_->size (), neighbours);
-  point_distances_.resize (input_->size (), distances);
-
-  for (const auto& point_index: (*indices_))
-  {
-    neighbours.clear ();
-    distances.clear ();
-    search_->nearestKSearch (point_index, region_neighbour_number_, neighbours, distances);
-    point_neighbours_[point_index].swap (neighbours);
-    point_distances_[point_index].swap (distances);
-  }
+  computeNeighbourLists (region_neighbour_number_, true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -316,19 +300,20 @@ pcl::RegionGrowingRGB<PointT, NormalT>::findRegionsKNN (pcl::index_t index, pcl:
   for (pcl::uindex_t i_point = 0; i_point < number_of_points; i_point++)
   {
     const auto point_index = clusters_[index].indices[i_point];
-    const auto number_of_neighbours = point_neighbours_[point_index].size ();
+    const auto neighbours = point_neighbours_[point_index];
+    const float* neighbour_distances = point_neighbours_.getSqrDistances (point_index);
     //loop through every neighbour of the current point, find out to which segment it belongs
     //and if it belongs to neighbouring segment and is close enough then remember segment and its distance
-    for (std::size_t i_nghbr = 0; i_nghbr < number_of_neighbours; i_nghbr++)
+    for (std::size_t i_nghbr = 0; i_nghbr < neighbours.size (); i_nghbr++)
     {
       // find segment
-      const pcl::index_t segment_index = point_labels_[ point_neighbours_[point_index][i_nghbr] ];
+      const pcl::index_t segment_index = point_labels_[ neighbours[i_nghbr] ];
 
       if ( segment_index != index )
       {
         // try to push it to the queue
-        if (distances[segment_index] > point_distances_[point_index][i_nghbr])
-          distances[segment_index] = point_distances_[point_index][i_nghbr];
+        if (distances[segment_index] > neighbour_distances[i_nghbr])
+          distances[segment_index] = neighbour_distances[i_nghbr];
       }
     }
   }// next point
@@ -697,7 +682,6 @@ pcl::RegionGrowingRGB<PointT, NormalT>::getSegmentFromPoint (pcl::index_t index,
       point_neighbours_.clear ();
       point_labels_.clear ();
       num_pts_in_segment_.clear ();
-      point_distances_.clear ();
       segment_neighbours_.clear ();
       segment_distances_.clear ();
       segment_labels_.clear ();
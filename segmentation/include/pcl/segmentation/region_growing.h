@@ -43,6 +43,7 @@
 #include <pcl/pcl_base.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/search/search.h>
+#include <pcl/search/neighbor_lists.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
@@ -179,6 +180,32 @@ namespace pcl
       void
       setNumberOfNeighbours (unsigned int neighbour_number);
 
+      /** \brief Returns the flag that signalizes if the regions are grown by merging (see setRegionMergingFlag). */
+      bool
+      getRegionMergingFlag () const;
+
+      /** \brief Allows to grow all regions at once, in parallel, instead of one seed after the other.
+        * Every point whose curvature passes the curvature test links with each of its neighbours that it would
+        * accept as a seed, and the linked points are merged into regions with a concurrent union-find. Each
+        * remaining point joins the earliest region of a neighbour that accepts it. The regions are the same for any
+        * number of threads, but may differ slightly from the serial growth, which depends on the order of the
+        * seeds. Requires the smooth mode; otherwise the regions are grown serially.
+        * \param[in] value new mode value, if set to true then the regions are grown by merging
+        */
+      void
+      setRegionMergingFlag (bool value);
+
+      /** \brief Returns the number of threads used for the neighbour search and the growth by merging. */
+      unsigned int
+      getNumberOfThreads () const;
+
+      /** \brief Allows to set the number of threads used for the neighbour search and the growth by merging.
+        * The neighbours are the same for any number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Returns the pointer to the search method that is used for KNN. */
       KdTreePtr
       getSearchMethod () const;
@@ -246,6 +273,14 @@ namespace pcl
       virtual void
       findPointNeighbours ();
 
+      /** \brief Finds the KNN of every point in the indices and stores them in \ref point_neighbours_,
+        * running the searches on \ref threads_ threads.
+        * \param[in] neighbour_number number of neighbours to find for each point
+        * \param[in] store_distances whether to store the squared distances of the neighbours too
+        */
+      void
+      computeNeighbourLists (unsigned int neighbour_number, bool store_distances);
+
       /** \brief This function implements the algorithm described in the article
         * "Segmentation of point clouds using smoothness constraint"
         * by T. Rabbani, F. A. van den Heuvel, G. Vosselman.
@@ -253,6 +288,12 @@ namespace pcl
       void
       applySmoothRegionGrowingAlgorithm ();
 
+      /** \brief Grows all regions at once by merging points with a concurrent union-find,
+        * see setRegionMergingFlag.
+        */
+      void
+      applyParallelRegionGrowingAlgorithm ();
+
       /** \brief This method grows a segment for the given seed point. And returns the number of its points.
         * \param[in] initial_seed index of the point that will serve as the seed point
         * \param[in] segment_number indicates which number this segment will have
@@ -305,14 +346,20 @@ namespace pcl
       /** \brief Number of neighbours to find. */
       unsigned int neighbour_number_{30};
 
+      /** \brief If set to true then all regions are grown at once by merging. */
+      bool region_merging_flag_{false};
+
+      /** \brief Number of threads to use. */
+      unsigned int threads_{1};
+
       /** \brief Search method that will be used for KNN. */
       KdTreePtr search_{nullptr};
 
       /** \brief Contains normals of the points that will be segmented. */
       NormalPtr normals_{nullptr};
 
-      /** \brief Contains neighbours of each point. */
-      std::vector<pcl::Indices> point_neighbours_{};
+      /** \brief Contains neighbours of each point of the input cloud, in CSR layout. */
+      pcl::search::NeighborLists point_neighbours_{};
 
       /** \brief Point labels that tells to which segment each point belongs. */
       std::vector<int> point_labels_{};
@@ -79,6 +79,7 @@ namespace pcl
       using RegionGrowing<PointT, NormalT>::clusters_;
       using RegionGrowing<PointT, NormalT>::number_of_segments_;
       using RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm;
+      using RegionGrowing<PointT, NormalT>::computeNeighbourLists;
       using RegionGrowing<PointT, NormalT>::assembleRegions;
 
     public:
@@ -263,9 +264,6 @@ namespace pcl
       /** \brief Number of neighbouring segments to find. */
       unsigned int region_neighbour_number_{100};
 
-      /** \brief Stores distances for the point neighbours from point_neighbours_ */
-      std::vector< std::vector<float> > point_distances_;
-
       /** \brief Stores the neighboures for the corresponding segments. */
       std::vector< pcl::Indices > segment_neighbours_;
 
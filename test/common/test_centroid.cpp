@@ -44,6 +44,8 @@
 
 #include <pcl/common/centroid.h>
 
+#include <random>
+
 using namespace pcl;
 using pcl::test::EXPECT_EQ_VECTORS;
 
@@ -838,6 +840,63 @@ TEST (PCL, computeMeanAndCovariance)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, computeMeanAndCovarianceMatrices)
+{
+  PointCloud<PointXYZ> cloud;
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> coordinate (-1.0f, 1.0f);
+  for (int i = 0; i < 500; ++i)
+    cloud.emplace_back (coordinate (rng) + 10.0f, coordinate (rng), 0.01f * coordinate (rng));
+  cloud[7].x = cloud[11].y = std::numeric_limits<float>::quiet_NaN ();
+
+  // neighborhoods with sizes around multiples of the SIMD register width, an empty one and one with only NaNs
+  std::vector<Indices> neighborhoods;
+  std::uniform_int_distribution<index_t> index (0, static_cast<index_t> (cloud.size ()) - 1);
+  for (std::size_t size : {0, 1, 3, 4, 5, 7, 8, 9, 16, 17, 30, 100})
+  {
+    Indices neighborhood (size);
+    for (auto &point_index : neighborhood)
+      point_index = index (rng);
+    neighborhoods.push_back (neighborhood);
+  }
+  neighborhoods.push_back ({7, 11});
+  neighborhoods.push_back ({7, 1, 2, 11, 3, 4, 5, 6, 8, 9});
+
+  for (const bool is_dense : {false, true})
+  {
+    cloud.is_dense = is_dense;
+    // a dense cloud must not contain NaNs
+    if (is_dense)
+    {
+      cloud[7].x = cloud[11].y = 0.0f;
+      neighborhoods.resize (neighborhoods.size () - 2);
+    }
+
+    std::vector<Eigen::Matrix3f> covariance_matrices;
+    std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > centroids;
+    std::vector<unsigned int> point_counts;
+    computeMeanAndCovarianceMatrices (cloud, neighborhoods, covariance_matrices, centroids, point_counts);
+    ASSERT_EQ (neighborhoods.size (), covariance_matrices.size ());
+    ASSERT_EQ (neighborhoods.size (), centroids.size ());
+    ASSERT_EQ (neighborhoods.size (), point_counts.size ());
+
+    for (std::size_t i = 0; i < neighborhoods.size (); ++i)
+    {
+      Eigen::Matrix3f covariance_matrix;
+      Eigen::Vector4f centroid;
+      const unsigned int point_count = computeMeanAndCovarianceMatrix (cloud, neighborhoods[i], covariance_matrix, centroid);
+      EXPECT_EQ (point_count, point_counts[i]);
+      if (point_count == 0)
+        continue;
+      for (int j = 0; j < 4; ++j)
+        EXPECT_NEAR (centroid[j], centroids[i][j], 1e-5);
+      for (int j = 0; j < 9; ++j)
+        EXPECT_NEAR (covariance_matrix.coeff (j), covariance_matrices[i].coeff (j), 1e-6);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, computeCentroidAndOBB)
 {
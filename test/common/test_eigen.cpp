@@ -797,6 +797,60 @@ TEST (PCL, eigen33f)
   EXPECT_LE (float(r_fail_count) / float(iterations), 0.01);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// the batched versions have to agree with the single matrix versions, up to the same failure rate as eigen33f
+TEST (PCL, eigen33fBatch)
+{
+  constexpr float epsilon = 1e-3f;
+  constexpr unsigned iterations = 100000;
+
+  std::vector<Eigen::Matrix3f> matrices (iterations);
+  for (auto &matrix : matrices)
+    generateSymPosMatrix3x3 (matrix);
+
+  std::vector<float> eigenvalues;
+  std::vector<Eigen::Vector3f> eigenvectors;
+  eigen33 (matrices, eigenvalues, eigenvectors);
+  ASSERT_EQ (iterations, eigenvalues.size ());
+  ASSERT_EQ (iterations, eigenvectors.size ());
+
+  std::vector<Eigen::Matrix3f> evecs;
+  std::vector<Eigen::Vector3f> evals;
+  eigen33 (matrices, evecs, evals);
+  ASSERT_EQ (iterations, evecs.size ());
+  ASSERT_EQ (iterations, evals.size ());
+
+  unsigned smallest_fail_count = 0;
+  unsigned single_fail_count = 0;
+  unsigned full_fail_count = 0;
+  for (unsigned idx = 0; idx < iterations; ++idx)
+  {
+    const Eigen::Matrix3f &matrix = matrices[idx];
+    float eigenvalue;
+    Eigen::Vector3f eigenvector;
+    eigen33 (matrix, eigenvalue, eigenvector);
+    // M * v = lambda * v, which the single matrix version misses as well for repeated smallest eigenvalues
+    if (!(std::abs (eigenvalue - eigenvalues[idx]) <= epsilon) ||
+        !((matrix * eigenvectors[idx] - eigenvalues[idx] * eigenvectors[idx]).cwiseAbs ().sum () <= epsilon))
+      ++smallest_fail_count;
+    if (!((matrix * eigenvector - eigenvalue * eigenvector).cwiseAbs ().sum () <= epsilon))
+      ++single_fail_count;
+
+    Eigen::Vector3f c_evals;
+    Eigen::Matrix3f c_evecs;
+    eigen33 (matrix, c_evecs, c_evals);
+    // U * V * U^T = M and U orthonormal
+    const float diff = (evecs[idx] * evals[idx].asDiagonal () * evecs[idx].transpose () - matrix).cwiseAbs ().sum ();
+    const float orthonormality = (evecs[idx] * evecs[idx].transpose () - Eigen::Matrix3f::Identity ()).cwiseAbs ().sum ();
+    if ((c_evals - evals[idx]).cwiseAbs ().maxCoeff () > epsilon || diff > epsilon || orthonormality > epsilon)
+      ++full_fail_count;
+  }
+
+  EXPECT_LE (smallest_fail_count, single_fail_count + iterations / 1000);
+  // less than 1% failure rate
+  EXPECT_LE (float (full_fail_count) / float (iterations), 0.01);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, transformLine)
 {
@@ -489,6 +489,101 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationThreads)
+{
+  // A curved surface with a depth step and some invalid points
+  PointCloud<PointXYZ>::Ptr surface (new PointCloud<PointXYZ> (160, 120));
+  for (std::size_t v = 0; v < surface->height; ++v)
+  {
+    for (std::size_t u = 0; u < surface->width; ++u)
+    {
+      PointXYZ& point = (*surface) (u, v);
+      point.x = static_cast<float> (u) * 0.01f;
+      point.y = static_cast<float> (v) * 0.01f;
+      point.z = 1.0f + 0.1f * std::sin (point.x * 5.0f) * std::cos (point.y * 3.0f) + (u > 100 ? 0.3f : 0.0f);
+      if ((u * 7 + v * 13) % 101 == 0)
+        point.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+  surface->is_dense = false;
+
+  using Estimation = IntegralImageNormalEstimation<PointXYZ, Normal>;
+  const Estimation::NormalEstimationMethod methods[] = {Estimation::COVARIANCE_MATRIX, Estimation::AVERAGE_3D_GRADIENT,
+                                                        Estimation::AVERAGE_DEPTH_CHANGE, Estimation::SIMPLE_3D_GRADIENT};
+  for (const auto method : methods)
+  {
+    for (const auto border_policy : {Estimation::BORDER_POLICY_IGNORE, Estimation::BORDER_POLICY_MIRROR})
+    {
+      if (method == Estimation::SIMPLE_3D_GRADIENT && border_policy == Estimation::BORDER_POLICY_MIRROR)
+        continue;
+      for (const bool depth_dependent_smoothing : {false, true})
+      {
+        PointCloud<Normal> normals_serial, normals_parallel, normals_float;
+        Estimation estimation;
+        estimation.setNormalEstimationMethod (method);
+        estimation.setBorderPolicy (border_policy);
+        estimation.setDepthDependentSmoothing (depth_dependent_smoothing);
+        estimation.setNormalSmoothingSize (8.0f);
+        estimation.setInputCloud (surface);
+        estimation.compute (normals_serial);
+
+        // The number of threads is the one of the Feature base class
+        static_cast<Feature<PointXYZ, Normal>&> (estimation).setNumberOfThreads (4);
+        estimation.setInputCloud (surface);
+        estimation.compute (normals_parallel);
+
+        estimation.setUseFloatAccumulators (true);
+        estimation.compute (normals_float);
+
+        ASSERT_EQ (normals_serial.size (), normals_parallel.size ());
+        ASSERT_EQ (normals_serial.size (), normals_float.size ());
+        for (std::size_t i = 0; i < normals_serial.size (); ++i)
+        {
+          const Eigen::Vector3f normal = normals_parallel[i].getNormalVector3fMap ();
+          if (!std::isfinite (normals_serial[i].normal_x))
+          {
+            EXPECT_FALSE (std::isfinite (normal[0]));
+            EXPECT_FALSE (std::isfinite (normals_float[i].normal_x));
+            continue;
+          }
+          // The integral images only differ by the rounding of the sums over the bands of rows of the threads
+          EXPECT_GT (normal.dot (normals_serial[i].getNormalVector3fMap ()), 1.0f - 1e-5f);
+          // Only the 3D gradients are accumulated in float
+          if (method == Estimation::AVERAGE_3D_GRADIENT)
+            EXPECT_GT (normal.dot (normals_float[i].getNormalVector3fMap ()), 1.0f - 1e-4f);
+          else
+            EXPECT_EQ (normal, normals_float[i].getNormalVector3fMap ());
+        }
+      }
+    }
+  }
+
+  // The covariance matrices of whole rows are decomposed together, check them against single points
+  PointCloud<Normal> normals;
+  Estimation estimation;
+  estimation.setNormalEstimationMethod (Estimation::COVARIANCE_MATRIX);
+  estimation.setNormalSmoothingSize (8.0f);
+  estimation.setInputCloud (surface);
+  estimation.compute (normals);
+  estimation.setRectSize (8, 8);
+  const float* distance_map = estimation.getDistanceMap ();
+  for (std::size_t v = 8; v < surface->height - 8; ++v)
+  {
+    for (std::size_t u = 8; u < surface->width - 8; ++u)
+    {
+      const std::size_t index = v * surface->width + u;
+      if (!std::isfinite ((*surface)[index].z) || distance_map[index] < 8.0f)
+        continue;
+      Normal normal;
+      estimation.computePointNormal (static_cast<int> (u), static_cast<int> (v), static_cast<unsigned> (index), normal);
+      ASSERT_TRUE (std::isfinite (normals[index].normal_x));
+      EXPECT_GT (std::abs (normal.getNormalVector3fMap ().dot (normals[index].getNormalVector3fMap ())), 1.0f - 1e-4f);
+      EXPECT_NEAR (normal.curvature, normals[index].curvature, 1e-3f);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
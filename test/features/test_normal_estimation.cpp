@@ -402,6 +402,36 @@ TEST (PCL, NormalEstimationOpenMP)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationOpenMPFeatureThreads)
+{
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+  PointCloud<Normal> normals, normals_omp;
+
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (cloudptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (normals);
+
+  // The number of threads of the OpenMP estimator is the one of the Feature base class
+  NormalEstimationOMP<PointXYZ, Normal> n_omp (1);
+  static_cast<Feature<PointXYZ, Normal>&> (n_omp).setNumberOfThreads (4);
+  n_omp.setInputCloud (cloudptr);
+  n_omp.setSearchMethod (tree);
+  n_omp.setKSearch (10);
+  n_omp.compute (normals_omp);
+
+  ASSERT_EQ (normals.size (), normals_omp.size ());
+  for (std::size_t i = 0; i < normals.size (); ++i)
+  {
+    EXPECT_NEAR (normals[i].normal_x, normals_omp[i].normal_x, 1e-4);
+    EXPECT_NEAR (normals[i].normal_y, normals_omp[i].normal_y, 1e-4);
+    EXPECT_NEAR (normals[i].normal_z, normals_omp[i].normal_z, 1e-4);
+    EXPECT_NEAR (normals[i].curvature, normals_omp[i].curvature, 1e-4);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This tests the indexing issue from #3573
 // In certain cases when you used a subset of the indices
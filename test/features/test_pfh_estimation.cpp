@@ -259,6 +259,136 @@ TEST (PCL, PFHEstimation)
   (cloud, cloud, test_indices, 125);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PFHEstimationParallel)
+{
+  using pcl::PFHSignature125;
+
+  pcl::IndicesPtr test_indices (new pcl::Indices (0));
+  for (std::size_t i = 0; i < cloud->size (); i += 2)
+    test_indices->push_back (static_cast<int> (i));
+
+  pcl::PFHEstimation<PointT, PointT, PFHSignature125> pfh;
+  pfh.setInputNormals (cloud);
+  pfh.setInputCloud (cloud);
+  pfh.setIndices (test_indices);
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (10);
+
+  PointCloud<PFHSignature125> pfhs, pfhs_parallel;
+  pfh.compute (pfhs);
+  // The result must not depend on the number of threads
+  pfh.setNumberOfThreads (4);
+  pfh.compute (pfhs_parallel);
+
+  ASSERT_EQ (test_indices->size (), pfhs_parallel.size ());
+  ASSERT_EQ (pfhs.size (), pfhs_parallel.size ());
+  EXPECT_EQ (pfhs.is_dense, pfhs_parallel.is_dense);
+  for (std::size_t i = 0; i < pfhs.size (); ++i)
+    for (int j = 0; j < 125; ++j)
+      ASSERT_EQ (pfhs[i].histogram[j], pfhs_parallel[i].histogram[j]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PFHEstimationCache)
+{
+  using pcl::PFHSignature125;
+
+  pcl::IndicesPtr test_indices (new pcl::Indices (0));
+  for (std::size_t i = 0; i < cloud->size (); i += 2)
+    test_indices->push_back (static_cast<int> (i));
+
+  pcl::PFHEstimation<PointT, PointT, PFHSignature125> pfh;
+  pfh.setInputNormals (cloud);
+  pfh.setInputCloud (cloud);
+  pfh.setIndices (test_indices);
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (10);
+
+  PointCloud<PFHSignature125> pfhs, pfhs_cached, pfhs_reused;
+  pfh.compute (pfhs);
+
+  // The internal cache is shared by all threads
+  pfh.setUseInternalCache (true);
+  pfh.setNumberOfThreads (4);
+  pfh.compute (pfhs_cached);
+  ASSERT_NE (pfh.getCache (), nullptr);
+  Eigen::Vector4f features;
+  pcl::Indices nn_indices;
+  std::vector<float> nn_dists;
+  tree->nearestKSearch ((*cloud)[(*test_indices)[0]], 10, nn_indices, nn_dists);
+  EXPECT_TRUE (pfh.getCache ()->find (nn_indices[1], nn_indices[0], features));
+  // The table is sized for the pairs of the neighborhoods (45 per point), not for the maximum size
+  EXPECT_GE (pfh.getCache ()->getNumberOfSlots (), 2 * 45 * test_indices->size ());
+  EXPECT_LE (pfh.getCache ()->getNumberOfSlots (), 4 * 45 * test_indices->size ());
+
+  // The internal cache is cleared by every call, so normals changed in place are taken into account
+  PointCloud<PointT>::Ptr flipped (new PointCloud<PointT> (*cloud));
+  pcl::PFHEstimation<PointT, PointT, PFHSignature125> pfh_flipped;
+  pfh_flipped.setInputNormals (flipped);
+  pfh_flipped.setInputCloud (flipped);
+  pfh_flipped.setIndices (test_indices);
+  pfh_flipped.setSearchMethod (tree);
+  pfh_flipped.setKSearch (10);
+  pfh_flipped.setUseInternalCache (true);
+  PointCloud<PFHSignature125> pfhs_flipped, pfhs_flipped_reference;
+  pfh_flipped.compute (pfhs_flipped);
+  for (std::size_t i = 0; i < flipped->size (); i += 3)
+    (*flipped)[i].getNormalVector3fMap () *= -1.0f;
+  pfh_flipped.compute (pfhs_flipped);
+  pfh_flipped.setUseInternalCache (false);
+  pfh_flipped.compute (pfhs_flipped_reference);
+  ASSERT_EQ (pfhs_flipped.size (), pfhs_flipped_reference.size ());
+  for (std::size_t i = 0; i < pfhs_flipped.size (); ++i)
+    for (int j = 0; j < 125; ++j)
+      ASSERT_EQ (pfhs_flipped[i].histogram[j], pfhs_flipped_reference[i].histogram[j]);
+
+  // A cache given explicitly is kept between calls on the same surface and normals
+  pcl::PairFeatureCache::Ptr cache (new pcl::PairFeatureCache);
+  pfh.setCache (cache);
+  pfh.compute (pfhs_cached);
+  EXPECT_TRUE (cache->find (nn_indices[1], nn_indices[0], features));
+  const std::size_t nr_slots = cache->getNumberOfSlots ();
+  // Larger neighborhoods grow the table, which keeps the stored pairs
+  pfh.setKSearch (15);
+  pfh.compute (pfhs_reused);
+  EXPECT_GT (cache->getNumberOfSlots (), nr_slots);
+  EXPECT_TRUE (cache->find (nn_indices[1], nn_indices[0], features));
+  pfh.setKSearch (10);
+  pfh.compute (pfhs_reused);
+
+  ASSERT_EQ (pfhs.size (), pfhs_cached.size ());
+  ASSERT_EQ (pfhs.size (), pfhs_reused.size ());
+  for (std::size_t i = 0; i < pfhs.size (); ++i)
+    for (int j = 0; j < 125; ++j)
+    {
+      ASSERT_EQ (pfhs[i].histogram[j], pfhs_cached[i].histogram[j]);
+      ASSERT_EQ (pfhs[i].histogram[j], pfhs_reused[i].histogram[j]);
+    }
+
+  // A different surface clears the cache
+  PointCloud<PointT>::Ptr copy (new PointCloud<PointT> (*cloud));
+  pfh.setInputCloud (copy);
+  pfh.setInputNormals (copy);
+  pfh.setSearchMethod (KdTreePtr (new pcl::search::KdTree<PointT> (false)));
+  pfh.setIndices (pcl::IndicesPtr (new pcl::Indices (1, (*test_indices)[1])));
+  pfh.compute (pfhs_reused);
+  EXPECT_FALSE (pfh.getCache ()->find (nn_indices[1], nn_indices[0], features));
+
+  // A full cache stops storing pairs, but the features are still computed
+  pfh.setInputCloud (cloud);
+  pfh.setInputNormals (cloud);
+  pfh.setSearchMethod (tree);
+  pfh.setIndices (test_indices);
+  pfh.setMaximumCacheSize (16);
+  EXPECT_EQ (pfh.getCache ()->getCapacity (), 16);
+  pfh.compute (pfhs_cached);
+  ASSERT_EQ (pfhs.size (), pfhs_cached.size ());
+  for (std::size_t i = 0; i < pfhs.size (); ++i)
+    for (int j = 0; j < 125; ++j)
+      ASSERT_EQ (pfhs[i].histogram[j], pfhs_cached[i].histogram[j]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 using pcl::FPFHEstimation;
@@ -444,6 +574,74 @@ TYPED_TEST (FPFHTest, Estimation)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FPFHEstimationOMPCache)
+{
+  pcl::IndicesPtr first_indices (new pcl::Indices), second_indices (new pcl::Indices), all_indices (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud->size (); ++i)
+  {
+    if (i < 2 * cloud->size () / 3)
+      first_indices->push_back (static_cast<int> (i));
+    if (i >= cloud->size () / 3)
+      second_indices->push_back (static_cast<int> (i));
+    all_indices->push_back (static_cast<int> (i));
+  }
+
+  FPFHEstimation<PointT, PointT, FPFHSignature33> fpfh;
+  fpfh.setInputNormals (cloud);
+  fpfh.setInputCloud (cloud);
+  fpfh.setIndices (all_indices);
+  fpfh.setSearchMethod (tree);
+  fpfh.setRadiusSearch (0.01);
+  PointCloud<FPFHSignature33> reference;
+  fpfh.compute (reference);
+
+  // Compute the two overlapping halves one after the other, the second reuses the SPFH signatures of the first
+  pcl::SPFHCache::Ptr cache (new pcl::SPFHCache);
+  FPFHEstimationOMP<PointT, PointT, FPFHSignature33> fpfh_omp (4);
+  fpfh_omp.setInputNormals (cloud);
+  fpfh_omp.setInputCloud (cloud);
+  fpfh_omp.setSearchMethod (tree);
+  fpfh_omp.setRadiusSearch (0.01);
+  fpfh_omp.setCache (cache);
+  PointCloud<FPFHSignature33> first, second;
+  fpfh_omp.setIndices (first_indices);
+  fpfh_omp.compute (first);
+  EXPECT_NE (cache->find (first_indices->back ()), nullptr);
+  EXPECT_EQ (cache->find (static_cast<int> (cloud->size ()) - 1), nullptr);
+  fpfh_omp.setIndices (second_indices);
+  fpfh_omp.compute (second);
+  EXPECT_NE (cache->find (static_cast<int> (cloud->size ()) - 1), nullptr);
+
+  ASSERT_EQ (first_indices->size (), first.size ());
+  ASSERT_EQ (second_indices->size (), second.size ());
+  for (std::size_t i = 0; i < first.size (); ++i)
+    for (int j = 0; j < 33; ++j)
+      EXPECT_NEAR (reference[(*first_indices)[i]].histogram[j], first[i].histogram[j], 1e-4);
+  for (std::size_t i = 0; i < second.size (); ++i)
+    for (int j = 0; j < 33; ++j)
+      EXPECT_NEAR (reference[(*second_indices)[i]].histogram[j], second[i].histogram[j], 1e-4);
+
+  // Other parameters clear the cache
+  fpfh_omp.setRadiusSearch (0.02);
+  fpfh_omp.setIndices (pcl::IndicesPtr (new pcl::Indices (1, 0)));
+  fpfh_omp.compute (first);
+  EXPECT_EQ (cache->find (static_cast<int> (cloud->size ()) - 1), nullptr);
+
+  // Without a cache, the signatures of a small set of indices are kept only for their neighbors
+  pcl::IndicesPtr few_indices (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud->size (); i += 10)
+    few_indices->push_back (static_cast<int> (i));
+  fpfh_omp.setCache (pcl::SPFHCache::Ptr ());
+  fpfh_omp.setRadiusSearch (0.01);
+  fpfh_omp.setIndices (few_indices);
+  fpfh_omp.compute (first);
+  ASSERT_EQ (few_indices->size (), first.size ());
+  for (std::size_t i = 0; i < first.size (); ++i)
+    for (int j = 0; j < 33; ++j)
+      EXPECT_NEAR (reference[(*few_indices)[i]].histogram[j], first[i].histogram[j], 1e-4);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, VFHEstimation)
 {
@@ -812,6 +812,42 @@ TEST (PCL, USCEstimation)
   testSHOTLocalReferenceFrame<UniqueShapeContext<PointXYZ, UniqueShapeContext1960>, PointXYZ, Normal, UniqueShapeContext1960> (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, USCEstimationParallel)
+{
+  float meshRes = 0.002f;
+  float radius = 20.0f * meshRes;
+
+  pcl::IndicesPtr test_indices (new pcl::Indices (0));
+  for (std::size_t i = 0; i < cloud.size (); i+=2)
+    test_indices->push_back (static_cast<int> (i));
+
+  UniqueShapeContext<PointXYZ, UniqueShapeContext1960> uscd;
+  uscd.setInputCloud (cloud.makeShared ());
+  uscd.setIndices (test_indices);
+  uscd.setSearchMethod (tree);
+  uscd.setRadiusSearch (radius);
+  uscd.setMinimalRadius (radius / 10.0f);
+  uscd.setPointDensityRadius (radius / 5.0f);
+  uscd.setLocalRadius (radius);
+
+  PointCloud<UniqueShapeContext1960> uscds, uscds_parallel;
+  uscd.compute (uscds);
+  // Every thread works on its own part of the reference frames, the result must be the same
+  uscd.setNumberOfThreads (4);
+  uscd.compute (uscds_parallel);
+
+  ASSERT_EQ (test_indices->size (), uscds_parallel.size ());
+  ASSERT_EQ (uscds.size (), uscds_parallel.size ());
+  for (std::size_t i = 0; i < uscds.size (); ++i)
+  {
+    for (int j = 0; j < 9; ++j)
+      ASSERT_EQ (uscds[i].rf[j], uscds_parallel[i].rf[j]);
+    for (int j = 0; j < 1960; ++j)
+      ASSERT_EQ (uscds[i].descriptor[j], uscds_parallel[i].descriptor[j]);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
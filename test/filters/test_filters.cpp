@@ -50,6 +50,8 @@
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/filters/voxel_grid_occlusion_estimation.h>
 #include <pcl/filters/voxel_grid_covariance.h>
+#include <pcl/filters/incremental_voxel_grid_covariance.h>
+#include <pcl/filters/streaming_voxel_grid.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/project_inliers.h>
 #include <pcl/filters/radius_outlier_removal.h>
@@ -1326,6 +1328,145 @@ TEST (VoxelGridCovariance, Filters)
   EXPECT_NEAR (leaves[2]->getMean ()[2], 0.0508024, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridCovariance, BatchedEigenSolver)
+{
+  // Leaves with (nearly) repeated eigen values: a flat disc, a line and an isotropic cross
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 36; ++i)
+  {
+    const float angle = static_cast<float> (i) * static_cast<float> (M_PI) / 18.0f;
+    const float noise = ((i % 3) - 1) * 1e-4f;
+    input->emplace_back (0.5f + 0.3f * std::cos (angle), 0.5f + 0.3f * std::sin (angle), 0.5f + noise);
+    input->emplace_back (1.1f + 0.02f * static_cast<float> (i), 0.5f + noise, 0.5f - noise);
+    input->emplace_back (2.5f + 0.2f * static_cast<float> (i % 2 == 0 ? 1 : -1), 0.5f, 0.5f + noise);
+    input->emplace_back (2.5f + noise, 0.5f + 0.2f * static_cast<float> (i % 2 == 0 ? 1 : -1), 0.5f);
+    input->emplace_back (2.5f, 0.5f - noise, 0.5f + 0.2f * static_cast<float> (i % 2 == 0 ? 1 : -1));
+  }
+
+  VoxelGridCovariance<PointXYZ> grid;
+  EXPECT_FALSE (grid.getUseBatchedEigenSolver ());
+  grid.setLeafSize (1.0f, 1.0f, 1.0f);
+  grid.setInputCloud (input);
+  PointCloud<PointXYZ> output;
+  grid.filter (output);
+  ASSERT_EQ (output.size (), 3);
+
+  VoxelGridCovariance<PointXYZ> batched_grid;
+  batched_grid.setUseBatchedEigenSolver (true);
+  batched_grid.setLeafSize (1.0f, 1.0f, 1.0f);
+  batched_grid.setInputCloud (input);
+  PointCloud<PointXYZ> batched_output;
+  batched_grid.filter (batched_output);
+  ASSERT_EQ (batched_output.size (), 3);
+
+  for (PointXYZ point : {PointXYZ (0.5f, 0.5f, 0.5f), PointXYZ (1.5f, 0.5f, 0.5f), PointXYZ (2.5f, 0.5f, 0.5f)})
+  {
+    const auto leaf = grid.getLeaf (point);
+    const auto batched_leaf = batched_grid.getLeaf (point);
+    ASSERT_NE (leaf, nullptr);
+    ASSERT_NE (batched_leaf, nullptr);
+
+    // The default is the double precision solver
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (leaf->getCov ());
+    EXPECT_TRUE (leaf->getEvals ().isApprox (solver.eigenvalues (), 1e-12));
+
+    // The eigen values agree, and the eigen vectors span the same eigen spaces
+    const double max_eval = leaf->getEvals ()[2];
+    for (int i = 0; i < 3; ++i)
+      EXPECT_NEAR (batched_leaf->getEvals ()[i], leaf->getEvals ()[i], 1e-5 * max_eval);
+    const Eigen::Matrix3d cov = leaf->getEvecs () * leaf->getEvals ().asDiagonal () * leaf->getEvecs ().transpose ();
+    const Eigen::Matrix3d batched_cov = batched_leaf->getEvecs () * batched_leaf->getEvals ().asDiagonal () * batched_leaf->getEvecs ().transpose ();
+    EXPECT_LT ((cov - batched_cov).norm (), 1e-5 * max_eval);
+    EXPECT_NEAR (std::abs (batched_leaf->getEvecs ().determinant ()), 1.0, 1e-5);
+    EXPECT_LT ((batched_leaf->getCov () - leaf->getCov ()).norm (), 1e-5 * max_eval);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (IncrementalVoxelGridCovariance, Filters)
+{
+  VoxelGridCovariance<PointXYZ> grid;
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  PointCloud<PointXYZ> output;
+  grid.filter (output, true);
+
+  IncrementalVoxelGridCovariance<PointXYZ> map (0.02f);
+  map.insert (*cloud);
+  EXPECT_EQ (map.getNumberOfPoints (), cloud->size ());
+  EXPECT_EQ (map.getCentroids ()->size (), output.size ());
+
+  // The distributions match the ones of the batch voxel grid
+  const auto leaf = map.getLeaf ((*cloud)[38]);
+  const auto reference = grid.getLeaf ((*cloud)[38]);
+  ASSERT_NE (leaf, nullptr);
+  ASSERT_NE (reference, nullptr);
+  EXPECT_EQ (leaf->getPointCount (), reference->getPointCount ());
+  EXPECT_TRUE (leaf->getMean ().isApprox (reference->getMean (), 1e-6));
+  EXPECT_TRUE (leaf->getCov ().isApprox (reference->getCov (), 1e-6));
+
+  std::vector<IncrementalVoxelGridCovariance<PointXYZ>::LeafConstPtr> leaves;
+  std::vector<float> distances;
+  map.radiusSearch (PointXYZ (0,0,0), 0.075, leaves, distances);
+  EXPECT_EQ (leaves.size (), 3);
+  for (std::size_t i = 0; i < leaves.size (); ++i)
+    EXPECT_NEAR (distances[i], leaves[i]->getMean ().squaredNorm (), 1e-6);
+
+  // Inserting and removing points updates the distributions in place
+  map.insert (*cloud);
+  EXPECT_EQ (map.getLeaf ((*cloud)[38])->getPointCount (), 2 * reference->getPointCount ());
+  map.remove (*cloud);
+  EXPECT_EQ (map.getNumberOfPoints (), cloud->size ());
+  EXPECT_TRUE (map.getLeaf ((*cloud)[38])->getMean ().isApprox (reference->getMean (), 1e-6));
+  EXPECT_TRUE (map.getLeaf ((*cloud)[38])->getCov ().isApprox (reference->getCov (), 1e-6));
+
+  // Evicting a region keeps the voxels inside of it
+  const std::size_t nr_voxels = map.getNumberOfVoxels ();
+  const std::size_t nr_removed = map.removeVoxelsOutside (Eigen::Vector3f (-1.0f, -1.0f, 0.0f), Eigen::Vector3f (1.0f, 1.0f, 1.0f));
+  EXPECT_GT (nr_removed, 0);
+  EXPECT_EQ (map.getNumberOfVoxels (), nr_voxels - nr_removed);
+  EXPECT_LT (map.getNumberOfPoints (), cloud->size ());
+  for (const auto &centroid : *map.getCentroids ())
+    EXPECT_GE (centroid.z, -0.02f);
+
+  map.remove (*cloud);
+  EXPECT_EQ (map.getNumberOfVoxels (), 0);
+  EXPECT_EQ (map.getNumberOfPoints (), 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (IncrementalVoxelGridCovariance_DistantVoxels, Filters)
+{
+  // Two voxels 2^21 voxels apart along x, which a key with 21 bits per axis would alias
+  PointCloud<PointXYZ> near_points, far_points;
+  for (const float dx : {0.25f, 0.75f})
+    for (const float dy : {0.25f, 0.75f})
+      for (const float dz : {0.25f, 0.75f})
+      {
+        near_points.emplace_back (dx, dy, dz);
+        far_points.emplace_back (2097152.0f + dx, dy, dz);
+      }
+
+  IncrementalVoxelGridCovariance<PointXYZ> map (1.0f);
+  map.insert (near_points);
+  map.insert (far_points);
+  EXPECT_EQ (map.getNumberOfVoxels (), 2);
+  for (const float x : {0.5f, 2097152.5f})
+  {
+    const auto leaf = map.getLeaf (PointXYZ (x, 0.5f, 0.5f));
+    ASSERT_NE (leaf, nullptr);
+    EXPECT_EQ (leaf->getPointCount (), 8);
+    EXPECT_NEAR (leaf->getMean ()[0], x, 1e-6);
+  }
+
+  map.remove (near_points);
+  EXPECT_EQ (map.getNumberOfVoxels (), 1);
+  EXPECT_EQ (map.getLeaf (PointXYZ (0.5f, 0.5f, 0.5f)), nullptr);
+  ASSERT_NE (map.getLeaf (PointXYZ (2097152.5f, 0.5f, 0.5f)), nullptr);
+  EXPECT_EQ (map.getLeaf (PointXYZ (2097152.5f, 0.5f, 0.5f))->getPointCount (), 8);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (VoxelGridMinPoints, Filters)
 {
@@ -1427,6 +1568,220 @@ TEST (VoxelGridMinPoints, Filters)
   EXPECT_NEAR (out_pc->at(0).y, outputMin6[0].y, 1e-4);
   EXPECT_NEAR (out_pc->at(0).z, outputMin6[0].z, 1e-4);
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGrid_Multithreaded, Filters)
+{
+  auto expect_near_clouds = [] (const PointCloud<PointXYZ> &a, const PointCloud<PointXYZ> &b, float tolerance)
+  {
+    ASSERT_EQ (a.size (), b.size ());
+    for (std::size_t i = 0; i < a.size (); ++i)
+    {
+      EXPECT_NEAR (a[i].x, b[i].x, tolerance);
+      EXPECT_NEAR (a[i].y, b[i].y, tolerance);
+      EXPECT_NEAR (a[i].z, b[i].z, tolerance);
+    }
+  };
+
+  // Test the PointCloud<PointT> method, with and without distance filtering
+  for (const bool filter : {false, true})
+  {
+    std::vector<PointCloud<PointXYZ> > outputs;
+    for (const unsigned int threads : {1, 2, 4})
+    {
+      VoxelGrid<PointXYZ> grid;
+      grid.setLeafSize (0.02f, 0.02f, 0.02f);
+      grid.setInputCloud (cloud);
+      grid.setSaveLeafLayout (true);
+      if (filter)
+      {
+        grid.setFilterFieldName ("z");
+        grid.setFilterLimits (0.05, 0.1);
+      }
+      grid.setNumberOfThreads (threads);
+      outputs.emplace_back ();
+      grid.filter (outputs.back ());
+
+      EXPECT_EQ (grid.getCentroidIndex (outputs.back ()[0]), 0);
+      EXPECT_EQ (grid.getCentroidIndex (outputs.back ().back ()), outputs.back ().size () - 1);
+    }
+    EXPECT_EQ (outputs[0].size (), filter ? 14 : 103);
+    expect_near_clouds (outputs[0], outputs[1], 1e-6f);
+    expect_near_clouds (outputs[1], outputs[2], 0.0f);
+  }
+
+  // Test the pcl::PCLPointCloud2 method
+  std::vector<PointCloud<PointXYZ> > outputs;
+  for (const unsigned int threads : {1, 4})
+  {
+    for (const bool downsample_all_data : {true, false})
+    {
+      PCLPointCloud2 output2;
+      VoxelGrid<PCLPointCloud2> grid2;
+      grid2.setLeafSize (0.02f, 0.02f, 0.02f);
+      grid2.setInputCloud (cloud_blob);
+      grid2.setDownsampleAllData (downsample_all_data);
+      grid2.setNumberOfThreads (threads);
+      grid2.filter (output2);
+
+      outputs.emplace_back ();
+      fromPCLPointCloud2 (output2, outputs.back ());
+    }
+  }
+  EXPECT_EQ (outputs[0].size (), 103);
+  expect_near_clouds (outputs[0], outputs[2], 1e-6f);
+  expect_near_clouds (outputs[1], outputs[3], 1e-6f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGrid_LargeCoordinates, Filters)
+{
+  // The voxel coordinates relative to the minimum (up to 2^25) are not exact in single precision
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  input->emplace_back (-16777215.0f, 0.0f, 0.0f);
+  for (const float x : {16777212.0f, 16777213.0f, 16777214.0f, 16777215.0f})
+    input->emplace_back (x, 0.0f, 0.0f);
+  PCLPointCloud2::Ptr input2 (new PCLPointCloud2);
+  toPCLPointCloud2 (*input, *input2);
+
+  for (const unsigned int threads : {1, 4})
+  {
+    PointCloud<PointXYZ> output;
+    VoxelGrid<PointXYZ> grid;
+    grid.setLeafSize (1.0f, 1.0f, 1.0f);
+    grid.setInputCloud (input);
+    grid.setNumberOfThreads (threads);
+    grid.filter (output);
+    ASSERT_EQ (output.size (), input->size ());
+    for (std::size_t i = 0; i < output.size (); ++i)
+      EXPECT_EQ (output[i].x, (*input)[i].x);
+
+    PCLPointCloud2 output2;
+    VoxelGrid<PCLPointCloud2> grid2;
+    grid2.setLeafSize (1.0f, 1.0f, 1.0f);
+    grid2.setInputCloud (input2);
+    grid2.setNumberOfThreads (threads);
+    grid2.filter (output2);
+    EXPECT_EQ (output2.width, input->size ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGrid_WideIndices, Filters)
+{
+  // The number of voxels (10^18) does not fit in 32 bit indices
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  input->emplace_back (0.0f, 0.0f, 0.0f);
+  input->emplace_back (0.0002f, 0.0f, 0.0f);
+  input->emplace_back (1000.0f, 1000.0f, 1000.0f);
+
+  PointCloud<PointXYZ> output;
+  VoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (0.001f, 0.001f, 0.001f);
+  grid.setInputCloud (input);
+  grid.filter (output);
+
+  ASSERT_EQ (output.size (), 2);
+  EXPECT_NEAR (output[0].x, 0.0001f, 1e-6);
+  EXPECT_NEAR (output[1].z, 1000.0f, 1e-3);
+
+  // Test the pcl::PCLPointCloud2 method
+  PCLPointCloud2::Ptr input2 (new PCLPointCloud2);
+  toPCLPointCloud2 (*input, *input2);
+  PCLPointCloud2 output2;
+  VoxelGrid<PCLPointCloud2> grid2;
+  grid2.setLeafSize (0.001f, 0.001f, 0.001f);
+  grid2.setInputCloud (input2);
+  grid2.filter (output2);
+
+  fromPCLPointCloud2 (output2, output);
+  ASSERT_EQ (output.size (), 2);
+  EXPECT_NEAR (output[0].x, 0.0001f, 1e-6);
+  EXPECT_NEAR (output[1].z, 1000.0f, 1e-3);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (StreamingVoxelGrid, Filters)
+{
+  auto sorted = [] (PointCloud<PointXYZ> points)
+  {
+    std::sort (points.begin (), points.end (), [] (const PointXYZ &a, const PointXYZ &b)
+    {
+      return (std::make_tuple (a.x, a.y, a.z) < std::make_tuple (b.x, b.y, b.z));
+    });
+    return (points);
+  };
+  auto expect_near_clouds = [] (const PointCloud<PointXYZ> &a, const PointCloud<PointXYZ> &b)
+  {
+    ASSERT_EQ (a.size (), b.size ());
+    for (std::size_t i = 0; i < a.size (); ++i)
+    {
+      EXPECT_NEAR (a[i].x, b[i].x, 1e-5);
+      EXPECT_NEAR (a[i].y, b[i].y, 1e-5);
+      EXPECT_NEAR (a[i].z, b[i].z, 1e-5);
+    }
+  };
+
+  // The voxels are the same as the ones of VoxelGrid
+  PointCloud<PointXYZ> expected;
+  VoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  grid.filter (expected);
+  expected = sorted (expected);
+
+  PointCloud<PointXYZ> output;
+  StreamingVoxelGrid<PointXYZ> streaming_grid;
+  streaming_grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  streaming_grid.setInputCloud (cloud);
+  streaming_grid.filter (output);
+  EXPECT_EQ (output.size (), 103);
+  EXPECT_EQ (output.width, 103);
+  EXPECT_EQ (output.height, 1);
+  EXPECT_TRUE (output.is_dense);
+  expect_near_clouds (expected, sorted (output));
+
+  // Add the points in chunks and emit the lower part of the cloud first
+  const std::size_t chunk_size = cloud->size () / 3 + 1;
+  for (std::size_t first = 0; first < cloud->size (); first += chunk_size)
+  {
+    Indices chunk;
+    for (std::size_t i = first; i < std::min (first + chunk_size, cloud->size ()); ++i)
+      chunk.push_back (static_cast<index_t> (i));
+    streaming_grid.addPointCloud (*cloud, chunk);
+  }
+  EXPECT_EQ (streaming_grid.getNumberOfPoints (), cloud->size ());
+  EXPECT_EQ (streaming_grid.getNumberOfVoxels (), 103);
+
+  PointCloud<PointXYZ> lower, upper;
+  const Eigen::Vector3f min_pt (-1.0f, 0.1f, -1.0f), max_pt (1.0f, 1.0f, 1.0f);
+  streaming_grid.flushVoxelsOutside (min_pt, max_pt, lower);
+  for (const auto &point : lower)
+    EXPECT_LT (point.y, 0.1f + 0.02f);
+  EXPECT_EQ (streaming_grid.flush (upper), 103 - lower.size ());
+  EXPECT_EQ (streaming_grid.getNumberOfVoxels (), 0);
+  EXPECT_EQ (streaming_grid.getNumberOfPoints (), 0);
+  expect_near_clouds (expected, sorted (lower + upper));
+
+  // Voxels with too few points are not emitted
+  streaming_grid.setMinimumPointsNumberPerVoxel (4);
+  streaming_grid.addPointCloud (*cloud);
+  grid.setMinimumPointsNumberPerVoxel (4);
+  grid.filter (expected);
+  streaming_grid.getCentroids (output);
+  EXPECT_EQ (output.size (), expected.size ());
+  EXPECT_EQ (streaming_grid.getNumberOfVoxels (), 103);
+
+  // Points whose voxel index would overflow an int are ignored
+  streaming_grid.clear ();
+  streaming_grid.setLeafSize (1e-6f, 1e-6f, 1e-6f);
+  streaming_grid.addPoint (PointXYZ (1e4f, 0.0f, 0.0f));
+  streaming_grid.addPoint (PointXYZ (0.0f, -1e4f, 0.0f));
+  streaming_grid.addPoint (PointXYZ (0.5f, 0.5f, 0.5f));
+  EXPECT_EQ (streaming_grid.getNumberOfPoints (), 1);
+  EXPECT_EQ (streaming_grid.getNumberOfVoxels (), 1);
+  EXPECT_EQ (streaming_grid.getNumberOfIgnoredPoints (), 2);
+}
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ProjectInliers, Filters)
 {
@@ -1648,6 +2003,51 @@ TEST (StatisticalOutlierRemoval, Filters)
   EXPECT_NEAR (output[output.size () - 1].z, -0.0444, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (OutlierRemoval, Multithreaded)
+{
+  // The radius filter uses a nearest-k search on dense clouds and a radius search otherwise
+  PointCloud<PointXYZ>::Ptr sparse_cloud (new PointCloud<PointXYZ> (*cloud));
+  sparse_cloud->is_dense = false;
+
+  for (const auto &input : {cloud, sparse_cloud})
+  {
+    for (const bool negative : {false, true})
+    {
+      std::vector<Indices> outputs, removed;
+      for (const unsigned int threads : {1, 4})
+      {
+        RadiusOutlierRemoval<PointXYZ> outrem (true);
+        outrem.setInputCloud (input);
+        outrem.setRadiusSearch (0.02);
+        outrem.setMinNeighborsInRadius (14);
+        outrem.setNegative (negative);
+        outrem.setNumberOfThreads (threads);
+        outputs.emplace_back ();
+        outrem.filter (outputs.back ());
+        removed.push_back (*outrem.getRemovedIndices ());
+
+        StatisticalOutlierRemoval<PointXYZ> sor (true);
+        sor.setInputCloud (input);
+        sor.setMeanK (50);
+        sor.setStddevMulThresh (1.0);
+        sor.setNegative (negative);
+        sor.setNumberOfThreads (threads);
+        outputs.emplace_back ();
+        sor.filter (outputs.back ());
+        removed.push_back (*sor.getRemovedIndices ());
+      }
+      EXPECT_EQ (negative ? cloud->size () - 307 : 307, outputs[0].size ());
+      EXPECT_EQ (negative ? cloud->size () - 352 : 352, outputs[1].size ());
+      for (std::size_t i = 0; i < 2; ++i)
+      {
+        EXPECT_EQ (outputs[i], outputs[i + 2]);
+        EXPECT_EQ (removed[i], removed[i + 2]);
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemoval, Filters)
 {
@@ -49,6 +49,7 @@
 #include <pcl/io/ascii_io.h>
 #include <pcl/io/obj_io.h>
 #include <fstream>
+#include <iterator>
 #include <locale>
 #include <stdexcept>
 
@@ -873,6 +874,215 @@ TEST (PCL, EmptyCloudToPCD)
                pcl::IOException);
   remove ("empty_cloud_compressed.pcd");
 }
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDCloudView)
+{
+  PointCloud<PointXYZI> cloud;
+  cloud.width  = 64;
+  cloud.height = 48;
+  cloud.resize (cloud.width * cloud.height);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    cloud[i].x = static_cast<float> (i);
+    cloud[i].y = static_cast<float> (i) * 0.5f;
+    cloud[i].z = -static_cast<float> (i);
+    cloud[i].intensity = static_cast<float> (i % 255);
+  }
+  pcl::PCLPointCloud2 cloud_blob;
+  toPCLPointCloud2 (cloud, cloud_blob);
+
+  PCDWriter writer;
+  writer.setAlignBinaryData (true);
+  const Eigen::Vector4f origin (1.0f, 2.0f, 3.0f, 0.0f);
+  writer.writeBinary ("test_pcl_io_view.pcd", cloud_blob, origin, Eigen::Quaternionf::Identity ());
+
+  // The typed writer pads the header in the same way, but drops the padding fields of PointXYZI
+  cloud.sensor_origin_ = origin;
+  writer.writeBinary ("test_pcl_io_view_packed.pcd", cloud);
+
+  PCDReader reader;
+  PCDCloudView view;
+  EXPECT_FALSE (view.isOpen ());
+  ASSERT_EQ (reader.read ("test_pcl_io_view.pcd", view), 0);
+  EXPECT_TRUE (view.isOpen ());
+  EXPECT_EQ (view.width (), cloud.width);
+  EXPECT_EQ (view.height (), cloud.height);
+  EXPECT_EQ (view.size (), cloud.size ());
+  EXPECT_TRUE (view.getHeader ().data.empty ());
+  EXPECT_EQ (view.getHeader ().point_step, sizeof (PointXYZI));
+  EXPECT_EQ (view.getOrigin (), origin);
+
+  // Lazy field accessors
+  const int intensity_idx = view.getFieldIndex ("intensity");
+  const int y_idx = view.getFieldIndex ("y");
+  ASSERT_GE (intensity_idx, 0);
+  ASSERT_GE (y_idx, 0);
+  EXPECT_EQ (view.getFieldIndex ("normal_x"), -1);
+  for (std::size_t i = 0; i < cloud.size (); i += 97)
+  {
+    EXPECT_EQ (view.getFieldValue<float> (i, intensity_idx), cloud[i].intensity);
+    EXPECT_EQ (view.getFieldValue<double> (i, y_idx), cloud[i].y);
+    EXPECT_EQ (view.getFieldValue<int> (i, intensity_idx), static_cast<int> (i % 255));
+  }
+
+  EXPECT_TRUE (view.isLayoutCompatible<PointXYZI> ());
+  EXPECT_FALSE (view.isLayoutCompatible<PointXYZ> ());
+  EXPECT_FALSE (view.isLayoutCompatible<PointNormal> ());
+  EXPECT_EQ (view.getPoints<PointXYZ> (), nullptr);
+
+  // Typed views, converting or not
+  PCDPointView<PointXYZI> view_xyzi (view);
+  // The writer aligns the binary data, so the points are used in place
+  EXPECT_EQ (reinterpret_cast<std::uintptr_t> (view.getData ()) % 32, 0);
+  EXPECT_TRUE (view_xyzi.isZeroCopy ());
+  EXPECT_NE (view.getPoints<PointXYZI> (), nullptr);
+  PCDPointView<PointXYZ> view_xyz (view);
+  EXPECT_FALSE (view_xyz.isZeroCopy ());
+  ASSERT_EQ (view_xyz.size (), cloud.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    const PointXYZI p = view_xyzi[i];
+    EXPECT_EQ (p.x, cloud[i].x);
+    EXPECT_EQ (p.y, cloud[i].y);
+    EXPECT_EQ (p.z, cloud[i].z);
+    EXPECT_EQ (p.intensity, cloud[i].intensity);
+    const PointXYZ q = view_xyz[i];
+    EXPECT_EQ (q.x, cloud[i].x);
+    EXPECT_EQ (q.y, cloud[i].y);
+    EXPECT_EQ (q.z, cloud[i].z);
+  }
+  EXPECT_EQ (view_xyz.at (5, 7).x, cloud.at (5, 7).x);
+
+  // The typed view keeps the mapping alive
+  view.close ();
+  EXPECT_FALSE (view.isOpen ());
+  EXPECT_EQ (view.size (), 0);
+  PointCloud<PointXYZ> cloud_xyz;
+  view_xyz.copyTo (cloud_xyz);
+  EXPECT_EQ (cloud_xyz.width, cloud.width);
+  EXPECT_EQ (cloud_xyz.height, cloud.height);
+  EXPECT_EQ (cloud_xyz.sensor_origin_, origin);
+  EXPECT_EQ (cloud_xyz.back ().z, cloud.back ().z);
+
+  // Aligned, but not layout compatible body written by the typed writer
+  ASSERT_EQ (loadPCDFile ("test_pcl_io_view_packed.pcd", view), 0);
+  EXPECT_EQ (reinterpret_cast<std::uintptr_t> (view.getData ()) % 32, 0);
+  EXPECT_EQ (view.getHeader ().point_step, 4 * sizeof (float));
+  EXPECT_FALSE (view.isLayoutCompatible<PointXYZI> ());
+  EXPECT_EQ (PCDPointView<PointXYZI> (view)[100].intensity, cloud[100].intensity);
+
+  // Zero copy access to the aligned body
+  ASSERT_EQ (loadPCDFile ("test_pcl_io_view.pcd", view), 0);
+  const PointXYZI *points = view.getPoints<PointXYZI> ();
+  ASSERT_NE (points, nullptr);
+  PCDPointView<PointXYZI> view_aligned (view);
+  EXPECT_TRUE (view_aligned.isZeroCopy ());
+  EXPECT_EQ (view_aligned.data (), points);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (points[i].x, cloud[i].x);
+    EXPECT_EQ (points[i].intensity, cloud[i].intensity);
+  }
+  PointCloud<PointXYZI> cloud_xyzi;
+  view_aligned.copyTo (cloud_xyzi);
+  ASSERT_EQ (cloud_xyzi.size (), cloud.size ());
+  EXPECT_EQ (cloud_xyzi[100].y, cloud[100].y);
+
+  // ASCII and compressed files cannot be mapped
+  writer.writeASCII ("test_pcl_io_view_ascii.pcd", cloud_blob);
+  writer.writeBinaryCompressed ("test_pcl_io_view_compressed.pcd", cloud_blob);
+  EXPECT_LT (reader.read ("test_pcl_io_view_ascii.pcd", view), 0);
+  EXPECT_FALSE (view.isOpen ());
+  EXPECT_LT (reader.read ("test_pcl_io_view_compressed.pcd", view), 0);
+  EXPECT_LT (reader.read ("test_pcl_io_view_missing.pcd", view), 0);
+
+  remove ("test_pcl_io_view.pcd");
+  remove ("test_pcl_io_view_packed.pcd");
+  remove ("test_pcl_io_view_ascii.pcd");
+  remove ("test_pcl_io_view_compressed.pcd");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDWriterAlignBinaryData)
+{
+  PointCloud<PointXYZI> cloud;
+  cloud.width  = 37;
+  cloud.height = 1;
+  cloud.resize (cloud.width);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    cloud[i].x = static_cast<float> (i);
+    cloud[i].y = static_cast<float> (i) * 0.25f;
+    cloud[i].z = -static_cast<float> (i);
+    cloud[i].intensity = static_cast<float> (i % 7);
+  }
+  const pcl::Indices indices {3, 5, 8, 13, 21};
+
+  // Returns the header of a binary file, up to the DATA line
+  const auto readHeader = [] (const std::string &file_name)
+  {
+    std::ifstream fs (file_name.c_str (), std::ios::binary);
+    const std::string contents ((std::istreambuf_iterator<char> (fs)), std::istreambuf_iterator<char> ());
+    const std::size_t data_line = contents.find ("DATA binary\n");
+    EXPECT_NE (data_line, std::string::npos);
+    return (contents.substr (0, data_line + 12));
+  };
+
+  // Not padded by default
+  PCDWriter writer;
+  EXPECT_FALSE (writer.getAlignBinaryData ());
+  writer.writeBinary ("test_pcl_io_unaligned.pcd", cloud);
+  EXPECT_EQ (readHeader ("test_pcl_io_unaligned.pcd").find ("\n#"), std::string::npos);
+
+  writer.setAlignBinaryData (true);
+  EXPECT_TRUE (writer.getAlignBinaryData ());
+  writer.writeBinary ("test_pcl_io_aligned.pcd", cloud);
+  writer.writeBinary ("test_pcl_io_aligned_indices.pcd", cloud, indices);
+  for (const std::string file_name : {"test_pcl_io_aligned.pcd", "test_pcl_io_aligned_indices.pcd"})
+  {
+    const std::string header = readHeader (file_name);
+    EXPECT_NE (header.find ("\n#"), std::string::npos);
+    EXPECT_EQ (header.size () % 32, 0);
+  }
+
+  // The padded files written by the typed writer read back like the unpadded one
+  for (const std::string file_name : {"test_pcl_io_unaligned.pcd", "test_pcl_io_aligned.pcd"})
+  {
+    PointCloud<PointXYZI> cloud_in;
+    ASSERT_EQ (loadPCDFile (file_name, cloud_in), 0);
+    ASSERT_EQ (cloud_in.size (), cloud.size ());
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+    {
+      EXPECT_EQ (cloud_in[i].x, cloud[i].x);
+      EXPECT_EQ (cloud_in[i].y, cloud[i].y);
+      EXPECT_EQ (cloud_in[i].z, cloud[i].z);
+      EXPECT_EQ (cloud_in[i].intensity, cloud[i].intensity);
+    }
+
+    PCDCloudView view;
+    ASSERT_EQ (loadPCDFile (file_name, view), 0);
+    ASSERT_EQ (view.size (), cloud.size ());
+    EXPECT_EQ (PCDPointView<PointXYZI> (view)[20].intensity, cloud[20].intensity);
+  }
+
+  PointCloud<PointXYZI> cloud_indices;
+  ASSERT_EQ (loadPCDFile ("test_pcl_io_aligned_indices.pcd", cloud_indices), 0);
+  ASSERT_EQ (cloud_indices.size (), indices.size ());
+  for (std::size_t i = 0; i < indices.size (); ++i)
+  {
+    EXPECT_EQ (cloud_indices[i].x, cloud[indices[i]].x);
+    EXPECT_EQ (cloud_indices[i].intensity, cloud[indices[i]].intensity);
+  }
+
+  PCDCloudView view;
+  ASSERT_EQ (loadPCDFile ("test_pcl_io_aligned.pcd", view), 0);
+  EXPECT_EQ (reinterpret_cast<std::uintptr_t> (view.getData ()) % 32, 0);
+
+  remove ("test_pcl_io_unaligned.pcd");
+  remove ("test_pcl_io_aligned.pcd");
+  remove ("test_pcl_io_aligned_indices.pcd");
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PCDReaderWriter)
 {
@@ -1515,6 +1725,211 @@ TEST (PCL, LZFInMem)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LZFChunked)
+{
+  PointCloud<PointXYZRGBNormal> cloud;
+  cloud.width  = 64;
+  cloud.height = 48;
+  cloud.resize (cloud.width * cloud.height);
+  cloud.is_dense = true;
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+  const auto nr_p = cloud.size ();
+  for (std::size_t i = 0; i < nr_p; ++i)
+  {
+    cloud[i].x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud[i].y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud[i].z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud[i].normal_x = 0.0f;
+    cloud[i].normal_y = 0.0f;
+    cloud[i].normal_z = 1.0f;
+    cloud[i].rgb = static_cast<float> (i % 16);
+  }
+
+  pcl::PCLPointCloud2 blob;
+  pcl::toPCLPointCloud2 (cloud, blob);
+
+  const auto expect_points = [&cloud] (const pcl::PCLPointCloud2 &blob2, std::size_t first_point)
+  {
+    PointCloud<PointXYZRGBNormal> cloud2;
+    pcl::fromPCLPointCloud2 (blob2, cloud2);
+    for (std::size_t i = 0; i < cloud2.size (); ++i)
+    {
+      const auto &p = cloud[first_point + i];
+      EXPECT_EQ (cloud2[i].x, p.x);
+      EXPECT_EQ (cloud2[i].y, p.y);
+      EXPECT_EQ (cloud2[i].z, p.z);
+      EXPECT_EQ (cloud2[i].normal_x, p.normal_x);
+      EXPECT_EQ (cloud2[i].normal_y, p.normal_y);
+      EXPECT_EQ (cloud2[i].normal_z, p.normal_z);
+      EXPECT_EQ (cloud2[i].rgb, p.rgb);
+    }
+  };
+
+  // Chunks which compress, and chunks of a single point which do not
+  for (const unsigned int chunk_size : {1000u, 1u})
+  {
+    std::ostringstream oss;
+    PCDWriter writer;
+    writer.setNumberOfThreads (2);
+    writer.setCompressionChunkSize (chunk_size);
+    int res = writer.writeBinaryCompressedChunked (oss, blob);
+    EXPECT_EQ (res, 0);
+    std::string pcd_str = oss.str ();
+
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    int pcd_version = -1;
+    int data_type = -1;
+    unsigned int data_idx = 0;
+    std::istringstream iss (pcd_str, std::ios::binary);
+    PCDReader reader;
+    reader.setNumberOfThreads (2);
+    pcl::PCLPointCloud2 blob2;
+    res = reader.readHeader (iss, blob2, origin, orientation, pcd_version, data_type, data_idx);
+    EXPECT_EQ (res, 0);
+    EXPECT_EQ (data_type, 3); // since it was written by writeBinaryCompressedChunked (), it should be chunked.
+
+    const auto *data = reinterpret_cast<const unsigned char *> (pcd_str.data ());
+    pcl::PCLPointCloud2 header = blob2;
+    res = reader.readBodyBinaryCompressedChunked (data, pcd_str.size (), blob2, data_idx);
+    EXPECT_EQ (res, 0);
+    EXPECT_EQ (blob2.width, blob.width);
+    EXPECT_EQ (blob2.height, blob.height);
+    EXPECT_EQ (bool (blob2.is_dense), cloud.is_dense);
+    expect_points (blob2, 0);
+
+    // Decompress only the chunks of a range of points
+    blob2 = header;
+    res = reader.readBodyBinaryCompressedChunked (data, pcd_str.size (), blob2, data_idx, 1500, 1234);
+    EXPECT_EQ (res, 0);
+    EXPECT_EQ (blob2.width, 1234);
+    EXPECT_EQ (blob2.height, 1);
+    expect_points (blob2, 1500);
+
+    // Truncated data
+    blob2 = header;
+    res = reader.readBodyBinaryCompressedChunked (data, pcd_str.size () - 1, blob2, data_idx);
+    EXPECT_LT (res, 0);
+  }
+
+  // Through a file
+  PCDWriter writer;
+  EXPECT_EQ (writer.writeBinaryCompressedChunked ("test_pcl_io_chunked.pcd", blob), 0);
+  PCDReader reader;
+  pcl::PCLPointCloud2 blob2;
+  EXPECT_EQ (reader.read ("test_pcl_io_chunked.pcd", blob2), 0);
+  EXPECT_EQ (blob2.width, blob.width);
+  EXPECT_EQ (blob2.height, blob.height);
+  expect_points (blob2, 0);
+  remove ("test_pcl_io_chunked.pcd");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDReadPartial)
+{
+  PointCloud<PointXYZRGBNormal> cloud;
+  cloud.width  = 40;
+  cloud.height = 25;
+  cloud.resize (cloud.width * cloud.height);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    cloud[i].x = static_cast<float> (i);
+    cloud[i].y = static_cast<float> (i) * 0.5f;
+    cloud[i].z = static_cast<float> (i) * -2.0f;
+    cloud[i].normal_x = 0.0f;
+    cloud[i].normal_y = 0.0f;
+    cloud[i].normal_z = 1.0f;
+    cloud[i].rgb = static_cast<float> (i % 16);
+    cloud[i].curvature = static_cast<float> (i) * 0.25f;
+  }
+  // A non finite normal, outside of the range read below
+  cloud[900].normal_x = std::numeric_limits<float>::quiet_NaN ();
+  cloud.is_dense = false;
+
+  const auto expect_fields = [&cloud] (const pcl::PCLPointCloud2 &blob, std::size_t first_point)
+  {
+    ASSERT_EQ (blob.fields.size (), 3);
+    EXPECT_EQ (blob.fields[0].name, "z");
+    EXPECT_EQ (blob.fields[0].offset, 0);
+    EXPECT_EQ (blob.fields[1].name, "x");
+    EXPECT_EQ (blob.fields[1].offset, 4);
+    EXPECT_EQ (blob.fields[2].name, "curvature");
+    EXPECT_EQ (blob.fields[2].offset, 8);
+    EXPECT_EQ (blob.point_step, 12);
+    ASSERT_EQ (blob.data.size (), std::size_t (blob.width) * blob.height * 12);
+    for (std::size_t i = 0; i < blob.width * blob.height; ++i)
+    {
+      float values[3];
+      memcpy (values, &blob.data[i * blob.point_step], sizeof (values));
+      EXPECT_EQ (values[0], cloud[first_point + i].z);
+      EXPECT_EQ (values[1], cloud[first_point + i].x);
+      EXPECT_EQ (values[2], cloud[first_point + i].curvature);
+    }
+  };
+
+  const std::string file_name = "test_pcl_io_partial.pcd";
+  const std::vector<std::string> field_names = {"z", "x", "curvature"};
+  for (int data_type = 0; data_type < 4; ++data_type)
+  {
+    PCDWriter writer;
+    writer.setCompressionChunkSize (128);
+    int res;
+    if (data_type == 0)
+      res = writer.writeASCII (file_name, cloud);
+    else if (data_type == 1)
+      res = writer.writeBinary (file_name, cloud);
+    else if (data_type == 2)
+      res = writer.writeBinaryCompressed (file_name, cloud);
+    else
+    {
+      pcl::PCLPointCloud2 blob;
+      pcl::toPCLPointCloud2 (cloud, blob);
+      res = writer.writeBinaryCompressedChunked (file_name, blob);
+    }
+    ASSERT_EQ (res, 0);
+
+    PCDReader reader;
+    pcl::PCLPointCloud2 blob;
+
+    // All the points of some fields keep the organization
+    EXPECT_EQ (reader.readPartial (file_name, blob, field_names), 0);
+    EXPECT_EQ (blob.width, cloud.width);
+    EXPECT_EQ (blob.height, cloud.height);
+    EXPECT_TRUE (blob.is_dense);
+    expect_fields (blob, 0);
+
+    // A range of points
+    EXPECT_EQ (reader.readPartial (file_name, blob, field_names, 123, 456), 0);
+    EXPECT_EQ (blob.width, 456);
+    EXPECT_EQ (blob.height, 1);
+    expect_fields (blob, 123);
+
+    // The range is clamped to the cloud
+    EXPECT_EQ (reader.readPartial (file_name, blob, field_names, 990, 100), 0);
+    EXPECT_EQ (blob.width, 10);
+    expect_fields (blob, 990);
+
+    // All the fields
+    EXPECT_EQ (reader.readPartial (file_name, blob, {}, 890, 20), 0);
+    EXPECT_FALSE (blob.is_dense);
+    PointCloud<PointXYZRGBNormal> cloud2;
+    pcl::fromPCLPointCloud2 (blob, cloud2);
+    ASSERT_EQ (cloud2.size (), 20);
+    for (std::size_t i = 0; i < cloud2.size (); ++i)
+    {
+      EXPECT_EQ (cloud2[i].y, cloud[890 + i].y);
+      EXPECT_EQ (cloud2[i].normal_z, cloud[890 + i].normal_z);
+      EXPECT_EQ (cloud2[i].rgb, cloud[890 + i].rgb);
+    }
+
+    // Unknown field
+    EXPECT_LT (reader.readPartial (file_name, blob, {"x", "intensity"}), 0);
+  }
+  remove (file_name.c_str ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, Locale)
 {
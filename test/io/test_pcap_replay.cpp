@@ -0,0 +1,425 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/io/hdl_grabber.h>
+#include <pcl/io/pcap_replay.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  void
+  appendBigEndian16 (std::vector<std::uint8_t> &buffer, std::uint16_t value)
+  {
+    buffer.push_back (static_cast<std::uint8_t> (value >> 8));
+    buffer.push_back (static_cast<std::uint8_t> (value & 0xff));
+  }
+
+  template <typename T> void
+  appendNative (std::vector<std::uint8_t> &buffer, T value)
+  {
+    const auto *bytes = reinterpret_cast<const std::uint8_t*> (&value);
+    buffer.insert (buffer.end (), bytes, bytes + sizeof (T));
+  }
+
+  /** \brief Write a pcap capture of Ethernet frames. */
+  class PcapWriter
+  {
+    public:
+      PcapWriter ()
+      {
+        appendNative<std::uint32_t> (file_, 0xa1b2c3d4);
+        appendNative<std::uint16_t> (file_, 2);
+        appendNative<std::uint16_t> (file_, 4);
+        appendNative<std::uint32_t> (file_, 0);
+        appendNative<std::uint32_t> (file_, 0);
+        appendNative<std::uint32_t> (file_, 65535);
+        appendNative<std::uint32_t> (file_, 1);   // Ethernet
+      }
+
+      /** \brief Add an IPv4 UDP packet sent by 192.168.1.<host>:<port>, captured at time <usec>. */
+      void
+      addUDP (std::uint64_t usec, std::uint8_t host, std::uint16_t port, const std::vector<std::uint8_t> &payload,
+              bool vlan = false, std::uint8_t protocol = 17, std::uint16_t fragment = 0)
+      {
+        std::vector<std::uint8_t> frame (12, 0);
+        if (vlan)
+        {
+          appendBigEndian16 (frame, 0x8100);
+          appendBigEndian16 (frame, 42);
+        }
+        appendBigEndian16 (frame, 0x0800);
+        // IPv4 header
+        frame.push_back (0x45);
+        frame.push_back (0);
+        appendBigEndian16 (frame, static_cast<std::uint16_t> (20 + 8 + payload.size ()));
+        appendBigEndian16 (frame, 0);
+        appendBigEndian16 (frame, fragment);
+        frame.push_back (64);
+        frame.push_back (protocol);
+        appendBigEndian16 (frame, 0);
+        frame.insert (frame.end (), {192, 168, 1, host, 192, 168, 1, 255});
+        // UDP header
+        appendBigEndian16 (frame, port);
+        appendBigEndian16 (frame, 2368);
+        appendBigEndian16 (frame, static_cast<std::uint16_t> (8 + payload.size ()));
+        appendBigEndian16 (frame, 0);
+        frame.insert (frame.end (), payload.begin (), payload.end ());
+
+        appendNative<std::uint32_t> (file_, static_cast<std::uint32_t> (usec / 1000000));
+        appendNative<std::uint32_t> (file_, static_cast<std::uint32_t> (usec % 1000000));
+        appendNative<std::uint32_t> (file_, static_cast<std::uint32_t> (frame.size ()));
+        appendNative<std::uint32_t> (file_, static_cast<std::uint32_t> (frame.size ()));
+        file_.insert (file_.end (), frame.begin (), frame.end ());
+      }
+
+      void
+      save (const std::string &file_name) const
+      {
+        std::ofstream fs (file_name.c_str (), std::ios::binary);
+        fs.write (reinterpret_cast<const char*> (file_.data ()), file_.size ());
+      }
+
+    private:
+      std::vector<std::uint8_t> file_;
+  };
+
+  /** \brief A Velodyne HDL-32 data packet with 12 firings of the given azimuths. */
+  std::vector<std::uint8_t>
+  makeHDLPacket (std::uint16_t first_azimuth, std::uint16_t azimuth_step)
+  {
+    std::vector<std::uint8_t> packet;
+    for (std::uint16_t i = 0; i < 12; ++i)
+    {
+      appendNative<std::uint16_t> (packet, 0xeeff);
+      appendNative<std::uint16_t> (packet, static_cast<std::uint16_t> ((first_azimuth + i * azimuth_step) % 36000));
+      for (std::uint16_t j = 0; j < 32; ++j)
+      {
+        appendNative<std::uint16_t> (packet, static_cast<std::uint16_t> (1000 + j));
+        packet.push_back (static_cast<std::uint8_t> (j));
+      }
+    }
+    appendNative<std::uint32_t> (packet, 0);
+    packet.push_back (0x37);
+    packet.push_back (0x21);
+    return (packet);
+  }
+
+  /** \brief Write a pcap capture of HDL-32 packets covering the given number of sweeps. */
+  void
+  writeHDLSweeps (const std::string &file_name, int nr_sweeps)
+  {
+    PcapWriter writer;
+    std::uint64_t usec = 0;
+    for (int sweep = 0; sweep < nr_sweeps; ++sweep)
+      for (std::uint16_t packet = 0; packet < 30; ++packet, usec += 500)
+        writer.addUDP (usec, 201, 2368, makeHDLPacket (static_cast<std::uint16_t> (packet * 1200), 100));
+    writer.save (file_name);
+  }
+
+  /** \brief Replay a pcap capture through the grabber and call back for every sweep. */
+  void
+  replayHDLSweeps (pcl::HDLGrabber &grabber,
+                   const std::function<void (const pcl::PointCloud<pcl::PointXYZI>::ConstPtr&)> &callback)
+  {
+    grabber.setPcapReplayRate (0);
+    grabber.registerCallback (callback);
+    grabber.start ();
+    for (int i = 0; i < 500 && grabber.isRunning (); ++i)
+      std::this_thread::sleep_for (std::chrono::milliseconds (10));
+    EXPECT_FALSE (grabber.isRunning ());
+    grabber.stop ();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+TEST (PcapReplay, Packets)
+{
+  PcapWriter writer;
+  writer.addUDP (1000000, 10, 443, {1, 2, 3});
+  writer.addUDP (1000100, 11, 444, {4, 5}, true);
+  writer.addUDP (1000200, 10, 443, {6}, false, 6);           // TCP
+  writer.addUDP (1000300, 10, 443, {7}, false, 17, 0x2000);  // fragment
+  writer.addUDP (1000400, 12, 445, {});
+  const std::string file_name = "test_pcap_replay_packets.pcap";
+  writer.save (file_name);
+
+  pcl::PcapReplay replay;
+  EXPECT_FALSE (replay.isOpen ());
+  ASSERT_EQ (0, replay.open (file_name));
+  EXPECT_TRUE (replay.isOpen ());
+  replay.setRate (0);
+
+  std::vector<std::vector<std::uint8_t> > payloads;
+  std::vector<std::uint64_t> timestamps;
+  std::vector<boost::asio::ip::udp::endpoint> sources;
+  const std::size_t nr_packets = replay.replay ([&] (const std::uint8_t *payload, std::size_t size, std::uint64_t timestamp,
+                                                     const boost::asio::ip::udp::endpoint &source)
+  {
+    payloads.emplace_back (payload, payload + size);
+    timestamps.push_back (timestamp);
+    sources.push_back (source);
+  });
+  replay.close ();
+  remove (file_name.c_str ());
+
+  ASSERT_EQ (3, nr_packets);
+  ASSERT_EQ (3, payloads.size ());
+  EXPECT_EQ ((std::vector<std::uint8_t> {1, 2, 3}), payloads[0]);
+  EXPECT_EQ ((std::vector<std::uint8_t> {4, 5}), payloads[1]);
+  EXPECT_TRUE (payloads[2].empty ());
+  EXPECT_EQ (1000000000ull, timestamps[0]);
+  EXPECT_EQ (1000100000ull, timestamps[1]);
+  EXPECT_EQ (1000400000ull, timestamps[2]);
+  EXPECT_EQ (boost::asio::ip::address::from_string ("192.168.1.10"), sources[0].address ());
+  EXPECT_EQ (443, sources[0].port ());
+  EXPECT_EQ (boost::asio::ip::address::from_string ("192.168.1.11"), sources[1].address ());
+  EXPECT_EQ (444, sources[1].port ());
+
+  EXPECT_EQ (-1, replay.open ("does_not_exist.pcap"));
+  EXPECT_FALSE (replay.isOpen ());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+TEST (PcapReplay, Rate)
+{
+  // 11 packets spanning 400 ms
+  PcapWriter writer;
+  for (std::uint64_t i = 0; i <= 10; ++i)
+    writer.addUDP (5000000 + i * 40000, 10, 443, {0});
+  const std::string file_name = "test_pcap_replay_rate.pcap";
+  writer.save (file_name);
+
+  pcl::PcapReplay replay;
+  const auto time_replay = [&] (double rate)
+  {
+    EXPECT_EQ (0, replay.open (file_name));
+    replay.setRate (rate);
+    const auto start = std::chrono::steady_clock::now ();
+    EXPECT_EQ (11, replay.replay ([] (const std::uint8_t*, std::size_t, std::uint64_t, const boost::asio::ip::udp::endpoint&) {}));
+    return (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ());
+  };
+
+  EXPECT_LT (time_replay (0), 0.1);
+  EXPECT_GE (time_replay (1), 0.4);
+  const double scaled = time_replay (4);
+  EXPECT_GE (scaled, 0.1);
+  EXPECT_LT (scaled, 0.4);
+
+  // Interrupted replay
+  ASSERT_EQ (0, replay.open (file_name));
+  replay.setRate (0.5);
+  std::thread stopper ([&replay] ()
+  {
+    std::this_thread::sleep_for (std::chrono::milliseconds (100));
+    replay.stop ();
+  });
+  const std::size_t nr_packets = replay.replay ([] (const std::uint8_t*, std::size_t, std::uint64_t, const boost::asio::ip::udp::endpoint&) {});
+  stopper.join ();
+  EXPECT_GT (nr_packets, 0);
+  EXPECT_LT (nr_packets, 11);
+
+  replay.close ();
+  remove (file_name.c_str ());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+TEST (PcapReplay, HDLGrabber)
+{
+  // 3 sweeps of 30 packets, and packets of another source
+  PcapWriter writer;
+  std::uint64_t usec = 0;
+  for (int sweep = 0; sweep < 3; ++sweep)
+  {
+    for (std::uint16_t packet = 0; packet < 30; ++packet, usec += 500)
+    {
+      writer.addUDP (usec, 201, 2368, makeHDLPacket (static_cast<std::uint16_t> (packet * 1200), 100));
+      writer.addUDP (usec + 1, 202, 2368, makeHDLPacket (0, 0));
+    }
+  }
+  const std::string file_name = "test_pcap_replay_hdl.pcap";
+  writer.save (file_name);
+
+  for (const std::size_t capacity : {std::size_t (0), std::size_t (4)})
+  {
+    pcl::HDLGrabber grabber ("", file_name);
+    grabber.filterPackets (boost::asio::ip::address::from_string ("192.168.1.201"), 2368);
+    grabber.setPcapReplayRate (0);
+    grabber.setLockFreeQueueCapacity (capacity);
+
+    std::atomic<int> nr_sweeps (0);
+    std::atomic<std::size_t> nr_points (0);
+    std::function<void (const pcl::PointCloud<pcl::PointXYZI>::ConstPtr&)> callback =
+      [&] (const pcl::PointCloud<pcl::PointXYZI>::ConstPtr &sweep)
+    {
+      ++nr_sweeps;
+      nr_points += sweep->size ();
+    };
+    grabber.registerCallback (callback);
+    grabber.start ();
+    for (int i = 0; i < 500 && grabber.isRunning (); ++i)
+      std::this_thread::sleep_for (std::chrono::milliseconds (10));
+    EXPECT_FALSE (grabber.isRunning ());
+    grabber.stop ();
+
+    // The last sweep is only sent once the next one starts
+    EXPECT_EQ (2, nr_sweeps);
+    EXPECT_EQ (2 * 30 * 12 * 32, nr_points);
+    EXPECT_EQ (0, grabber.getNumberOfDroppedPackets ());
+  }
+  remove (file_name.c_str ());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+TEST (HDLGrabber, DecodeSettings)
+{
+  const std::string file_name = "test_hdl_grabber_decode.pcap";
+  writeHDLSweeps (file_name, 4);
+
+  // Serial decoding through the default queue, fresh clouds
+  std::vector<pcl::PointCloud<pcl::PointXYZI> > expected;
+  {
+    pcl::HDLGrabber grabber ("", file_name);
+    grabber.setNumberOfThreads (1);
+    replayHDLSweeps (grabber, [&] (const pcl::PointCloud<pcl::PointXYZI>::ConstPtr &sweep)
+    {
+      expected.push_back (*sweep);
+    });
+  }
+  ASSERT_EQ (3, expected.size ());
+
+  // The lock-free ring, the parallel decoding and the recycled clouds give the same sweeps
+  for (const std::size_t capacity : {std::size_t (0), std::size_t (8)})
+  {
+    for (const unsigned int nr_threads : {1u, 4u})
+    {
+      for (const bool recycle : {false, true})
+      {
+        pcl::HDLGrabber grabber ("", file_name);
+        grabber.setLockFreeQueueCapacity (capacity);
+        grabber.setNumberOfThreads (nr_threads);
+        grabber.setCloudRecycling (recycle);
+        EXPECT_EQ (capacity, grabber.getLockFreeQueueCapacity ());
+        EXPECT_EQ (recycle, grabber.getCloudRecycling ());
+
+        std::vector<pcl::PointCloud<pcl::PointXYZI> > sweeps;
+        replayHDLSweeps (grabber, [&] (const pcl::PointCloud<pcl::PointXYZI>::ConstPtr &sweep)
+        {
+          sweeps.push_back (*sweep);
+        });
+        EXPECT_EQ (0, grabber.getNumberOfDroppedPackets ());
+
+        ASSERT_EQ (expected.size (), sweeps.size ());
+        for (std::size_t i = 0; i < sweeps.size (); ++i)
+        {
+          ASSERT_EQ (expected[i].size (), sweeps[i].size ());
+          for (std::size_t j = 0; j < sweeps[i].size (); ++j)
+          {
+            EXPECT_EQ (expected[i][j].x, sweeps[i][j].x);
+            EXPECT_EQ (expected[i][j].y, sweeps[i][j].y);
+            EXPECT_EQ (expected[i][j].z, sweeps[i][j].z);
+            EXPECT_EQ (expected[i][j].intensity, sweeps[i][j].intensity);
+          }
+        }
+      }
+    }
+  }
+  remove (file_name.c_str ());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+TEST (HDLGrabber, CloudRecycling)
+{
+  const std::string file_name = "test_hdl_grabber_recycling.pcap";
+  writeHDLSweeps (file_name, 6);
+
+  pcl::PointCloud<pcl::PointXYZI>::ConstPtr kept;
+  pcl::PointCloud<pcl::PointXYZI> kept_copy;
+  {
+    pcl::HDLGrabber grabber ("", file_name);
+    EXPECT_FALSE (grabber.getCloudRecycling ());
+    grabber.setCloudRecycling (true);
+
+    // The first sweep is kept by the slot, the others are released right away
+    std::vector<const pcl::PointCloud<pcl::PointXYZI>*> clouds;
+    replayHDLSweeps (grabber, [&] (const pcl::PointCloud<pcl::PointXYZI>::ConstPtr &sweep)
+    {
+      if (!kept)
+      {
+        kept = sweep;
+        kept_copy = *sweep;
+      }
+      clouds.push_back (sweep.get ());
+    });
+    ASSERT_EQ (5, clouds.size ());
+
+    // A released cloud is handed out again, the kept one is not
+    for (std::size_t i = 1; i < clouds.size (); ++i)
+      EXPECT_NE (clouds[0], clouds[i]);
+    EXPECT_EQ (clouds[1], clouds[3]);
+    EXPECT_EQ (clouds[2], clouds[4]);
+  }
+
+  // The kept sweep is left untouched, and can be released after the grabber is gone
+  ASSERT_EQ (kept_copy.size (), kept->size ());
+  EXPECT_EQ (kept_copy.header.seq, kept->header.seq);
+  for (std::size_t i = 0; i < kept->size (); ++i)
+  {
+    EXPECT_EQ (kept_copy[i].x, (*kept)[i].x);
+    EXPECT_EQ (kept_copy[i].intensity, (*kept)[i].intensity);
+  }
+  kept.reset ();
+  remove (file_name.c_str ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
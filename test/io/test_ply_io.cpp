@@ -35,6 +35,7 @@
  *
  */
 #include <pcl/common/io.h>
+#include <pcl/common/pcl_filesystem.h>
 #include <pcl/io/ply_io.h>
 #include <pcl/conversions.h>
 #include <pcl/PolygonMesh.h>
@@ -42,7 +43,9 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <pcl/test/gtest.h>
+#include <algorithm> // for reverse
 #include <fstream> // for ofstream
+#include <limits>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PLYReaderWriter)
@@ -625,6 +628,163 @@ TEST_F (PLYTest, Float64Cloud)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T> void
+writeBinaryValue (std::ofstream &fs, T value, bool swap)
+{
+  char bytes[sizeof (T)];
+  memcpy (bytes, &value, sizeof (T));
+  if (swap)
+    std::reverse (bytes, bytes + sizeof (T));
+  fs.write (bytes, sizeof (T));
+}
+
+void
+expectSameCloud (const pcl::PCLPointCloud2 &cloud, const pcl::PCLPointCloud2 &expected)
+{
+  EXPECT_EQ (cloud.width, expected.width);
+  EXPECT_EQ (cloud.height, expected.height);
+  EXPECT_EQ (cloud.point_step, expected.point_step);
+  EXPECT_EQ (cloud.row_step, expected.row_step);
+  EXPECT_EQ (cloud.is_dense, expected.is_dense);
+  ASSERT_EQ (cloud.fields.size (), expected.fields.size ());
+  for (std::size_t i = 0; i < cloud.fields.size (); ++i)
+  {
+    EXPECT_EQ (cloud.fields[i].name, expected.fields[i].name);
+    EXPECT_EQ (cloud.fields[i].offset, expected.fields[i].offset);
+    EXPECT_EQ (cloud.fields[i].datatype, expected.fields[i].datatype);
+    EXPECT_EQ (cloud.fields[i].count, expected.fields[i].count);
+  }
+  EXPECT_TRUE (cloud.data == expected.data);
+}
+
+TEST_F (PLYTest, BinaryFastPath)
+{
+  for (const bool big_endian : {false, true})
+  {
+    const bool swap = big_endian != (pcl::io::ply::host_byte_order == pcl::io::ply::big_endian_byte_order);
+    std::ofstream fs;
+    fs.open (mesh_file_ply_.c_str (), std::ios::binary);
+    fs << "ply\n"
+          "format " << (big_endian ? "binary_big_endian" : "binary_little_endian") << " 1.0\n"
+          "comment PCL test\n"
+          "element vertex 6\n"
+          "property float x\n"
+          "property double y\n"
+          "property uchar red\n"
+          "property uchar green\n"
+          "property uchar blue\n"
+          "property uchar alpha\n"
+          "property uchar intensity\n"
+          "property short s\n"
+          "property int i\n"
+          "property float nx\n"
+          "element face 0\n"
+          "property list uchar int vertex_indices\n"
+          "element camera 1\n"
+          "property float view_px\n"
+          "property float view_py\n"
+          "property float view_pz\n"
+          "property int viewportx\n"
+          "property int viewporty\n"
+          "end_header\n";
+    for (int i = 0; i < 6; ++i)
+    {
+      writeBinaryValue (fs, 0.5f * static_cast<float> (i), swap);
+      writeBinaryValue (fs, -0.25 * i, swap);
+      writeBinaryValue (fs, static_cast<std::uint8_t> (10 * i), swap);
+      writeBinaryValue (fs, static_cast<std::uint8_t> (20 * i), swap);
+      writeBinaryValue (fs, static_cast<std::uint8_t> (30 * i), swap);
+      writeBinaryValue (fs, static_cast<std::uint8_t> (200 + i), swap);
+      writeBinaryValue (fs, static_cast<std::uint8_t> (7 * i), swap);
+      writeBinaryValue (fs, static_cast<std::int16_t> (-100 * i), swap);
+      writeBinaryValue (fs, static_cast<std::int32_t> (100000 * i), swap);
+      writeBinaryValue (fs, i == 3 ? std::numeric_limits<float>::quiet_NaN () : 0.1f * static_cast<float> (i), swap);
+    }
+    writeBinaryValue (fs, 1.0f, swap);
+    writeBinaryValue (fs, 2.0f, swap);
+    writeBinaryValue (fs, 3.0f, swap);
+    writeBinaryValue (fs, std::int32_t (3), swap);
+    writeBinaryValue (fs, std::int32_t (2), swap);
+    fs.close ();
+
+    pcl::PLYReader reader;
+    pcl::PCLPointCloud2 expected, cloud;
+    Eigen::Vector4f expected_origin, origin;
+    Eigen::Quaternionf expected_orientation, orientation;
+    int ply_version;
+    reader.setBinaryFastPath (false);
+    ASSERT_EQ (reader.read (mesh_file_ply_, expected, expected_origin, expected_orientation, ply_version), 0);
+    reader.setBinaryFastPath (true);
+    ASSERT_EQ (reader.read (mesh_file_ply_, cloud, origin, orientation, ply_version), 0);
+    expectSameCloud (cloud, expected);
+    EXPECT_EQ (origin, expected_origin);
+    EXPECT_EQ (origin, Eigen::Vector4f (1.0f, 2.0f, 3.0f, 0.0f));
+
+    EXPECT_EQ (cloud.width, 3);
+    EXPECT_EQ (cloud.height, 2);
+    EXPECT_FALSE (cloud.is_dense);
+    std::uint32_t rgba;
+    memcpy (&rgba, &cloud.data[cloud.point_step + cloud.fields[pcl::getFieldIndex (cloud, "rgba")].offset], sizeof (rgba));
+    EXPECT_EQ (rgba, (201u << 24) | (10u << 16) | (20u << 8) | 30u);
+    float intensity;
+    memcpy (&intensity, &cloud.data[2 * cloud.point_step + cloud.fields[pcl::getFieldIndex (cloud, "intensity")].offset], sizeof (intensity));
+    EXPECT_EQ (intensity, 14.0f);
+    EXPECT_NE (pcl::getFieldIndex (cloud, "normal_x"), -1);
+
+    reader.setMemoryMapping (true);
+    ASSERT_EQ (reader.read (mesh_file_ply_, cloud, origin, orientation, ply_version), 0);
+    expectSameCloud (cloud, expected);
+    reader.setMemoryMapping (false);
+
+    // Chunks concatenate to the whole cloud
+    pcl::PCLPointCloud2 chunks;
+    std::vector<std::size_t> first_points;
+    ASSERT_EQ (reader.readChunks (mesh_file_ply_, 4, [&] (const pcl::PCLPointCloud2 &chunk, std::size_t first_point)
+    {
+      EXPECT_EQ (chunk.height, 1);
+      EXPECT_EQ (chunk.fields.size (), expected.fields.size ());
+      first_points.push_back (first_point);
+      chunks.data.insert (chunks.data.end (), chunk.data.begin (), chunk.data.end ());
+      return (true);
+    }), 0);
+    EXPECT_EQ (first_points, std::vector<std::size_t> ({0, 4}));
+    EXPECT_TRUE (chunks.data == expected.data);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, BinaryFastPathPCLFile)
+{
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  cloud.width = 4;
+  cloud.height = 3;
+  for (std::size_t i = 0; i < 12; ++i)
+    cloud.push_back (pcl::PointXYZ (static_cast<float> (i), 2.0f * static_cast<float> (i), -1.0f));
+  cloud.width = 4;
+  cloud.height = 3;
+  pcl::PLYWriter writer;
+  ASSERT_EQ (writer.write (mesh_file_ply_, cloud, true, true), 0);
+
+  pcl::PLYReader reader;
+  pcl::PCLPointCloud2 expected, blob;
+  reader.setBinaryFastPath (false);
+  ASSERT_EQ (reader.read (mesh_file_ply_, expected), 0);
+  reader.setBinaryFastPath (true);
+  ASSERT_EQ (reader.read (mesh_file_ply_, blob), 0);
+  expectSameCloud (blob, expected);
+  EXPECT_EQ (blob.width, 4);
+  EXPECT_EQ (blob.height, 3);
+  EXPECT_TRUE (blob.is_dense);
+
+  // Truncated data
+  const auto file_size = pcl_fs::file_size (mesh_file_ply_);
+  pcl_fs::resize_file (mesh_file_ply_, file_size - 120);
+  EXPECT_LT (reader.read (mesh_file_ply_, blob), 0);
+  reader.setMemoryMapping (true);
+  EXPECT_LT (reader.read (mesh_file_ply_, blob), 0);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -0,0 +1,125 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/io/impl/spsc_queue.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////
+TEST (SPSCQueue, SingleThread)
+{
+  pcl::SPSCQueue<int> queue (5);
+  EXPECT_EQ (8, queue.capacity ());
+  EXPECT_TRUE (queue.isEmpty ());
+
+  int value;
+  EXPECT_FALSE (queue.pop (value));
+  for (int i = 0; i < 8; ++i)
+    EXPECT_TRUE (queue.push (i));
+  EXPECT_FALSE (queue.push (8));
+  EXPECT_EQ (8, queue.size ());
+
+  // Wrap around the end of the ring a few times
+  for (int i = 0; i < 20; ++i)
+  {
+    ASSERT_TRUE (queue.pop (value));
+    EXPECT_EQ (i, value);
+    EXPECT_TRUE (queue.push (i + 8));
+  }
+  EXPECT_EQ (8, queue.size ());
+
+  int *slot = queue.getReadSlot ();
+  ASSERT_NE (nullptr, slot);
+  EXPECT_EQ (20, *slot);
+  queue.release ();
+  slot = queue.getWriteSlot ();
+  ASSERT_NE (nullptr, slot);
+  *slot = 42;
+  queue.publish ();
+  for (int i = 21; i < 28; ++i)
+  {
+    ASSERT_TRUE (queue.pop (value));
+    EXPECT_EQ (i, value);
+  }
+  ASSERT_TRUE (queue.pop (value));
+  EXPECT_EQ (42, value);
+  EXPECT_TRUE (queue.isEmpty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+TEST (SPSCQueue, ProducerConsumer)
+{
+  const std::uint32_t nr_elements = 1000000;
+  pcl::SPSCQueue<std::uint32_t> queue (64);
+
+  std::thread producer ([&queue, nr_elements] ()
+  {
+    for (std::uint32_t i = 0; i < nr_elements; ++i)
+      while (!queue.push (i))
+        std::this_thread::yield ();
+  });
+
+  std::uint32_t expected = 0;
+  bool in_order = true;
+  while (expected < nr_elements)
+  {
+    std::uint32_t value;
+    if (!queue.pop (value))
+    {
+      std::this_thread::yield ();
+      continue;
+    }
+    in_order &= (value == expected);
+    ++expected;
+  }
+  producer.join ();
+
+  EXPECT_TRUE (in_order);
+  EXPECT_TRUE (queue.isEmpty ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
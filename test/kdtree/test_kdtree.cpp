@@ -37,6 +37,7 @@
  */
 
 #include <pcl/kdtree/impl/kdtree_flann.hpp>
+#include <pcl/kdtree/impl/kdtree_3d.hpp>
 
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
@@ -52,6 +53,8 @@
 #include <algorithm>
 #include <iostream>  // For debug
 #include <map>
+#include <random>
+#include <set>
 
 using namespace pcl;
 
@@ -327,6 +330,125 @@ TEST (PCL, KdTreeFLANN_32_vs_64_bit)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTree3D_radiusSearch)
+{
+  KdTree3D<MyPoint> kdtree;
+  kdtree.setInputCloud (cloud.makeShared ());
+  MyPoint test_point (0.0f, 0.0f, 0.0f);
+  double max_dist = 0.15;
+  std::multimap<float, int> brute_force_result;
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    if (squaredEuclideanDistance (cloud[i], test_point) < max_dist * max_dist)
+      brute_force_result.insert (std::make_pair (squaredEuclideanDistance (cloud[i], test_point), static_cast<int> (i)));
+
+  pcl::Indices k_indices;
+  std::vector<float> k_distances;
+  EXPECT_EQ (brute_force_result.size (), kdtree.radiusSearch (test_point, max_dist, k_indices, k_distances));
+  ASSERT_EQ (brute_force_result.size (), k_indices.size ());
+  ASSERT_EQ (brute_force_result.size (), k_distances.size ());
+  auto it = brute_force_result.cbegin ();
+  for (std::size_t i = 0; i < k_indices.size (); ++i, ++it)
+  {
+    EXPECT_NEAR (it->first, k_distances[i], 1e-6);
+    EXPECT_NEAR (it->first, squaredEuclideanDistance (cloud[k_indices[i]], test_point), 1e-6);
+  }
+
+  // With max_nn set, the closest max_nn points are returned
+  EXPECT_EQ (3, kdtree.radiusSearch (test_point, max_dist, k_indices, k_distances, 3));
+  it = brute_force_result.cbegin ();
+  for (std::size_t i = 0; i < k_indices.size (); ++i, ++it)
+    EXPECT_NEAR (it->first, k_distances[i], 1e-6);
+
+  // Unsorted results hold the same points
+  kdtree.setSortedResults (false);
+  kdtree.radiusSearch (test_point, max_dist, k_indices, k_distances);
+  std::set<int> found (k_indices.cbegin (), k_indices.cend ());
+  EXPECT_EQ (brute_force_result.size (), found.size ());
+  for (const auto &result : brute_force_result)
+    EXPECT_EQ (1, found.count (result.second));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTree3D_nearestKSearch)
+{
+  PointCloud<MyPoint>::Ptr random_cloud (new PointCloud<MyPoint> ());
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> distribution (0.0f, 1024.0f);
+  for (std::size_t i = 0; i < 20000; ++i)
+    random_cloud->emplace_back (distribution (rng), distribution (rng), distribution (rng));
+
+  KdTree3D<MyPoint> kdtree;
+  kdtree.setInputCloud (random_cloud);
+  const unsigned int no_of_neighbors = 20;
+
+  pcl::Indices k_indices;
+  std::vector<float> k_distances;
+  std::vector<float> brute_force_distances (random_cloud->size ());
+  for (std::size_t q = 0; q < random_cloud->size (); q += 97)
+  {
+    // Query points in between the points of the cloud
+    const MyPoint test_point ((*random_cloud)[q].x + 0.5f, (*random_cloud)[q].y - 0.5f, (*random_cloud)[q].z);
+    for (std::size_t i = 0; i < random_cloud->size (); ++i)
+      brute_force_distances[i] = squaredEuclideanDistance ((*random_cloud)[i], test_point);
+    std::partial_sort (brute_force_distances.begin (), brute_force_distances.begin () + no_of_neighbors, brute_force_distances.end ());
+
+    ASSERT_EQ (no_of_neighbors, kdtree.nearestKSearch (test_point, no_of_neighbors, k_indices, k_distances));
+    for (std::size_t i = 0; i < no_of_neighbors; ++i)
+    {
+      EXPECT_FLOAT_EQ (brute_force_distances[i], k_distances[i]);
+      EXPECT_FLOAT_EQ (k_distances[i], squaredEuclideanDistance ((*random_cloud)[k_indices[i]], test_point));
+    }
+  }
+
+  // Asking for more neighbors than points returns all of them
+  KdTree3D<MyPoint> kdtree_small;
+  kdtree_small.setInputCloud (cloud.makeShared ());
+  EXPECT_EQ (cloud.size (), kdtree_small.nearestKSearch (cloud[0], cloud.size () + 10, k_indices, k_distances));
+  EXPECT_EQ (cloud.size (), std::set<int> (k_indices.cbegin (), k_indices.cend ()).size ());
+
+  ScopeTime scopeTime ("KdTree3D nearestKSearch");
+  {
+    for (const auto &point : random_cloud->points)
+      kdtree.nearestKSearch (point, no_of_neighbors, k_indices, k_distances);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTree3D_indices)
+{
+  // Invalid points are skipped and the returned indices refer to the input cloud
+  shared_ptr<pcl::Indices> indices (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud_in->size (); i += 2)
+    indices->push_back (static_cast<int> (i));
+
+  KdTree3D<PointXYZ> tree;
+  tree.setInputCloud (cloud_in, indices);
+  KdTreeFLANN<PointXYZ> flann_tree;
+  flann_tree.setInputCloud (cloud_in, indices);
+
+  pcl::Indices nn_indices, flann_nn_indices;
+  std::vector<float> nn_dists, flann_nn_dists;
+  for (std::size_t i = 0; i < cloud_in->size (); i += 7)
+  {
+    if (!isFinite ((*cloud_in)[i]))
+      continue;
+    tree.radiusSearch ((*cloud_in)[i], 0.02, nn_indices, nn_dists);
+    flann_tree.radiusSearch ((*cloud_in)[i], 0.02, flann_nn_indices, flann_nn_dists);
+    ASSERT_EQ (flann_nn_indices.size (), nn_indices.size ());
+    for (std::size_t j = 0; j < nn_indices.size (); ++j)
+    {
+      EXPECT_EQ (0, nn_indices[j] % 2);
+      EXPECT_NEAR (flann_nn_dists[j], nn_dists[j], 1e-6);
+    }
+
+    tree.nearestKSearch ((*cloud_in)[i], 5, nn_indices, nn_dists);
+    flann_tree.nearestKSearch ((*cloud_in)[i], 5, flann_nn_indices, flann_nn_dists);
+    for (std::size_t j = 0; j < nn_indices.size (); ++j)
+      EXPECT_NEAR (flann_nn_dists[j], nn_dists[j], 1e-6);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -38,6 +38,8 @@
  */
 #include <pcl/test/gtest.h>
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include <pcl/common/time.h>
@@ -1645,6 +1647,287 @@ TEST (PCL, Octree_Pointcloud_Bounds)
     ASSERT_DOUBLE_EQ (min_x2, min_x);
     ASSERT_DOUBLE_EQ (max_x2, max_x);
 }
+
+TEST (PCL, Octree_Pointcloud_Bulk_Build)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> ());
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (std::size_t i = 0; i < 50000; i++)
+  {
+    // clusters of points sharing voxels, and a few invalid points
+    if (i % 1000 == 0)
+      cloud->push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+    else
+      cloud->push_back (PointXYZ (static_cast<float> (rand () % 100) / 10.0f + 0.01f * static_cast<float> (rand ()) / RAND_MAX,
+                                  static_cast<float> (rand () % 100) / 10.0f,
+                                  static_cast<float> (rand () % 50) / 10.0f));
+  }
+  OctreePointCloudSearch<PointXYZ>::IndicesPtr indices (new Indices);
+  for (index_t i = 0; i < static_cast<index_t> (cloud->size ()); i += 3)
+    indices->push_back (i);
+
+  const auto leafIndices = [] (const OctreePointCloudSearch<PointXYZ>& octree)
+  {
+    std::vector<Indices> leaves;
+    for (auto it = octree.leaf_depth_begin (); it != octree.leaf_depth_end (); ++it)
+    {
+      leaves.emplace_back ();
+      it.getLeafContainer ().getPointIndices (leaves.back ());
+    }
+    return leaves;
+  };
+
+  for (const bool use_indices : {false, true})
+  {
+    OctreePointCloudSearch<PointXYZ> octree (0.05);
+    octree.setInputCloud (cloud, use_indices ? indices : OctreePointCloudSearch<PointXYZ>::IndicesPtr ());
+    octree.defineBoundingBox ();
+    octree.addPointsFromInputCloud ();
+
+    for (const unsigned int nr_threads : {1u, 4u})
+    {
+      OctreePointCloudSearch<PointXYZ> octree_bulk (0.05);
+      octree_bulk.setBulkBuild (true);
+      octree_bulk.setNumberOfThreads (nr_threads);
+      octree_bulk.setInputCloud (cloud, use_indices ? indices : OctreePointCloudSearch<PointXYZ>::IndicesPtr ());
+      octree_bulk.addPointsFromInputCloud ();
+
+      EXPECT_EQ (octree.getTreeDepth (), octree_bulk.getTreeDepth ());
+      EXPECT_EQ (octree.getLeafCount (), octree_bulk.getLeafCount ());
+      EXPECT_EQ (octree.getBranchCount (), octree_bulk.getBranchCount ());
+      EXPECT_EQ (leafIndices (octree), leafIndices (octree_bulk));
+
+      Indices k_indices, k_indices_bulk;
+      std::vector<float> k_distances, k_distances_bulk;
+      octree.nearestKSearch ((*cloud)[17], 10, k_indices, k_distances);
+      octree_bulk.nearestKSearch ((*cloud)[17], 10, k_indices_bulk, k_distances_bulk);
+      EXPECT_EQ (k_distances, k_distances_bulk);
+    }
+  }
+
+  // A bounding box too small for the points: they are inserted one by one
+  {
+    OctreePointCloudSearch<PointXYZ> octree (0.05);
+    octree.setInputCloud (cloud);
+    octree.defineBoundingBox (0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+    octree.addPointsFromInputCloud ();
+
+    OctreePointCloudSearch<PointXYZ> octree_bulk (0.05);
+    octree_bulk.setBulkBuild (true);
+    octree_bulk.setInputCloud (cloud);
+    octree_bulk.defineBoundingBox (0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+    octree_bulk.addPointsFromInputCloud ();
+
+    EXPECT_EQ (octree.getTreeDepth (), octree_bulk.getTreeDepth ());
+    EXPECT_EQ (octree.getLeafCount (), octree_bulk.getLeafCount ());
+    EXPECT_EQ (leafIndices (octree), leafIndices (octree_bulk));
+  }
+
+  // Voxel centroids
+  {
+    OctreePointCloudVoxelCentroid<PointXYZ> octree (0.1);
+    octree.setInputCloud (cloud);
+    octree.defineBoundingBox ();
+    octree.addPointsFromInputCloud ();
+
+    OctreePointCloudVoxelCentroid<PointXYZ> octree_bulk (0.1);
+    octree_bulk.setBulkBuild (true);
+    octree_bulk.setNumberOfThreads (4);
+    octree_bulk.setInputCloud (cloud);
+    octree_bulk.addPointsFromInputCloud ();
+
+    OctreePointCloudVoxelCentroid<PointXYZ>::AlignedPointTVector centroids, centroids_bulk;
+    octree.getVoxelCentroids (centroids);
+    octree_bulk.getVoxelCentroids (centroids_bulk);
+    ASSERT_EQ (centroids.size (), centroids_bulk.size ());
+    for (std::size_t i = 0; i < centroids.size (); ++i)
+    {
+      EXPECT_EQ (centroids[i].x, centroids_bulk[i].x);
+      EXPECT_EQ (centroids[i].y, centroids_bulk[i].y);
+      EXPECT_EQ (centroids[i].z, centroids_bulk[i].z);
+    }
+  }
+}
+
+TEST (PCL, Octree_Pointcloud_Change_Detector_Bulk_Build)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  PointCloud<PointXYZ>::Ptr cloudOut (new PointCloud<PointXYZ> ());
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (std::size_t i = 0; i < 10000; i++)
+  {
+    const PointXYZ point (static_cast<float> (5.0  * rand () / RAND_MAX),
+                          static_cast<float> (10.0 * rand () / RAND_MAX),
+                          static_cast<float> (10.0 * rand () / RAND_MAX));
+    cloudIn->push_back (point);
+    // keep half of the points, and move the others
+    cloudOut->push_back (i % 2 ? point : PointXYZ (point.x + 20.0f, point.y, point.z));
+  }
+
+  OctreePointCloudChangeDetector<PointXYZ> octree (0.01f);
+  octree.setBulkBuild (true);
+  octree.setNumberOfThreads (4);
+  octree.defineBoundingBox (0.0, 0.0, 0.0, 30.0, 30.0, 30.0);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+  const std::size_t leaf_count = octree.getLeafCount ();
+
+  // switch buffers - reset tree
+  octree.switchBuffers ();
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+  EXPECT_EQ (leaf_count, octree.getLeafCount ());
+
+  Indices newPointIdxVector;
+  octree.getPointIndicesFromNewVoxels (newPointIdxVector);
+  EXPECT_TRUE (newPointIdxVector.empty ());
+
+  octree.switchBuffers ();
+  octree.setInputCloud (cloudOut);
+  octree.addPointsFromInputCloud ();
+
+  // reference built one point at a time
+  OctreePointCloudChangeDetector<PointXYZ> octree_ref (0.01f);
+  octree_ref.defineBoundingBox (0.0, 0.0, 0.0, 30.0, 30.0, 30.0);
+  octree_ref.setInputCloud (cloudIn);
+  octree_ref.addPointsFromInputCloud ();
+  octree_ref.switchBuffers ();
+  octree_ref.setInputCloud (cloudOut);
+  octree_ref.addPointsFromInputCloud ();
+
+  Indices newPointIdxVectorRef;
+  octree.getPointIndicesFromNewVoxels (newPointIdxVector);
+  octree_ref.getPointIndicesFromNewVoxels (newPointIdxVectorRef);
+  EXPECT_FALSE (newPointIdxVector.empty ());
+  EXPECT_EQ (newPointIdxVectorRef, newPointIdxVector);
+  for (const auto& index : newPointIdxVector)
+    EXPECT_EQ (0, index % 2);
+}
+
+TEST (PCL, Octree_Pointcloud_Compact)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (std::size_t i = 0; i < 20000; i++)
+    cloudIn->push_back (PointXYZ (static_cast<float> (5.0  * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX)));
+
+  OctreePointCloudSearch<PointXYZ> octree (0.1);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+
+  PointCloud<PointXYZ>::Ptr cloudRef (new PointCloud<PointXYZ> (*cloudIn));
+  OctreePointCloudSearch<PointXYZ> octree_ref (0.1);
+  octree_ref.setInputCloud (cloudRef);
+  octree_ref.addPointsFromInputCloud ();
+
+  octree.compact ();
+  ASSERT_EQ (octree_ref.getLeafCount (), octree.getLeafCount ());
+  ASSERT_EQ (octree_ref.getBranchCount (), octree.getBranchCount ());
+
+  // the depth first order of the leaves is unchanged
+  const auto compareLeaves = [&] ()
+  {
+    auto leaf_itr = octree.leaf_depth_begin ();
+    auto leaf_itr_ref = octree_ref.leaf_depth_begin ();
+    for (; leaf_itr_ref != octree_ref.leaf_depth_end (); ++leaf_itr, ++leaf_itr_ref)
+    {
+      ASSERT_TRUE (leaf_itr != octree.leaf_depth_end ());
+      EXPECT_EQ (leaf_itr_ref.getCurrentOctreeKey (), leaf_itr.getCurrentOctreeKey ());
+      EXPECT_EQ (leaf_itr_ref.getLeafContainer ().getPointIndicesVector (),
+                 leaf_itr.getLeafContainer ().getPointIndicesVector ());
+    }
+    EXPECT_TRUE (leaf_itr == octree.leaf_depth_end ());
+  };
+  compareLeaves ();
+
+  const auto compareSearches = [&] ()
+  {
+    for (std::size_t i = 0; i < 50; i++)
+    {
+      const PointXYZ query (static_cast<float> (5.0  * rand () / RAND_MAX),
+                            static_cast<float> (10.0 * rand () / RAND_MAX),
+                            static_cast<float> (10.0 * rand () / RAND_MAX));
+      Indices k_indices, k_indices_ref;
+      std::vector<float> k_sqr_distances, k_sqr_distances_ref;
+      octree.nearestKSearch (query, 10, k_indices, k_sqr_distances);
+      octree_ref.nearestKSearch (query, 10, k_indices_ref, k_sqr_distances_ref);
+      EXPECT_EQ (k_sqr_distances_ref, k_sqr_distances);
+
+      octree.radiusSearch (query, 0.3, k_indices, k_sqr_distances);
+      octree_ref.radiusSearch (query, 0.3, k_indices_ref, k_sqr_distances_ref);
+      std::sort (k_indices.begin (), k_indices.end ());
+      std::sort (k_indices_ref.begin (), k_indices_ref.end ());
+      EXPECT_EQ (k_indices_ref, k_indices);
+
+      octree.voxelSearch (query, k_indices);
+      octree_ref.voxelSearch (query, k_indices_ref);
+      EXPECT_EQ (k_indices_ref, k_indices);
+    }
+  };
+  compareSearches ();
+
+  // nodes can still be added and removed after compacting
+  for (std::size_t i = 0; i < 1000; i++)
+  {
+    const PointXYZ point (static_cast<float> (8.0  * rand () / RAND_MAX),
+                          static_cast<float> (10.0 * rand () / RAND_MAX),
+                          static_cast<float> (10.0 * rand () / RAND_MAX));
+    octree.addPointToCloud (point, cloudIn);
+    octree_ref.addPointToCloud (point, cloudRef);
+    if (i % 4 == 0)
+    {
+      octree.deleteVoxelAtPoint ((*cloudIn)[i * 7]);
+      octree_ref.deleteVoxelAtPoint ((*cloudIn)[i * 7]);
+    }
+  }
+  ASSERT_EQ (octree_ref.getLeafCount (), octree.getLeafCount ());
+  compareLeaves ();
+  compareSearches ();
+
+  // compacting twice replaces the previous storage
+  octree.compact ();
+  compareLeaves ();
+  compareSearches ();
+
+  const OctreePointCloudSearch<PointXYZ> octree_copy (octree);
+  EXPECT_EQ (octree.getLeafCount (), octree_copy.getLeafCount ());
+
+  octree.deleteTree ();
+  EXPECT_EQ (0, octree.getLeafCount ());
+  EXPECT_TRUE (octree.leaf_depth_begin () == octree.leaf_depth_end ());
+}
+
+TEST (PCL, Octree_Pointcloud_Adjacency_Compact)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  constexpr float resolution = 0.01f;
+  const PointXYZ point (0.2549f, 0.2549f, 0.2549f);
+  cloudIn->push_back (PointXYZ (1, 1, 1));
+  cloudIn->push_back (PointXYZ (-1, -1, -1));
+  for (int dx = -1; dx <= 1; ++dx)
+    for (int dy = -1; dy <= 1; ++dy)
+      for (int dz = -1; dz <= 1; ++dz)
+        cloudIn->push_back (PointXYZ (point.x + dx * resolution,
+                                      point.y + dy * resolution,
+                                      point.z + dz * resolution));
+
+  OctreePointCloudAdjacency<PointXYZ> octree (resolution);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+  // compacting through the base class also rebuilds the leaf vector and the neighbors
+  OctreePointCloudAdjacency<PointXYZ>::OctreeBaseT& octree_base = octree;
+  octree_base.compact ();
+
+  ASSERT_EQ (octree.getLeafCount (), octree.size ());
+  const auto* leaf_container = octree.getLeafContainerAtPoint (point);
+  ASSERT_NE (nullptr, leaf_container);
+  ASSERT_EQ (27, leaf_container->size ());
+  for (auto neighbor_itr = leaf_container->cbegin (); neighbor_itr != leaf_container->cend (); ++neighbor_itr)
+    EXPECT_NE (octree.end (), std::find (octree.begin (), octree.end (), *neighbor_itr));
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
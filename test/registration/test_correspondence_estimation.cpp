@@ -37,6 +37,7 @@
 
 #include <pcl/test/gtest.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/registration/correspondence_estimation.h>
 #include <pcl/registration/correspondence_estimation_normal_shooting.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/kdtree/kdtree.h>
@@ -175,6 +176,49 @@ TYPED_TEST (CorrespondenceEstimationTestSuite, CorrespondenceEstimationSetSearch
   
 }
 
+//////////////////////////////////////////////////////////////////////////////////////
+TYPED_TEST (CorrespondenceEstimationTestSuite, CorrespondenceEstimationNumberOfThreads)
+{
+  using PointSource = typename TypeParam::first_type;
+  using PointTarget = typename TypeParam::second_type;
+  auto cloud1 (pcl::make_shared<pcl::PointCloud<PointSource>> ());
+  auto cloud2 (pcl::make_shared<pcl::PointCloud<PointTarget>> ());
+  for (std::size_t i = 0; i < 1000; i++)
+  {
+    cloud1->push_back(makeRandomPoint<PointSource>());
+    cloud2->push_back(makeRandomPoint<PointTarget>());
+  }
+  const double max_distance = 0.25 * RAND_MAX;
+
+  pcl::registration::CorrespondenceEstimation<PointSource, PointTarget> ce;
+  ce.setInputSource (cloud1);
+  ce.setInputTarget (cloud2);
+  pcl::Correspondences corr_serial, corr_reciprocal_serial;
+  ce.determineCorrespondences (corr_serial, max_distance);
+  ce.determineReciprocalCorrespondences (corr_reciprocal_serial, max_distance);
+  EXPECT_LT (corr_reciprocal_serial.size (), corr_serial.size ());
+
+  ce.setNumberOfThreads (4);
+  pcl::Correspondences corr_parallel, corr_reciprocal_parallel;
+  ce.determineCorrespondences (corr_parallel, max_distance);
+  ce.determineReciprocalCorrespondences (corr_reciprocal_parallel, max_distance);
+
+  // The parallel search must produce exactly the same correspondences, in order
+  ASSERT_EQ (corr_serial.size (), corr_parallel.size ());
+  for (std::size_t i = 0; i < corr_serial.size (); i++)
+  {
+    EXPECT_EQ (corr_serial[i].index_query, corr_parallel[i].index_query);
+    EXPECT_EQ (corr_serial[i].index_match, corr_parallel[i].index_match);
+    EXPECT_EQ (corr_serial[i].distance, corr_parallel[i].distance);
+  }
+  ASSERT_EQ (corr_reciprocal_serial.size (), corr_reciprocal_parallel.size ());
+  for (std::size_t i = 0; i < corr_reciprocal_serial.size (); i++)
+  {
+    EXPECT_EQ (corr_reciprocal_serial[i].index_query, corr_reciprocal_parallel[i].index_query);
+    EXPECT_EQ (corr_reciprocal_serial[i].index_match, corr_reciprocal_parallel[i].index_match);
+  }
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)
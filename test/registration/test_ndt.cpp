@@ -94,6 +94,106 @@ TEST (PCL, NormalDistributionsTransform)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalDistributionsTransformMultithreaded)
+{
+  using PointT = PointNormal;
+  using NDT = NormalDistributionsTransform<PointT, PointT>;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  for (const auto method : {NDT::NeighborSearchMethod::KDTREE, NDT::NeighborSearchMethod::DIRECT7, NDT::NeighborSearchMethod::DIRECT27})
+  {
+    NDT reg;
+    reg.setStepSize (0.05);
+    reg.setResolution (0.025f);
+    reg.setNeighborSearchMethod (method);
+    reg.setInputSource (src);
+    reg.setInputTarget (tgt);
+    reg.setMaximumIterations (50);
+    reg.setTransformationEpsilon (1e-8);
+    reg.align (output);
+    EXPECT_EQ (output.size (), cloud_source.size ());
+    EXPECT_LT (reg.getFitnessScore (), 0.001);
+    const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+    // The result does not depend on the number of threads
+    NDT reg_mt;
+    reg_mt.setNumberOfThreads (4);
+    reg_mt.setStepSize (0.05);
+    reg_mt.setResolution (0.025f);
+    reg_mt.setNeighborSearchMethod (method);
+    reg_mt.setInputSource (src);
+    reg_mt.setInputTarget (tgt);
+    reg_mt.setMaximumIterations (50);
+    reg_mt.setTransformationEpsilon (1e-8);
+    reg_mt.align (output);
+    EXPECT_EQ (output.size (), cloud_source.size ());
+    EXPECT_LT (reg_mt.getFitnessScore (), 0.001);
+    EXPECT_TRUE (reg_mt.getFinalTransformation ().isApprox (transformation, 1e-4f));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalDistributionsTransformTargetMap)
+{
+  using PointT = PointXYZ;
+  using NDT = NormalDistributionsTransform<PointT, PointT>;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  auto map = pcl::make_shared<NDT::TargetMap> (0.025f);
+  map->insert (*tgt);
+
+  for (const auto method : {NDT::NeighborSearchMethod::KDTREE, NDT::NeighborSearchMethod::DIRECT7})
+  {
+    NDT reg;
+    reg.setStepSize (0.05);
+    reg.setResolution (0.025f);
+    reg.setNeighborSearchMethod (method);
+    reg.setInputSource (src);
+    reg.setInputTarget (tgt);
+    reg.setMaximumIterations (50);
+    reg.setTransformationEpsilon (1e-8);
+    reg.align (output);
+
+    // Aligning to the map is the same as aligning to the cloud it was built from
+    NDT reg_map;
+    reg_map.setStepSize (0.05);
+    reg_map.setNeighborSearchMethod (method);
+    reg_map.setInputSource (src);
+    reg_map.setTargetMap (map);
+    reg_map.setMaximumIterations (50);
+    reg_map.setTransformationEpsilon (1e-8);
+    reg_map.align (output);
+    EXPECT_EQ (output.size (), cloud_source.size ());
+    EXPECT_EQ (reg_map.getResolution (), 0.025f);
+    EXPECT_TRUE (reg_map.getFinalTransformation ().isApprox (reg.getFinalTransformation (), 1e-4f));
+
+    // The resolution of the map is kept
+    reg_map.setResolution (0.05f);
+    EXPECT_EQ (reg_map.getResolution (), 0.025f);
+
+    // The target cloud is only replaced if the map was modified
+    const auto target = reg_map.getInputTarget ();
+    reg_map.setTargetMap (map);
+    EXPECT_EQ (reg_map.getInputTarget (), target);
+  }
+
+  NDT reg_map;
+  reg_map.setTargetMap (map);
+  const auto target = reg_map.getInputTarget ();
+  map->insert (*tgt);
+  reg_map.setTargetMap (map);
+  EXPECT_NE (reg_map.getInputTarget (), target);
+}
+
 int
 main (int argc, char** argv)
 {
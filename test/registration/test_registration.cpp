@@ -48,6 +48,7 @@
 #include <pcl/registration/icp_nl.h>
 #include <pcl/registration/gicp.h>
 #include <pcl/registration/gicp6d.h>
+#include <pcl/registration/vgicp.h>
 #include <pcl/registration/transformation_estimation_point_to_plane.h>
 #include <pcl/registration/transformation_validation_euclidean.h>
 #include <pcl/registration/correspondence_rejection_median_distance.h>
@@ -647,6 +648,156 @@ TEST (PCL, GeneralizedIterativeClosestPointBFGS)
   EXPECT_LT (reg.getFitnessScore (), 0.0001);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GeneralizedIterativeClosestPointMultithreaded)
+{
+  using PointT = PointXYZ;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output, output_mt;
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg;
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.align (output);
+  const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg_mt;
+  reg_mt.setNumberOfThreads (4);
+  reg_mt.setInputSource (src);
+  reg_mt.setInputTarget (tgt);
+  reg_mt.setMaximumIterations (50);
+  reg_mt.setTransformationEpsilon (1e-8);
+  reg_mt.align (output_mt);
+  EXPECT_EQ (output_mt.size (), cloud_source.size ());
+  EXPECT_LT (reg_mt.getFitnessScore (), 0.0001);
+  EXPECT_TRUE (reg_mt.getFinalTransformation ().isApprox (transformation, 1e-4f));
+
+  // The covariances computed with several threads match the serial ones
+  ASSERT_TRUE (reg.getTargetCovariances ());
+  ASSERT_TRUE (reg_mt.getTargetCovariances ());
+  ASSERT_EQ (reg.getTargetCovariances ()->size (), reg_mt.getTargetCovariances ()->size ());
+  for (std::size_t i = 0; i < reg.getTargetCovariances ()->size (); ++i)
+    EXPECT_TRUE ((*reg.getTargetCovariances ())[i].isApprox ((*reg_mt.getTargetCovariances ())[i], 1e-8));
+
+  // Reuse the target covariances after setting the same target again
+  auto target_covariances = reg_mt.getTargetCovariances ();
+  reg_mt.setInputTarget (tgt);
+  EXPECT_FALSE (reg_mt.getTargetCovariances ());
+  reg_mt.setTargetCovariances (target_covariances);
+  reg_mt.align (output_mt);
+  EXPECT_EQ (reg_mt.getTargetCovariances (), target_covariances);
+  EXPECT_LT (reg_mt.getFitnessScore (), 0.0001);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, VoxelizedGeneralizedIterativeClosestPoint)
+{
+  using PointT = PointXYZ;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output, output_mt;
+
+  using VGICP = VoxelizedGeneralizedIterativeClosestPoint<PointT, PointT>;
+  VGICP reg;
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setResolution (0.01f);
+  reg.setNeighborSearchMethod (VGICP::NeighborSearchMethod::DIRECT7);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.align (output);
+  EXPECT_TRUE (reg.hasConverged ());
+  EXPECT_EQ (output.size (), cloud_source.size ());
+  EXPECT_LT (reg.getFitnessScore (), 0.0003);
+  EXPECT_FALSE (reg.getVoxels ().empty ());
+  EXPECT_LT (reg.getVoxels ().size (), tgt->size ());
+
+  // The result does not depend on the number of threads
+  VGICP reg_mt;
+  reg_mt.setNumberOfThreads (4);
+  reg_mt.setInputSource (src);
+  reg_mt.setInputTarget (tgt);
+  reg_mt.setResolution (0.01f);
+  reg_mt.setNeighborSearchMethod (VGICP::NeighborSearchMethod::DIRECT7);
+  reg_mt.setMaximumIterations (50);
+  reg_mt.setTransformationEpsilon (1e-8);
+  reg_mt.align (output_mt);
+  EXPECT_TRUE (reg_mt.getFinalTransformation ().isApprox (reg.getFinalTransformation (), 1e-5f));
+
+  // Changing the resolution rebuilds the voxels
+  reg.setResolution (0.03f);
+  reg.align (output);
+  EXPECT_TRUE (reg.hasConverged ());
+  EXPECT_LT (reg.getVoxels ().size (), reg_mt.getVoxels ().size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, VoxelizedGeneralizedIterativeClosestPointTargetMap)
+{
+  using PointT = PointXYZ;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  using VGICP = VoxelizedGeneralizedIterativeClosestPoint<PointT, PointT>;
+  VGICP reg;
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setResolution (0.025f);
+  reg.setNeighborSearchMethod (VGICP::NeighborSearchMethod::DIRECT1);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.align (output);
+  EXPECT_TRUE (reg.hasConverged ());
+
+  auto map = pcl::make_shared<VGICP::TargetMap> (0.025f);
+  map->insert (*tgt);
+
+  VGICP reg_map, reg_map_mt;
+  reg_map_mt.setNumberOfThreads (4);
+  for (VGICP* r : {&reg_map, &reg_map_mt})
+  {
+    r->setInputSource (src);
+    r->setTargetMap (map);
+    r->setNeighborSearchMethod (VGICP::NeighborSearchMethod::DIRECT1);
+    r->setMaximumIterations (50);
+    r->setTransformationEpsilon (1e-8);
+    r->align (output);
+    EXPECT_TRUE (r->hasConverged ());
+    EXPECT_EQ (output.size (), cloud_source.size ());
+    EXPECT_TRUE (r->getVoxels ().empty ());
+  }
+  EXPECT_TRUE (reg_map_mt.getFinalTransformation ().isApprox (reg_map.getFinalTransformation (), 1e-5f));
+
+  // The voxels of the map describe the spread of the points instead of the mean of their
+  // covariances, so the result is close to the one of the target cloud, but not the same
+  const Eigen::Matrix4f delta = reg.getFinalTransformation ().inverse () * reg_map.getFinalTransformation ();
+  const Eigen::AngleAxisf rotation (Eigen::Matrix3f (delta.block (0, 0, 3, 3)));
+  EXPECT_LT (rotation.angle (), 0.035f);
+  EXPECT_LT (delta.block (0, 3, 3, 1).norm (), 0.005f);
+
+  // The resolution of the map is used
+  reg_map.setResolution (0.05f);
+  EXPECT_EQ (reg_map.getResolution (), 0.025f);
+
+  // The target cloud is only replaced if the map was modified
+  const auto target = reg_map.getInputTarget ();
+  reg_map.setTargetMap (map);
+  EXPECT_EQ (reg_map.getInputTarget (), target);
+  map->insert (PointT (1.f, 1.f, 1.f));
+  reg_map.setTargetMap (map);
+  EXPECT_NE (reg_map.getInputTarget (), target);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, GeneralizedIterativeClosestPoint6D)
 {
@@ -93,7 +93,8 @@ using sacTypes = ::testing::Types<
 >;
 TYPED_TEST_SUITE(SacTest, sacTypes);
 
-TYPED_TEST(SacTest, InfiniteLoop)
+template <typename SacT> void
+verifyTerminates (int threads)
 {
   using namespace std::chrono_literals;
 
@@ -108,14 +109,15 @@ TYPED_TEST(SacTest, InfiniteLoop)
   }
 
   SampleConsensusModelSpherePtr model (new SampleConsensusModelSphere<PointXYZ> (cloud.makeShared ()));
-  TypeParam sac (model, 0.03);
+  SacT sac (model, 0.03);
+  sac.setNumberOfThreads (threads);
 
   // This test sometimes fails for LMedS on azure, but always passes when run locally.
   // Enable all output for LMedS, so that when it fails next time, we hopefully see why.
   // This can be removed again when the failure reason is found and fixed.
   int debug_verbosity_level = 0;
   const auto previous_verbosity_level = pcl::console::getVerbosityLevel();
-  if (std::is_same<TypeParam, LeastMedianSquares<PointXYZ>>::value) {
+  if (std::is_same<SacT, LeastMedianSquares<PointXYZ>>::value) {
     debug_verbosity_level = 2;
     pcl::console::setVerbosityLevel(pcl::console::L_VERBOSE);
   }
@@ -149,6 +151,16 @@ TYPED_TEST(SacTest, InfiniteLoop)
   pcl::console::setVerbosityLevel(previous_verbosity_level); // reset verbosity level
 }
 
+TYPED_TEST(SacTest, InfiniteLoop)
+{
+  verifyTerminates<TypeParam> (-1);
+}
+
+TYPED_TEST(SacTest, InfiniteLoopParallel)
+{
+  verifyTerminates<TypeParam> (4);
+}
+
 int
 main (int argc, char** argv)
 {
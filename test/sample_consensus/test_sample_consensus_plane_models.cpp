@@ -47,6 +47,7 @@
 #include <pcl/sample_consensus/lmeds.h>
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/mlesac.h>
+#include <pcl/sample_consensus/prosac.h>
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/rransac.h>
 #include <pcl/sample_consensus/sac_model_plane.h>
@@ -315,6 +316,83 @@ TEST (SampleConsensusModelPlane, RMSAC)
   verifyPlaneSac (model, sac, 600, 1.0f, 1.0f, 0.01f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, Parallel)
+{
+  // Create a shared plane model pointer directly
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+
+  // Every method evaluates its hypotheses on several threads, each one with its own random number stream
+  {
+    LeastMedianSquares<PointXYZ> sac (model, 0.03);
+    sac.setNumberOfThreads (4);
+    verifyPlaneSac (model, sac);
+  }
+  {
+    MEstimatorSampleConsensus<PointXYZ> sac (model, 0.03);
+    sac.setNumberOfThreads (4);
+    verifyPlaneSac (model, sac);
+  }
+  {
+    RandomizedRandomSampleConsensus<PointXYZ> sac (model, 0.03);
+    sac.setFractionNrPretest (0.1);
+    sac.setNumberOfThreads (4);
+    verifyPlaneSac (model, sac, 600, 1.0f, 1.0f, 0.01f);
+  }
+  {
+    MaximumLikelihoodSampleConsensus<PointXYZ> sac (model, 0.03);
+    sac.setNumberOfThreads (4);
+    verifyPlaneSac (model, sac, 1000, 0.3f, 0.2f, 0.01f);
+  }
+  {
+    RandomizedMEstimatorSampleConsensus<PointXYZ> sac (model, 0.03);
+    sac.setFractionNrPretest (0.1);
+    sac.setNumberOfThreads (4);
+    verifyPlaneSac (model, sac, 600, 1.0f, 1.0f, 0.01f);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, PROSACSamplingPool)
+{
+  // Points sorted by quality: 100 points on the plane z = 0 first, then 900 points far above it
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> ());
+  cloud->resize (1000);
+  srand (0);
+  for (std::size_t i = 0; i < cloud->size (); ++i)
+  {
+    (*cloud)[i].x = static_cast<float> (rand ()) / static_cast<float> (RAND_MAX);
+    (*cloud)[i].y = static_cast<float> (rand ()) / static_cast<float> (RAND_MAX);
+    (*cloud)[i].z = (i < 100) ? 0.0f : 1.0f + static_cast<float> (rand ()) / static_cast<float> (RAND_MAX);
+  }
+
+  // PROSAC grows its sampling pool by at most one point per sample, so with 20 trials
+  // all samples are drawn from the first few points of the cloud, with one or several threads
+  for (const int threads : {-1, 4})
+  {
+    SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+    ProgressiveSampleConsensus<PointXYZ> sac (model, 0.01);
+    sac.setMaxIterations (20);
+    sac.setNumberOfThreads (threads);
+    ASSERT_TRUE (sac.computeModel ());
+
+    pcl::Indices sample;
+    sac.getModel (sample);
+    ASSERT_EQ (3, sample.size ());
+    for (const auto &index : sample)
+      EXPECT_GT (40, index);
+
+    pcl::Indices inliers;
+    sac.getInliers (inliers);
+    EXPECT_EQ (100, inliers.size ());
+
+    Eigen::VectorXf coeff;
+    sac.getModelCoefficients (coeff);
+    EXPECT_NEAR (1.0f, std::abs (coeff[2]), 1e-4f);
+    EXPECT_NEAR (0.0f, coeff[3], 1e-4f);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelNormalPlane, RANSAC)
 {
@@ -67,6 +67,8 @@ using namespace pcl;
 #define TEST_ORGANIZED_SPARSE_VIEW_KNN                1
 #define TEST_ORGANIZED_SPARSE_COMPLETE_RADIUS         1
 #define TEST_ORGANIZED_SPARSE_VIEW_RADIUS             1
+#define TEST_unorganized_dense_cloud_BATCH            1
+#define TEST_ORGANIZED_SPARSE_BATCH                   1
 
 #if EXCESSIVE_TESTING
 /** \brief number of points used for creating unordered point clouds */
@@ -446,6 +448,50 @@ testRadiusSearch (typename PointCloud<PointT>::ConstPtr point_cloud, std::vector
   }
 }
 
+/** \brief compares the batched searches, which write into NeighborLists, with single point searches of the same method
+  * \param point_cloud point cloud to be searched
+  * \param search_methods vector of all search methods to be tested
+  * \param query_indices indices of query points in the point cloud (not necessarily in input_indices)
+  */
+template<typename PointT> void
+testBatchSearch (typename PointCloud<PointT>::ConstPtr point_cloud, std::vector<search::Search<PointT>*> search_methods,
+                 const pcl::Indices& query_indices)
+{
+  constexpr int knn = 10;
+  constexpr double radius = 0.05;
+  for (auto& search_method : search_methods)
+  {
+    search_method->setInputCloud (point_cloud);
+    for (const unsigned int threads : {1u, 4u})
+    {
+      search_method->setNumberOfThreads (threads);
+      pcl::search::NeighborLists knn_neighbors, radius_neighbors;
+      search_method->nearestKSearch (*point_cloud, query_indices, knn, knn_neighbors);
+      search_method->radiusSearch (*point_cloud, query_indices, radius, radius_neighbors);
+      ASSERT_EQ (query_indices.size (), knn_neighbors.size ());
+      ASSERT_EQ (query_indices.size (), radius_neighbors.size ());
+      ASSERT_EQ (knn_neighbors.indices.size (), knn_neighbors.sqr_distances.size ());
+      ASSERT_EQ (radius_neighbors.indices.size (), radius_neighbors.sqr_distances.size ());
+
+      pcl::Indices indices;
+      std::vector<float> distances;
+      for (std::size_t i = 0; i < query_indices.size (); ++i)
+      {
+        search_method->nearestKSearch ((*point_cloud)[query_indices[i]], knn, indices, distances);
+        const auto neighbors = knn_neighbors[i];
+        EXPECT_EQ (indices, pcl::Indices (neighbors.begin (), neighbors.end ())) << search_method->getName ();
+        EXPECT_EQ (distances, std::vector<float> (knn_neighbors.getSqrDistances (i),
+                                                  knn_neighbors.getSqrDistances (i) + neighbors.size ())) << search_method->getName ();
+
+        search_method->radiusSearch ((*point_cloud)[query_indices[i]], radius, indices, distances);
+        const auto radius_list = radius_neighbors[i];
+        EXPECT_EQ (indices, pcl::Indices (radius_list.begin (), radius_list.end ())) << search_method->getName ();
+      }
+    }
+    search_method->setNumberOfThreads (1);
+  }
+}
+
 #if TEST_unorganized_dense_cloud_COMPLETE_KNN
 // Test search on unorganized point clouds
 TEST (PCL, unorganized_dense_cloud_Complete_KNN)
@@ -552,6 +598,20 @@ TEST (PCL, Organized_Sparse_View_Radius)
 }
 #endif
 
+#if TEST_unorganized_dense_cloud_BATCH
+TEST (PCL, unorganized_dense_cloud_Batch)
+{
+  testBatchSearch (unorganized_dense_cloud, unorganized_search_methods, unorganized_dense_cloud_query_indices);
+}
+#endif
+
+#if TEST_ORGANIZED_SPARSE_BATCH
+TEST (PCL, Organized_Sparse_Batch)
+{
+  testBatchSearch (organized_sparse_cloud, organized_search_methods, organized_sparse_query_indices);
+}
+#endif
+
 /** \brief create subset of point in cloud to use as query points
   * \param[out] query_indices resulting query indices - not guaranteed to have size of query_count but guaranteed not to exceed that value
   * \param cloud input cloud required to check for nans and to get number of points
@@ -44,6 +44,10 @@
 #include <pcl/search/search.h>
 #include <pcl/features/normal_3d.h>
 
+#include <pcl/search/kdtree.h>
+#include <pcl/search/organized.h>
+
+#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 #include <pcl/segmentation/region_growing.h>
@@ -92,6 +96,31 @@ TEST (RegionGrowingTest, Segment)
   EXPECT_NE (0, num_of_segments);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingTest, Multithreaded)
+{
+  for (const bool merging : {false, true})
+  {
+    std::vector<std::vector <pcl::PointIndices> > results;
+    for (const unsigned int threads : {1, 4})
+    {
+      pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+      rg.setInputCloud (cloud_);
+      rg.setInputNormals (normals_);
+      rg.setRegionMergingFlag (merging);
+      rg.setNumberOfThreads (threads);
+      EXPECT_EQ (merging, rg.getRegionMergingFlag ());
+
+      results.emplace_back ();
+      rg.extract (results.back ());
+      EXPECT_NE (0, results.back ().size ());
+    }
+    ASSERT_EQ (results[0].size (), results[1].size ());
+    for (std::size_t i = 0; i < results[0].size (); ++i)
+      EXPECT_EQ (results[0][i].indices, results[1][i].indices);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RegionGrowingTest, SegmentWithoutCloud)
 {
@@ -334,6 +363,81 @@ TEST (MinCutSegmentationTest, SegmentWithWrongParameters)
   EXPECT_EQ (2, num_of_segments);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, Multithreaded)
+{
+  for (const auto &input : {std::make_pair (cloud_, 0.005), std::make_pair (another_cloud_, 0.05)})
+  {
+    EuclideanClusterExtraction<PointXYZ> ec;
+    ec.setInputCloud (input.first);
+    ec.setClusterTolerance (input.second);
+    ec.setMinClusterSize (2);
+    std::vector<PointIndices> clusters;
+    ec.extract (clusters);
+    EXPECT_GT (clusters.size (), 1);
+
+    // The union-find variant finds the same clusters, in the same order
+    ec.setNumberOfThreads (4);
+    std::vector<PointIndices> clusters_mt;
+    ec.extract (clusters_mt);
+    ASSERT_EQ (clusters_mt.size (), clusters.size ());
+    for (std::size_t i = 0; i < clusters.size (); ++i)
+      EXPECT_EQ (clusters_mt[i].indices, clusters[i].indices);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, Organized)
+{
+  // Two objects in front of a wall, seen by a pinhole camera, with a hole in a corner
+  const unsigned width = 160, height = 120;
+  const float focal_length = 100.0f;
+  PointCloud<PointXYZ>::Ptr organized (new PointCloud<PointXYZ> (width, height));
+  IndicesPtr finite (new Indices);
+  for (unsigned v = 0; v < height; ++v)
+  {
+    for (unsigned u = 0; u < width; ++u)
+    {
+      PointXYZ &point = (*organized) (u, v);
+      if (u > 100 && v > 90)
+      {
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+        continue;
+      }
+      point.z = 3.0f;
+      if (u > 20 && u < 60 && v > 20 && v < 100)
+        point.z = 1.0f;
+      else if (u > 80 && u < 140 && v > 30 && v < 70)
+        point.z = 1.5f + 0.002f * static_cast<float> (u);
+      point.x = (static_cast<float> (u) - 0.5f * width) * point.z / focal_length;
+      point.y = (static_cast<float> (v) - 0.5f * height) * point.z / focal_length;
+      finite->push_back (static_cast<index_t> (v * width + u));
+    }
+  }
+
+  search::Search<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ>);
+  tree->setInputCloud (organized, finite);
+  std::vector<PointIndices> clusters;
+  extractEuclideanClusters (*organized, *finite, tree, 0.05f, clusters, 1, std::numeric_limits<int>::max ());
+  std::sort (clusters.rbegin (), clusters.rend (), comparePointClusters);
+  EXPECT_EQ (clusters.size (), 3);
+
+  // The search box of the organized neighbor search is scanned directly
+  for (const unsigned int nr_threads : {1u, 4u})
+  {
+    EuclideanClusterExtraction<PointXYZ> ec;
+    ec.setInputCloud (organized);
+    ec.setIndices (finite);
+    ec.setClusterTolerance (0.05);
+    ec.setNumberOfThreads (nr_threads);
+    std::vector<PointIndices> clusters_organized;
+    ec.extract (clusters_organized);
+    ASSERT_EQ (clusters_organized.size (), clusters.size ());
+    for (std::size_t i = 0; i < clusters.size (); ++i)
+      EXPECT_EQ (clusters_organized[i].indices, clusters[i].indices);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SegmentDifferences, Segmentation)
 {